@@ -0,0 +1,57 @@
+#!/bin/bash
+#
+# Builds the headless runner twice on Linux, once as a plain optimised build and once optimised with the profile of a
+# training run over the snapshots in the test directory, and compares the speed of both emulator cores.
+#
+#   ./pgo-build.sh [build directory prefix] [frames per snapshot]
+#
+# The profile guided build is made in three steps in the same build directory, as GCC looks for the profile of each
+# object file under the path of that object file:
+#
+#   cmake -DZX_PGO=Generate ..   build an instrumented core
+#   make zxbenchmark             run the training run, which writes the profile
+#   cmake -DZX_PGO=Use ..        rebuild the core with the profile
+#
+
+set -e
+
+SOURCE_DIR="$(cd "$(dirname "$0")" && pwd)"
+PREFIX="${1:-${SOURCE_DIR}/cmake-build}"
+FRAMES="${2:-5000}"
+JOBS="$(nproc 2>/dev/null || echo 4)"
+
+RELEASE_DIR="${PREFIX}-release"
+PGO_DIR="${PREFIX}-pgo"
+
+echo "Building the optimised core in ${RELEASE_DIR}"
+cmake -S "${SOURCE_DIR}" -B "${RELEASE_DIR}" -DCMAKE_BUILD_TYPE=Release -DZX_PGO=Off > /dev/null
+cmake --build "${RELEASE_DIR}" --target zxheadless -j"${JOBS}"
+
+echo "Building the instrumented core in ${PGO_DIR}"
+rm -rf "${PGO_DIR}/pgo"
+cmake -S "${SOURCE_DIR}" -B "${PGO_DIR}" -DCMAKE_BUILD_TYPE=Release -DZX_PGO=Generate \
+      -DZX_BENCHMARK_FRAMES="${FRAMES}" > /dev/null
+cmake --build "${PGO_DIR}" --target zxheadless -j"${JOBS}"
+
+echo "Training run"
+cmake --build "${PGO_DIR}" --target zxbenchmark > /dev/null
+
+echo "Building the core with the profile of the training run"
+cmake -S "${SOURCE_DIR}" -B "${PGO_DIR}" -DZX_PGO=Use > /dev/null
+cmake --build "${PGO_DIR}" --target zxheadless -j"${JOBS}"
+
+# Prints the average emulated clock, in MHz, of a headless runner over the snapshots in the test directory
+benchmark() {
+    local runner="$1"
+    for snapshot in "${SOURCE_DIR}"/test/*.sna; do
+        "${runner}" --frames "${FRAMES}" "${snapshot}" 2> /dev/null
+        "${runner}" --frames "${FRAMES}" --scanline "${snapshot}" 2> /dev/null
+    done | awk '/^Emulated clock:/ { total += $3; runs++ } END { if (runs > 0) printf "%.2f\n", total / runs }'
+}
+
+RELEASE_MHZ="$(benchmark "${RELEASE_DIR}/zxheadless")"
+PGO_MHZ="$(benchmark "${PGO_DIR}/zxheadless")"
+
+echo "Optimised core:                    ${RELEASE_MHZ} MHz"
+echo "Profile guided optimised core:     ${PGO_MHZ} MHz"
+awk -v release="${RELEASE_MHZ}" -v pgo="${PGO_MHZ}" 'BEGIN { printf "Speedup:                           %.1f%%\n", (pgo / release - 1) * 100 }'
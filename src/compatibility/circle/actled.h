@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_ACTLED_H
+#define CIRCLE_ACTLED_H
+
+#include "types.h"
+
+/*
+ * The activity LED only remembers whether it is on.
+ */
+class CActLED {
+
+public:
+    void On() {
+        m_bOn = TRUE;
+    }
+
+    void Off() {
+        m_bOn = FALSE;
+    }
+
+    void Blink(unsigned /* nCount */, unsigned /* nTimeOnMs */ = 200, unsigned /* nTimeOffMs */ = 500) {
+        m_bOn = FALSE;
+    }
+
+    // Only in the simulation
+    [[nodiscard]] boolean IsOn() const {
+        return m_bOn;
+    }
+
+private:
+    boolean m_bOn = FALSE;
+
+};
+
+#endif // CIRCLE_ACTLED_H
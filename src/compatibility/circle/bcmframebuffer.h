@@ -21,9 +21,12 @@
 
 
 #include "types.h"
-#include <QtGlobal>
-#include <QtDebug>
+#include "logger.h"
 
+/*
+ * A framebuffer in memory, in place of the one the VideoCore GPU scans out to the screen.  The virtual offset is kept
+ * so that the part of a double or triple buffered framebuffer that would be on the screen can be found.
+ */
 class CBcmFrameBuffer {
 
 private:
@@ -34,8 +37,12 @@ private:
     unsigned nVirtualHeight = 0;
     unsigned nDisplay = 0;
     bool bDoubleBuffered = false;
+    unsigned nOffsetX = 0;
+    unsigned nOffsetY = 0;
     uint32_t *m_pBuffer = nullptr;
 
+    static inline CBcmFrameBuffer *s_pDisplayed = nullptr;
+
 public:
 
     uint32_t palette[256] = {0};
@@ -51,54 +58,76 @@ public:
         this->nDisplay = nDisplay;
         this->bDoubleBuffered = bDoubleBuffered;
 
-        // TODO: change data type according to the colour depth (min 8 bits)
-        m_pBuffer = new uint32_t[((long int) nWidth * nHeight) / 4];
+        // Allocate at least one byte per pixel, as the example programs expect, and more for the deeper colour depths.
+        // A virtual height larger than the height holds multiple frames, e.g. for double or triple buffering.
+        m_pBuffer = new uint32_t[(GetSize() + 3) / 4]();
+    };
+
+
+    ~CBcmFrameBuffer() {
+
+        if (s_pDisplayed == this) {
+            s_pDisplayed = nullptr;
+        }
+        delete[] m_pBuffer;
     };
 
 
-    ~CBcmFrameBuffer() = default;
+    CBcmFrameBuffer(const CBcmFrameBuffer &) = delete;
+    CBcmFrameBuffer &operator=(const CBcmFrameBuffer &) = delete;
 
 
     void SetPalette(u8 nIndex, u16 nRGB565) {
 
-        if ((nIndex >= 0) && (nIndex <= 255)) {
-            /* Z80 spectrum palette.  Please note that the bit order in attribute memory
-             * is GRB in attribute whilst QImage is expecting RGB.  In this method, we are
-             * re-ordering, i.e. swapping around the R and B components, to avoid having
-             * to swap attribute bits around when decoding colors.
-              *
-             * - http://www.overtakenbyevents.com/lets-talk-about-the-zx-specrum-screen-layout/
-             * - https://forum.arduino.cc/index.php?topic=285303.0
-             *
-             * The correct conversion, without colour component swapping is:
-             *
-             * uint32_t nRGBA;
-             * nRGBA  = (uint32_t) (nRGB565 >> 11 & 0x1F) << (0+3);   // red
-             * nRGBA |= (uint32_t) (nRGB565 >> 5  & 0x3F) << (8+2);   // green
-             * nRGBA |= (uint32_t) (nRGB565       & 0x1F) << (16+3);  // blue
-             * nRGBA |=                             0xFF  << 24;      // alpha
-             */
-            uint32_t nRGBA;
-            nRGBA = (uint32_t) (nRGB565 & 0x1F) << (0 + 3);  // blue
-            nRGBA |= (uint32_t) (nRGB565 >> 5 & 0x3F) << (8 + 2);  // green
-            nRGBA |= (uint32_t) (nRGB565 >> 11 & 0x1F) << (16 + 3); // red
-            nRGBA |= 0xFF << 24;     // alpha
-
-            qDebug("Palette[0x%02X] = nRGBA: 0x%08X (RGB565: 0x%04X)", nIndex, nRGBA, nRGB565);
-
-            palette[nIndex] = nRGBA;
-        } else {
-            qCritical("Palette index 0x%02X is out of bounds", nIndex);
-        }
+        /* Z80 spectrum palette.  Please note that the bit order in attribute memory
+         * is GRB in attribute whilst QImage is expecting RGB.  In this method, we are
+         * re-ordering, i.e. swapping around the R and B components, to avoid having
+         * to swap attribute bits around when decoding colors.
+          *
+         * - http://www.overtakenbyevents.com/lets-talk-about-the-zx-specrum-screen-layout/
+         * - https://forum.arduino.cc/index.php?topic=285303.0
+         *
+         * The correct conversion, without colour component swapping is:
+         *
+         * uint32_t nRGBA;
+         * nRGBA  = (uint32_t) (nRGB565 >> 11 & 0x1F) << (0+3);   // red
+         * nRGBA |= (uint32_t) (nRGB565 >> 5  & 0x3F) << (8+2);   // green
+         * nRGBA |= (uint32_t) (nRGB565       & 0x1F) << (16+3);  // blue
+         * nRGBA |=                             0xFF  << 24;      // alpha
+         */
+        uint32_t nRGBA;
+        nRGBA = (uint32_t) (nRGB565 & 0x1F) << (0 + 3);  // blue
+        nRGBA |= (uint32_t) (nRGB565 >> 5 & 0x3F) << (8 + 2);  // green
+        nRGBA |= (uint32_t) (nRGB565 >> 11 & 0x1F) << (16 + 3); // red
+        nRGBA |= 0xFF << 24;     // alpha
+
+        CLogger::Get()->Write("bcmframebuffer", LogDebug, "Palette[0x%02X] = nRGBA: 0x%08X (RGB565: 0x%04X)",
+                              nIndex, nRGBA, nRGB565);
+
+        palette[nIndex] = nRGBA;
     };
 
 
+    // The framebuffer initialised last is the one on the screen
     bool Initialize() {
 
+        s_pDisplayed = this;
         return true;
     };
 
 
+    [[nodiscard]] u32 GetWidth() const {
+
+        return nWidth;
+    };
+
+
+    [[nodiscard]] u32 GetHeight() const {
+
+        return nHeight;
+    };
+
+
     [[nodiscard]] u32 *GetBuffer() const {
 
         return reinterpret_cast<u32 *>(m_pBuffer);
@@ -107,15 +136,41 @@ public:
 
     [[nodiscard]] u32 GetSize() const {
 
-        return nWidth * nHeight;
+        return nWidth * ((nVirtualHeight > nHeight) ? nVirtualHeight : nHeight) * ((nDepth > 8) ? nDepth : 8) / 8;
+    };
+
+
+    [[nodiscard]] u32 GetDepth() const {
+
+        return nDepth;
     };
 
 
-    void SetVirtualOffset(int, int) {
+    boolean SetVirtualOffset(u32 nOffsetX, u32 nOffsetY) {
+
+        this->nOffsetX = nOffsetX;
+        this->nOffsetY = nOffsetY;
+        return TRUE;
     }
 
 
-    void WaitForVerticalSync() {
+    boolean WaitForVerticalSync() {
+
+        return TRUE;
+    }
+
+
+    // Only in the simulation: the first row of the framebuffer on the screen
+    [[nodiscard]] u32 GetOffsetY() const {
+
+        return nOffsetY;
+    }
+
+
+    // Only in the simulation: the framebuffer on the screen, if any has been initialised
+    static CBcmFrameBuffer *GetDisplayed() {
+
+        return s_pDisplayed;
     }
 
 };
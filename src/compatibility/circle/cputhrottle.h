@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_CPUTHROTTLE_H
+#define CIRCLE_CPUTHROTTLE_H
+
+#include "types.h"
+
+enum TCPUSpeed {
+    CPUSpeedLow,
+    CPUSpeedMaximum,
+    CPUSpeedUnknown
+};
+
+/*
+ * The host decides how fast its CPU runs, so the throttle reports the maximum clock rate of the Raspberry Pi 4 and
+ * ignores any change of speed.
+ */
+class CCPUThrottle {
+
+public:
+    static const unsigned CLOCK_RATE = 1500000000;
+
+    explicit CCPUThrottle(TCPUSpeed /* InitialSpeed */ = CPUSpeedUnknown) {
+        s_pThis = this;
+    }
+
+    ~CCPUThrottle() {
+        if (s_pThis == this) {
+            s_pThis = nullptr;
+        }
+    }
+
+    static CCPUThrottle *Get() {
+        return s_pThis;
+    }
+
+    [[nodiscard]] unsigned GetClockRate() const {
+        return CLOCK_RATE;
+    }
+
+    boolean SetSpeed(TCPUSpeed /* Speed */, boolean /* bWait */ = TRUE) {
+        return TRUE;
+    }
+
+private:
+    static inline CCPUThrottle *s_pThis = nullptr;
+
+};
+
+#endif // CIRCLE_CPUTHROTTLE_H
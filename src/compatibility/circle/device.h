@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_DEVICE_H
+#define CIRCLE_DEVICE_H
+
+/*
+ * Base class of the devices that can be looked up by name in the device name service.
+ */
+class CDevice {
+
+public:
+    virtual ~CDevice() = default;
+
+};
+
+#endif // CIRCLE_DEVICE_H
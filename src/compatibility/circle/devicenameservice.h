@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_DEVICENAMESERVICE_H
+#define CIRCLE_DEVICENAMESERVICE_H
+
+#include <map>
+#include <string>
+#include "device.h"
+#include "types.h"
+
+/*
+ * Looks up the devices by name, e.g. "ukbd1", or by prefix and index, e.g. "upad" and 1.  As in Circle, the most
+ * recently constructed name service is the one returned by Get(), which is the one the kernel sets up.
+ */
+class CDeviceNameService {
+
+public:
+    CDeviceNameService() : m_pPrevious(s_pThis) {
+        s_pThis = this;
+    }
+
+    ~CDeviceNameService() {
+        if (s_pThis == this) {
+            s_pThis = m_pPrevious;
+        }
+    }
+
+    CDeviceNameService(const CDeviceNameService &) = delete;
+    CDeviceNameService &operator=(const CDeviceNameService &) = delete;
+
+    static CDeviceNameService *Get() {
+        return s_pThis;
+    }
+
+    void AddDevice(const char *pName, CDevice *pDevice, boolean bBlockDevice) {
+        m_devices[key(pName, bBlockDevice)] = pDevice;
+    }
+
+    void AddDevice(const char *pPrefix, unsigned nIndex, CDevice *pDevice, boolean bBlockDevice) {
+        AddDevice((pPrefix + std::to_string(nIndex)).c_str(), pDevice, bBlockDevice);
+    }
+
+    void RemoveDevice(const char *pName, boolean bBlockDevice) {
+        m_devices.erase(key(pName, bBlockDevice));
+    }
+
+    CDevice *GetDevice(const char *pName, boolean bBlockDevice) const {
+        auto device = m_devices.find(key(pName, bBlockDevice));
+        return (device != m_devices.end()) ? device->second : nullptr;
+    }
+
+    CDevice *GetDevice(const char *pPrefix, unsigned nIndex, boolean bBlockDevice) const {
+        return GetDevice((pPrefix + std::to_string(nIndex)).c_str(), bBlockDevice);
+    }
+
+private:
+    // Block and character devices may have the same name
+    static std::string key(const char *pName, boolean bBlockDevice) {
+        return std::string(bBlockDevice ? "b:" : "c:") + pName;
+    }
+
+    std::map<std::string, CDevice *> m_devices;
+    CDeviceNameService *m_pPrevious;
+
+    static inline CDeviceNameService *s_pThis = nullptr;
+
+};
+
+#endif // CIRCLE_DEVICENAMESERVICE_H
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_GPIOPIN_H
+#define CIRCLE_GPIOPIN_H
+
+#include "types.h"
+#include "simulation.h"
+
+#define LOW     0
+#define HIGH    1
+
+enum TGPIOMode {
+    GPIOModeInput,
+    GPIOModeOutput,
+    GPIOModeInputPullUp,
+    GPIOModeInputPullDown,
+    GPIOModeAlternateFunction0,
+    GPIOModeUnknown
+};
+
+/*
+ * A GPIO pin whose input level is set by the simulation script.  A floating input pin reads as its pull-up or
+ * pull-down resistor sets it.
+ */
+class CGPIOPin {
+
+public:
+    CGPIOPin(unsigned nPin, TGPIOMode Mode) : m_nPin(nPin), m_Mode(Mode) {
+    }
+
+    unsigned Read() const {
+        return CSimulation::Get().ReadPin(m_nPin, (m_Mode == GPIOModeInputPullUp) ? HIGH : LOW);
+    }
+
+    void Write(unsigned nValue) {
+        if (m_Mode == GPIOModeOutput) {
+            CSimulation::Get().SetPin(m_nPin, nValue);
+        }
+    }
+
+private:
+    unsigned m_nPin;
+    TGPIOMode m_Mode;
+
+};
+
+#endif // CIRCLE_GPIOPIN_H
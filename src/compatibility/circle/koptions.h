@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_KOPTIONS_H
+#define CIRCLE_KOPTIONS_H
+
+#include <map>
+#include <string>
+
+/*
+ * The kernel options, which Circle reads from cmdline.txt on the boot partition, come from the ZX_SIM_CMDLINE
+ * environment variable in the simulation, e.g. ZX_SIM_CMDLINE="loglevel=3 runahead=1".
+ */
+class CKernelOptions {
+
+public:
+    CKernelOptions();
+    ~CKernelOptions();
+
+    static CKernelOptions *Get();
+
+    [[nodiscard]] unsigned GetLogLevel() const;
+
+    // Returns the value of an option not known to Circle, or the default if the option is not set or not a number
+    unsigned GetAppOptionDecimal(const char *pOption, unsigned nDefault) const;
+    const char *GetAppOptionString(const char *pOption, const char *pDefault = nullptr) const;
+
+private:
+    std::map<std::string, std::string> m_options;
+
+    static CKernelOptions *s_pThis;
+
+};
+
+#endif // CIRCLE_KOPTIONS_H
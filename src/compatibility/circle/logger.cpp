@@ -16,6 +16,48 @@
  * You should have received a copy of the GNU General Public License
  * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <cstdarg>
 #include "logger.h"
+#include "timer.h"
 
-CLogger *CLogger::instance = new CLogger();
+CLogger *CLogger::s_pThis = nullptr;
+
+// Logs the messages written before the kernel, or anything else, sets up a logger of its own
+static CLogger DefaultLogger;
+
+
+CLogger::CLogger(unsigned nLogLevel, CTimer *pTimer, boolean /* bOverwriteOldest */) :
+        m_nLogLevel(nLogLevel), m_pTimer(pTimer), m_pPrevious(s_pThis) {
+
+    s_pThis = this;
+}
+
+
+CLogger::~CLogger() {
+
+    if (s_pThis == this) {
+        s_pThis = m_pPrevious;
+    }
+}
+
+
+void CLogger::Write(const char *pSource, TLogSeverity Severity, const char *pMessage, ...) {
+
+    if (static_cast<unsigned>(Severity) > m_nLogLevel) {
+        return;
+    }
+
+    char message[256];
+    va_list argptr;
+    va_start(argptr, pMessage);
+    vsnprintf(message, sizeof message, pMessage, argptr);
+    va_end(argptr);
+
+    if (m_pTimer != nullptr) {
+        unsigned hundredths = CTimer::GetClockTicks() / (CLOCKHZ / 100);
+        fprintf(stderr, "%02u:%02u:%02u.%02u %s: %s\n", hundredths / 360000, hundredths / 6000 % 60,
+                hundredths / 100 % 60, hundredths % 100, pSource, message);
+    } else {
+        fprintf(stderr, "%s: %s\n", pSource, message);
+    }
+}
@@ -19,8 +19,7 @@
 #ifndef CIRCLE_LOGGER_H
 #define CIRCLE_LOGGER_H
 
-#include <cstdarg>
-#include <QDebug>
+#include "types.h"
 
 enum TLogSeverity
 {
@@ -31,22 +30,33 @@ enum TLogSeverity
     LogDebug	// Message, which is only interesting for debugging this component
 };
 
+class CDevice;
+class CTimer;
+
+/*
+ * Writes the log messages to the standard error.  As in Circle, the most recently constructed logger is the system
+ * logger returned by Get(), e.g. the one set up by the kernel, and messages above its log level are discarded.  Only
+ * a logger constructed with a timer prefixes its messages with the time since start-up.
+ */
 class CLogger {
 
 private:
-    static CLogger *instance;
+    static CLogger *s_pThis;
+
+    unsigned m_nLogLevel;
+    CTimer *m_pTimer;
+    CLogger *m_pPrevious;
 
 public:
-    CLogger() = default;
-    static CLogger *Get() { return instance; };
-    void Write(const char *pSource, TLogSeverity /* Severity */, const char *pMessage, ...) {
-        char message[256];
-        va_list argptr;
-        va_start(argptr, pMessage);
-        vsprintf(message, pMessage, argptr);
-        va_end(argptr);
-        qDebug() << pSource << message;
-    };
+    explicit CLogger(unsigned nLogLevel = LogDebug, CTimer *pTimer = nullptr, boolean bOverwriteOldest = TRUE);
+    ~CLogger();
+
+    CLogger(const CLogger &) = delete;
+    CLogger &operator=(const CLogger &) = delete;
+
+    boolean Initialize(CDevice * /* pTarget */) { return TRUE; };
+    static CLogger *Get() { return s_pThis; };
+    void Write(const char *pSource, TLogSeverity Severity, const char *pMessage, ...);
 
 };
 
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_MEMORY_H
+#define CIRCLE_MEMORY_H
+
+/*
+ * The memory is managed by the host operating system, so there is only the one memory system to hand to the
+ * multi-core support.
+ */
+class CMemorySystem {
+
+public:
+    static CMemorySystem *Get() {
+        static CMemorySystem memorySystem;
+        return &memorySystem;
+    }
+
+};
+
+#endif // CIRCLE_MEMORY_H
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_MULTICORE_H
+#define CIRCLE_MULTICORE_H
+
+#include <thread>
+#include "types.h"
+
+// Multi-core support is always available on the desktop, as if Circle had been built with it
+#ifndef ARM_ALLOW_MULTI_CORE
+#define ARM_ALLOW_MULTI_CORE
+#endif
+
+// Number of cores of the Raspberry Pi 2 and later, as defined in circle/sysconfig.h
+#ifndef CORES
+#define CORES 4
+#endif
+
+class CMemorySystem;
+
+/*
+ * Runs the secondary cores as threads, so that code written for Circle's multi-core support also runs on the desktop.
+ * Unlike on the Raspberry Pi, Run() is expected to return when the emulator shuts down, as the threads are joined
+ * when this object is destroyed; derived classes must make sure Run() has returned on every core before that.
+ */
+class CMultiCoreSupport {
+
+public:
+    explicit CMultiCoreSupport(CMemorySystem * /* pMemorySystem */) {
+    }
+
+    virtual ~CMultiCoreSupport() {
+        for (auto &thread : m_threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    // Starts Run() for cores 1 to CORES - 1
+    boolean Initialize() {
+        for (unsigned nCore = 1; nCore < CORES; nCore++) {
+            m_threads[nCore - 1] = std::thread(&CMultiCoreSupport::Run, this, nCore);
+        }
+        return TRUE;
+    }
+
+    virtual void Run(unsigned nCore) = 0;
+
+private:
+    std::thread m_threads[CORES - 1];
+};
+
+#endif // CIRCLE_MULTICORE_H
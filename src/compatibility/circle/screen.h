@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_SCREEN_H
+#define CIRCLE_SCREEN_H
+
+#include "device.h"
+#include "types.h"
+
+/*
+ * The text screen is not used by the emulator, which draws straight to the framebuffer.
+ */
+class CScreenDevice : public CDevice {
+
+public:
+    CScreenDevice(unsigned /* nWidth */, unsigned /* nHeight */, boolean /* bVirtual */ = FALSE) {
+    }
+
+    boolean Initialize() {
+        return TRUE;
+    }
+
+};
+
+#endif // CIRCLE_SCREEN_H
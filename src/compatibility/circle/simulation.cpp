@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "simulation.h"
+#include "bcmframebuffer.h"
+#include "devicenameservice.h"
+#include "koptions.h"
+#include "logger.h"
+#include "startup.h"
+#include "timer.h"
+#include "usb/usbgamepad.h"
+#include "usb/usbhcidevice.h"
+#include "usb/usbkeyboard.h"
+
+static const char FromSimulation[] = "simulation";
+
+
+CSimulation &CSimulation::Get() {
+
+    static CSimulation simulation;
+    return simulation;
+}
+
+
+CSimulation::CSimulation() {
+
+    const char *pTime = getenv("ZX_SIM_TIME");
+    CTimer::SetVirtualTime(pTime != nullptr && strcmp(pTime, "virtual") == 0);
+    CTimer::SetDelayHandler(delayHandler);
+    m_lastTicks = CTimer::GetClockTicks();
+
+    const char *pScript = getenv("ZX_SIM_SCRIPT");
+    if (pScript != nullptr && !LoadScript(pScript)) {
+        CLogger::Get()->Write(FromSimulation, LogError, "Cannot load the simulation script %s", pScript);
+    }
+
+    m_pDumpFile = getenv("ZX_SIM_DUMP");
+}
+
+
+void CSimulation::delayHandler() {
+
+    Get().Play();
+}
+
+
+void CSimulation::AttachKeyboard(CUSBKeyboardDevice *pKeyboard) {
+
+    m_pKeyboard = pKeyboard;
+}
+
+
+void CSimulation::AttachGamePad(CUSBGamePadDevice *pGamePad) {
+
+    m_pGamePad = pGamePad;
+}
+
+
+boolean CSimulation::AddEvent(const char *pLine) {
+
+    char *pNext;
+    Event event{};
+    event.time = strtoull(pLine, &pNext, 0) * 1000;
+    if (pNext == pLine) {
+        return FALSE;
+    }
+
+    char action[16];
+    int length = 0;
+    if (sscanf(pNext, " %15s%n", action, &length) != 1) {
+        return FALSE;
+    }
+    pNext += length;
+
+    if (strcmp(action, "keys") == 0) {
+        event.action = Action::Keys;
+        char *pValue = pNext;
+        event.value = strtoul(pValue, &pNext, 0);
+        if (pNext == pValue) {
+            return FALSE;
+        }
+        for (unsigned char &key : event.keys) {
+            pValue = pNext;
+            key = static_cast<unsigned char>(strtoul(pValue, &pNext, 0));
+            if (pNext == pValue) {
+                break;
+            }
+        }
+    } else if (strcmp(action, "buttons") == 0) {
+        event.action = Action::Buttons;
+        char *pValue = pNext;
+        event.value = strtoul(pValue, &pNext, 0);
+        if (pNext == pValue) {
+            return FALSE;
+        }
+    } else if (strcmp(action, "gpio") == 0) {
+        event.action = Action::Gpio;
+        if (sscanf(pNext, "%u %u", &event.pin, &event.value) != 2) {
+            return FALSE;
+        }
+    } else if (strcmp(action, "halt") == 0) {
+        event.action = Action::Halt;
+    } else {
+        return FALSE;
+    }
+
+    // Keep the events in order of time, and those at the same time in the order in which they were added
+    auto position = std::upper_bound(m_events.begin() + static_cast<long>(m_nextEvent), m_events.end(), event,
+                                     [](const Event &a, const Event &b) { return a.time < b.time; });
+    m_events.insert(position, event);
+    return TRUE;
+}
+
+
+boolean CSimulation::LoadScript(const char *pFileName) {
+
+    FILE *pFile = fopen(pFileName, "r");
+    if (pFile == nullptr) {
+        return FALSE;
+    }
+
+    char line[256];
+    unsigned lineNumber = 0;
+    boolean bOK = TRUE;
+    while (fgets(line, sizeof line, pFile) != nullptr) {
+        lineNumber++;
+        const char *pLine = line + strspn(line, " \t");
+        if (*pLine == '#' || *pLine == '\n' || *pLine == '\r' || *pLine == '\0') {
+            continue;
+        }
+        if (!AddEvent(pLine)) {
+            CLogger::Get()->Write(FromSimulation, LogError, "%s:%u: cannot understand the event", pFileName,
+                                  lineNumber);
+            bOK = FALSE;
+        }
+    }
+
+    fclose(pFile);
+    return bOK;
+}
+
+
+void CSimulation::Play() {
+
+    // The devices may wait, and so play the events, while handling an event
+    if (m_bPlaying) {
+        return;
+    }
+    m_bPlaying = true;
+
+    unsigned ticks = CTimer::GetClockTicks();
+    m_elapsed += ticks - m_lastTicks;
+    m_lastTicks = ticks;
+
+    while (m_nextEvent < m_events.size() && m_events[m_nextEvent].time <= m_elapsed) {
+        const Event event = m_events[m_nextEvent++];
+        switch (event.action) {
+            case Action::Keys:
+                if (m_pKeyboard != nullptr) {
+                    m_pKeyboard->SimulateKeyStatus(static_cast<unsigned char>(event.value), event.keys);
+                }
+                break;
+            case Action::Buttons:
+                if (m_pGamePad != nullptr) {
+                    m_pGamePad->SimulateButtons(event.value);
+                }
+                break;
+            case Action::Gpio:
+                SetPin(event.pin, event.value);
+                break;
+            case Action::Halt:
+                halt();
+        }
+    }
+
+    m_bPlaying = false;
+}
+
+
+size_t CSimulation::PendingEvents() const {
+
+    return m_events.size() - m_nextEvent;
+}
+
+
+unsigned CSimulation::ReadPin(unsigned nPin, unsigned nDefault) {
+
+    Play();
+
+    auto pin = m_pins.find(nPin);
+    return (pin != m_pins.end()) ? pin->second : nDefault;
+}
+
+
+void CSimulation::SetPin(unsigned nPin, unsigned nLevel) {
+
+    m_pins[nPin] = (nLevel != 0) ? 1 : 0;
+}
+
+
+/*
+ * Writes the frame on the screen as a binary PPM image, looking up the colours of 4 and 8 bit pixels in the palette.
+ * The 4 bit pixels are packed two to a byte, the one on the left in the upper nibble.
+ */
+boolean CSimulation::DumpFrameBuffer(const char *pFileName) {
+
+    const CBcmFrameBuffer *pFrameBuffer = CBcmFrameBuffer::GetDisplayed();
+    if (pFrameBuffer == nullptr) {
+        return FALSE;
+    }
+
+    const unsigned width = pFrameBuffer->GetWidth();
+    const unsigned height = pFrameBuffer->GetHeight();
+    const unsigned depth = pFrameBuffer->GetDepth();
+    const auto *pFrame = reinterpret_cast<const uint8_t *>(pFrameBuffer->GetBuffer()) +
+                         static_cast<size_t>(pFrameBuffer->GetOffsetY()) * width * depth / 8;
+
+    FILE *pFile = fopen(pFileName, "wb");
+    if (pFile == nullptr) {
+        return FALSE;
+    }
+
+    fprintf(pFile, "P6\n%u %u\n255\n", width, height);
+    for (unsigned i = 0; i < width * height; i++) {
+        uint32_t xrgb;
+        switch (depth) {
+            case 4:
+                xrgb = pFrameBuffer->palette[(pFrame[i / 2] >> ((i & 1) ? 0 : 4)) & 0x0Fu];
+                break;
+            case 8:
+                xrgb = pFrameBuffer->palette[pFrame[i]];
+                break;
+            case 16: {
+                uint16_t rgb565 = reinterpret_cast<const uint16_t *>(pFrame)[i];
+                xrgb = ((rgb565 >> 11 & 0x1Fu) << 19) | ((rgb565 >> 5 & 0x3Fu) << 10) | ((rgb565 & 0x1Fu) << 3);
+                break;
+            }
+            default:
+                xrgb = reinterpret_cast<const uint32_t *>(pFrame)[i];
+                break;
+        }
+        const uint8_t rgb[3] = {
+                static_cast<uint8_t>(xrgb >> 16), static_cast<uint8_t>(xrgb >> 8), static_cast<uint8_t>(xrgb)
+        };
+        fwrite(rgb, 1, sizeof rgb, pFile);
+    }
+
+    return fclose(pFile) == 0;
+}
+
+
+void CSimulation::Exit(int nStatus) {
+
+    CLogger::Get()->Write(FromSimulation, LogNotice, "Simulation ended with %s after %llu us",
+                          (nStatus == EXIT_REBOOT) ? "reboot" : "halt", static_cast<unsigned long long>(m_elapsed));
+
+    if (m_pDumpFile != nullptr && !DumpFrameBuffer(m_pDumpFile)) {
+        CLogger::Get()->Write(FromSimulation, LogError, "Cannot write the frame on the screen to %s", m_pDumpFile);
+    }
+
+    // The secondary cores may still be running, so leave without destroying anything that they may be using
+    fflush(stdout);
+    fflush(stderr);
+    std::_Exit(nStatus);
+}
+
+
+void halt() {
+
+    CSimulation::Get().Exit(EXIT_HALT);
+}
+
+
+void reboot() {
+
+    CSimulation::Get().Exit(EXIT_REBOOT);
+}
+
+
+CKernelOptions *CKernelOptions::s_pThis = nullptr;
+
+
+CKernelOptions::CKernelOptions() {
+
+    // Set the simulation up before anything else in the kernel, e.g. the timer, is used
+    CSimulation::Get();
+
+    const char *pCommandLine = getenv("ZX_SIM_CMDLINE");
+    std::string commandLine = (pCommandLine != nullptr) ? pCommandLine : "";
+    size_t start = 0;
+    while ((start = commandLine.find_first_not_of(' ', start)) != std::string::npos) {
+        size_t end = commandLine.find(' ', start);
+        std::string option = commandLine.substr(start, end - start);
+        size_t equals = option.find('=');
+        if (equals != std::string::npos) {
+            m_options[option.substr(0, equals)] = option.substr(equals + 1);
+        }
+        start = end;
+    }
+
+    s_pThis = this;
+}
+
+
+CKernelOptions::~CKernelOptions() {
+
+    if (s_pThis == this) {
+        s_pThis = nullptr;
+    }
+}
+
+
+CKernelOptions *CKernelOptions::Get() {
+
+    return s_pThis;
+}
+
+
+unsigned CKernelOptions::GetLogLevel() const {
+
+    return GetAppOptionDecimal("loglevel", LogDebug);
+}
+
+
+unsigned CKernelOptions::GetAppOptionDecimal(const char *pOption, unsigned nDefault) const {
+
+    auto option = m_options.find(pOption);
+    if (option == m_options.end() || option->second.empty()) {
+        return nDefault;
+    }
+
+    char *pEnd;
+    unsigned long value = strtoul(option->second.c_str(), &pEnd, 10);
+    return (*pEnd == '\0') ? static_cast<unsigned>(value) : nDefault;
+}
+
+
+const char *CKernelOptions::GetAppOptionString(const char *pOption, const char *pDefault) const {
+
+    auto option = m_options.find(pOption);
+    return (option != m_options.end()) ? option->second.c_str() : pDefault;
+}
+
+
+CUSBHCIDevice::CUSBHCIDevice(CInterruptSystem * /* pInterruptSystem */, CTimer * /* pTimer */,
+                             boolean /* bPlugAndPlay */) {
+}
+
+
+CUSBHCIDevice::~CUSBHCIDevice() {
+
+    CSimulation::Get().AttachKeyboard(nullptr);
+    CSimulation::Get().AttachGamePad(nullptr);
+    delete m_pKeyboard;
+    delete m_pGamePad;
+}
+
+
+boolean CUSBHCIDevice::Initialize() {
+
+    CDeviceNameService *pDeviceNameService = CDeviceNameService::Get();
+    if (pDeviceNameService == nullptr) {
+        return FALSE;
+    }
+
+    m_pKeyboard = new CUSBKeyboardDevice();
+    pDeviceNameService->AddDevice("ukbd", 1, m_pKeyboard, FALSE);
+    CSimulation::Get().AttachKeyboard(m_pKeyboard);
+
+    m_pGamePad = new CUSBGamePadDevice(0);
+    pDeviceNameService->AddDevice("upad", 1, m_pGamePad, FALSE);
+    CSimulation::Get().AttachGamePad(m_pGamePad);
+
+    return TRUE;
+}
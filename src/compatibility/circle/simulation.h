@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_SIMULATION_H
+#define CIRCLE_SIMULATION_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "types.h"
+
+class CUSBKeyboardDevice;
+class CUSBGamePadDevice;
+
+/*
+ * Stands in for the world outside the Raspberry Pi so that the kernel can run, unchanged, on a Linux host.  It is set
+ * up from these environment variables the first time that it is used:
+ *
+ *   ZX_SIM_TIME=virtual  run in virtual time, which only moves on when the kernel waits, rather than in real time
+ *   ZX_SIM_SCRIPT=file   play the input events in the file when they become due
+ *   ZX_SIM_DUMP=file     write the frame on the screen to a binary PPM file when the simulation ends
+ *
+ * The script has one event per line, given as the time in milliseconds since the simulation started followed by the action, e.g.
+ *
+ *   # Press ENTER for 100ms, then hold FIRE on the gamepad, then press SW3 on the Maker pHAT to reboot
+ *   3000 keys 0x00 0x28
+ *   3100 keys 0x00
+ *   4000 buttons 0x200
+ *   6000 gpio 20 0
+ *
+ * where "keys" takes the USB keyboard modifiers and up to 6 usage IDs, "buttons" the TGamePadButton bits held down,
+ * "gpio" the pin and its input level, and "halt" ends the simulation.  Blank lines and lines starting with '#' are
+ * ignored.
+ */
+class CSimulation {
+
+public:
+    static CSimulation &Get();
+
+    CSimulation(const CSimulation &) = delete;
+    CSimulation &operator=(const CSimulation &) = delete;
+
+    void AttachKeyboard(CUSBKeyboardDevice *pKeyboard);
+    void AttachGamePad(CUSBGamePadDevice *pGamePad);
+
+    // Adds the event in the line of a script, returning FALSE if the line cannot be understood
+    boolean AddEvent(const char *pLine);
+    boolean LoadScript(const char *pFileName);
+
+    // Plays the events that have become due
+    void Play();
+    [[nodiscard]] size_t PendingEvents() const;
+
+    // Returns the input level of the pin, or the given level if nothing has set it
+    unsigned ReadPin(unsigned nPin, unsigned nDefault);
+    void SetPin(unsigned nPin, unsigned nLevel);
+
+    static boolean DumpFrameBuffer(const char *pFileName);
+
+    // Ends the simulation with the given exit status, after writing the frame on the screen if asked to
+    [[noreturn]] void Exit(int nStatus);
+
+private:
+    CSimulation();
+
+    enum class Action {
+        Keys,
+        Buttons,
+        Gpio,
+        Halt
+    };
+
+    struct Event {
+        uint64_t time;      // microseconds
+        Action action;
+        unsigned value;     // keyboard modifiers, gamepad buttons or pin level
+        unsigned pin;
+        unsigned char keys[6];
+    };
+
+    static void delayHandler();
+
+    std::vector<Event> m_events;
+    size_t m_nextEvent = 0;
+    unsigned m_lastTicks;
+    uint64_t m_elapsed = 0;
+    bool m_bPlaying = false;
+    std::map<unsigned, unsigned> m_pins;
+    CUSBKeyboardDevice *m_pKeyboard = nullptr;
+    CUSBGamePadDevice *m_pGamePad = nullptr;
+    const char *m_pDumpFile = nullptr;
+
+};
+
+#endif // CIRCLE_SIMULATION_H
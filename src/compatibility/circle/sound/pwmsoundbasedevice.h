@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_SOUND_PWMSOUNDBASEDEVICE_H
+#define CIRCLE_SOUND_PWMSOUNDBASEDEVICE_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../types.h"
+
+class CInterruptSystem;
+
+/*
+ * The PWM sound device asks for a chunk of samples, as the DMA interrupt handler does on the Raspberry Pi, every time
+ * the previous chunk would have finished playing, from a thread of its own that keeps to real time.  The samples go
+ * nowhere.
+ */
+class CPWMSoundBaseDevice {
+
+public:
+    explicit CPWMSoundBaseDevice(CInterruptSystem * /* pInterrupt */, unsigned nSampleRate = 44100,
+                                 unsigned nChunkSize = 2048) :
+            m_nSampleRate(nSampleRate),
+            m_nChunkSize(nChunkSize),
+            m_bActive(false) {
+    }
+
+    virtual ~CPWMSoundBaseDevice() {
+        Cancel();
+    }
+
+    // As on the Raspberry Pi, the range of the samples follows from the PWM clock and the sample rate
+    [[nodiscard]] int GetRangeMin() const {
+        return 0;
+    }
+
+    [[nodiscard]] int GetRangeMax() const {
+        return static_cast<int>(PWM_CLOCK / m_nSampleRate);
+    }
+
+    boolean Start() {
+        if (m_bActive) {
+            return FALSE;
+        }
+        m_bActive = true;
+        m_Player = std::thread(&CPWMSoundBaseDevice::Play, this);
+        return TRUE;
+    }
+
+    // Unlike on the Raspberry Pi, the device has stopped once this returns
+    void Cancel() {
+        m_bActive = false;
+        if (m_Player.joinable()) {
+            m_Player.join();
+        }
+    }
+
+    [[nodiscard]] boolean IsActive() const {
+        return m_bActive;
+    }
+
+protected:
+    // Fills the chunk with interleaved left and right samples and returns how many it wrote, 0 to stop
+    virtual unsigned GetChunk(u32 *pBuffer, unsigned nChunkSize) = 0;
+
+private:
+    static const unsigned PWM_CLOCK = 62500000;
+
+    void Play() {
+        std::vector<u32> chunk(m_nChunkSize);
+        auto chunkTime = std::chrono::microseconds(1000000ull * m_nChunkSize / 2 / m_nSampleRate);
+        auto deadline = std::chrono::steady_clock::now();
+        while (m_bActive) {
+            if (GetChunk(chunk.data(), m_nChunkSize) == 0) {
+                m_bActive = false;
+                break;
+            }
+            deadline += chunkTime;
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+
+    const unsigned m_nSampleRate;
+    const unsigned m_nChunkSize;
+    std::atomic<bool> m_bActive;
+    std::thread m_Player;
+
+};
+
+#endif // CIRCLE_SOUND_PWMSOUNDBASEDEVICE_H
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_STARTUP_H
+#define CIRCLE_STARTUP_H
+
+// The exit codes of the simulation for each way in which the kernel can shut down
+#define EXIT_HALT	0
+#define EXIT_REBOOT	1
+
+/*
+ * Halting or rebooting ends the simulation, as there is no one to turn the power off or to start it all over again.
+ */
+[[noreturn]] void halt();
+[[noreturn]] void reboot();
+
+#endif // CIRCLE_STARTUP_H
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_STRING_H
+#define CIRCLE_STRING_H
+
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+
+/*
+ * Circle's string class, on top of the standard library.
+ */
+class CString {
+
+public:
+    CString() = default;
+
+    CString(const char *pString) : m_string(pString) {
+    }
+
+    operator const char *() const {
+        return m_string.c_str();
+    }
+
+    CString &operator=(const char *pString) {
+        m_string = pString;
+        return *this;
+    }
+
+    [[nodiscard]] size_t GetLength() const {
+        return m_string.length();
+    }
+
+    void Append(const char *pString) {
+        m_string.append(pString);
+    }
+
+    void Format(const char *pFormat, ...) {
+        va_list args;
+        va_start(args, pFormat);
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        int nLength = vsnprintf(nullptr, 0, pFormat, argsCopy);
+        va_end(argsCopy);
+        m_string.assign((nLength > 0) ? nLength : 0, '\0');
+        if (nLength > 0) {
+            vsnprintf(&m_string[0], nLength + 1, pFormat, args);
+        }
+        va_end(args);
+    }
+
+private:
+    std::string m_string;
+
+};
+
+#endif // CIRCLE_STRING_H
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_TIMER_H
+#define CIRCLE_TIMER_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "types.h"
+
+// The Circle system timer ticks once per microsecond
+#define CLOCKHZ 1000000
+
+class CInterruptSystem;
+
+/*
+ * Circle's system timer, which either follows the host clock or, in virtual time, only moves on when a delay is
+ * waited for, so that a run does not depend on how fast the host is.  Virtual time belongs to the thread that turns it
+ * on, normally the one running the kernel; delays on any other thread, e.g. the secondary cores, take real time.
+ *
+ * The delay handler, if any, is called after every delay of the thread that owns the time, which lets the simulation
+ * play the input events that became due while waiting, much as the interrupt handlers would on the Raspberry Pi.
+ */
+class CTimer {
+
+public:
+    typedef void TDelayHandler();
+
+    explicit CTimer(CInterruptSystem * /* pInterruptSystem */ = nullptr) {
+    }
+
+    boolean Initialize() {
+        return TRUE;
+    }
+
+    static unsigned GetClockTicks() {
+        if (s_bVirtual) {
+            return static_cast<unsigned>(s_nVirtualTicks.load());
+        }
+
+        return static_cast<unsigned>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - s_Start).count());
+    }
+
+    void MsDelay(unsigned nMilliSeconds) {
+        SimpleMsDelay(nMilliSeconds);
+    }
+
+    void usDelay(unsigned nMicroSeconds) {
+        SimpleusDelay(nMicroSeconds);
+    }
+
+    static void SimpleMsDelay(unsigned nMilliSeconds) {
+        SimpleusDelay(nMilliSeconds * 1000);
+    }
+
+    static void SimpleusDelay(unsigned nMicroSeconds) {
+        bool bOwner = (std::this_thread::get_id() == s_Owner);
+        if (s_bVirtual && bOwner) {
+            s_nVirtualTicks += nMicroSeconds;
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(nMicroSeconds));
+        }
+
+        if (bOwner && s_pDelayHandler != nullptr) {
+            (*s_pDelayHandler)();
+        }
+    }
+
+    // Only in the simulation: switches between the host clock and virtual time, which starts from zero
+    static void SetVirtualTime(boolean bVirtual) {
+        s_nVirtualTicks = 0;
+        s_Owner = std::this_thread::get_id();
+        s_bVirtual = bVirtual;
+    }
+
+    // Only in the simulation: sets the function called after the delays of the thread that owns the time
+    static void SetDelayHandler(TDelayHandler *pHandler) {
+        s_Owner = std::this_thread::get_id();
+        s_pDelayHandler = pHandler;
+    }
+
+private:
+    static inline const std::chrono::steady_clock::time_point s_Start = std::chrono::steady_clock::now();
+    static inline std::atomic<uint64_t> s_nVirtualTicks{0};
+    static inline std::atomic<bool> s_bVirtual{false};
+    static inline std::thread::id s_Owner;
+    static inline TDelayHandler *s_pDelayHandler = nullptr;
+
+};
+
+#endif // CIRCLE_TIMER_H
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_USB_USBGAMEPAD_H
+#define CIRCLE_USB_USBGAMEPAD_H
+
+#include "../device.h"
+#include "../types.h"
+
+#define MAX_AXIS    16
+#define MAX_HATS    6
+
+// The gamepad state in Circle's common format
+struct TGamePadState {
+    int naxes;
+    struct {
+        int value;
+        int minimum;
+        int maximum;
+    } axes[MAX_AXIS];
+
+    int nhats;
+    int hats[MAX_HATS];
+
+    int nbuttons;
+    unsigned buttons;
+};
+
+// The digital buttons, as the bits of TGamePadState::buttons
+enum TGamePadButton {
+    GamePadButtonGuide = 1u << 0,
+#define GamePadButtonXbox       GamePadButtonGuide
+#define GamePadButtonPS         GamePadButtonGuide
+#define GamePadButtonHome       GamePadButtonGuide
+    GamePadButtonLT = 1u << 3,
+#define GamePadButtonL2         GamePadButtonLT
+    GamePadButtonRT = 1u << 4,
+#define GamePadButtonR2         GamePadButtonRT
+    GamePadButtonLB = 1u << 5,
+#define GamePadButtonL1         GamePadButtonLB
+    GamePadButtonRB = 1u << 6,
+#define GamePadButtonR1         GamePadButtonRB
+    GamePadButtonY = 1u << 7,
+#define GamePadButtonTriangle   GamePadButtonY
+    GamePadButtonB = 1u << 8,
+#define GamePadButtonCircle     GamePadButtonB
+    GamePadButtonA = 1u << 9,
+#define GamePadButtonCross      GamePadButtonA
+    GamePadButtonX = 1u << 10,
+#define GamePadButtonSquare     GamePadButtonX
+    GamePadButtonSelect = 1u << 11,
+#define GamePadButtonBack       GamePadButtonSelect
+#define GamePadButtonShare      GamePadButtonSelect
+    GamePadButtonStart = 1u << 12,
+#define GamePadButtonOptions    GamePadButtonStart
+    GamePadButtonUp = 1u << 15,
+    GamePadButtonRight = 1u << 16,
+    GamePadButtonDown = 1u << 17,
+    GamePadButtonLeft = 1u << 18
+};
+
+// The analog axes and buttons, as the indices of TGamePadState::axes
+enum TGamePadAxis {
+    GamePadAxisLeftX,
+    GamePadAxisLeftY,
+    GamePadAxisRightX,
+    GamePadAxisRightY,
+    GamePadAxisButtonLT,
+#define GamePadAxisButtonL2     GamePadAxisButtonLT
+    GamePadAxisButtonRT,
+#define GamePadAxisButtonR2     GamePadAxisButtonRT
+    GamePadAxisButtonUp,
+    GamePadAxisButtonRight,
+    GamePadAxisButtonDown,
+    GamePadAxisButtonLeft,
+    GamePadAxisButtonL1,
+    GamePadAxisButtonR1,
+    GamePadAxisButtonTriangle,
+    GamePadAxisButtonCircle,
+    GamePadAxisButtonCross,
+    GamePadAxisButtonSquare,
+    GamePadAxisUnknown
+};
+
+enum TGamePadProperty {
+    GamePadPropertyIsKnown = 1u << 0,
+    GamePadPropertyHasLED = 1u << 1,
+    GamePadPropertyHasRGBLED = 1u << 2,
+    GamePadPropertyHasRumble = 1u << 3
+};
+
+enum TGamePadRumbleMode {
+    GamePadRumbleModeOff,
+    GamePadRumbleModeLow,
+    GamePadRumbleModeHigh,
+    GamePadRumbleModeUnknown
+};
+
+typedef void TGamePadStatusHandler(unsigned nDeviceIndex, const TGamePadState *pState);
+
+/*
+ * A gamepad with a known mapping but no analog controls, whose buttons are pressed by the simulation script.  It
+ * reports its state to the status handler, which is given the index of the device counting from 0.
+ */
+class CUSBGamePadDevice : public CDevice {
+
+public:
+    explicit CUSBGamePadDevice(unsigned nDeviceIndex) : m_nDeviceIndex(nDeviceIndex), m_State{} {
+        m_State.nbuttons = 19;
+    }
+
+    [[nodiscard]] unsigned GetProperties() const {
+        return GamePadPropertyIsKnown;
+    }
+
+    const TGamePadState *GetInitialState() {
+        return &m_State;
+    }
+
+    void RegisterStatusHandler(TGamePadStatusHandler *pStatusHandler) {
+        m_pStatusHandler = pStatusHandler;
+    }
+
+    boolean SetRumbleMode(TGamePadRumbleMode /* Mode */) {
+        return FALSE;
+    }
+
+    // Only in the simulation: reports the buttons held down, as the gamepad does periodically
+    void SimulateButtons(unsigned nButtons) {
+        m_State.buttons = nButtons;
+        if (m_pStatusHandler != nullptr) {
+            (*m_pStatusHandler)(m_nDeviceIndex, &m_State);
+        }
+    }
+
+private:
+    unsigned m_nDeviceIndex;
+    TGamePadState m_State;
+    TGamePadStatusHandler *m_pStatusHandler = nullptr;
+
+};
+
+#endif // CIRCLE_USB_USBGAMEPAD_H
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_USB_USBHCIDEVICE_H
+#define CIRCLE_USB_USBHCIDEVICE_H
+
+#include "../types.h"
+
+class CInterruptSystem;
+class CTimer;
+class CUSBKeyboardDevice;
+class CUSBGamePadDevice;
+
+/*
+ * The USB host controller of the simulation finds a keyboard, "ukbd1", and a gamepad, "upad1", both of which are
+ * driven by the simulation script.
+ */
+class CUSBHCIDevice {
+
+public:
+    CUSBHCIDevice(CInterruptSystem *pInterruptSystem, CTimer *pTimer, boolean bPlugAndPlay = FALSE);
+    ~CUSBHCIDevice();
+
+    CUSBHCIDevice(const CUSBHCIDevice &) = delete;
+    CUSBHCIDevice &operator=(const CUSBHCIDevice &) = delete;
+
+    boolean Initialize();
+
+private:
+    CUSBKeyboardDevice *m_pKeyboard = nullptr;
+    CUSBGamePadDevice *m_pGamePad = nullptr;
+
+};
+
+#endif // CIRCLE_USB_USBHCIDEVICE_H
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CIRCLE_USB_USBKEYBOARD_H
+#define CIRCLE_USB_USBKEYBOARD_H
+
+#include <cstring>
+#include "../device.h"
+#include "../types.h"
+
+typedef void TKeyPressedHandler(const char *pString);
+typedef void TShutdownHandler();
+typedef void TKeyStatusHandlerRaw(unsigned char ucModifiers, const unsigned char RawKeys[6]);
+
+/*
+ * A USB keyboard driven by the simulation script, which only reports in raw mode: the modifiers and the usage IDs of
+ * up to six keys held down, as in the boot protocol report.
+ */
+class CUSBKeyboardDevice : public CDevice {
+
+public:
+    void RegisterKeyPressedHandler(TKeyPressedHandler *pKeyPressedHandler) {
+        m_pKeyPressedHandler = pKeyPressedHandler;
+    }
+
+    void RegisterShutdownHandler(TShutdownHandler *pShutdownHandler) {
+        m_pShutdownHandler = pShutdownHandler;
+    }
+
+    void RegisterKeyStatusHandlerRaw(TKeyStatusHandlerRaw *pKeyStatusHandlerRaw) {
+        m_pKeyStatusHandlerRaw = pKeyStatusHandlerRaw;
+    }
+
+    // Only in the simulation: reports the keys held down, as the keyboard does whenever they change
+    void SimulateKeyStatus(unsigned char ucModifiers, const unsigned char RawKeys[6]) {
+        memcpy(m_rawKeys, RawKeys, sizeof m_rawKeys);
+        if (m_pKeyStatusHandlerRaw != nullptr) {
+            (*m_pKeyStatusHandlerRaw)(ucModifiers, m_rawKeys);
+        }
+    }
+
+private:
+    TKeyPressedHandler *m_pKeyPressedHandler = nullptr;
+    TShutdownHandler *m_pShutdownHandler = nullptr;
+    TKeyStatusHandlerRaw *m_pKeyStatusHandlerRaw = nullptr;
+    unsigned char m_rawKeys[6] = {0};
+
+};
+
+#endif // CIRCLE_USB_USBKEYBOARD_H
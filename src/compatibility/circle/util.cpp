@@ -48,10 +48,3 @@ uint16_t bswap16(uint16_t usValue) {
 #endif
 }
 
-
-void *memset(void *pBuffer, int nValue, size_t nLength) {     
-    for (unsigned int i=0; i<nLength; i++) {
-        *(reinterpret_cast<uint8_t *>(pBuffer) + i) = (uint8_t) nValue;
-    }
-    return pBuffer; 
-};
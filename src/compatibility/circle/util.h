@@ -26,10 +26,12 @@
 // This header inclusion provides the definition of size_t
 #include <cstdio>
 
+// The C library provides the memory and string functions that Circle declares here, e.g. memset() and memcmp()
+#include <cstring>
+
 
 uint32_t bswap32(uint32_t ulValue);
 uint16_t bswap16(uint16_t usValue);
-void *memset(void *pBuffer, int nValue, size_t nLength);
 
 
 #endif // CIRCLE_UTIL_H
@@ -18,11 +18,16 @@
  */
 #include <streambuf>
 #include <istream>
+#include <algorithm>
 #include <cstring>
 #include <circle/logger.h>
 #include <circle/util.h>
 #include <common/hardware/zxhardwaremodel48k.h>
 #include "zxdisplay.h"
+#include "zxinputqueue.h"
+#include "audio/zxay.h"
+#include "audio/zxbeeper.h"
+#include "audio/zxtapeinput.h"
 #include "Z80emu.h"
 #include "keyboard.h"
 #include "clock.h"
@@ -43,18 +48,57 @@ struct imemstream: virtual membuf, std::istream {
 };
 
 using namespace std;
+// Hardware model until the front end selects one
 static ZxHardwareModel48k model48K;
 
+static const uint32_t PAGE_SIZE = 0x4000;
+// Offset of each RAM bank and of ROM 1 in the memory, in pages (see m_pMemory), and the size of the memory
+static const uint32_t BANK_PAGE[8] = { 3, 4, 2, 5, 6, 1, 7, 8 };
+static const uint32_t ROM1_PAGE = 9;
+static const uint32_t MEMORY_SIZE = 10 * PAGE_SIZE;
+
+/* Port 0x7FFD of the 128K: RAM bank paged in at 0xC000, screen displayed (bank 5 or 7), ROM paged in at 0x0000 (the
+ * 128K editor or 48K BASIC), and a lock that ignores any further writes until the machine is reset.
+ *
+ * Reference: [Sinclair Wiki: ZX Spectrum 128](https://sinclair.wiki.zxnet.co.uk/wiki/ZX_Spectrum_128)
+ */
+static const uint8_t PAGING_BANK = 0x07u;
+static const uint8_t PAGING_SCREEN = 0x08u;
+static const uint8_t PAGING_ROM = 0x10u;
+static const uint8_t PAGING_LOCK = 0x20u;
+
+// 48K and 128K SNA snapshots; the latter has the remaining banks after the PC and paging, and may hold one twice
+static const size_t SNA_HEADER_SIZE = 27;
+static const size_t SNA_48K_SIZE = SNA_HEADER_SIZE + 3 * PAGE_SIZE;
+static const size_t SNA_128K_SIZE = SNA_48K_SIZE + 4 + 5 * PAGE_SIZE;
+static const size_t SNA_128K_LONG_SIZE = SNA_128K_SIZE + PAGE_SIZE;
+
 
 static const char msgFromULA[] = "[ULA    ]";
 
 
 Z80emu::Z80emu(ZxDisplay *pZxDisplay) :
     cpu(this),
+    m_pMemory(new uint8_t[MEMORY_SIZE]()),
+    m_pPages(),
+    m_pScreen(m_pMemory + BANK_PAGE[5] * PAGE_SIZE),
+    m_screenPage(),
+    m_pModel(&model48K),
+    m_paging(0),
     m_border(0x07u),
-    m_pZxDisplay(pZxDisplay)
+    m_pZxDisplay(pZxDisplay),
+    m_floatingBus(model48K),
+    m_pInputQueue(nullptr),
+    m_pBeeper(nullptr),
+    m_bSilent(false),
+    m_ayRegisters(),
+    m_aySelected(0),
+    m_pAY(nullptr),
+    m_pTape(nullptr),
+    m_nextEvent(0),
+    m_bINT(false),
+    m_bFrameDone(false)
 {
-    m_pMemory = new uint8_t[0x10000];
     m_pIOPort = new uint8_t[0x10000];
 
     Clock::getInstance().reset();
@@ -77,11 +121,40 @@ Z80emu::Z80emu(ZxDisplay *pZxDisplay) :
     m_contendedRamPage[2] = m_contendedIOPage[2] = false;
     m_contendedRamPage[3] = m_contendedIOPage[3] = false;
 
-    uint32_t delayTableSize = model48K.tStatesPerScreenFrame() + 256;
+    m_pDelayTstates = nullptr;
+    buildContentionTable();
+    mapPages();
+    startEvents();
+}
+
+Z80emu::~Z80emu() = default;
+
+
+void Z80emu::setHardwareModel(ZxHardwareModel *pModel) {
+
+    assert(pModel != nullptr);
+    m_pModel = pModel;
+    m_floatingBus.setHardwareModel(*m_pModel);
+    buildContentionTable();
+    m_paging = 0;
+    mapPages();
+    startEvents();
+}
+
+
+/*
+ * The ULA delays the CPU by 6, 5, 4, 3, 2, 1, 0 and 0 T-states in every group of 8 T-states of the 128 T-states in
+ * which it fetches each of the 192 screen lines.
+ */
+void Z80emu::buildContentionTable() {
+
+    delete[] m_pDelayTstates;
+    uint32_t delayTableSize = m_pModel->tStatesPerScreenFrame() + 256;
     m_pDelayTstates = new ::uint8_t[delayTableSize];
     memset(m_pDelayTstates, 0, delayTableSize);
 
-    for (uint32_t idx = 14335; idx < 57247; idx += model48K.tStatesPerScreenLine()) {
+    for (uint32_t line = 0; line < 192; line++) {
+        uint32_t idx = m_pModel->tStatesToFirstContention() + line * m_pModel->tStatesPerScreenLine();
         for (uint32_t ndx = 0; ndx < 128; ndx += 8) {
             uint32_t frame = idx + ndx;
             m_pDelayTstates[frame++] = 6;
@@ -96,24 +169,50 @@ Z80emu::Z80emu(ZxDisplay *pZxDisplay) :
     }
 }
 
-Z80emu::~Z80emu() = default;
+
+/*
+ * Points the pages seen by the CPU and the ULA at the ROM and banks selected by port 0x7FFD, if the model has it.
+ * Nothing is copied.  On the 128K, the odd banks are contended wherever they are paged in.
+ */
+void Z80emu::mapPages() {
+
+    const bool paging = m_pModel->hasMemoryPaging();
+    const uint32_t bank = paging ? (m_paging & PAGING_BANK) : 0;
+    m_pPages[0] = m_pMemory + ((paging && (m_paging & PAGING_ROM) != 0) ? ROM1_PAGE * PAGE_SIZE : 0);
+    m_pPages[1] = getRamBank(5);
+    m_pPages[2] = getRamBank(2);
+    m_pPages[3] = getRamBank(bank);
+    m_contendedRamPage[3] = m_contendedIOPage[3] = (bank & 1u) != 0;
+
+    uint8_t *pScreen = getRamBank((paging && (m_paging & PAGING_SCREEN) != 0) ? 7 : 5);
+    for (uint32_t page = 0; page < 4; page++) {
+        m_screenPage[page] = m_pPages[page] == pScreen;
+    }
+    if (pScreen != m_pScreen) {
+        m_pScreen = pScreen;
+        m_pZxDisplay->setVideoMemory(m_pScreen, Clock::getInstance().getTstates());
+    }
+}
 
 uint8_t Z80emu::fetchOpcode(uint16_t address) {
     // 3 clocks to fetch opcode from RAM and 1 execution clock = 4 t-states
     Clock::getInstance().addTstates(4);
-    return m_pMemory[address];
+    return m_pPages[address >> 14][address & 0x3FFFu];
 }
 
 uint8_t Z80emu::peek8(uint16_t address) {
     // 3 clocks for read byte from RAM
     Clock::getInstance().addTstates(3);
-    return m_pMemory[address];
+    return m_pPages[address >> 14][address & 0x3FFFu];
 }
 
 void Z80emu::poke8(uint16_t address, uint8_t value) {
     // Do not allow writes to ROM
     if (address >= 0x4000) {
-        m_pMemory[address] = value;
+        if (m_screenPage[address >> 14] && (address & 0x3FFFu) < ZxDisplay::VIDEO_MEMORY_SIZE) {
+            m_pZxDisplay->videoMemoryWrite(Clock::getInstance().getTstates());
+        }
+        m_pPages[address >> 14][address & 0x3FFFu] = value;
     } else {
         CLogger::Get()->Write(msgFromULA, LogDebug, "Invalid write to ROM address: 0x%04X; value: %02X", address, value);
 //        assert(address >= 0x4000);
@@ -130,7 +229,7 @@ uint16_t Z80emu::peek16(uint16_t address) {
         Clock::getInstance().addTstates(3);
     }
 
-    int lsb = m_pMemory[address];
+    int lsb = m_pPages[address >> 14][address & 0x3FFFu];
     address = (address + 1) & 0xffff;
 
     if (m_contendedRamPage[address >> 14]) {
@@ -139,21 +238,27 @@ uint16_t Z80emu::peek16(uint16_t address) {
         Clock::getInstance().addTstates(3);
     }
 
-    return ((m_pMemory[address] << 8) | lsb);
+    return ((m_pPages[address >> 14][address & 0x3FFFu] << 8) | lsb);
 }
 
 void Z80emu::poke16(uint16_t address, RegisterPair word) {
 
-    // Do not allow writes to ROM
-    assert(address >= 0x4000);
-
     if (m_contendedRamPage[address >> 14]) {
         Clock::getInstance().addTstates(m_pDelayTstates[Clock::getInstance().getTstates()] + 3);
     } else {
         Clock::getInstance().addTstates(3);
     }
 
-    m_pMemory[address] = word.byte8.lo;
+    // Do not allow writes to ROM, for either byte: the word may start in ROM or wrap around into it
+    if (address >= 0x4000) {
+        if (m_screenPage[address >> 14] && (address & 0x3FFFu) < ZxDisplay::VIDEO_MEMORY_SIZE) {
+            m_pZxDisplay->videoMemoryWrite(Clock::getInstance().getTstates());
+        }
+        m_pPages[address >> 14][address & 0x3FFFu] = word.byte8.lo;
+    } else {
+        CLogger::Get()->Write(msgFromULA, LogDebug, "Invalid write to ROM address: 0x%04X; value: %02X", address,
+                              word.byte8.lo);
+    }
     address = (address + 1) & 0xffff;
 
     if (m_contendedRamPage[address >> 14]) {
@@ -162,10 +267,21 @@ void Z80emu::poke16(uint16_t address, RegisterPair word) {
         Clock::getInstance().addTstates(3);
     }
 
-    m_pMemory[address] = word.byte8.hi;
+    if (address >= 0x4000) {
+        if (m_screenPage[address >> 14] && (address & 0x3FFFu) < ZxDisplay::VIDEO_MEMORY_SIZE) {
+            m_pZxDisplay->videoMemoryWrite(Clock::getInstance().getTstates());
+        }
+        m_pPages[address >> 14][address & 0x3FFFu] = word.byte8.hi;
+    } else {
+        CLogger::Get()->Write(msgFromULA, LogDebug, "Invalid write to ROM address: 0x%04X; value: %02X", address,
+                              word.byte8.hi);
+    }
 }
 
 uint8_t Z80emu::inPort(uint16_t port) {
+    // The ULA samples the bus one T-state into the I/O cycle
+    const uint32_t tstates = Clock::getInstance().getTstates() + 1;
+
     // 4 clocks for read byte from bus
     Clock::getInstance().addTstates(4);
 
@@ -216,17 +332,26 @@ uint8_t Z80emu::inPort(uint16_t port) {
             value &= m_pIOPort[0x7FFEu];
         };
 
+        // The EAR input reads high unless a tape is playing into it
+        if (m_pTape != nullptr && m_pTape->isPlaying() &&
+                !m_pTape->level(Clock::getInstance().getFrameStart() + tstates)) {
+            value &= 0xBFu;
+        }
+
         return value;
     } else if (port == 0x011Fu) {  // Kempston joystick port
-        // No need to do anything here at this point
-    } else {
+        return m_pIOPort[port];
+    } else if ((port & 0xC003u) == 0xC001u && m_pModel->hasAY()) {  // AY port 0xFFFD reads the selected register
+        return (m_aySelected < 16) ? m_ayRegisters[m_aySelected] : 0xFFu;
+    }
+
 //#ifdef DEBUG
-//        // Log the port number that the emulated ZX Spectrum software is trying to access
-//        CLogger::Get()->Write(msgFromULA, LogDebug, "[PORT IN ] port 0x%04X <-- value 0x%02X", port, m_pIOPort[port]);
+//    // Log the port number that the emulated ZX Spectrum software is trying to access
+//    CLogger::Get()->Write(msgFromULA, LogDebug, "[PORT IN ] port 0x%04X <-- floating bus", port);
 //#endif
-    }
 
-    return m_pIOPort[port];
+    // No device answers this port, so the read returns whatever the ULA is fetching from video memory, if anything
+    return m_floatingBus.readScreen(m_pScreen, tstates);
 }
 
 /*
@@ -302,20 +427,45 @@ void Z80emu::outPort(uint16_t port, uint8_t value) {
          *     +-------------------------------+
          */
 
+        auto tstates = Clock::getInstance().getTstates();
+        if (m_pBeeper != nullptr && !m_bSilent) {
+            m_pBeeper->write(value, tstates);
+        }
+
         // Update the border but only if the border colour has actually changed.
         uint8_t border = value & 0x07u;
         if (m_border != border) {
-            auto tstates = Clock::getInstance().getTstates();
             m_border = border;
 #ifdef DEBUG
             CLogger::Get()->Write(msgFromULA, LogDebug,
                                   "(OutPort) Frame: %5d; T-states: %5d; Port: 0x%04X; Value: %d (%s)",
                                   Clock::getInstance().getFrames(),
-                                  tstates, port, border, m_pZxDisplay->m_paletteColourName[border]);
+                                  tstates, port, border, zxPaletteColourName[border]);
 #endif //DEBUG
             m_pZxDisplay->updateBorder(m_border, tstates);
         }
 
+    } else if ((port & 0x8002u) == 0x8000u && m_pModel->hasAY()) {
+        /* The AY sound chip decodes A15 and A1 only, and A14 to tell its two ports apart: a write to port 0xFFFD selects
+         * a register and a write to port 0xBFFD sets the selected register.  Register numbers from 16 up select
+         * nothing.  The 48K has no AY, so its reads of port 0xFFFD see the floating bus.
+         *
+         * Reference: [Sinclair Wiki: AY-3-8912](https://sinclair.wiki.zxnet.co.uk/wiki/AY-3-8912)
+         */
+        if ((port & 0x4000u) != 0) {
+            m_aySelected = value;
+        } else if (m_aySelected < 16) {
+            m_ayRegisters[m_aySelected] = value & ZxAY::registerMask(m_aySelected);
+            if (m_pAY != nullptr && !m_bSilent) {
+                m_pAY->write(m_aySelected, value, Clock::getInstance().getTstates());
+            }
+        }
+    }
+
+    // The 128K decodes port 0x7FFD from A15 and A1 only
+    if ((port & 0x8002u) == 0 && m_pModel->hasMemoryPaging() && (m_paging & PAGING_LOCK) == 0) {
+        m_paging = value;
+        mapPages();
     }
 
     m_pIOPort[port] = value;
@@ -331,12 +481,9 @@ void Z80emu::interruptHandlingTime(int32_t wstates) {
 }
 
 bool Z80emu::isActiveINT() {
-    int64_t tmp = Clock::getInstance().getTstates();
-
-    if (tmp >= model48K.tStatesPerScreenFrame())
-        tmp -= static_cast<int64_t>(model48K.tStatesPerScreenFrame());
-
-    return ((tmp >= 0) && (tmp < model48K.lengthINT()));
+    // The instruction that has just completed may have run into the start or the end of the interrupt
+    runEvents();
+    return m_bINT;
 }
 
 #ifdef WITH_EXEC_DONE
@@ -414,7 +561,14 @@ void Z80emu::runTest(std::ifstream* f) {
 
 void Z80emu::loadRom(const uint8_t *const base, size_t size) {
 
-    memcpy(&m_pMemory[0x0000], base, size);
+    memcpy(&m_pMemory[0x0000], base, std::min<size_t>(size, PAGE_SIZE));
+    if (size > PAGE_SIZE && m_pModel->romPages() > 1) {
+        memcpy(&m_pMemory[ROM1_PAGE * PAGE_SIZE], base + PAGE_SIZE, std::min<size_t>(size - PAGE_SIZE, PAGE_SIZE));
+    }
+
+    // A reset pages in ROM 0, bank 0 and the normal screen again
+    m_paging = 0;
+    mapPages();
     cpu.reset();
 }
 
@@ -453,9 +607,37 @@ void Z80emu::loadRom(const uint8_t *const base, size_t size) {
 //    ------------------------------------------------------------------------
 //    Total: 49179 bytes
 //
-void Z80emu::loadSnapshot(const uint8_t *snapshot, size_t size) {
+// The 128K format carries on with the PC, as the program is not resumed with a RETN, and the rest of the RAM:
+//
+//    Offset   Size   Description
+//    ------------------------------------------------------------------------
+//    0        27     bytes  SNA header (see above)
+//    27       16Kb   bytes  RAM bank 5, as in the 48K SNA file
+//    16411    16Kb   bytes  RAM bank 2, as in the 48K SNA file
+//    32795    16Kb   bytes  RAM bank n (currently paged bank), as in the 48K SNA file
+//    49179    2      word   PC
+//    49181    1      byte   port 0x7FFD setting
+//    49182    1      byte   TR-DOS rom paged (1) or not (0)
+//    49183    16Kb   bytes  remaining RAM banks in ascending order
+//    ------------------------------------------------------------------------
+//    Total: 131103 or 147487 bytes
+//
+// The remaining banks are all but banks 5, 2 and n, so there are six of them if bank n is bank 5 or 2.
+//
+// Returns false, leaving the machine untouched, if the snapshot is not one of these or is for a model with more RAM.
+//
+bool Z80emu::loadSnapshot(const uint8_t *snapshot, size_t size) {
 
-    assert(size == (49152 + 27));
+    const bool extended = size != SNA_48K_SIZE;
+    if (snapshot == nullptr || (extended && (!m_pModel->hasMemoryPaging() || size < SNA_128K_SIZE))) {
+        return false;
+    }
+    if (extended) {
+        const uint32_t pagedBank = snapshot[SNA_48K_SIZE + 2] & PAGING_BANK;
+        if (size != ((pagedBank == 5 || pagedBank == 2) ? SNA_128K_LONG_SIZE : SNA_128K_SIZE)) {
+            return false;
+        }
+    }
     cpu.reset();
 
     cpu.setRegI(snapshot[0]);
@@ -505,17 +687,80 @@ void Z80emu::loadSnapshot(const uint8_t *snapshot, size_t size) {
     m_border = snapshot[26] & 0x07u;
     m_pZxDisplay->updateBorder(m_border, 0);
 
+    /* A 48K snapshot runs on a 128K with 48K BASIC paged in and the paging locked, as if it had been loaded in 48K
+     * mode.
+     */
+    m_paging = extended ? snapshot[SNA_48K_SIZE + 2] : (m_pModel->hasMemoryPaging() ? PAGING_ROM | PAGING_LOCK : 0);
+    mapPages();
+
     /* Skip the first 27 (0x1B) bytes of the snapshot to load the RAM dump into the last 3 x 16K blocks (0xC000) of
      * ZX Spectrum memory.
      */
-    memcpy(&m_pMemory[0x4000], &snapshot[0x1B], 0xC000u);
+    for (uint32_t page = 1; page < 4; page++) {
+        memcpy(m_pPages[page], &snapshot[SNA_HEADER_SIZE + (page - 1) * PAGE_SIZE], PAGE_SIZE);
+    }
 
     Clock::getInstance().setTstates(0);
+    startEvents();
+
+    if (extended) {
+        const uint32_t pagedBank = m_paging & PAGING_BANK;
+        size_t offset = SNA_48K_SIZE + 4;
+        for (uint32_t bank = 0; bank < 8; bank++) {
+            if (bank != 5 && bank != 2 && bank != pagedBank) {
+                memcpy(getRamBank(bank), &snapshot[offset], PAGE_SIZE);
+                offset += PAGE_SIZE;
+            }
+        }
+        cpu.setRegPC(snapshot[SNA_48K_SIZE] | (snapshot[SNA_48K_SIZE + 1] << 8u));
+    } else {
+        // ROM address 0x72 contains the 'RETN' instruction required to resume the program
+        cpu.setRegPC(0x72u);
+    }
 
-    // ROM address 0x72 contains the 'RETN' instruction required to resume the program
-    cpu.setRegPC(0x72u);
+    return true;
 }
 
+void Z80emu::saveState(MachineState &state) const {
+
+    state.cpu = cpu;
+    memcpy(state.ram, &m_pMemory[PAGE_SIZE], m_pModel->ramPages() * PAGE_SIZE);
+    state.paging = m_paging;
+    state.border = m_border;
+    memcpy(state.ayRegisters, m_ayRegisters, sizeof(state.ayRegisters));
+    state.aySelected = m_aySelected;
+    state.tstates = Clock::getInstance().getTstates();
+    state.frames = static_cast<uint32_t>(Clock::getInstance().getFrames());
+    state.frameStart = Clock::getInstance().getFrameStart();
+    state.scheduler = m_scheduler;
+    state.intActive = m_bINT;
+}
+
+
+/*
+ * Puts the machine back to a saved state.  The display drops whatever it logged since then and carries on from the
+ * saved border colour as if the frame in between had been skipped, and the AY chip carries on from the saved registers.
+ */
+void Z80emu::restoreState(const MachineState &state) {
+
+    cpu = state.cpu;
+    memcpy(&m_pMemory[PAGE_SIZE], state.ram, m_pModel->ramPages() * PAGE_SIZE);
+    m_paging = state.paging;
+    m_border = state.border;
+    memcpy(m_ayRegisters, state.ayRegisters, sizeof(m_ayRegisters));
+    m_aySelected = state.aySelected;
+    if (m_pAY != nullptr) {
+        m_pAY->synchronise(m_ayRegisters);
+    }
+    Clock::getInstance().restore(state.tstates, state.frames, state.frameStart);
+    mapPages();
+    m_scheduler = state.scheduler;
+    m_bINT = state.intActive;
+    m_nextEvent = 0;
+    m_pZxDisplay->rewind(m_border);
+}
+
+
 // void Z80emu::initialise(unsigned char const* base, size_t size) {
 
 //     memcpy(&m_pZ80Ram[0x0100],  base,  size);
@@ -541,12 +786,168 @@ void Z80emu::loadSnapshot(const uint8_t *snapshot, size_t size) {
 void Z80emu::execute(const uint32_t tstates) {
 
     Clock &clock = Clock::getInstance();
-    while (clock.getTstates() < tstates) {
-        cpu.execute();
+
+    // The clock has moved on to a new frame since the last call, so the next event has to be worked out again
+    m_nextEvent = 0;
+    m_bFrameDone = false;
+    schedule(this, FRAME_END, clock.getFrameStart() + tstates);
+    if (m_pInputQueue != nullptr) {
+        // Look at the input queue as soon as the frame starts
+        schedule(this, INPUT, clock.getAbsTstates());
+    }
+
+    runEvents();
+    while (!m_bFrameDone) {
+        // Run flat out until the next event is due; events may also be handled when the CPU looks at the INT line
+        while (clock.getTstates() < m_nextEvent) {
+            cpu.execute();
+        }
+        runEvents();
+    }
+}
+
+
+void Z80emu::schedule(ZxEventHandler *pHandler, uint32_t event, uint64_t tstates) {
+
+    // The emulator's own events, at most one of each, go in the reserved slots so that the frame always ends
+    if (!m_scheduler.schedule(pHandler, event, tstates, pHandler == this)) {
+        return;
+    }
+
+    // The deadline is brought forward if the new event is due before the one that the CPU is running to
+    uint64_t frameStart = Clock::getInstance().getFrameStart();
+    uint64_t nextEvent = (tstates > frameStart) ? tstates - frameStart : 0;
+    if (nextEvent < m_nextEvent) {
+        m_nextEvent = static_cast<uint32_t>(nextEvent);
+    }
+}
+
+
+void Z80emu::cancel(ZxEventHandler *pHandler, uint32_t event) {
+
+    // Running to the old deadline does no harm; there is nothing to handle when it comes
+    m_scheduler.cancel(pHandler, event);
+}
+
+
+/*
+ * Handles the events that are due, if any, and works out the T-state of the current frame at which the next one is
+ * due.  Once the frame has ended, the CPU is stopped straight away.
+ */
+void Z80emu::runEvents() {
+
+    Clock &clock = Clock::getInstance();
+    if (clock.getTstates() < m_nextEvent) {
+        return;
     }
+
+    m_scheduler.runUntil(clock.getAbsTstates());
+
+    // Every pending deadline is now later than the current T-state, so later than the start of the frame
+    uint64_t nextEvent = m_scheduler.nextDeadline() - clock.getFrameStart();
+    m_nextEvent = m_bFrameDone ? 0 : static_cast<uint32_t>(std::min<uint64_t>(nextEvent, UINT32_MAX));
+}
+
+
+/*
+ * Starts the ULA interrupt again from the start of the current frame, e.g. after loading a snapshot.  The interrupt is
+ * active straight away if the frame has only just started.
+ */
+void Z80emu::startEvents() {
+
+    m_bINT = false;
+    m_scheduler.cancel(this, INT_END);
+    schedule(this, INT_START, Clock::getInstance().getFrameStart());
+}
+
+
+void Z80emu::handleEvent(uint32_t event, uint64_t tstates) {
+
+    switch (event) {
+        case INT_START:
+            // The ULA holds the INT line active for a few T-states at the start of every frame
+            m_bINT = true;
+            schedule(this, INT_END, tstates + m_pModel->lengthINT());
+            schedule(this, INT_START, tstates + m_pModel->tStatesPerScreenFrame());
+            break;
+        case INT_END:
+            m_bINT = false;
+            break;
+        case FRAME_END:
+            m_bFrameDone = true;
+            if (m_pBeeper != nullptr && !m_bSilent) {
+                auto frameTstates = static_cast<uint32_t>(tstates - Clock::getInstance().getFrameStart());
+                if (m_pAY != nullptr) {
+                    uint32_t count = m_pAY->endFrame(frameTstates);
+                    m_pBeeper->endFrame(frameTstates, m_pAY->frame(), count);
+                } else {
+                    m_pBeeper->endFrame(frameTstates);
+                }
+            }
+            break;
+        case INPUT:
+            applyInput(Clock::getInstance().getTstates());
+            break;
+        default:
+            break;
+    }
+}
+
+
+void Z80emu::setAY(ZxAY *pAY) {
+
+    m_pAY = pAY;
+    if (m_pAY != nullptr) {
+        m_pAY->synchronise(m_ayRegisters);
+    }
+}
+
+
+void Z80emu::setSilent(bool silent) {
+
+    if (m_bSilent && !silent && m_pAY != nullptr) {
+        m_pAY->synchronise(m_ayRegisters);
+    }
+    m_bSilent = silent;
+}
+
+
+void Z80emu::setInputQueue(ZxInputQueue *pInputQueue) {
+
+    m_pInputQueue = pInputQueue;
+    if (m_pInputQueue != nullptr) {
+        schedule(this, INPUT, Clock::getInstance().getAbsTstates());
+    } else {
+        cancel(this, INPUT);
+    }
+}
+
+
+/*
+ * Applies the input events that are due by the given T-state to the keyboard and joystick ports.  New events can be
+ * queued at any time, so while the queue is empty it is looked at again once per scan line.
+ */
+void Z80emu::applyInput(uint32_t tstates) {
+
+    ZxInputEvent event {};
+    while (m_pInputQueue->nextTstates() <= tstates && m_pInputQueue->pop(event)) {
+        // Half row n of the keyboard is read with bit n of the high byte of the port address reset
+        for (uint32_t row = 0; row < 8; row++) {
+            internalOutPort(static_cast<uint16_t>((~(1u << (row + 8)) & 0xFF00u) | 0x00FEu), event.keyboard[row]);
+        }
+        internalOutPort(0x011F, event.kempston);
+    }
+
+    uint32_t nextInput = std::min(m_pInputQueue->nextTstates(), tstates + m_pModel->tStatesPerScreenLine());
+    schedule(this, INPUT, Clock::getInstance().getFrameStart() + nextInput);
 }
 
 
 uint8_t *Z80emu::getRam() {
     return m_pMemory;
 }
+
+
+uint8_t *Z80emu::getRamBank(uint32_t bank) {
+    return m_pMemory + BANK_PAGE[bank & 0x07u] * PAGE_SIZE;
+}
@@ -24,24 +24,106 @@
 
 #include "z80.h"
 #include "z80operations.h"
+#include "hardware/zxfloatingbus.h"
+#include "zxscheduler.h"
 
+class ZxAY;
+class ZxBeeper;
 class ZxDisplay;
+class ZxHardwareModel;
+class ZxInputQueue;
+class ZxTapeInput;
 
-class Z80emu : public Z80operations
+class Z80emu : public Z80operations, public ZxEventHandler
 {
 private:
     Z80 cpu;
+    /* Every 16K page of ROM and RAM of the model, laid out as ROM 0 and RAM banks 5, 2, 0, 1, 3, 4, 6 and 7, then
+     * ROM 1, so that the memory map of the 48K, which is also that of the 128K at power-on, is the first 64K and all the
+     * RAM is in one block.  Paging only changes the pointers to the pages that the CPU sees at 0x0000, 0x4000, 0x8000
+     * and 0xC000, and to the bank that the ULA displays, and which of the pages seen by the CPU that bank is.
+     */
     uint8_t *m_pMemory;
+    uint8_t *m_pPages[4];
+    uint8_t *m_pScreen;
+    bool m_screenPage[4];
+    ZxHardwareModel *m_pModel;
+    // Last value written to port 0x7FFD
+    uint8_t m_paging;
     uint8_t *m_pIOPort;
     bool finish;
     uint8_t m_border;
     ZxDisplay *m_pZxDisplay;
+    // Precomputed ULA fetch addresses, read by the ports that no device answers
+    ZxFloatingBus m_floatingBus;
+    // Input events applied to the ports as execution reaches them
+    ZxInputQueue *m_pInputQueue;
+    // Sound of the EAR and MIC bits, unless the frame being emulated is not to be heard
+    ZxBeeper *m_pBeeper;
+    bool m_bSilent;
+    // Registers of the AY sound chip as the program sees them, the one selected and the sound of the chip, if any
+    uint8_t m_ayRegisters[16];
+    uint8_t m_aySelected;
+    ZxAY *m_pAY;
+    // Recording played into the EAR input, if any
+    ZxTapeInput *m_pTape;
+    // Timed events of the machine, the T-state of the current frame at which the next one is due and the INT line
+    ZxScheduler m_scheduler;
+    uint32_t m_nextEvent;
+    bool m_bINT;
+    bool m_bFrameDone;
 
 public:
+    // RAM of the largest model, the 128K
+    static const uint32_t MAX_RAM_SIZE = 8 * 0x4000;
+
+    /* Everything that the emulated machine does depends on, apart from the input ports, e.g. to run frames ahead of
+     * the real machine and then go back.  Saving or restoring it costs little more than a copy of the RAM of the
+     * model, 48K or 128K.
+     */
+    struct MachineState {
+        MachineState() : cpu(nullptr) {
+        }
+
+        Z80 cpu;
+        uint8_t ram[MAX_RAM_SIZE];
+        uint8_t paging;
+        uint8_t border;
+        uint8_t ayRegisters[16];
+        uint8_t aySelected;
+        uint32_t tstates;
+        uint32_t frames;
+        uint64_t frameStart;
+        ZxScheduler scheduler;
+        bool intActive;
+    };
+
+    // Events that the emulator schedules for itself, in the slots that the scheduler reserves
+    enum Event : uint32_t {
+        INT_START,
+        INT_END,
+        FRAME_END,
+        INPUT,
+        EVENTS
+    };
+    static_assert(EVENTS <= ZxScheduler::RESERVED, "the scheduler reserves a slot for each event");
+
     explicit Z80emu(ZxDisplay *pZxDisplay);
     ~Z80emu() override;
 
+    /* The model drives the memory map and paging, the contention, the floating bus and the interrupt timing.  It
+     * starts with the 48K and changing it resets the paging, so the ROM and snapshot are loaded afterwards.
+     */
+    void setHardwareModel(ZxHardwareModel *pModel);
+
+    // Memory as the 48K sees it, which is also the 128K with its power-on paging: ROM 0 and RAM banks 5, 2 and 0
     uint8_t *getRam();
+    // RAM bank of the 128K, or the RAM of the 48K at 0x4000, 0x8000 and 0xC000 as banks 5, 2 and 0
+    uint8_t *getRamBank(uint32_t bank);
+
+    [[nodiscard]] uint8_t getPaging() const {
+        return m_paging;
+    }
 
     uint8_t fetchOpcode(uint16_t address) override;
     uint8_t peek8(uint16_t address) override;
@@ -66,17 +148,63 @@ public:
 #endif
 
     void runTest(std::ifstream* f);
+    // A 16K ROM, or the two ROMs of the 128K one after the other
     void loadRom(const uint8_t * const base, size_t size);
-    void loadSnapshot(const uint8_t * const snapshot, size_t size);
+    // 48K or, on a model with paging, 128K SNA snapshot; false if it is neither
+    bool loadSnapshot(const uint8_t * const snapshot, size_t size);
+    void saveState(MachineState &state) const;
+    void restoreState(const MachineState &state);
 
+    // Runs until the given T-state of the current frame
     void execute(uint32_t);
 
+    void setInputQueue(ZxInputQueue *pInputQueue);
+
+    // The beeper gets the samples of every frame as soon as it ends
+    void setBeeper(ZxBeeper *pBeeper) {
+        m_pBeeper = pBeeper;
+    }
+
+    /* The sound of the AY chip is mixed into that of the beeper, so it is only heard with a beeper.  It picks up the
+     * registers of the chip as they are.
+     */
+    void setAY(ZxAY *pAY);
+
+    /* Frames emulated while silent make no sound, e.g. frames emulated ahead of the real machine, which are emulated
+     * again once the real machine gets there.  The AY chip picks up the registers written in the meantime.
+     */
+    void setSilent(bool silent);
+
+    /* While the tape plays, bit 6 of the ULA port reads the level of the recording at the T-state of the read.  The
+     * tape keeps its own time, so it needs nothing from the machine state to be heard again after going back in time.
+     */
+    void setTape(ZxTapeInput *pTape) {
+        m_pTape = pTape;
+    }
+
+    [[nodiscard]] bool isSilent() const {
+        return m_bSilent;
+    }
+
+    /* Peripherals with timed behaviour schedule their events here, in absolute T-states (see Clock::getAbsTstates()).
+     * The event is handled as soon as the instruction running at its deadline completes.
+     */
+    void schedule(ZxEventHandler *pHandler, uint32_t event, uint64_t tstates);
+    void cancel(ZxEventHandler *pHandler, uint32_t event);
+
+    void handleEvent(uint32_t event, uint64_t tstates) override;
+
     [[nodiscard]] uint8_t getBorder() const {
         return m_border;
     }
 
 private:
+    void buildContentionTable();
+    void mapPages();
     void preIO(int port);
+    void applyInput(uint32_t tstates);
+    void startEvents();
+    void runEvents();
 
     uint8_t *m_pDelayTstates;
     bool m_contendedRamPage[4];
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXAUDIOBUFFER_H
+#define ZXRASPBERRY_ZXAUDIOBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include "../zxspscring.h"
+
+
+/*
+ * Bounded lock-free ring of 16-bit mono samples between a single producer, the emulation, which writes the samples of
+ * a frame once it has been emulated, and a single consumer, the audio sink, which reads them at its own pace from an
+ * interrupt handler or a thread of its own.
+ *
+ * Neither side ever waits for the other: samples written while the buffer is full are dropped and counted as overruns.
+ * The number of samples buffered tells how far the emulation is ahead of the audio output.
+ */
+class ZxAudioBuffer {
+
+public:
+    // The capacity is rounded up to a power of two
+    explicit ZxAudioBuffer(uint32_t capacity) :
+            m_ring(capacity),
+            m_overruns(0) {
+    }
+
+    ZxAudioBuffer(const ZxAudioBuffer &) = delete;
+    ZxAudioBuffer &operator=(const ZxAudioBuffer &) = delete;
+
+    // Producer side; returns the number of samples written, dropping the rest if the buffer is full
+    uint32_t write(const int16_t *pSamples, uint32_t count) {
+        uint32_t written = m_ring.write(pSamples, count);
+        if (written < count) {
+            m_overruns.store(m_overruns.load(std::memory_order_relaxed) + count - written, std::memory_order_relaxed);
+        }
+        return written;
+    }
+
+    // Consumer side; returns the number of samples read, which is less than asked for if the buffer runs dry
+    uint32_t read(int16_t *pSamples, uint32_t count) {
+        return m_ring.read(pSamples, count);
+    }
+
+    // Samples waiting to be read, i.e. how far the emulation is ahead of the audio output
+    [[nodiscard]] uint32_t available() const {
+        return m_ring.available();
+    }
+
+    [[nodiscard]] uint32_t capacity() const {
+        return m_ring.capacity();
+    }
+
+    [[nodiscard]] uint32_t overruns() const {
+        return m_overruns.load(std::memory_order_relaxed);
+    }
+
+private:
+    ZxSpscRing<int16_t> m_ring;
+    std::atomic<uint32_t> m_overruns;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXAUDIOBUFFER_H
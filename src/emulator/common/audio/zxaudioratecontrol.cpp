@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "zxaudioratecontrol.h"
+
+
+ZxAudioRateControl::ZxAudioRateControl(uint32_t targetLevel) :
+        m_targetLevel(targetLevel > 0 ? targetLevel : 1) {
+
+    reset();
+}
+
+
+void ZxAudioRateControl::reset() {
+
+    m_averageLevel = static_cast<int64_t>(m_targetLevel) << LEVEL_SHIFT;
+    m_adjustment = 0;
+}
+
+
+int32_t ZxAudioRateControl::update(uint32_t level) {
+
+    m_averageLevel += static_cast<int64_t>(level) - (m_averageLevel >> LEVEL_SHIFT);
+
+    int64_t error = (m_averageLevel >> LEVEL_SHIFT) - static_cast<int64_t>(m_targetLevel);
+    int64_t adjustment = -error * MAX_ADJUSTMENT * 2 / static_cast<int64_t>(m_targetLevel);
+    m_adjustment = static_cast<int32_t>((adjustment > MAX_ADJUSTMENT) ? MAX_ADJUSTMENT :
+                                        (adjustment < -MAX_ADJUSTMENT) ? -MAX_ADJUSTMENT : adjustment);
+    return m_adjustment;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXAUDIORATECONTROL_H
+#define ZXRASPBERRY_ZXAUDIORATECONTROL_H
+
+#include <cstdint>
+
+
+/*
+ * Dynamic rate control: keeps the audio buffer at a steady level by nudging the speed of the emulation, and so the
+ * rate at which it makes samples, by a fraction of a percent.
+ *
+ * The emulation is paced by the system timer and the samples are played by the audio clock of the host, e.g. the PWM
+ * clock of the Raspberry Pi, which never run at exactly the same rate: a host playing 48003 Hz instead of 48000 Hz
+ * drains an 8192-sample buffer in under an hour, and then every underrun is heard as a pop.  Once a frame, the level of
+ * the buffer is averaged over about 2^LEVEL_SHIFT frames, to smooth out the chunks in which the audio output takes
+ * its samples, and the emulation is sped up when the average is below the target level and slowed down when it is
+ * above, in proportion to the difference, up to MAX_ADJUSTMENT parts per million when the average is half the target
+ * level away from it.  The change in pitch, and in frame rate, is far too small to notice.
+ *
+ * The buffer then settles where the adjustment makes up for the difference between both clocks, as long as that is
+ * under MAX_ADJUSTMENT.
+ *
+ * Reference: Hans-Kristian Arntzen, Dynamic Rate Control for Retro Game Emulators, 2012
+ */
+class ZxAudioRateControl {
+
+public:
+    // Largest adjustment of the speed, in parts per million, i.e. 0.5%
+    static const int32_t MAX_ADJUSTMENT = 5000;
+    // The average level follows the buffer by 1/2^LEVEL_SHIFT of the difference every frame
+    static const uint32_t LEVEL_SHIFT = 6;
+
+    explicit ZxAudioRateControl(uint32_t targetLevel);
+
+    // Starts again from the target level, e.g. after the emulation has run without sound
+    void reset();
+
+    // Called once a frame with the number of samples in the buffer; returns the speed adjustment in parts per million
+    int32_t update(uint32_t level);
+
+    [[nodiscard]] int32_t adjustment() const {
+        return m_adjustment;
+    }
+
+    [[nodiscard]] uint32_t targetLevel() const {
+        return m_targetLevel;
+    }
+
+    // Average level of the buffer, in samples
+    [[nodiscard]] uint32_t averageLevel() const {
+        return static_cast<uint32_t>(m_averageLevel >> LEVEL_SHIFT);
+    }
+
+private:
+    uint32_t m_targetLevel;
+    // Average level in 1/2^LEVEL_SHIFT of a sample
+    int64_t m_averageLevel;
+    int32_t m_adjustment;
+};
+
+
+#endif //ZXRASPBERRY_ZXAUDIORATECONTROL_H
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXAUDIOSINK_H
+#define ZXRASPBERRY_ZXAUDIOSINK_H
+
+#include <cstdint>
+
+
+/*
+ * Takes the samples that the emulation writes into a ZxAudioBuffer out of it at a fixed sample rate, e.g. to play them
+ * on the audio output of the Raspberry Pi or to write them to a WAV file.  The emulation only ever sees the buffer, so
+ * sinks can be swapped without it knowing.  How a sink is started depends on the sink.
+ */
+class ZxAudioSink {
+
+public:
+    static const uint32_t DEFAULT_SAMPLE_RATE = 48000;
+
+    virtual ~ZxAudioSink() = default;
+
+    [[nodiscard]] virtual uint32_t sampleRate() const = 0;
+
+    // Stops taking samples out of the buffer
+    virtual void stop() = 0;
+
+    // Times the sink found fewer samples in the buffer than it needed
+    [[nodiscard]] virtual uint32_t underruns() const = 0;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXAUDIOSINK_H
@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstring>
+#include "zxay.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ZX_AY_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ZX_AY_NEON 1
+#endif
+
+
+/* Output of the logarithmic DAC of a channel for each of its 16 volume levels, as a fraction of 0xFFFF, measured on a
+ * real chip.
+ *
+ * Reference: [Fuse, the Free Unix Spectrum Emulator: sound.c](https://fuse-emulator.sourceforge.net/)
+ */
+static const uint16_t DAC[16] = {
+        0x0000, 0x0385, 0x053D, 0x0770, 0x0AD7, 0x0FD5, 0x15B0, 0x230C,
+        0x2B4C, 0x43C1, 0x5A4B, 0x732F, 0x9204, 0xAFF1, 0xD921, 0xFFFF
+};
+
+// The averaging filters add up to 1 << FILTER_BITS
+static const uint32_t FILTER_BITS = 15;
+// All bits set: a tone or noise output that is high, or a generator that is switched off in the mixer
+static const int16_t HIGH = -1;
+
+static inline int16_t amplitude(uint32_t level) {
+    return static_cast<int16_t>(DAC[level & 0x0Fu] * ZxAY::VOLUME / 0xFFFF);
+}
+
+
+/*
+ * What the mixer makes of a channel over a block: its tone and noise, unless switched off (all bits set), gate either
+ * the envelope or a fixed amplitude.  Each tick adds (tone | toneOff) & (noise | noiseOff) & amplitude, where the
+ * amplitude is (envelope & envelopeOn) | fixed.
+ */
+struct ChannelMix {
+    int16_t toneOff;
+    int16_t noiseOff;
+    int16_t envelopeOn;
+    int16_t fixed;
+};
+
+static void mixTicks(const ChannelMix *pMix, int16_t *const *ppTone, const int16_t *pNoise,
+                     const int16_t *pEnvelope, int16_t *pTarget, uint32_t ticks) {
+    for (uint32_t i = 0; i < ticks; i++) {
+        int32_t level = 0;
+        for (uint32_t channel = 0; channel < 3; channel++) {
+            const ChannelMix &mix = pMix[channel];
+            int16_t gate = static_cast<int16_t>((ppTone[channel][i] | mix.toneOff) & (pNoise[i] | mix.noiseOff));
+            level += gate & ((pEnvelope[i] & mix.envelopeOn) | mix.fixed);
+        }
+        pTarget[i] = static_cast<int16_t>(level);
+    }
+}
+
+static inline int16_t filterTicks(const int16_t *pFilter, const int16_t *pTicks) {
+    int32_t sum = 0;
+    for (uint32_t tap = 0; tap < ZxAY::TAPS; tap++) {
+        sum += pFilter[tap] * pTicks[tap];
+    }
+    return static_cast<int16_t>((sum + (1 << (FILTER_BITS - 1))) >> FILTER_BITS);
+}
+
+
+#if ZX_AY_SSE2
+
+static void mixTicksVectorised(const ChannelMix *pMix, int16_t *const *ppTone, const int16_t *pNoise,
+                               const int16_t *pEnvelope, int16_t *pTarget, uint32_t ticks) {
+    __m128i toneOff[3];
+    __m128i noiseOff[3];
+    __m128i envelopeOn[3];
+    __m128i fixed[3];
+    for (uint32_t channel = 0; channel < 3; channel++) {
+        toneOff[channel] = _mm_set1_epi16(pMix[channel].toneOff);
+        noiseOff[channel] = _mm_set1_epi16(pMix[channel].noiseOff);
+        envelopeOn[channel] = _mm_set1_epi16(pMix[channel].envelopeOn);
+        fixed[channel] = _mm_set1_epi16(pMix[channel].fixed);
+    }
+    uint32_t i = 0;
+    for (; i + 8 <= ticks; i += 8) {
+        __m128i noise = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pNoise[i]));
+        __m128i envelope = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pEnvelope[i]));
+        __m128i level = _mm_setzero_si128();
+        for (uint32_t channel = 0; channel < 3; channel++) {
+            __m128i tone = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&ppTone[channel][i]));
+            __m128i gate = _mm_and_si128(_mm_or_si128(tone, toneOff[channel]), _mm_or_si128(noise, noiseOff[channel]));
+            __m128i volume = _mm_or_si128(_mm_and_si128(envelope, envelopeOn[channel]), fixed[channel]);
+            level = _mm_add_epi16(level, _mm_and_si128(gate, volume));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&pTarget[i]), level);
+    }
+    int16_t *const pTone[3] = { ppTone[0] + i, ppTone[1] + i, ppTone[2] + i };
+    mixTicks(pMix, pTone, &pNoise[i], &pEnvelope[i], &pTarget[i], ticks - i);
+}
+
+static inline int16_t filterTicksVectorised(const int16_t *pFilter, const int16_t *pTicks) {
+    __m128i low = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pTicks)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(pFilter)));
+    __m128i high = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pTicks + 8)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i *>(pFilter + 8)));
+    __m128i sum = _mm_add_epi32(low, high);
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return static_cast<int16_t>((_mm_cvtsi128_si32(sum) + (1 << (FILTER_BITS - 1))) >> FILTER_BITS);
+}
+
+#elif ZX_AY_NEON
+
+static void mixTicksVectorised(const ChannelMix *pMix, int16_t *const *ppTone, const int16_t *pNoise,
+                               const int16_t *pEnvelope, int16_t *pTarget, uint32_t ticks) {
+    int16x8_t toneOff[3];
+    int16x8_t noiseOff[3];
+    int16x8_t envelopeOn[3];
+    int16x8_t fixed[3];
+    for (uint32_t channel = 0; channel < 3; channel++) {
+        toneOff[channel] = vdupq_n_s16(pMix[channel].toneOff);
+        noiseOff[channel] = vdupq_n_s16(pMix[channel].noiseOff);
+        envelopeOn[channel] = vdupq_n_s16(pMix[channel].envelopeOn);
+        fixed[channel] = vdupq_n_s16(pMix[channel].fixed);
+    }
+    uint32_t i = 0;
+    for (; i + 8 <= ticks; i += 8) {
+        int16x8_t noise = vld1q_s16(&pNoise[i]);
+        int16x8_t envelope = vld1q_s16(&pEnvelope[i]);
+        int16x8_t level = vdupq_n_s16(0);
+        for (uint32_t channel = 0; channel < 3; channel++) {
+            int16x8_t tone = vld1q_s16(&ppTone[channel][i]);
+            int16x8_t gate = vandq_s16(vorrq_s16(tone, toneOff[channel]), vorrq_s16(noise, noiseOff[channel]));
+            int16x8_t volume = vorrq_s16(vandq_s16(envelope, envelopeOn[channel]), fixed[channel]);
+            level = vaddq_s16(level, vandq_s16(gate, volume));
+        }
+        vst1q_s16(&pTarget[i], level);
+    }
+    int16_t *const pTone[3] = { ppTone[0] + i, ppTone[1] + i, ppTone[2] + i };
+    mixTicks(pMix, pTone, &pNoise[i], &pEnvelope[i], &pTarget[i], ticks - i);
+}
+
+static inline int16_t filterTicksVectorised(const int16_t *pFilter, const int16_t *pTicks) {
+    int16x8_t low = vld1q_s16(pTicks);
+    int16x8_t high = vld1q_s16(pTicks + 8);
+    int16x8_t filterLow = vld1q_s16(pFilter);
+    int16x8_t filterHigh = vld1q_s16(pFilter + 8);
+    int32x4_t sum = vmull_s16(vget_low_s16(low), vget_low_s16(filterLow));
+    sum = vmlal_s16(sum, vget_high_s16(low), vget_high_s16(filterLow));
+    sum = vmlal_s16(sum, vget_low_s16(high), vget_low_s16(filterHigh));
+    sum = vmlal_s16(sum, vget_high_s16(high), vget_high_s16(filterHigh));
+    int32x2_t pair = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+    pair = vpadd_s32(pair, pair);
+    return static_cast<int16_t>((vget_lane_s32(pair, 0) + (1 << (FILTER_BITS - 1))) >> FILTER_BITS);
+}
+
+#endif
+
+
+ZxAY::ZxAY(uint32_t clockFrequency, uint32_t tStatesPerFrame, uint32_t sampleRate) :
+        m_step((static_cast<uint64_t>(sampleRate) << 32) / clockFrequency),
+        m_ratio(UINT64_MAX / (m_step * TSTATES_PER_TICK)),
+        m_position(0),
+        m_frameStart(0),
+        m_tstates(0),
+        m_bVectorised(isVectorised()),
+        m_pWrites(new Write[MAX_WRITES]),
+        m_writeCount(0),
+        m_writesDropped(0),
+        m_registers(),
+        m_toneCounter(),
+        m_toneOutput(),
+        m_noiseCounter(0),
+        m_noiseShift(1),
+        m_envelopeCounter(0),
+        m_envelopeStep(0),
+        m_envelopeAttack(0),
+        m_bEnvelopeHold(false),
+        m_bEnvelopeAlternate(false),
+        m_bEnvelopeHolding(false),
+        m_filter() {
+
+    // Room for the ticks of two frames, in case a frame runs over, and for those carried over from the last frame
+    uint32_t ticksPerFrame = tStatesPerFrame / TSTATES_PER_TICK + 1;
+    m_tickSize = ticksPerFrame * 2 + TAPS * 2;
+    for (auto &pTone : m_pTone) {
+        pTone = new int16_t[m_tickSize];
+    }
+    m_pNoise = new int16_t[m_tickSize];
+    m_pEnvelope = new int16_t[m_tickSize];
+    // The first samples start TAPS ticks of silence early, so that the ticks under every sample are always there
+    m_pTicks = new int16_t[m_tickSize]();
+    m_tickCount = TAPS;
+    m_sampleSize = (static_cast<uint32_t>((static_cast<uint64_t>(tStatesPerFrame) * m_step) >> 32) + 1) * 2;
+    m_pSamples = new int16_t[m_sampleSize]();
+
+    /* Each sample is the average of the ticks under it: those from the fraction of a tick at which it starts to the
+     * start of the next sample, ticksPerSample later, counting the ticks at either end only for the part of them under
+     * the sample.  Sample rates so low that a sample covers more than TAPS - 1 ticks only average the first ones.
+     */
+    const double ticksPerSample = static_cast<double>(m_ratio) / 4294967296.0;
+    for (uint32_t phase = 0; phase < PHASES; phase++) {
+        const double start = static_cast<double>(phase) / PHASES;
+        const double end = std::min(start + ticksPerSample, static_cast<double>(TAPS));
+        int32_t sum = 0;
+        uint32_t largest = 0;
+        for (uint32_t tap = 0; tap < TAPS; tap++) {
+            double covered = std::min(end, tap + 1.0) - std::max(start, static_cast<double>(tap));
+            auto weight = static_cast<int16_t>((covered > 0.0) ? covered / (end - start) * (1 << FILTER_BITS) + 0.5 : 0);
+            m_filter[phase][tap] = weight;
+            sum += weight;
+            largest = (weight > m_filter[phase][largest]) ? tap : largest;
+        }
+        m_filter[phase][largest] = static_cast<int16_t>(m_filter[phase][largest] + (1 << FILTER_BITS) - sum);
+    }
+
+    startEnvelope();
+}
+
+
+ZxAY::~ZxAY() {
+
+    delete[] m_pSamples;
+    delete[] m_pTicks;
+    delete[] m_pEnvelope;
+    delete[] m_pNoise;
+    for (auto &pTone : m_pTone) {
+        delete[] pTone;
+    }
+    delete[] m_pWrites;
+}
+
+
+bool ZxAY::isVectorised() {
+
+#if ZX_AY_SSE2 || ZX_AY_NEON
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void ZxAY::synchronise(const uint8_t *pRegisters) {
+
+    for (uint8_t reg = 0; reg < REGISTERS; reg++) {
+        if (reg != ENVELOPE_SHAPE || (pRegisters[reg] & registerMask(reg)) != m_registers[reg]) {
+            setRegister(reg, pRegisters[reg]);
+        }
+    }
+}
+
+
+void ZxAY::setRegister(uint8_t reg, uint8_t value) {
+
+    reg &= REGISTERS - 1;
+    m_registers[reg] = value & registerMask(reg);
+    if (reg == ENVELOPE_SHAPE) {
+        startEnvelope();
+    }
+}
+
+
+/*
+ * Writing the shape starts the envelope again from the top of its first ramp.  Shapes that do not continue (bit 3
+ * clear) hold at zero once the ramp is over, as does a shape that does not alternate and holds (bit 0).
+ */
+void ZxAY::startEnvelope() {
+
+    const uint8_t shape = m_registers[ENVELOPE_SHAPE];
+    m_envelopeAttack = (shape & 0x04u) ? 0x0F : 0x00;
+    if ((shape & 0x08u) == 0) {
+        m_bEnvelopeHold = true;
+        m_bEnvelopeAlternate = m_envelopeAttack != 0;
+    } else {
+        m_bEnvelopeHold = (shape & 0x01u) != 0;
+        m_bEnvelopeAlternate = (shape & 0x02u) != 0;
+    }
+    m_envelopeStep = 0x0F;
+    m_envelopeCounter = 0;
+    m_bEnvelopeHolding = false;
+}
+
+
+/*
+ * The tone counter counts ticks up to the period of the channel, where its output changes and it starts again.  The
+ * output stays the same for whole runs of ticks, so it is written a run at a time.
+ */
+void ZxAY::runTone(uint32_t channel, int16_t *pTarget, uint32_t ticks) {
+
+    uint32_t period = m_registers[TONE_A_FINE + channel * 2] |
+                      (static_cast<uint32_t>(m_registers[TONE_A_COARSE + channel * 2]) << 8);
+    period = (period == 0) ? 1 : period;
+    uint32_t counter = m_toneCounter[channel];
+    int16_t output = m_toneOutput[channel];
+
+    while (ticks > 0) {
+        uint32_t toChange = (counter < period) ? period - counter : 1;
+        if (toChange > ticks) {
+            std::fill_n(pTarget, ticks, output);
+            counter += ticks;
+            break;
+        }
+        std::fill_n(pTarget, toChange - 1, output);
+        pTarget += toChange - 1;
+        output = static_cast<int16_t>(~output);
+        *pTarget++ = output;
+        ticks -= toChange;
+        counter = 0;
+    }
+    m_toneCounter[channel] = counter;
+    m_toneOutput[channel] = output;
+}
+
+
+/*
+ * The noise is the lowest bit of a 17-bit linear feedback shift register, shifted every other time that its counter
+ * reaches the noise period.
+ */
+void ZxAY::runNoise(int16_t *pTarget, uint32_t ticks) {
+
+    uint32_t period = m_registers[NOISE_PERIOD];
+    period = ((period == 0) ? 1 : period) * 2;
+    uint32_t counter = m_noiseCounter;
+    uint32_t shift = m_noiseShift;
+
+    while (ticks > 0) {
+        uint32_t toChange = (counter < period) ? period - counter : 1;
+        int16_t output = (shift & 1u) ? HIGH : 0;
+        if (toChange > ticks) {
+            std::fill_n(pTarget, ticks, output);
+            counter += ticks;
+            break;
+        }
+        std::fill_n(pTarget, toChange - 1, output);
+        pTarget += toChange - 1;
+        shift = (shift >> 1) | (((shift ^ (shift >> 3)) & 1u) << 16);
+        *pTarget++ = (shift & 1u) ? HIGH : 0;
+        ticks -= toChange;
+        counter = 0;
+    }
+    m_noiseCounter = counter;
+    m_noiseShift = shift;
+}
+
+
+/*
+ * The envelope goes down one of 16 steps every other time that its counter reaches the envelope period.  Its level is
+ * the step, or the step inverted while it ramps up, and at the end of each ramp it holds, alternates or starts again
+ * as the shape says.
+ */
+void ZxAY::runEnvelope(int16_t *pTarget, uint32_t ticks) {
+
+    uint32_t period = m_registers[ENVELOPE_FINE] | (static_cast<uint32_t>(m_registers[ENVELOPE_COARSE]) << 8);
+    period = ((period == 0) ? 1 : period) * 2;
+
+    while (ticks > 0) {
+        int16_t output = amplitude(static_cast<uint32_t>(m_envelopeStep) ^ m_envelopeAttack);
+        uint32_t toChange = (m_envelopeCounter < period) ? period - m_envelopeCounter : 1;
+        if (m_bEnvelopeHolding || toChange > ticks) {
+            std::fill_n(pTarget, ticks, output);
+            m_envelopeCounter += m_bEnvelopeHolding ? 0 : ticks;
+            break;
+        }
+        std::fill_n(pTarget, toChange - 1, output);
+        pTarget += toChange - 1;
+        ticks -= toChange;
+        m_envelopeCounter = 0;
+
+        if (--m_envelopeStep < 0) {
+            if (m_bEnvelopeHold) {
+                m_envelopeAttack ^= m_bEnvelopeAlternate ? 0x0F : 0x00;
+                m_bEnvelopeHolding = true;
+                m_envelopeStep = 0;
+            } else {
+                m_envelopeAttack ^= (m_bEnvelopeAlternate && (m_envelopeStep & 0x10)) ? 0x0F : 0x00;
+                m_envelopeStep &= 0x0F;
+            }
+        }
+        *pTarget++ = amplitude(static_cast<uint32_t>(m_envelopeStep) ^ m_envelopeAttack);
+    }
+}
+
+
+void ZxAY::run(uint32_t ticks) {
+
+    ticks = std::min(ticks, m_tickSize - m_tickCount);
+    if (ticks == 0) {
+        return;
+    }
+
+    for (uint32_t channel = 0; channel < 3; channel++) {
+        runTone(channel, m_pTone[channel], ticks);
+    }
+    runNoise(m_pNoise, ticks);
+    runEnvelope(m_pEnvelope, ticks);
+
+    ChannelMix mix[3];
+    const uint8_t mixer = m_registers[MIXER];
+    for (uint32_t channel = 0; channel < 3; channel++) {
+        const uint8_t volume = m_registers[VOLUME_A + channel];
+        mix[channel].toneOff = (mixer & (0x01u << channel)) ? HIGH : 0;
+        mix[channel].noiseOff = (mixer & (0x08u << channel)) ? HIGH : 0;
+        mix[channel].envelopeOn = (volume & 0x10u) ? HIGH : 0;
+        mix[channel].fixed = (volume & 0x10u) ? 0 : amplitude(volume);
+    }
+
+#if ZX_AY_SSE2 || ZX_AY_NEON
+    if (m_bVectorised) {
+        mixTicksVectorised(mix, m_pTone, m_pNoise, m_pEnvelope, m_pTicks + m_tickCount, ticks);
+    } else {
+        mixTicks(mix, m_pTone, m_pNoise, m_pEnvelope, m_pTicks + m_tickCount, ticks);
+    }
+#else
+    mixTicks(mix, m_pTone, m_pNoise, m_pEnvelope, m_pTicks + m_tickCount, ticks);
+#endif
+    m_tickCount += ticks;
+}
+
+
+void ZxAY::downsample(uint32_t count) {
+
+    const uint32_t lastStart = m_tickCount - TAPS;
+    uint64_t position = m_position;
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = static_cast<uint32_t>(position >> 32);
+        start = (start < lastStart) ? start : lastStart;
+        const int16_t *pFilter = m_filter[(position >> (32 - PHASE_BITS)) & (PHASES - 1)];
+#if ZX_AY_SSE2 || ZX_AY_NEON
+        m_pSamples[i] = m_bVectorised ? filterTicksVectorised(pFilter, m_pTicks + start)
+                                      : filterTicks(pFilter, m_pTicks + start);
+#else
+        m_pSamples[i] = filterTicks(pFilter, m_pTicks + start);
+#endif
+        position += m_ratio;
+    }
+
+    // The ticks from the start of the next sample on carry over to the next frame
+    auto consumed = static_cast<uint32_t>(position >> 32);
+    consumed = (consumed < lastStart) ? consumed : lastStart;
+    memmove(m_pTicks, m_pTicks + consumed, (m_tickCount - consumed) * sizeof(int16_t));
+    m_tickCount -= consumed;
+    m_position = position - (static_cast<uint64_t>(consumed) << 32);
+}
+
+
+uint32_t ZxAY::endFrame(uint32_t frameTstates) {
+
+    // Run the generators up to each write and then change the register
+    uint32_t ticks = 0;
+    for (uint32_t i = 0; i < m_writeCount; i++) {
+        const Write &write = m_pWrites[i];
+        uint32_t tick = (m_tstates + write.tstates) / TSTATES_PER_TICK;
+        if (tick > ticks) {
+            run(tick - ticks);
+            ticks = tick;
+        }
+        setRegister(write.reg, write.value);
+    }
+    m_writeCount = 0;
+
+    const uint32_t frameEnd = m_tstates + frameTstates;
+    if (frameEnd / TSTATES_PER_TICK > ticks) {
+        run(frameEnd / TSTATES_PER_TICK - ticks);
+    }
+    m_tstates = frameEnd % TSTATES_PER_TICK;
+
+    // As many samples as the beeper makes for the frame
+    uint64_t sampleEnd = m_frameStart + frameTstates * m_step;
+    auto count = static_cast<uint32_t>(sampleEnd >> 32);
+    count = (count < m_sampleSize) ? count : m_sampleSize;
+    m_frameStart = sampleEnd - (static_cast<uint64_t>(count) << 32);
+    downsample(count);
+    return count;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXAY_H
+#define ZXRASPBERRY_ZXAY_H
+
+#include <cstdint>
+
+
+/*
+ * Sound of the AY-3-8912 programmable sound generator of the 128K models, also fitted to the 48K by several
+ * interfaces: three square wave tone channels, a noise generator and a volume envelope, clocked at half the clock of
+ * the CPU.  The registers that the program sees are kept by the emulator, which passes every write on to this class.
+ *
+ * During a frame, the writes are only logged with their T-state.  Once the frame has ended, the generators are run in
+ * blocks, from one write to the next, at the rate at which they change, i.e. every 8 clocks of the chip or 16 T-states
+ * (a tick): tone, noise and envelope are worked out as runs of equal values, and then the three channels are mixed,
+ * 8 ticks at a time with SSE2 or NEON, into the output level of each tick.  The levels are downsampled to the sample
+ * rate by averaging the ticks under each sample with a polyphase filter, TAPS ticks wide, also 8 ticks at a time.
+ *
+ * The samples of the frame are mixed into those of the beeper, which filters out the DC level of both.
+ *
+ * References:
+ *  - [General Instrument AY-3-8910 / 8912 Programmable Sound Generator data manual](https://map.grauw.nl/resources/sound/generalinstrument_ay-3-8910.pdf)
+ *  - [Sinclair Wiki: AY-3-8912](https://sinclair.wiki.zxnet.co.uk/wiki/AY-3-8912)
+ */
+class ZxAY {
+
+public:
+    static const uint32_t REGISTERS = 16;
+    // Writes logged per frame; a program cannot write to the chip more than once every 12 T-states
+    static const uint32_t MAX_WRITES = 8192;
+    static const uint32_t TSTATES_PER_TICK = 16;
+    static const uint32_t TAPS = 16;
+    static const uint32_t PHASE_BITS = 5;
+    static const uint32_t PHASES = 1u << PHASE_BITS;
+    // Output level of a channel at full volume; the three channels together are a little louder than the beeper
+    static const int32_t VOLUME = 6144;
+
+    // Registers of the chip
+    enum Register : uint8_t {
+        TONE_A_FINE,
+        TONE_A_COARSE,
+        TONE_B_FINE,
+        TONE_B_COARSE,
+        TONE_C_FINE,
+        TONE_C_COARSE,
+        NOISE_PERIOD,
+        MIXER,
+        VOLUME_A,
+        VOLUME_B,
+        VOLUME_C,
+        ENVELOPE_FINE,
+        ENVELOPE_COARSE,
+        ENVELOPE_SHAPE,
+        PORT_A,
+        PORT_B
+    };
+
+    ZxAY(uint32_t clockFrequency, uint32_t tStatesPerFrame, uint32_t sampleRate);
+    ~ZxAY();
+
+    ZxAY(const ZxAY &) = delete;
+    ZxAY &operator=(const ZxAY &) = delete;
+
+    // Bits of each register that the chip implements; the others read as zero
+    static uint8_t registerMask(uint8_t reg) {
+        static const uint8_t masks[REGISTERS] = {
+                0xFF, 0x0F, 0xFF, 0x0F, 0xFF, 0x0F, 0x1F, 0xFF, 0x1F, 0x1F, 0x1F, 0xFF, 0xFF, 0x0F, 0xFF, 0xFF
+        };
+        return masks[reg & (REGISTERS - 1)];
+    }
+
+    // Logs a value written to a register at a T-state of the current frame
+    void write(uint8_t reg, uint8_t value, uint32_t tstates) {
+        if (m_writeCount < MAX_WRITES) {
+            m_pWrites[m_writeCount++] = { tstates, reg, value };
+        } else {
+            m_writesDropped++;
+        }
+    }
+
+    /* Sets the registers of the generators to those of the emulated chip, e.g. after frames that were not heard and
+     * whose writes were not logged.  The envelope only starts again if its shape is different.
+     */
+    void synchronise(const uint8_t *pRegisters);
+
+    /* Turns the writes logged during the frame that has just ended, after the given number of T-states, into samples
+     * and returns how many.  The beeper, given the same clock and sample rate, makes as many for the same frame.
+     */
+    uint32_t endFrame(uint32_t frameTstates);
+
+    // Samples of the last frame
+    [[nodiscard]] const int16_t *frame() const {
+        return m_pSamples;
+    }
+
+    [[nodiscard]] uint32_t writesDropped() const {
+        return m_writesDropped;
+    }
+
+    // Whether the channels are mixed and downsampled with SSE2 or NEON, if the build has either
+    void setVectorised(bool vectorised) {
+        m_bVectorised = vectorised && isVectorised();
+    }
+
+    static bool isVectorised();
+
+private:
+    struct Write {
+        uint32_t tstates;
+        uint8_t reg;
+        uint8_t value;
+    };
+
+    void setRegister(uint8_t reg, uint8_t value);
+    void startEnvelope();
+    // Runs the generators for the given number of ticks and appends the output level of each tick to m_pTicks
+    void run(uint32_t ticks);
+    void runTone(uint32_t channel, int16_t *pTarget, uint32_t ticks);
+    void runNoise(int16_t *pTarget, uint32_t ticks);
+    void runEnvelope(int16_t *pTarget, uint32_t ticks);
+    void downsample(uint32_t count);
+
+    // Samples per T-state, as for the beeper, ticks per sample, and position of the next sample in the ticks
+    uint64_t m_step;
+    uint64_t m_ratio;
+    uint64_t m_position;
+    uint64_t m_frameStart;
+    // T-states of the frame that did not make a whole tick, carried over to the next frame
+    uint32_t m_tstates;
+    bool m_bVectorised;
+
+    Write *m_pWrites;
+    uint32_t m_writeCount;
+    uint32_t m_writesDropped;
+
+    // State of the generators
+    uint8_t m_registers[REGISTERS];
+    uint32_t m_toneCounter[3];
+    int16_t m_toneOutput[3];
+    uint32_t m_noiseCounter;
+    uint32_t m_noiseShift;
+    uint32_t m_envelopeCounter;
+    int32_t m_envelopeStep;
+    uint8_t m_envelopeAttack;
+    bool m_bEnvelopeHold;
+    bool m_bEnvelopeAlternate;
+    bool m_bEnvelopeHolding;
+
+    // Averaging filter for every fraction of a tick at which a sample can start, each one adding up to 1.0 (32768)
+    int16_t m_filter[PHASES][TAPS];
+    // Output of each generator over a block, as all bits set or clear (tone and noise) or a level (envelope)
+    int16_t *m_pTone[3];
+    int16_t *m_pNoise;
+    int16_t *m_pEnvelope;
+    // Output level of each tick not yet downsampled, and samples of the last frame
+    int16_t *m_pTicks;
+    uint32_t m_tickCount;
+    uint32_t m_tickSize;
+    int16_t *m_pSamples;
+    uint32_t m_sampleSize;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXAY_H
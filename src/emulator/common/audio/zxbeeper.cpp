@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cmath>
+#include <cstring>
+#include "zxbeeper.h"
+#include "zxaudiobuffer.h"
+
+
+static const double PI = 3.14159265358979323846;
+// The band-limited steps add up to 1 << KERNEL_BITS
+static const uint32_t KERNEL_BITS = 15;
+// Cut-off frequency of the steps as a fraction of the sample rate, a little below the Nyquist frequency
+static const double CUTOFF = 0.45;
+// The output loses 1/2^BASS_SHIFT of its level every sample, which filters out the DC level below about 15 Hz
+static const uint32_t BASS_SHIFT = 9;
+
+/* Output level for each value of the EAR and MIC bits, from the voltages measured on the EAR socket of an issue 3 48K
+ * Spectrum: 0.39 V with neither bit set, 0.73 V with MIC, 3.66 V with EAR and 3.79 V with both.
+ *
+ * Reference:
+ *  - [Sinclair Wiki: ZX Spectrum ULA](https://faqwiki.zxnet.co.uk/wiki/ZX_Spectrum_ULA)
+ */
+static const int32_t LEVELS[4] = {
+        0,
+        ZxBeeper::VOLUME / 10,
+        ZxBeeper::VOLUME * 96 / 100,
+        ZxBeeper::VOLUME
+};
+
+
+ZxBeeper::ZxBeeper(ZxAudioBuffer &buffer, uint32_t clockFrequency, uint32_t tStatesPerFrame, uint32_t sampleRate) :
+        m_buffer(buffer),
+        m_sampleRate(sampleRate),
+        m_step((static_cast<uint64_t>(sampleRate) << 32) / clockFrequency),
+        m_frameStart(0),
+        m_pEdges(new Edge[MAX_EDGES]),
+        m_edgeCount(0),
+        m_edgesDropped(0),
+        m_level(0),
+        m_amplitude(0),
+        m_kernel(),
+        m_integrator(0),
+        m_mixLevel(0),
+        m_samples(0) {
+
+    // Room for the samples of two frames, in case a frame runs over, and the tail of the steps near the end of it
+    uint32_t samplesPerFrame = static_cast<uint32_t>((static_cast<uint64_t>(tStatesPerFrame) * m_step) >> 32) + 1;
+    m_deltaSize = samplesPerFrame * 2 + KERNEL_WIDTH;
+    m_pDeltas = new int32_t[m_deltaSize]();
+    m_pSamples = new int16_t[m_deltaSize];
+
+    /* The step is the running sum of a sinc, cut off at CUTOFF, with a Blackman window KERNEL_WIDTH - 2 samples wide.
+     * It is worked out on a grid of 2 * PHASES points per sample, so that every phase falls on a point of the grid.
+     */
+    const uint32_t halfWidth = KERNEL_WIDTH / 2 - 1;
+    const uint32_t pointsPerSample = 2 * PHASES;
+    const uint32_t points = 2 * halfWidth * pointsPerSample;
+    auto *pStep = new double[points + 1];
+    double previous = 0.0;
+    pStep[0] = 0.0;
+    for (uint32_t point = 0; point <= points; point++) {
+        double x = static_cast<double>(point) / pointsPerSample - halfWidth;
+        double sinc = (point == points / 2) ? 2.0 * CUTOFF : std::sin(2.0 * PI * CUTOFF * x) / (PI * x);
+        double window = static_cast<double>(point) / points;
+        double impulse = sinc * (0.42 - 0.5 * std::cos(2.0 * PI * window) + 0.08 * std::cos(4.0 * PI * window));
+        if (point > 0) {
+            pStep[point] = pStep[point - 1] + (previous + impulse) / 2.0;
+        }
+        previous = impulse;
+    }
+
+    /* The step of phase p happens p / PHASES of a sample after sample halfWidth, so sample i of the step is the value
+     * of the running sum at i - halfWidth - p / PHASES samples from the centre of the sinc.  Each tap is the difference
+     * between two consecutive samples of the step; any rounding error goes into the largest one.
+     */
+    for (uint32_t phase = 0; phase < PHASES; phase++) {
+        double last = 0.0;
+        int32_t sum = 0;
+        uint32_t largest = 0;
+        for (uint32_t tap = 0; tap < KERNEL_WIDTH; tap++) {
+            int32_t point = static_cast<int32_t>(tap * pointsPerSample) - static_cast<int32_t>(2 * phase);
+            point = (point < 0) ? 0 : (point > static_cast<int32_t>(points) ? static_cast<int32_t>(points) : point);
+            double value = pStep[point] / pStep[points];
+            auto delta = static_cast<int16_t>(std::lround((value - last) * (1 << KERNEL_BITS)));
+            m_kernel[phase][tap] = delta;
+            sum += delta;
+            largest = (delta > m_kernel[phase][largest]) ? tap : largest;
+            last = value;
+        }
+        m_kernel[phase][largest] = static_cast<int16_t>(m_kernel[phase][largest] + (1 << KERNEL_BITS) - sum);
+    }
+    delete[] pStep;
+}
+
+
+ZxBeeper::~ZxBeeper() {
+
+    delete[] m_pSamples;
+    delete[] m_pDeltas;
+    delete[] m_pEdges;
+}
+
+
+void ZxBeeper::endFrame(uint32_t frameTstates, const int16_t *pMix, uint32_t mixCount) {
+
+    // Add the steps of the changes of level, at the fraction of the sample at which each one happened
+    const uint32_t lastPosition = m_deltaSize - KERNEL_WIDTH;
+    for (uint32_t i = 0; i < m_edgeCount; i++) {
+        const Edge &edge = m_pEdges[i];
+        uint64_t time = m_frameStart + edge.tstates * m_step;
+        auto position = static_cast<uint32_t>(time >> 32);
+        if (position > lastPosition) {
+            continue;
+        }
+        const int16_t *pKernel = m_kernel[(time >> (32 - PHASE_BITS)) & (PHASES - 1)];
+        int32_t delta = LEVELS[edge.level] - m_amplitude;
+        m_amplitude = LEVELS[edge.level];
+
+        int32_t *pDeltas = m_pDeltas + position;
+        for (uint32_t tap = 0; tap < KERNEL_WIDTH; tap++) {
+            pDeltas[tap] += delta * pKernel[tap];
+        }
+    }
+    m_edgeCount = 0;
+
+    // Add up the differences into the samples up to the end of the frame
+    uint64_t frameEnd = m_frameStart + frameTstates * m_step;
+    auto count = static_cast<uint32_t>(frameEnd >> 32);
+    count = (count < lastPosition) ? count : lastPosition;
+
+    // Samples mixed in go into the differences too, so that their DC level is filtered out along with the speaker's
+    if (pMix != nullptr) {
+        mixCount = (mixCount < count) ? mixCount : count;
+        int16_t mixLevel = m_mixLevel;
+        for (uint32_t i = 0; i < mixCount; i++) {
+            m_pDeltas[i] += (pMix[i] - mixLevel) * (1 << KERNEL_BITS);
+            mixLevel = pMix[i];
+        }
+        m_mixLevel = mixLevel;
+    }
+
+    int32_t integrator = m_integrator;
+    for (uint32_t i = 0; i < count; i++) {
+        integrator += m_pDeltas[i];
+        int32_t sample = integrator >> KERNEL_BITS;
+        m_pSamples[i] = static_cast<int16_t>((sample > INT16_MAX) ? INT16_MAX : (sample < INT16_MIN) ? INT16_MIN : sample);
+        integrator -= integrator >> BASS_SHIFT;
+    }
+    m_integrator = integrator;
+    m_buffer.write(m_pSamples, count);
+    m_samples += count;
+
+    // The differences past the end of the frame, i.e. the tails of the last steps, carry over to the next frame
+    memmove(m_pDeltas, m_pDeltas + count, (m_deltaSize - count) * sizeof(int32_t));
+    memset(m_pDeltas + m_deltaSize - count, 0, count * sizeof(int32_t));
+    m_frameStart = frameEnd - (static_cast<uint64_t>(count) << 32);
+}
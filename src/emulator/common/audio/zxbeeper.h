@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXBEEPER_H
+#define ZXRASPBERRY_ZXBEEPER_H
+
+#include <cstdint>
+
+class ZxAudioBuffer;
+
+
+/*
+ * Turns the EAR and MIC bits written to the ULA port into band-limited audio.
+ *
+ * During a frame, every change of the bits is only logged with its T-state, so that beeper music engines, which write
+ * to the port tens of thousands of times a second, cost the emulation next to nothing.  Once the frame has ended, each
+ * change adds a band-limited step (BLEP) at its exact position in time, i.e. the difference between two output levels
+ * smoothed by a windowed sinc, to a buffer of differences: a fixed KERNEL_WIDTH additions per change, however many
+ * samples or changes there are.  A single pass over the buffer then adds the differences up into samples, filtering
+ * out the DC level of the speaker on the way, and the samples of the frame are written to the audio buffer.
+ *
+ * There is no aliasing from the 3.5 MHz edges and steps between samples are heard at their exact time, to a
+ * 1/PHASES of a sample.  The output lags behind the emulation by KERNEL_WIDTH / 2 samples.
+ */
+class ZxBeeper {
+
+public:
+    // Changes logged per frame; a beeper engine cannot write to the port more than once every 11 T-states
+    static const uint32_t MAX_EDGES = 8192;
+    static const uint32_t PHASE_BITS = 5;
+    static const uint32_t PHASES = 1u << PHASE_BITS;
+    static const uint32_t KERNEL_WIDTH = 16;
+    // Output level with the EAR bit set, the loudest the beeper goes
+    static const int32_t VOLUME = 8192;
+
+    ZxBeeper(ZxAudioBuffer &buffer, uint32_t clockFrequency, uint32_t tStatesPerFrame, uint32_t sampleRate);
+    ~ZxBeeper();
+
+    ZxBeeper(const ZxBeeper &) = delete;
+    ZxBeeper &operator=(const ZxBeeper &) = delete;
+
+    // Logs the EAR (bit 4) and MIC (bit 3) bits of a value written to the ULA port at a T-state of the current frame
+    void write(uint8_t value, uint32_t tstates) {
+        uint8_t level = (value >> 3) & 0x03u;
+        if (level != m_level) {
+            m_level = level;
+            if (m_edgeCount < MAX_EDGES) {
+                m_pEdges[m_edgeCount++] = { tstates, level };
+            } else {
+                m_edgesDropped++;
+            }
+        }
+    }
+
+    /* Turns the changes logged during the frame that has just ended, after the given number of T-states, into samples.
+     * The samples of other sound sources for the same frame, if any, are mixed in before filtering out the DC level.
+     */
+    void endFrame(uint32_t frameTstates, const int16_t *pMix = nullptr, uint32_t mixCount = 0);
+
+    [[nodiscard]] uint32_t sampleRate() const {
+        return m_sampleRate;
+    }
+
+    // Samples written to the audio buffer since start-up, including any that it dropped because it was full
+    [[nodiscard]] uint64_t samples() const {
+        return m_samples;
+    }
+
+    [[nodiscard]] uint32_t edgesDropped() const {
+        return m_edgesDropped;
+    }
+
+private:
+    struct Edge {
+        uint32_t tstates;
+        uint8_t level;
+    };
+
+    ZxAudioBuffer &m_buffer;
+    const uint32_t m_sampleRate;
+    // Samples per T-state and position of the start of the frame in the buffer of differences, as 32.32 fixed point
+    uint64_t m_step;
+    uint64_t m_frameStart;
+
+    Edge *m_pEdges;
+    uint32_t m_edgeCount;
+    uint32_t m_edgesDropped;
+    uint8_t m_level;
+    int32_t m_amplitude;
+
+    // Band-limited steps for every fraction of a sample at which a change can happen, each one adding up to 1.0 (32768)
+    int16_t m_kernel[PHASES][KERNEL_WIDTH];
+    int32_t *m_pDeltas;
+    uint32_t m_deltaSize;
+    int16_t *m_pSamples;
+    int32_t m_integrator;
+    // Last sample mixed in from other sound sources
+    int16_t m_mixLevel;
+    uint64_t m_samples;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXBEEPER_H
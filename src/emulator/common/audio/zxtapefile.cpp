@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "zxtapefile.h"
+
+
+ZxTapeFile::ZxTapeFile() : m_pFile(nullptr) {
+}
+
+ZxTapeFile::~ZxTapeFile() {
+    close();
+}
+
+bool ZxTapeFile::open(const char *pFileName) {
+
+    close();
+    m_pFile = std::fopen(pFileName, "rb");
+    return m_pFile != nullptr;
+}
+
+void ZxTapeFile::close() {
+
+    if (m_pFile != nullptr) {
+        std::fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+}
+
+uint32_t ZxTapeFile::read(uint8_t *pData, uint32_t size) {
+
+    if (m_pFile == nullptr) {
+        return 0;
+    }
+    return static_cast<uint32_t>(std::fread(pData, 1, size, m_pFile));
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXTAPEFILE_H
+#define ZXRASPBERRY_ZXTAPEFILE_H
+
+#include <cstdio>
+#include "zxtapesource.h"
+
+
+/*
+ * Recording read from a file as the tape plays, so that however long it is, only the chunk being decoded is in memory.
+ * Like the WAV writer, it needs a file system and is therefore not part of the bare metal build.
+ */
+class ZxTapeFile : public ZxTapeSource {
+
+public:
+    ZxTapeFile();
+    ~ZxTapeFile() override;
+
+    ZxTapeFile(const ZxTapeFile &) = delete;
+    ZxTapeFile &operator=(const ZxTapeFile &) = delete;
+
+    bool open(const char *pFileName);
+    void close();
+
+    uint32_t read(uint8_t *pData, uint32_t size) override;
+
+private:
+    std::FILE *m_pFile;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXTAPEFILE_H
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include "zxtapeinput.h"
+#include "zxtapesource.h"
+
+// WAV format tags of PCM samples
+static const uint32_t FORMAT_PCM = 0x0001;
+static const uint32_t FORMAT_EXTENSIBLE = 0xFFFE;
+static const uint32_t MAX_CHANNELS = 2;
+static const uint32_t CHUNK_SIZE = ZxTapeInput::CHUNK_FRAMES * MAX_CHANNELS * 2;
+
+
+static uint32_t get16(const uint8_t *pData) {
+    return pData[0] | (pData[1] << 8u);
+}
+
+static uint32_t get32(const uint8_t *pData) {
+    return get16(pData) | (get16(pData + 2) << 16u);
+}
+
+// First channel of a sample, and the second one if there is one, averaged, as a signed 16-bit value
+static int32_t sampleAt(const uint8_t *pData, uint32_t bytesPerSample, uint32_t channels) {
+    if (bytesPerSample == 1) {
+        int32_t sample = (pData[0] - 128) * 256;
+        return (channels == 1) ? sample : (sample + (pData[1] - 128) * 256) / 2;
+    }
+    int32_t sample = static_cast<int16_t>(get16(pData));
+    return (channels == 1) ? sample : (sample + static_cast<int16_t>(get16(pData + 2))) / 2;
+}
+
+
+ZxTapeInput::ZxTapeInput(uint32_t clockFrequency) :
+        m_clockFrequency(clockFrequency),
+        m_pSource(nullptr),
+        m_sampleRate(0),
+        m_channels(0),
+        m_bytesPerSample(0),
+        m_dataLeft(0),
+        m_pChunk(new uint8_t[CHUNK_SIZE]),
+        m_bPlaying(false),
+        m_bEnded(true),
+        m_start(0),
+        m_samples(0),
+        m_decodedUntil(0),
+        m_bHigh(false),
+        m_centre(0),
+        m_pEdges(new uint64_t[EDGE_CAPACITY]),
+        m_first(0),
+        m_end(0),
+        m_cursor(0),
+        m_bLevel(false) {
+}
+
+ZxTapeInput::~ZxTapeInput() {
+    delete[] m_pEdges;
+    delete[] m_pChunk;
+}
+
+bool ZxTapeInput::insert(ZxTapeSource *pSource) {
+
+    m_pSource = pSource;
+    m_bPlaying = false;
+    m_samples = 0;
+    m_decodedUntil = 0;
+    m_bHigh = false;
+    m_centre = 0;
+    m_first = m_end = m_cursor = 0;
+    m_bLevel = false;
+    m_bEnded = !readHeader();
+    if (m_bEnded) {
+        m_pSource = nullptr;
+    }
+    return !m_bEnded;
+}
+
+/*
+ * The tape carries on from where it stopped.  The edges already found were timed for the last time it played, so
+ * they are forgotten.
+ */
+void ZxTapeInput::play(uint64_t tstates) {
+
+    if (m_pSource == nullptr || m_bPlaying) {
+        return;
+    }
+
+    // Unsigned arithmetic wraps around, so the start may well be "before" 0
+    m_start = tstates - m_samples * m_clockFrequency / m_sampleRate;
+    m_decodedUntil = tstates;
+    m_first = m_cursor = m_end;
+    m_bLevel = m_bHigh;
+    m_bPlaying = true;
+}
+
+void ZxTapeInput::stop() {
+    m_bPlaying = false;
+}
+
+/*
+ * RIFF header, format chunk and header of the data chunk, skipping any other chunks, e.g. lists of tags.
+ */
+bool ZxTapeInput::readHeader() {
+
+    uint8_t header[16];
+    if (m_pSource == nullptr || m_pSource->read(header, 12) != 12 ||
+            memcmp(&header[0], "RIFF", 4) != 0 || memcmp(&header[8], "WAVE", 4) != 0) {
+        return false;
+    }
+
+    bool format = false;
+    while (m_pSource->read(header, 8) == 8) {
+        uint32_t size = get32(&header[4]);
+        if (memcmp(&header[0], "fmt ", 4) == 0 && size >= 16) {
+            if (m_pSource->read(header, 16) != 16 || !skip(size - 16 + (size & 1u))) {
+                return false;
+            }
+            uint32_t tag = get16(&header[0]);
+            m_channels = get16(&header[2]);
+            m_sampleRate = get32(&header[4]);
+            m_bytesPerSample = get16(&header[14]) / 8;
+            format = (tag == FORMAT_PCM || tag == FORMAT_EXTENSIBLE) && m_channels >= 1 &&
+                     m_channels <= MAX_CHANNELS && (m_bytesPerSample == 1 || m_bytesPerSample == 2) &&
+                     m_sampleRate > 0 && get16(&header[14]) % 8 == 0;
+        } else if (memcmp(&header[0], "data", 4) == 0) {
+            // Recordings still being written may have no size yet, in which case they run until the source does
+            m_dataLeft = size;
+            return format;
+        } else if (!skip(size + (size & 1u))) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool ZxTapeInput::skip(uint32_t size) {
+
+    while (size > 0) {
+        uint32_t count = m_pSource->read(m_pChunk, (size < CHUNK_SIZE) ? size : CHUNK_SIZE);
+        if (count == 0) {
+            return false;
+        }
+        size -= count;
+    }
+    return true;
+}
+
+/*
+ * Moves the cursor to the given time, going back over the edges still kept or decoding chunks as needed.
+ */
+void ZxTapeInput::seek(uint64_t tstates) {
+
+    if (!m_bPlaying) {
+        return;
+    }
+
+    while (m_cursor != m_first && m_pEdges[(m_cursor - 1) & EDGE_MASK] > tstates) {
+        m_cursor--;
+        m_bLevel = !m_bLevel;
+    }
+
+    for (;;) {
+        while (m_cursor != m_end && m_pEdges[m_cursor & EDGE_MASK] <= tstates) {
+            m_cursor++;
+            m_bLevel = !m_bLevel;
+        }
+        if (m_cursor != m_end || m_bEnded || m_decodedUntil > tstates) {
+            break;
+        }
+        decode();
+    }
+}
+
+/*
+ * Reads the next chunk of samples and adds the edges found in it, forgetting the oldest ones if there is no room.
+ */
+void ZxTapeInput::decode() {
+
+    const uint32_t frameSize = m_channels * m_bytesPerSample;
+    uint32_t wanted = CHUNK_FRAMES * frameSize;
+    wanted = (wanted < m_dataLeft) ? wanted : m_dataLeft;
+    uint32_t size = 0;
+    uint32_t count;
+    while (size < wanted && (count = m_pSource->read(m_pChunk + size, wanted - size)) > 0) {
+        size += count;
+    }
+    m_dataLeft -= size;
+    m_bEnded = size < wanted || m_dataLeft < frameSize;
+
+    const uint32_t frames = size / frameSize;
+    const uint8_t *pData = m_pChunk;
+    for (uint32_t i = 0; i < frames; i++, pData += frameSize) {
+        const int32_t sample = sampleAt(pData, m_bytesPerSample, m_channels);
+        const int32_t centre = m_centre >> CENTRE_SHIFT;
+        m_centre += sample - centre;
+        if (m_bHigh ? sample < centre - HYSTERESIS : sample > centre + HYSTERESIS) {
+            m_bHigh = !m_bHigh;
+            m_first += (m_end - m_first == EDGE_CAPACITY) ? 1 : 0;
+            m_pEdges[m_end & EDGE_MASK] = m_start + (m_samples + i) * m_clockFrequency / m_sampleRate;
+            m_end++;
+        }
+    }
+
+    m_samples += frames;
+    m_decodedUntil = m_start + m_samples * m_clockFrequency / m_sampleRate;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXTAPEINPUT_H
+#define ZXRASPBERRY_ZXTAPEINPUT_H
+
+#include <cstdint>
+
+class ZxTapeSource;
+
+
+/*
+ * Plays a tape recording, a PCM WAV file with 8 or 16-bit samples, into the EAR input, bit 6 of the ULA port.
+ *
+ * The recording is streamed from its source CHUNK_FRAMES samples at a time, as the tape gets there, and each chunk is
+ * turned into the times of the edges of the signal by a Schmitt trigger: the input goes high when a sample rises
+ * HYSTERESIS above the centre of the signal and low when it falls HYSTERESIS below it, so that noise around the centre
+ * makes no edges.  The centre follows the average of the signal over about 2^CENTRE_SHIFT samples, which takes out the
+ * DC offset of recordings made with the wrong bias.  Only the chunk being decoded and the last EDGE_CAPACITY edges are
+ * ever in memory, however long the recording is.
+ *
+ * Reads of the input are answered by a cursor on the edges: the level only changes when a read passes the next edge,
+ * so a loader polling the port in a tight loop costs a comparison per read and the work done scales with the edges of
+ * the signal.  The cursor also goes back over the edges that are still in memory, so that frames emulated again after
+ * going back in time, e.g. by the run-ahead, hear the tape as it was then.
+ */
+class ZxTapeInput {
+
+public:
+    // Samples decoded at a time, so also the most edges that a chunk can add
+    static const uint32_t CHUNK_FRAMES = 1024;
+    static const uint32_t EDGE_CAPACITY = 4096;
+    // Distance from the centre of the signal that a sample must cross to change the level, about 3% of full scale
+    static const int32_t HYSTERESIS = 1024;
+    static const uint32_t CENTRE_SHIFT = 10;
+
+    explicit ZxTapeInput(uint32_t clockFrequency);
+    ~ZxTapeInput();
+
+    ZxTapeInput(const ZxTapeInput &) = delete;
+    ZxTapeInput &operator=(const ZxTapeInput &) = delete;
+
+    /* Reads the header of the recording, up to the start of the samples, and returns false unless it is a mono or
+     * stereo PCM WAV file with 8 or 16-bit samples.  The source must outlive the tape or the next insert().
+     */
+    bool insert(ZxTapeSource *pSource);
+    // Starts the tape at an absolute T-state (see Clock::getAbsTstates())
+    void play(uint64_t tstates);
+    void stop();
+
+    // Level of the signal at an absolute T-state
+    bool level(uint64_t tstates) {
+        if ((m_cursor != m_end && m_pEdges[m_cursor & EDGE_MASK] <= tstates) ||
+                (m_cursor == m_end && !m_bEnded && m_decodedUntil <= tstates) ||
+                (m_cursor != m_first && m_pEdges[(m_cursor - 1) & EDGE_MASK] > tstates)) {
+            seek(tstates);
+        }
+        return m_bLevel;
+    }
+
+    [[nodiscard]] bool isPlaying() const {
+        return m_bPlaying;
+    }
+
+    // True once every sample of the recording has been decoded
+    [[nodiscard]] bool ended() const {
+        return m_bEnded;
+    }
+
+    [[nodiscard]] uint32_t sampleRate() const {
+        return m_sampleRate;
+    }
+
+    // Edges found in the recording so far
+    [[nodiscard]] uint64_t edges() const {
+        return m_end;
+    }
+
+private:
+    static const uint64_t EDGE_MASK = EDGE_CAPACITY - 1;
+
+    bool readHeader();
+    bool skip(uint32_t size);
+    void seek(uint64_t tstates);
+    void decode();
+
+    const uint32_t m_clockFrequency;
+    ZxTapeSource *m_pSource;
+    uint32_t m_sampleRate;
+    uint32_t m_channels;
+    uint32_t m_bytesPerSample;
+    // Bytes of samples left in the recording
+    uint32_t m_dataLeft;
+    uint8_t *m_pChunk;
+
+    bool m_bPlaying;
+    bool m_bEnded;
+    uint64_t m_start;
+    // Samples decoded since the start of the tape and the T-state of the next one
+    uint64_t m_samples;
+    uint64_t m_decodedUntil;
+    // State of the Schmitt trigger and centre of the signal, scaled by 2^CENTRE_SHIFT
+    bool m_bHigh;
+    int32_t m_centre;
+
+    // Edges kept, from m_first up to m_end, counted since the start of the tape, and the cursor: the next edge to pass
+    uint64_t *m_pEdges;
+    uint64_t m_first;
+    uint64_t m_end;
+    uint64_t m_cursor;
+    bool m_bLevel;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXTAPEINPUT_H
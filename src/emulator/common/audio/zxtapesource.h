@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXTAPESOURCE_H
+#define ZXRASPBERRY_ZXTAPESOURCE_H
+
+#include <cstdint>
+#include <cstring>
+
+
+/*
+ * Where the tape input reads a recording from, a few kilobytes at a time, e.g. a file or a recording in memory.
+ * read() returns the number of bytes read, which is less than asked for, or 0, once the recording runs out.
+ */
+class ZxTapeSource {
+
+public:
+    virtual ~ZxTapeSource() = default;
+
+    virtual uint32_t read(uint8_t *pData, uint32_t size) = 0;
+
+};
+
+
+/*
+ * Recording held in memory, e.g. linked into the kernel.  The memory is not copied and must outlive the source.
+ */
+class ZxTapeMemorySource : public ZxTapeSource {
+
+public:
+    ZxTapeMemorySource(const uint8_t *pData, uint32_t size) : m_pData(pData), m_size(size), m_offset(0) {
+    }
+
+    uint32_t read(uint8_t *pData, uint32_t size) override {
+        size = (size < m_size - m_offset) ? size : m_size - m_offset;
+        memcpy(pData, m_pData + m_offset, size);
+        m_offset += size;
+        return size;
+    }
+
+private:
+    const uint8_t *m_pData;
+    const uint32_t m_size;
+    uint32_t m_offset;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXTAPESOURCE_H
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <cstring>
+#include "zxwavwriter.h"
+#include "zxaudiobuffer.h"
+
+// How long the writer thread sleeps when the buffer is empty, well under the 20 ms that a frame of samples lasts
+static const std::chrono::milliseconds IDLE_WAIT(2);
+// Samples taken out of the buffer at a time
+static const uint32_t CHUNK_SIZE = 4096;
+static const uint32_t HEADER_SIZE = 44;
+
+
+static void put16(uint8_t *pData, uint32_t value) {
+    pData[0] = static_cast<uint8_t>(value);
+    pData[1] = static_cast<uint8_t>(value >> 8);
+}
+
+static void put32(uint8_t *pData, uint32_t value) {
+    put16(pData, value);
+    put16(pData + 2, value >> 16);
+}
+
+
+ZxWavWriter::ZxWavWriter(ZxAudioBuffer &buffer, uint32_t sampleRate) :
+        m_buffer(buffer),
+        m_sampleRate(sampleRate),
+        m_pFile(nullptr),
+        m_bRunning(false),
+        m_samplesWritten(0),
+        m_bWriteFailed(false) {
+}
+
+ZxWavWriter::~ZxWavWriter() {
+    stop();
+}
+
+bool ZxWavWriter::start(const char *pFileName) {
+
+    if (m_writer.joinable()) {
+        return false;
+    }
+
+    m_pFile = std::fopen(pFileName, "wb");
+    if (m_pFile == nullptr) {
+        return false;
+    }
+
+    // The sizes in the header are filled in once the file is complete
+    m_samplesWritten = 0;
+    m_bWriteFailed = !writeHeader(0);
+    m_bRunning = true;
+    m_writer = std::thread(&ZxWavWriter::run, this);
+    return true;
+}
+
+void ZxWavWriter::stop() {
+
+    if (!m_writer.joinable()) {
+        return;
+    }
+
+    m_bRunning = false;
+    m_writer.join();
+    writeSamples();
+
+    if (std::fseek(m_pFile, 0, SEEK_SET) != 0 || !writeHeader(m_samplesWritten)) {
+        m_bWriteFailed = true;
+    }
+    if (std::fclose(m_pFile) != 0) {
+        m_bWriteFailed = true;
+    }
+    m_pFile = nullptr;
+}
+
+void ZxWavWriter::run() {
+
+    while (m_bRunning.load(std::memory_order_relaxed)) {
+        if (m_buffer.available() == 0) {
+            std::this_thread::sleep_for(IDLE_WAIT);
+        }
+        writeSamples();
+    }
+}
+
+/*
+ * Writes out the samples in the buffer, as little endian values whatever the host.
+ */
+void ZxWavWriter::writeSamples() {
+
+    int16_t samples[CHUNK_SIZE];
+    uint8_t data[CHUNK_SIZE * 2];
+    uint32_t count;
+    while ((count = m_buffer.read(samples, CHUNK_SIZE)) > 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            put16(&data[i * 2], static_cast<uint16_t>(samples[i]));
+        }
+        if (std::fwrite(data, 2, count, m_pFile) != count) {
+            m_bWriteFailed = true;
+        }
+        m_samplesWritten.store(m_samplesWritten.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+}
+
+/*
+ * RIFF header of a PCM WAV file with one channel of 16-bit samples.
+ */
+bool ZxWavWriter::writeHeader(uint32_t samples) {
+
+    uint8_t header[HEADER_SIZE];
+    const uint32_t dataSize = samples * 2;
+    memcpy(&header[0], "RIFF", 4);
+    put32(&header[4], HEADER_SIZE - 8 + dataSize);
+    memcpy(&header[8], "WAVE", 4);
+    memcpy(&header[12], "fmt ", 4);
+    put32(&header[16], 16);                     // Size of the format chunk
+    put16(&header[20], 1);                      // PCM
+    put16(&header[22], 1);                      // Channels
+    put32(&header[24], m_sampleRate);
+    put32(&header[28], m_sampleRate * 2);       // Bytes per second
+    put16(&header[32], 2);                      // Bytes per sample
+    put16(&header[34], 16);                     // Bits per sample
+    memcpy(&header[36], "data", 4);
+    put32(&header[40], dataSize);
+    return std::fwrite(header, 1, HEADER_SIZE, m_pFile) == HEADER_SIZE;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXWAVWRITER_H
+#define ZXRASPBERRY_ZXWAVWRITER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include "zxaudiosink.h"
+
+class ZxAudioBuffer;
+
+
+/*
+ * Audio sink that writes the samples to a 16-bit mono PCM WAV file, e.g. to listen to or check the sound of headless
+ * runs and tests.  A writer thread takes the samples out of the buffer as soon as they are there rather than at the
+ * sample rate, so the file always holds everything that the emulation produced, however fast it ran, as long as the
+ * buffer is large enough to hold the samples written while the thread waits.  Like the video capture, it needs threads
+ * and a file system and is therefore not part of the bare metal build.
+ */
+class ZxWavWriter : public ZxAudioSink {
+
+public:
+    ZxWavWriter(ZxAudioBuffer &buffer, uint32_t sampleRate);
+    ~ZxWavWriter() override;
+
+    ZxWavWriter(const ZxWavWriter &) = delete;
+    ZxWavWriter &operator=(const ZxWavWriter &) = delete;
+
+    bool start(const char *pFileName);
+    // Writes out what is left in the buffer, completes the header and closes the file
+    void stop() override;
+
+    [[nodiscard]] uint32_t sampleRate() const override {
+        return m_sampleRate;
+    }
+
+    // The file takes whatever is in the buffer, so it never runs short of samples
+    [[nodiscard]] uint32_t underruns() const override {
+        return 0;
+    }
+
+    [[nodiscard]] uint32_t samplesWritten() const {
+        return m_samplesWritten.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool writeFailed() const {
+        return m_bWriteFailed.load(std::memory_order_relaxed);
+    }
+
+private:
+    void run();
+    bool writeHeader(uint32_t samples);
+    void writeSamples();
+
+    ZxAudioBuffer &m_buffer;
+    const uint32_t m_sampleRate;
+    std::FILE *m_pFile;
+    std::thread m_writer;
+    std::atomic<bool> m_bRunning;
+    std::atomic<uint32_t> m_samplesWritten;
+    std::atomic<bool> m_bWriteFailed;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXWAVWRITER_H
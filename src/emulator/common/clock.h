@@ -25,14 +25,20 @@
 #include "common/hardware/zxhardwaremodel.h"
 
 
+/*
+ * Emulated time.  The T-states are counted from the start of the current frame, which is what the contention tables
+ * and the display work with, and the start of the frame is kept in absolute T-states since the machine was started, so
+ * that the scheduler can order events across frames.  At 3.5 MHz a 64-bit count never wraps around.
+ */
 class Clock {
 
 private:
-    Clock() : m_spectrumModel(nullptr), m_tstates(0), m_frames(0) {};
+    Clock() : m_spectrumModel(nullptr), m_tstates(0), m_frames(0), m_frameStart(0) {};
 
     ZxHardwareModel *m_spectrumModel;
     uint32_t m_tstates;
     uint32_t m_frames;
+    uint64_t m_frameStart;
 
 public:
     static Clock &getInstance() {
@@ -67,6 +73,7 @@ public:
     }
 
 
+    // The absolute time carries on from where it was, so the events already scheduled stay in order
     void setTstates(uint32_t states) {
 
         m_tstates = (states > m_spectrumModel->tStatesPerScreenFrame()) ? 0 : states;
@@ -86,22 +93,40 @@ public:
     }
 
 
+    // Absolute T-state at which the current frame started
+    [[nodiscard]] uint64_t getFrameStart() const {
+
+        return m_frameStart;
+    }
+
+
+    // Puts the clock back to a time saved earlier with getTstates(), getFrames() and getFrameStart()
+    void restore(uint32_t tstates, uint32_t frames, uint64_t frameStart) {
+
+        m_tstates = tstates;
+        m_frames = frames;
+        m_frameStart = frameStart;
+    }
+
+
     void endFrame() {
         assert(m_tstates >= m_spectrumModel->tStatesPerScreenFrame());
         m_frames++;
         m_tstates -= m_spectrumModel->tStatesPerScreenFrame();
+        m_frameStart += m_spectrumModel->tStatesPerScreenFrame();
     }
 
 
     [[nodiscard]] uint64_t getAbsTstates() const {
 
-        return m_frames * m_spectrumModel->tStatesPerScreenFrame() + m_tstates;
+        return m_frameStart + m_tstates;
     }
 
 
     void reset() {
 
         m_frames = m_tstates = 0;
+        m_frameStart = 0;
     }
 
 };
@@ -22,50 +22,66 @@
 #include <cstdint>
 #include "zxview.h"
 #include "zxdialog.h"
-#include "zx48k_rom.h"
+#include "zxcharset.h"
+#include "../zxdisplayrenderer.h"
 
 
-uint8_t ZxView::characters[0x90 * 0x08];
+// Expanded character set, generated at compile time
+static constexpr ZxCharset charset{};
+
+const uint8_t *const ZxView::characters = charset.bitmap;
+
+
+ZxView::ZxView(ZxRect const bounds) : m_parent(nullptr), m_bounds(bounds) {
+}
 
 /*
- * Renders an expanded version of the character set for easy drawing of UI elements.
+ * Draws one line of a character cell, i.e. 8 pixels, where each bit set in the character line is drawn with the ink
+ * colour and every other bit with the paper colour.
  */
-ZxView::ZxView(ZxRect const bounds) : m_parent(nullptr), m_bounds(bounds) {
+void ZxView::drawCharacterLine(uint8_t *pCell, uint8_t charLine, uint8_t ink, uint8_t paper) {
 
-    /*
-     * The first 128 (0x80) characters in the ZX Spectrum character set are stored as 8 byte bit patters each
-     * representing an 8 by 8 character.
-     */
-    for (unsigned int g = 0x00; g < 0x80; g++) {
-        for (unsigned int idx = 0x00; idx < 0x08; idx++) {
-            characters[g * 0x08 + idx] = zx48k_rom[charsetAddr + g * 8 + idx];
-        }
-    }
+    switch (colourDepth) {
+        case 8:
+            for (unsigned int x = 0; x < 8; x++) {
+                pCell[x] = (charLine & (0x80u >> x)) ? ink : paper;
+            }
+            break;
+        case 16:
+            for (unsigned int x = 0; x < 8; x++) {
+                reinterpret_cast<uint16_t *>(pCell)[x] =
+                        static_cast<uint16_t>(zxNativeColour(16, (charLine & (0x80u >> x)) ? ink : paper));
+            }
+            break;
+        case 32:
+            for (unsigned int x = 0; x < 8; x++) {
+                reinterpret_cast<uint32_t *>(pCell)[x] = zxNativeColour(32, (charLine & (0x80u >> x)) ? ink : paper);
+            }
+            break;
+        default: {
+            // possible combinations of 2 pixels stored in a single byte as a group of 2 elements of 4 bits.
+            const uint8_t twinColouredPixels[] = {
+                    static_cast<uint8_t>(static_cast<uint8_t>(paper << 0x4u) | paper),
+                    static_cast<uint8_t>(static_cast<uint8_t>(paper << 0x4u) | ink),
+                    static_cast<uint8_t>(static_cast<uint8_t>(ink << 0x4u) | paper),
+                    static_cast<uint8_t>(static_cast<uint8_t>(ink << 0x4u) | ink)
+            };
 
-    // Lookup table representing the 4 possible states a row in a character block graphic can be in
-    const uint8_t rowFillTable[] = {0x00, 0x0F, 0xF0, 0xFF};
-
-    /*
-     * The graphics characters are not stored in ROM but are instead calculated from the character code where each bit
-     * of the lower 4 bits in the byte represents a corner in the target block character in the following order:
-     *
-     *      bottom-left, bottom, right, top-left, top-right.
-     *
-     *  BYTE: 1 0 0 0 BL BR TL TR
-     */
-    for (unsigned int g = 0x80; g < 0x90; g++) {
-        for (unsigned int idx = 0x00; idx < 0x08; idx++) {
-            characters[g * 0x08 + idx] = rowFillTable[(idx < 0x04) ? (g & 0x03u) : ((g & 0x0Cu) >> 0x02u)];
+            uint8_t mask = 0xC0;
+            for (unsigned int x = 0; x < 4; x++) {
+                uint8_t bits = charLine & mask;
+                mask = mask >> 0x02u;
+                pCell[x] = twinColouredPixels[bits >> (6 - x * 2)];
+            }
+            break;
         }
     }
 }
 
 void ZxView::clear(uint8_t *buffer, uint8_t paper) {
 
-    uint8_t background = paper;
-
-    // Combination of 2 pixels stored in a single byte as a group of 2 elements of 4 bits representing the paper colour.
-    auto twinColouredPixel = static_cast<uint8_t>(static_cast<uint8_t>(background << 0x4u) | background);
+    // Bytes per line of pixels: 44 cells of 8 pixels each
+    const unsigned int pitch = 44 * colourDepth;
 
     auto parent = this->parent();
     ZxRect bounds;
@@ -80,16 +96,10 @@ void ZxView::clear(uint8_t *buffer, uint8_t paper) {
 
     for (int row = bounds.getAx(); row < bounds.getAx() + bounds.getHeight(); row++) {
         for (int column = bounds.getAx(); column < bounds.getAx() + bounds.getWidth(); column++) {
-            unsigned int rowOffset = row * 8 * 176;
+            unsigned int rowOffset = row * 8 * pitch;
 
             for (unsigned int line = 0x00; line < 0x08; line++) {
-                /*
-                 * A character is 8 pixels wide and since we are drawing two pixels at a time we only have to repeat
-                 * the operations 4 times.
-                 */
-                for (unsigned int x = 0; x < 4; x++) {
-                    buffer[rowOffset + column * 4 + x + line * 176] = twinColouredPixel;
-                }
+                drawCharacterLine(&buffer[rowOffset + column * colourDepth + line * pitch], 0x00, paper, paper);
             }
         }
     }
@@ -118,20 +128,12 @@ void ZxView::printText(uint8_t *buffer, unsigned int column, unsigned int row, u
     column += bounds.getAx();
     row += bounds.getAy();
 
-    uint8_t foreground = ink;
-    uint8_t background = paper;
-
-    // possible combinations of 2 pixels stored in a single byte as a group of 2 elements of 4 bits.
-    uint8_t twinColouredPixels[] = {
-            static_cast<uint8_t>(static_cast<uint8_t>(background << 0x4u) | background),
-            static_cast<uint8_t>(static_cast<uint8_t>(background << 0x4u) | foreground),
-            static_cast<uint8_t>(static_cast<uint8_t>(foreground << 0x4u) | background),
-            static_cast<uint8_t>(static_cast<uint8_t>(foreground << 0x4u) | foreground)
-    };
+    // Bytes per line of pixels: 44 cells of 8 pixels each
+    const unsigned int pitch = 44 * colourDepth;
 
     auto const *c = reinterpret_cast<unsigned char const *>(text);
     do {
-        unsigned int rowOffset = row * 8 * 176;
+        unsigned int rowOffset = row * 8 * pitch;
 
         for (unsigned int line=0x00; line < 0x08; line++) {
             uint8_t charLine = ZxDialog::characters[((*c - 0x20u) * 0x08) + line];
@@ -140,12 +142,7 @@ void ZxView::printText(uint8_t *buffer, unsigned int column, unsigned int row, u
 //            qDebug() << line << x.to_string();
 //            uint8_t charLine = zx48k_rom[charsetAddr + ((*c) * 8) + line];
 
-            uint8_t mask = 0xC0;
-            for (unsigned int x = 0; x < 4; x++) {
-                uint8_t bits = charLine & mask;
-                mask = mask >> 0x02u;
-                buffer[rowOffset + column * 4 + x + line * 176] = twinColouredPixels[bits >> (6 - x * 2)];
-            }
+            drawCharacterLine(&buffer[rowOffset + column * colourDepth + line * pitch], charLine, ink, paper);
         }
         if (++column >= 44) {
             column = 0;
@@ -33,6 +33,14 @@ public:
     void clear(uint8_t *buffer, uint8_t paper);
     virtual void draw(uint8_t *buffer) = 0;
 
+    /*
+     * Sets the colour depth of the framebuffer the views are drawn into: 4 or 8 bits per pixel indexed colour, 16 bits
+     * per pixel RGB565 or 32 bits per pixel XRGB8888.
+     */
+    static void setColourDepth(uint32_t depth) {
+        colourDepth = depth;
+    }
+
     ZxView *parent() const;
     void setParent(ZxView *parent);
 
@@ -40,8 +48,11 @@ public:
 
 private:
     // TODO: move this to a singleton ZxCharset class;
-    static uint8_t characters[0x90 * 0x08];
-    const unsigned int charsetAddr = 0x3D00;
+    static const uint8_t *const characters;
+    // Colour depth of the framebuffer, in bits per pixel
+    inline static uint32_t colourDepth = 4;
+
+    static void drawCharacterLine(uint8_t *pCell, uint8_t charLine, uint8_t ink, uint8_t paper);
 
 protected:
     ZxView *m_parent;
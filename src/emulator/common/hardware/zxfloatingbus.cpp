@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include "zxfloatingbus.h"
+
+
+ZxFloatingBus::ZxFloatingBus(ZxHardwareModel &model) : m_size(0), m_pAddress(nullptr) {
+
+    setHardwareModel(model);
+}
+
+
+void ZxFloatingBus::setHardwareModel(ZxHardwareModel &model) {
+
+    // Leave some room past the end of the frame, as an instruction may overrun it before the interrupt is taken
+    delete[] m_pAddress;
+    m_size = model.tStatesPerScreenFrame() + 256;
+    m_pAddress = new uint16_t[m_size];
+    memset(m_pAddress, 0, m_size * sizeof(uint16_t));
+    static_assert(IDLE == 0, "the table is cleared to IDLE");
+
+    const uint32_t firstFetch = model.tStatesToFirstScreenByte() + 2;
+
+    for (uint32_t line = 0; line < 192; line++) {
+        // Bitmap address of the first byte of the line, i.e. 010Y7Y6 Y2Y1Y0 Y5Y4Y3 X4X3X2X1X0 with X = 0
+        auto bitmap = static_cast<uint16_t>(0x4000u | ((line & 0xC0u) << 5) | ((line & 0x07u) << 8) | ((line & 0x38u) << 2));
+        auto attribute = static_cast<uint16_t>(0x5800u | ((line >> 3) << 5));
+        uint32_t tstates = firstFetch + line * model.tStatesPerScreenLine();
+
+        // 16 groups of 8 T-states draw the 32 bytes of the line, 2 bytes per group
+        for (uint32_t group = 0; group < 16; group++, tstates += 8, bitmap += 2, attribute += 2) {
+            m_pAddress[tstates + 0] = bitmap;
+            m_pAddress[tstates + 1] = attribute;
+            m_pAddress[tstates + 2] = static_cast<uint16_t>(bitmap + 1);
+            m_pAddress[tstates + 3] = static_cast<uint16_t>(attribute + 1);
+        }
+    }
+}
+
+
+ZxFloatingBus::~ZxFloatingBus() {
+
+    delete[] m_pAddress;
+}
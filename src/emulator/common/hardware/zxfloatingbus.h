@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXFLOATINGBUS_H
+#define ZXRASPBERRY_ZXFLOATINGBUS_H
+
+#include <cstdint>
+#include "zxhardwaremodel.h"
+
+
+/*
+ * Reading a port that no device answers returns whatever is on the data bus at that moment. While the ULA draws the
+ * screen area, that is the bitmap or attribute byte it is fetching; the rest of the time the bus floats high and the
+ * read returns 0xFF. Some games (Arkanoid, Cobra, Sidewize...) rely on this to synchronise with the beam.
+ *
+ * Within each group of 8 T-states of a screen line, the ULA fetches a bitmap byte, its attribute, the next bitmap byte
+ * and its attribute, starting 2 T-states after the group begins, and leaves the bus idle for the other 4 T-states.
+ * This class precomputes, for every T-state of the frame, the address the ULA is fetching from, so that reading the
+ * floating bus is just a table lookup and a memory read.
+ *
+ * Reference: [Sinclair Wiki: Floating bus](https://sinclair.wiki.zxnet.co.uk/wiki/Floating_bus)
+ */
+class ZxFloatingBus {
+
+public:
+    // Address stored for the T-states at which the ULA is not fetching anything
+    static const uint16_t IDLE = 0x0000;
+    static const uint8_t IDLE_VALUE = 0xFF;
+
+    explicit ZxFloatingBus(ZxHardwareModel &model);
+    ~ZxFloatingBus();
+
+    // Builds the table again for the timings of another model
+    void setHardwareModel(ZxHardwareModel &model);
+
+    ZxFloatingBus(const ZxFloatingBus &) = delete;
+    ZxFloatingBus &operator=(const ZxFloatingBus &) = delete;
+
+    // Address that the ULA is fetching from at the given T-state of the frame, or IDLE
+    [[nodiscard]] uint16_t address(uint32_t tstates) const {
+        return (tstates < m_size) ? m_pAddress[tstates] : IDLE;
+    }
+
+    // Value read from an unattached port at the given T-state of the frame
+    [[nodiscard]] uint8_t read(const uint8_t *pMemory, uint32_t tstates) const {
+        uint16_t fetchAddress = address(tstates);
+        return (fetchAddress != IDLE) ? pMemory[fetchAddress] : IDLE_VALUE;
+    }
+
+    // The same, reading from the 16K bank that the ULA displays, e.g. the second screen of the 128K
+    [[nodiscard]] uint8_t readScreen(const uint8_t *pScreen, uint32_t tstates) const {
+        uint16_t fetchAddress = address(tstates);
+        return (fetchAddress != IDLE) ? pScreen[fetchAddress & 0x3FFFu] : IDLE_VALUE;
+    }
+
+private:
+    uint32_t m_size;
+    uint16_t *m_pAddress;
+};
+
+
+#endif //ZXRASPBERRY_ZXFLOATINGBUS_H
@@ -46,6 +46,19 @@ public:
     // Interrupt signal length in t-states
     virtual uint32_t lengthINT() = 0;
 
+    // Number of T-states until the ULA first delays the CPU, i.e. the start of the contention pattern of the first line
+    virtual uint32_t tStatesToFirstContention() = 0;
+
+    // 16K pages of ROM and RAM, e.g. 1 and 3 on the 48K
+    virtual uint32_t romPages() = 0;
+    virtual uint32_t ramPages() = 0;
+
+    // Whether port 0x7FFD pages the ROM, the RAM at 0xC000 and the screen, as on the 128K
+    virtual bool hasMemoryPaging() = 0;
+
+    // Whether there is an AY-3-8912 sound chip on ports 0xFFFD and 0xBFFD, as on the 128K
+    virtual bool hasAY() = 0;
+
 //protected:
 //    CodeModel codeModel; // Código de modelo
 //    String longModelName;   // Nombre largo del modelo de Spectrum
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXHARDWAREMODEL128K_H
+#define ZXRASPBERRY_ZXHARDWAREMODEL128K_H
+
+
+#include "zxhardwaremodel.h"
+
+/*
+ * The original ZX Spectrum 128K: a slightly faster clock and longer lines and frames than the 48K, two 16K ROMs (the
+ * 128K editor and 48K BASIC) and eight 16K banks of RAM paged through port 0x7FFD, with a second screen in bank 7.
+ *
+ * Reference: [Sinclair Wiki: ZX Spectrum 128](https://sinclair.wiki.zxnet.co.uk/wiki/ZX_Spectrum_128)
+ */
+class ZxHardwareModel128k : public ZxHardwareModel {
+
+public:
+    ~ZxHardwareModel128k() override = default;
+
+    std::string longModelName() override { return "ZX Spectrum 128K"; };
+    std::string shortModelName() override { return "128k"; };
+    uint32_t clockFrequency() override { return 3546900; };
+    uint32_t tStatesPerScreenFrame() override { return 70908; };
+    uint32_t tStatesPerScreenLine() override { return 228; };
+    uint32_t upBorderHeight() override { return 63; };
+    uint32_t tStatesToFirstScreenByte() override { return 14364; };
+    uint32_t lengthINT() override {return 36; };
+    uint32_t tStatesToFirstContention() override { return 14361; };
+    uint32_t romPages() override { return 2; };
+    uint32_t ramPages() override { return 8; };
+    bool hasMemoryPaging() override { return true; };
+    bool hasAY() override { return true; };
+
+};
+
+
+#endif //ZXRASPBERRY_ZXHARDWAREMODEL128K_H
@@ -35,6 +35,11 @@ public:
     uint32_t upBorderHeight() override { return 64; };
     uint32_t tStatesToFirstScreenByte() override { return 14336; };
     uint32_t lengthINT() override {return 32; };
+    uint32_t tStatesToFirstContention() override { return 14335; };
+    uint32_t romPages() override { return 1; };
+    uint32_t ramPages() override { return 3; };
+    bool hasMemoryPaging() override { return false; };
+    bool hasAY() override { return false; };
 
 };
 
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include "zxframedecoder.h"
+#include "zxframestream.h"
+
+using namespace ZxFrameStream;
+
+
+ZxFrameDecoder::ZxFrameDecoder() :
+        m_pFrame(nullptr),
+        m_words(0),
+        m_width(0),
+        m_height(0),
+        m_depth(0),
+        m_frameNumber(0),
+        m_bHeaderDecoded(false),
+        m_bSynchronised(false),
+        m_bFrameReady(false) {
+}
+
+ZxFrameDecoder::~ZxFrameDecoder() {
+    delete[] m_pFrame;
+}
+
+int32_t ZxFrameDecoder::decode(const uint8_t *pData, uint32_t size) {
+
+    m_bFrameReady = false;
+    if (!m_bHeaderDecoded) {
+        return decodeHeader(pData, size);
+    }
+
+    if (size < RECORD_HEADER_SIZE) {
+        return 0;
+    }
+    uint8_t type = pData[0];
+    uint32_t payloadSize = getU32(&pData[5]);
+    if ((type != KEY_FRAME && type != DELTA_FRAME) || payloadSize > maxPayloadSize(m_words)) {
+        return -1;
+    }
+    if (size < RECORD_HEADER_SIZE + payloadSize) {
+        return 0;
+    }
+
+    if (type == KEY_FRAME) {
+        std::memset(m_pFrame, 0, m_words * 4);
+        m_bSynchronised = true;
+    }
+    if (m_bSynchronised) {
+        if (!decodePayload(&pData[RECORD_HEADER_SIZE], payloadSize)) {
+            // The frame is only partially updated, so wait for the next key frame
+            m_bSynchronised = false;
+            return -1;
+        }
+        m_frameNumber = getU32(&pData[1]);
+        m_bFrameReady = true;
+    }
+    return static_cast<int32_t>(RECORD_HEADER_SIZE + payloadSize);
+}
+
+int32_t ZxFrameDecoder::decodeHeader(const uint8_t *pData, uint32_t size) {
+
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+    if (std::memcmp(pData, MAGIC, sizeof(MAGIC)) != 0 || pData[4] != VERSION) {
+        return -1;
+    }
+
+    uint32_t width = getU16(&pData[5]);
+    uint32_t height = getU16(&pData[7]);
+    uint32_t depth = pData[9];
+    // In 64 bits, as a crafted header can describe a frame too large for 32
+    uint64_t bits = static_cast<uint64_t>(width) * height * depth;
+    if ((depth != 4 && depth != 8 && depth != 16 && depth != 32) || bits % 32 != 0 || bits == 0 ||
+        bits / 8 > UINT32_MAX) {
+        return -1;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_depth = depth;
+    m_words = static_cast<uint32_t>(bits / 32);
+    delete[] m_pFrame;
+    m_pFrame = new uint32_t[m_words]();
+    m_bHeaderDecoded = true;
+    return HEADER_SIZE;
+}
+
+bool ZxFrameDecoder::decodePayload(const uint8_t *pData, uint32_t size) {
+
+    const uint8_t *pEnd = pData + size;
+    uint32_t word = 0;
+    while (pData < pEnd) {
+        uint32_t token = 0;
+        for (uint32_t shift = 0; ; shift += 7) {
+            if (pData == pEnd || shift > 28) {
+                return false;
+            }
+            uint8_t byte = *pData++;
+            token |= static_cast<uint32_t>(byte & 0x7Fu) << shift;
+            if ((byte & 0x80u) == 0) {
+                break;
+            }
+        }
+
+        uint32_t count = token >> 2;
+        if (count > m_words - word) {
+            return false;
+        }
+        switch (token & 0x03u) {
+            case OP_SKIP:
+                break;
+            case OP_COPY:
+                if (static_cast<uint32_t>(pEnd - pData) < count * 4) {
+                    return false;
+                }
+                for (uint32_t i = 0; i < count; i++, pData += 4) {
+                    m_pFrame[word + i] = getU32(pData);
+                }
+                break;
+            case OP_REPEAT: {
+                if (pEnd - pData < 4) {
+                    return false;
+                }
+                uint32_t value = getU32(pData);
+                pData += 4;
+                for (uint32_t i = 0; i < count; i++) {
+                    m_pFrame[word + i] = value;
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+        word += count;
+    }
+    return true;
+}
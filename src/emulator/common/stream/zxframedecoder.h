@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXFRAMEDECODER_H
+#define ZXRASPBERRY_ZXFRAMEDECODER_H
+
+#include <cstdint>
+
+
+/*
+ * Decodes the delta encoded frame stream written by ZxFrameEncoder, see zxframestream.h.
+ *
+ * decode() is given the bytes received so far, starting at the first byte not yet consumed, and decodes at most the
+ * stream header or one frame record from them.  It returns the number of bytes consumed, 0 if more data is needed or
+ * -1 if the stream is invalid.  Delta frames received before the first key frame, e.g. when joining a stream from a
+ * serial link, are consumed and discarded.
+ */
+class ZxFrameDecoder {
+
+public:
+    ZxFrameDecoder();
+    ~ZxFrameDecoder();
+
+    ZxFrameDecoder(const ZxFrameDecoder &) = delete;
+    ZxFrameDecoder &operator=(const ZxFrameDecoder &) = delete;
+
+    int32_t decode(const uint8_t *pData, uint32_t size);
+
+    // True if the last call to decode() completed a frame.
+    [[nodiscard]] bool frameReady() const {
+        return m_bFrameReady;
+    }
+
+    [[nodiscard]] const uint8_t *frame() const {
+        return reinterpret_cast<const uint8_t *>(m_pFrame);
+    }
+
+    [[nodiscard]] uint32_t frameNumber() const {
+        return m_frameNumber;
+    }
+
+    [[nodiscard]] uint32_t width() const {
+        return m_width;
+    }
+
+    [[nodiscard]] uint32_t height() const {
+        return m_height;
+    }
+
+    [[nodiscard]] uint32_t depth() const {
+        return m_depth;
+    }
+
+    // Frame size in bytes
+    [[nodiscard]] uint32_t frameSize() const {
+        return m_words * 4;
+    }
+
+private:
+    int32_t decodeHeader(const uint8_t *pData, uint32_t size);
+    bool decodePayload(const uint8_t *pData, uint32_t size);
+
+    uint32_t *m_pFrame;
+    uint32_t m_words;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_depth;
+    uint32_t m_frameNumber;
+    bool m_bHeaderDecoded;
+    bool m_bSynchronised;                // A key frame has been decoded
+    bool m_bFrameReady;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXFRAMEDECODER_H
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include "zxframeencoder.h"
+#include "zxframestream.h"
+
+using namespace ZxFrameStream;
+
+// Runs of identical words at least this long are encoded as REPEAT rather than COPY.
+static const uint32_t MIN_REPEAT = 4;
+// A changed region ends at this many unchanged words, since a SKIP is cheaper than copying them from then on.
+static const uint32_t MIN_SKIP = 2;
+
+
+ZxFrameEncoder::ZxFrameEncoder(uint32_t width, uint32_t height, uint32_t depth, ZxFrameSink *pSink,
+                               uint32_t keyFrameInterval) :
+        m_pSink(pSink),
+        m_width(width),
+        m_height(height),
+        m_depth(depth),
+        m_keyFrameInterval(keyFrameInterval),
+        m_words(width * height * depth / 32),
+        m_pPrevious(new uint32_t[width * height * depth / 32]),
+        m_pRecord(new uint8_t[RECORD_HEADER_SIZE + maxPayloadSize(width * height * depth / 32)]),
+        m_frameNumber(0),
+        m_bytesWritten(0),
+        m_bHeaderWritten(false),
+        m_bKeyFrameRequested(true) {
+}
+
+ZxFrameEncoder::~ZxFrameEncoder() {
+    delete[] m_pRecord;
+    delete[] m_pPrevious;
+}
+
+void ZxFrameEncoder::frameCompleted(const uint8_t *pFrame, uint32_t depth) {
+
+    if (depth != m_depth || m_pSink == nullptr) {
+        return;
+    }
+
+    if (!m_bHeaderWritten) {
+        uint8_t header[HEADER_SIZE];
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        header[4] = VERSION;
+        putU16(&header[5], m_width);
+        putU16(&header[7], m_height);
+        header[9] = static_cast<uint8_t>(m_depth);
+        if (!m_pSink->write(header, HEADER_SIZE)) {
+            return;
+        }
+        m_bytesWritten += HEADER_SIZE;
+        m_bHeaderWritten = true;
+    }
+
+    bool keyFrame = m_bKeyFrameRequested || (m_keyFrameInterval != 0 && m_frameNumber % m_keyFrameInterval == 0);
+    uint32_t size = encode(pFrame, keyFrame);
+    if (m_pSink->write(m_pRecord, size)) {
+        m_bytesWritten += size;
+    } else {
+        // The decoder has lost track of the frame, so start over from a key frame
+        m_bKeyFrameRequested = true;
+    }
+}
+
+uint8_t *ZxFrameEncoder::encodeLiteral(uint8_t *pOut, const uint32_t *pWords, uint32_t count) {
+    if (count > 0) {
+        pOut = putVarint(pOut, (count << 2) | OP_COPY);
+        for (uint32_t i = 0; i < count; i++) {
+            pOut = putU32(pOut, pWords[i]);
+        }
+    }
+    return pOut;
+}
+
+uint32_t ZxFrameEncoder::encode(const uint8_t *pFrame, bool keyFrame) {
+
+    auto *pCurrent = reinterpret_cast<const uint32_t *>(pFrame);
+    uint32_t *pPrevious = m_pPrevious;
+    const uint32_t words = m_words;
+
+    if (keyFrame) {
+        std::memset(pPrevious, 0, words * 4);
+        m_bKeyFrameRequested = false;
+    }
+
+    uint8_t *pOut = m_pRecord + RECORD_HEADER_SIZE;
+    uint32_t covered = 0;   // First word not yet covered by an operation
+    uint32_t word = 0;
+    while (true) {
+        while (word < words && pCurrent[word] == pPrevious[word]) {
+            word++;
+        }
+        if (word == words) {
+            break;
+        }
+
+        // Find the end of the changed region, allowing for short gaps of unchanged words
+        uint32_t end = word + 1;
+        uint32_t unchanged = 0;
+        while (end < words && unchanged < MIN_SKIP) {
+            unchanged = (pCurrent[end] == pPrevious[end]) ? unchanged + 1 : 0;
+            end++;
+        }
+        end -= unchanged;
+
+        if (word > covered) {
+            pOut = putVarint(pOut, ((word - covered) << 2) | OP_SKIP);
+        }
+        std::memcpy(&pPrevious[word], &pCurrent[word], (end - word) * 4);
+
+        uint32_t literal = word;
+        for (uint32_t run; word < end; word += run) {
+            uint32_t value = pCurrent[word];
+            for (run = 1; word + run < end && pCurrent[word + run] == value; run++);
+            if (run >= MIN_REPEAT) {
+                pOut = encodeLiteral(pOut, &pCurrent[literal], word - literal);
+                pOut = putVarint(pOut, (run << 2) | OP_REPEAT);
+                pOut = putU32(pOut, value);
+                literal = word + run;
+            }
+        }
+        pOut = encodeLiteral(pOut, &pCurrent[literal], end - literal);
+        covered = end;
+    }
+
+    uint32_t size = static_cast<uint32_t>(pOut - m_pRecord);
+    m_pRecord[0] = keyFrame ? KEY_FRAME : DELTA_FRAME;
+    putU32(&m_pRecord[1], m_frameNumber++);
+    putU32(&m_pRecord[5], size - RECORD_HEADER_SIZE);
+    return size;
+}
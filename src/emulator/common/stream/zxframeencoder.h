@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXFRAMEENCODER_H
+#define ZXRASPBERRY_ZXFRAMEENCODER_H
+
+#include <cstdint>
+#include "../zxframelistener.h"
+
+
+/*
+ * Destination of an encoded frame stream, e.g. a file, a pipe or a serial link.  Returns false if the data could not
+ * be written.
+ */
+class ZxFrameSink {
+
+public:
+    virtual ~ZxFrameSink() = default;
+
+    virtual bool write(const uint8_t *pData, uint32_t size) = 0;
+
+};
+
+
+/*
+ * Encodes every completed frame as a record of the delta encoded frame stream described in zxframestream.h and writes
+ * it to the sink, preceded by the stream header on the first frame.
+ *
+ * Each frame is compared with the previous one 32 bits at a time in a single pass, which also brings the copy of the
+ * previous frame up to date, so a static screen costs one read of both frames and produces a 9 byte record.  A key
+ * frame is written first, every keyFrameInterval frames if it is not 0, and after the sink fails to write a record, so
+ * that a decoder can join the stream or recover from lost data.
+ */
+class ZxFrameEncoder : public ZxFrameListener {
+
+public:
+    ZxFrameEncoder(uint32_t width, uint32_t height, uint32_t depth, ZxFrameSink *pSink, uint32_t keyFrameInterval = 0);
+    ~ZxFrameEncoder() override;
+
+    ZxFrameEncoder(const ZxFrameEncoder &) = delete;
+    ZxFrameEncoder &operator=(const ZxFrameEncoder &) = delete;
+
+    void frameCompleted(const uint8_t *pFrame, uint32_t depth) override;
+
+    // Encodes the frame into the record buffer and returns the size of the record.
+    uint32_t encode(const uint8_t *pFrame, bool keyFrame);
+
+    void requestKeyFrame() {
+        m_bKeyFrameRequested = true;
+    }
+
+    [[nodiscard]] const uint8_t *record() const {
+        return m_pRecord;
+    }
+
+    [[nodiscard]] uint32_t frameNumber() const {
+        return m_frameNumber;
+    }
+
+    [[nodiscard]] uint64_t bytesWritten() const {
+        return m_bytesWritten;
+    }
+
+private:
+    uint8_t *encodeLiteral(uint8_t *pOut, const uint32_t *pWords, uint32_t count);
+
+    ZxFrameSink *m_pSink;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_depth;
+    uint32_t m_keyFrameInterval;
+    uint32_t m_words;                    // Frame size in 32-bit words
+    uint32_t *m_pPrevious;               // Previous frame, as seen by the decoder
+    uint8_t *m_pRecord;                  // Record of the last encoded frame
+    uint32_t m_frameNumber;
+    uint64_t m_bytesWritten;
+    bool m_bHeaderWritten;
+    bool m_bKeyFrameRequested;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXFRAMEENCODER_H
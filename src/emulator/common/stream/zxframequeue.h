@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXFRAMEQUEUE_H
+#define ZXRASPBERRY_ZXFRAMEQUEUE_H
+
+#include <cstdint>
+#include "../zxspscring.h"
+
+
+/*
+ * Bounded lock-free queue of frames between a single producer (the emulation loop) and a single consumer (e.g. a
+ * writer thread).  All frame buffers are allocated up front, so neither side ever allocates memory or waits for the
+ * other: the producer fills the slot returned by acquire() and hands it over with publish(), or drops the frame if
+ * acquire() returns nullptr because the queue is full.  The consumer reads the slot returned by front() and gives it
+ * back with release().  The capacity is rounded up to a power of two.
+ */
+class ZxFrameQueue {
+
+public:
+    struct Slot {
+        uint8_t *pFrame;
+        uint32_t frameNumber;
+        uint64_t timestamp;              // Microseconds
+    };
+
+    ZxFrameQueue(uint32_t frameSize, uint32_t capacity) :
+            m_ring(capacity),
+            m_pFrames(new uint8_t[static_cast<size_t>(frameSize) * m_ring.capacity()]) {
+        for (uint32_t i = 0; i < m_ring.capacity(); i++) {
+            m_ring.slot(i) = { &m_pFrames[static_cast<size_t>(frameSize) * i], 0, 0 };
+        }
+    }
+
+    ~ZxFrameQueue() {
+        delete[] m_pFrames;
+    }
+
+    ZxFrameQueue(const ZxFrameQueue &) = delete;
+    ZxFrameQueue &operator=(const ZxFrameQueue &) = delete;
+
+    // Producer side
+    Slot *acquire() {
+        return m_ring.back();
+    }
+
+    void publish() {
+        m_ring.push();
+    }
+
+    // Consumer side
+    Slot *front() {
+        return m_ring.front();
+    }
+
+    void release() {
+        m_ring.pop();
+    }
+
+    [[nodiscard]] uint32_t capacity() const {
+        return m_ring.capacity();
+    }
+
+private:
+    ZxSpscRing<Slot> m_ring;
+    uint8_t *m_pFrames;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXFRAMEQUEUE_H
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXFRAMESTREAM_H
+#define ZXRASPBERRY_ZXFRAMESTREAM_H
+
+#include <cstdint>
+
+
+/*
+ * Delta encoded frame stream format.  All multi-byte values are little endian.
+ *
+ * The stream starts with a 10 byte header:
+ *
+ *      "ZXFS" | version (u8) | width (u16) | height (u16) | colour depth (u8)
+ *
+ * followed by one record per frame:
+ *
+ *      type (u8) | frame number (u32) | payload size (u32) | payload
+ *
+ * The frame is handled as an array of 32-bit words.  A key frame is encoded against an all zero frame and a delta frame
+ * against the previous frame in the stream.  The payload is a sequence of operations, each one starting with a varint
+ * (7 bits per byte, least significant group first, top bit set on all but the last byte) holding (count << 2) | op:
+ *
+ *      SKIP:    count words are unchanged
+ *      COPY:    count words follow, 4 bytes each
+ *      REPEAT:  one word follows, 4 bytes, which is repeated count times
+ *
+ * Any words not covered by the operations are unchanged, so a frame identical to the previous one has an empty payload.
+ */
+namespace ZxFrameStream {
+
+    static const uint8_t MAGIC[4] = { 'Z', 'X', 'F', 'S' };
+    static const uint8_t VERSION = 1;
+    static const uint32_t HEADER_SIZE = 10;
+    static const uint32_t RECORD_HEADER_SIZE = 9;
+
+    static const uint8_t KEY_FRAME = 'K';
+    static const uint8_t DELTA_FRAME = 'D';
+
+    static const uint32_t OP_SKIP = 0;
+    static const uint32_t OP_COPY = 1;
+    static const uint32_t OP_REPEAT = 2;
+
+    // Worst case payload size for a frame of the given number of words, i.e. a single word COPY for every word.
+    inline uint32_t maxPayloadSize(uint32_t words) {
+        return words * 5 + 16;
+    }
+
+    inline uint8_t *putU16(uint8_t *p, uint32_t value) {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+        return p + 2;
+    }
+
+    inline uint8_t *putU32(uint8_t *p, uint32_t value) {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+        p[2] = static_cast<uint8_t>(value >> 16);
+        p[3] = static_cast<uint8_t>(value >> 24);
+        return p + 4;
+    }
+
+    inline uint32_t getU16(const uint8_t *p) {
+        return p[0] | (static_cast<uint32_t>(p[1]) << 8);
+    }
+
+    inline uint32_t getU32(const uint8_t *p) {
+        return p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+               (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    inline uint8_t *putVarint(uint8_t *p, uint32_t value) {
+        while (value >= 0x80u) {
+            *p++ = static_cast<uint8_t>(value | 0x80u);
+            value >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(value);
+        return p;
+    }
+
+}
+
+
+#endif //ZXRASPBERRY_ZXFRAMESTREAM_H
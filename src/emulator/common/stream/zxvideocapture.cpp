@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <cstring>
+#include <string>
+#include "zxvideocapture.h"
+#include "../zxdisplayrenderer.h"
+
+// How long the writer thread sleeps when the queue is empty, well under the 20 ms between frames
+static const std::chrono::milliseconds IDLE_WAIT(2);
+
+static uint64_t microseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * BT.601 RGB to YUV conversion with "studio swing" values, i.e. Y from 16 to 235 and U, V from 16 to 240, which is
+ * what players assume for Y4M files.
+ */
+static uint8_t lumaOf(uint32_t r, uint32_t g, uint32_t b) {
+    return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+static uint8_t blueChromaOf(int32_t r, int32_t g, int32_t b) {
+    return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+static uint8_t redChromaOf(int32_t r, int32_t g, int32_t b) {
+    return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+
+ZxVideoCapture::ZxVideoCapture(uint32_t width, uint32_t height, uint32_t depth, uint32_t queueSize) :
+        m_width(width),
+        m_height(height),
+        m_depth(depth),
+        // Spectrum 48K frame rate: 3500000 / 69888 = 50.08 Hz
+        m_frameRateNumerator(3500000),
+        m_frameRateDenominator(69888),
+        m_queue(width * height * depth / 8, queueSize),
+        m_format(Format::Y4M),
+        m_pFile(nullptr),
+        m_pTimestampFile(nullptr),
+        m_bRunning(false),
+        m_startTime(0),
+        m_framesCaptured(0),
+        m_framesDropped(0),
+        m_framesWritten(0),
+        m_bWriteFailed(false),
+        m_pRGB(new uint8_t[width * height * 3]),
+        m_pYUV(new uint8_t[width * height * 3 / 2]),
+        m_lastFrameNumber(0) {
+}
+
+ZxVideoCapture::~ZxVideoCapture() {
+    stop();
+    delete[] m_pYUV;
+    delete[] m_pRGB;
+}
+
+bool ZxVideoCapture::start(const char *pFileName, Format format) {
+
+    if (m_writer.joinable() || (m_width % 2) != 0 || (m_height % 2) != 0) {
+        return false;
+    }
+
+    m_pFile = std::fopen(pFileName, "wb");
+    if (m_pFile == nullptr) {
+        return false;
+    }
+    if (format == Format::Raw) {
+        m_pTimestampFile = std::fopen((std::string(pFileName) + ".timestamps").c_str(), "w");
+        if (m_pTimestampFile == nullptr) {
+            std::fclose(m_pFile);
+            m_pFile = nullptr;
+            return false;
+        }
+    } else {
+        std::fprintf(m_pFile, "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 C420jpeg\n",
+                     m_width, m_height, m_frameRateNumerator, m_frameRateDenominator);
+    }
+
+    m_format = format;
+    m_startTime = microseconds();
+    m_framesCaptured = 0;
+    m_framesDropped = 0;
+    m_framesWritten = 0;
+    m_bWriteFailed = false;
+    m_bRunning = true;
+    m_writer = std::thread(&ZxVideoCapture::run, this);
+    return true;
+}
+
+void ZxVideoCapture::stop() {
+
+    if (!m_writer.joinable()) {
+        return;
+    }
+
+    m_bRunning = false;
+    m_writer.join();
+
+    if (std::fclose(m_pFile) != 0) {
+        m_bWriteFailed = true;
+    }
+    m_pFile = nullptr;
+    if (m_pTimestampFile != nullptr) {
+        if (std::fclose(m_pTimestampFile) != 0) {
+            m_bWriteFailed = true;
+        }
+        m_pTimestampFile = nullptr;
+    }
+}
+
+/*
+ * Called by the emulation loop: never blocks, at worst the frame is counted as dropped.
+ */
+void ZxVideoCapture::frameCompleted(const uint8_t *pFrame, uint32_t depth) {
+
+    if (!m_bRunning.load(std::memory_order_relaxed) || depth != m_depth) {
+        return;
+    }
+
+    uint32_t frameNumber = m_framesCaptured++;
+    ZxFrameQueue::Slot *pSlot = m_queue.acquire();
+    if (pSlot == nullptr) {
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::memcpy(pSlot->pFrame, pFrame, m_width * m_height * m_depth / 8);
+    pSlot->frameNumber = frameNumber;
+    pSlot->timestamp = microseconds() - m_startTime;
+    m_queue.publish();
+}
+
+void ZxVideoCapture::run() {
+
+    bool firstFrame = true;
+    while (true) {
+        ZxFrameQueue::Slot *pSlot = m_queue.front();
+        if (pSlot != nullptr) {
+            if (m_bWriteFailed.load(std::memory_order_relaxed)) {
+                m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+            } else if (!writeFrame(*pSlot, firstFrame)) {
+                m_bWriteFailed = true;
+                m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            firstFrame = false;
+            m_queue.release();
+        } else if (m_bRunning.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(IDLE_WAIT);
+        } else if (m_queue.front() == nullptr) {
+            // The producer has stopped and the queue is still empty, so the last frame it published has been written
+            break;
+        }
+    }
+}
+
+bool ZxVideoCapture::writeFrame(const ZxFrameQueue::Slot &slot, bool firstFrame) {
+
+    toRGB(slot.pFrame);
+
+    if (m_format == Format::Raw) {
+        if (std::fwrite(m_pRGB, 1, m_width * m_height * 3, m_pFile) != m_width * m_height * 3 ||
+            std::fprintf(m_pTimestampFile, "%u %llu\n", slot.frameNumber,
+                         static_cast<unsigned long long>(slot.timestamp)) < 0) {
+            return false;
+        }
+    } else {
+        toYUV420();
+        // Fill the gap left by any dropped frames so that the video keeps time
+        uint32_t copies = firstFrame ? 1 : slot.frameNumber - m_lastFrameNumber;
+        const uint32_t size = m_width * m_height * 3 / 2;
+        for (uint32_t copy = 0; copy < copies; copy++) {
+            if (std::fputs("FRAME\n", m_pFile) < 0 || std::fwrite(m_pYUV, 1, size, m_pFile) != size) {
+                return false;
+            }
+        }
+    }
+
+    m_lastFrameNumber = slot.frameNumber;
+    m_framesWritten.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ZxVideoCapture::toRGB(const uint8_t *pFrame) {
+
+    static constexpr struct Palette {
+        uint32_t colour[16];
+
+        constexpr Palette() : colour() {
+            for (uint32_t i = 0; i < 16; i++) {
+                colour[i] = zxRGB565ToXRGB8888(zxPaletteRGB565[i]);
+            }
+        }
+    } palette{};
+
+    const uint32_t pixels = m_width * m_height;
+    uint8_t *pRGB = m_pRGB;
+    auto put = [&pRGB](uint32_t xrgb) {
+        *pRGB++ = static_cast<uint8_t>(xrgb >> 16);
+        *pRGB++ = static_cast<uint8_t>(xrgb >> 8);
+        *pRGB++ = static_cast<uint8_t>(xrgb);
+    };
+
+    switch (m_depth) {
+        case 4:
+            for (uint32_t i = 0; i < pixels / 2; i++) {
+                put(palette.colour[pFrame[i] >> 4]);
+                put(palette.colour[pFrame[i] & 0x0Fu]);
+            }
+            break;
+        case 8:
+            for (uint32_t i = 0; i < pixels; i++) {
+                put(palette.colour[pFrame[i] & 0x0Fu]);
+            }
+            break;
+        case 16:
+            for (uint32_t i = 0; i < pixels; i++) {
+                put(zxRGB565ToXRGB8888(reinterpret_cast<const uint16_t *>(pFrame)[i]));
+            }
+            break;
+        default:
+            for (uint32_t i = 0; i < pixels; i++) {
+                put(reinterpret_cast<const uint32_t *>(pFrame)[i]);
+            }
+            break;
+    }
+}
+
+/*
+ * Converts the RGB24 frame into Y, U and V planes, with one U and V value for each block of 2 x 2 pixels.
+ */
+void ZxVideoCapture::toYUV420() {
+
+    uint8_t *pY = m_pYUV;
+    uint8_t *pU = pY + m_width * m_height;
+    uint8_t *pV = pU + (m_width / 2) * (m_height / 2);
+    const uint32_t stride = m_width * 3;
+
+    for (uint32_t y = 0; y < m_height; y += 2) {
+        const uint8_t *pTop = &m_pRGB[y * stride];
+        const uint8_t *pBottom = pTop + stride;
+        for (uint32_t x = 0; x < m_width; x += 2) {
+            const uint8_t *pPixels[4] = { &pTop[x * 3], &pTop[x * 3 + 3], &pBottom[x * 3], &pBottom[x * 3 + 3] };
+            int32_t r = 0;
+            int32_t g = 0;
+            int32_t b = 0;
+            for (uint32_t i = 0; i < 4; i++) {
+                pY[(y + i / 2) * m_width + x + i % 2] = lumaOf(pPixels[i][0], pPixels[i][1], pPixels[i][2]);
+                r += pPixels[i][0];
+                g += pPixels[i][1];
+                b += pPixels[i][2];
+            }
+            *pU++ = blueChromaOf(r / 4, g / 4, b / 4);
+            *pV++ = redChromaOf(r / 4, g / 4, b / 4);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXVIDEOCAPTURE_H
+#define ZXRASPBERRY_ZXVIDEOCAPTURE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include "../zxframelistener.h"
+#include "zxframequeue.h"
+
+
+/*
+ * Records completed frames to a file without slowing down emulation.  The emulation loop only copies each frame into
+ * a ZxFrameQueue slot, or drops it if the queue is full because the disk cannot keep up, while a writer thread converts
+ * the queued frames and writes them out.  Only the C++ standard library is used, so this works in headless builds, but
+ * it needs threads and a file system and is therefore not part of the bare metal build.
+ *
+ * The following file formats are supported:
+ *
+ *  Y4M: YUV4MPEG2 video, 4:2:0 BT.601, at the frame rate of the Spectrum (3.5 MHz / 69888 T-states = 50.08 Hz by
+ *       default).  The gap left by dropped frames is filled by repeating the frame that follows it, so that the video
+ *       keeps time.
+ *  Raw: RGB24 frames with no header, e.g. for ffmpeg -f rawvideo -pixel_format rgb24 -video_size 352x296, plus a
+ *       <file>.timestamps text file with the frame number and capture time in microseconds of every frame written.
+ */
+class ZxVideoCapture : public ZxFrameListener {
+
+public:
+    enum class Format {
+        Y4M,
+        Raw
+    };
+
+    static const uint32_t DEFAULT_QUEUE_SIZE = 16;
+
+    ZxVideoCapture(uint32_t width, uint32_t height, uint32_t depth, uint32_t queueSize = DEFAULT_QUEUE_SIZE);
+    ~ZxVideoCapture() override;
+
+    ZxVideoCapture(const ZxVideoCapture &) = delete;
+    ZxVideoCapture &operator=(const ZxVideoCapture &) = delete;
+
+    void setFrameRate(uint32_t numerator, uint32_t denominator) {
+        m_frameRateNumerator = numerator;
+        m_frameRateDenominator = denominator;
+    }
+
+    bool start(const char *pFileName, Format format);
+    // Writes out any queued frames and closes the file(s)
+    void stop();
+
+    void frameCompleted(const uint8_t *pFrame, uint32_t depth) override;
+
+    // Frames given to the capture, dropped because the queue was full and written to the file
+    [[nodiscard]] uint32_t framesCaptured() const {
+        return m_framesCaptured;
+    }
+
+    [[nodiscard]] uint32_t framesDropped() const {
+        return m_framesDropped.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint32_t framesWritten() const {
+        return m_framesWritten.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool writeFailed() const {
+        return m_bWriteFailed.load(std::memory_order_relaxed);
+    }
+
+private:
+    void run();
+    void toRGB(const uint8_t *pFrame);
+    void toYUV420();
+    bool writeFrame(const ZxFrameQueue::Slot &slot, bool firstFrame);
+
+    const uint32_t m_width;
+    const uint32_t m_height;
+    const uint32_t m_depth;
+    uint32_t m_frameRateNumerator;
+    uint32_t m_frameRateDenominator;
+    ZxFrameQueue m_queue;
+    Format m_format;
+    std::FILE *m_pFile;
+    std::FILE *m_pTimestampFile;
+    std::thread m_writer;
+    std::atomic<bool> m_bRunning;
+    uint64_t m_startTime;
+
+    uint32_t m_framesCaptured;
+    std::atomic<uint32_t> m_framesDropped;
+    std::atomic<uint32_t> m_framesWritten;
+    std::atomic<bool> m_bWriteFailed;
+
+    // Writer thread buffers: the frame as RGB24 and, for Y4M, as Y, U and V planes
+    uint8_t *m_pRGB;
+    uint8_t *m_pYUV;
+    uint32_t m_lastFrameNumber;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXVIDEOCAPTURE_H
@@ -16,6 +16,7 @@
  * You should have received a copy of the GNU General Public License
  * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
@@ -25,19 +26,40 @@
 #include "zxdisplay.h"
 #include "gui/zxview.h"
 #include "clock.h"
+#include "hardware/zxhardwaremodel48k.h"
+
+
+// Hardware model used to build the timing tables when the caller does not select one
+static ZxHardwareModel48k model48K;
+
+static uint8_t flashMask[] = {0x7Fu, 0xFFu};
 
 
 ZxDisplay::ZxDisplay()
         : m_pZxView(nullptr),
+          m_pFrameListener(nullptr),
           m_pFrameBuffer(nullptr),
+          m_lookupStrategy(DEFAULT_LOOKUP_STRATEGY),
+          m_pRenderer(nullptr),
           m_pVideoMem(nullptr),
           m_border(0x07u),
-          m_bDoubleBufferingEnabled(false),
-          m_bVSync(false),
-          m_bBufferSwapped(false),
-          m_pBaseBuffer(nullptr),
-          m_pBuffer(nullptr),
-          m_lastBorderChange(0) {
+          m_renderMode(RenderMode::Frame),
+          m_flashMask(flashMask[0]),
+          m_pFrames{nullptr, nullptr, nullptr},
+          m_bTripleBuffered(false),
+          m_pTargetBuffer8(nullptr),
+          m_pStates2Border(nullptr),
+          m_states2BorderSize(0),
+          m_pBorderLog(new BorderChange[BORDER_LOG_SIZE]),
+          m_borderLogSize(0),
+          m_borderCell(0),
+          m_drawnBorder(0x07u),
+          m_frameBorder(0x07u),
+          m_bFrameSkipped(false),
+          m_bDrawBorder(true),
+          m_pStepStates(nullptr),
+          m_step(0),
+          m_nextScreenFetch(NO_EVENT) {
 }
 
 
@@ -45,13 +67,17 @@ ZxDisplay::~ZxDisplay() {
     // Delete the video frame buffer
     delete m_pFrameBuffer;
 
-    // Delete the colour / screen lookup table
-    delete[] m_pScrTable;
+    // Delete the output stage and its lookup tables
+    delete m_pRenderer;
+
+    // Delete the scanline rendering and border timeline tables
+    delete[] m_pStepStates;
+    delete[] m_pStates2Border;
+    delete[] m_pBorderLog;
 
     m_pVideoMem = nullptr;
     m_pFrameBuffer = nullptr;
-    m_pBaseBuffer = nullptr;
-    m_pBuffer = nullptr;
+    m_pTargetBuffer8 = nullptr;
 }
 
 
@@ -63,170 +89,197 @@ bool ZxDisplay::Initialize(uint8_t *pVideoMem, CBcmFrameBuffer *pFrameBuffer) {
     m_pFrameBuffer = pFrameBuffer;
     assert(m_pFrameBuffer != nullptr);
 
-    /* Set up the colour palette definition in RGB565 format.
+    /* Set up the colour palette definition in RGB565 format for the indexed colour depths.
      * Needs to be defined BEFORE the call to initialise the framebuffer.
      */
-    for (uint32_t i = 0; i < (sizeof(m_palette)/sizeof(uint16_t)); i++) {
-        CLogger::Get()->Write("[Display]", LogDebug,"Setting palette index %02d to '%s' (RGB565: 0x%04X)",
-                              i, m_paletteColourName[i], m_palette[i]);
-        m_pFrameBuffer->SetPalette(i, m_palette[i]);
+    if (m_pFrameBuffer->GetDepth() <= 8) {
+        for (uint32_t i = 0; i < (sizeof(zxPaletteRGB565) / sizeof(uint16_t)); i++) {
+            m_pFrameBuffer->SetPalette(i, zxPaletteRGB565[i]);
+        }
     }
 
     if (!m_pFrameBuffer->Initialize()) {
         return false;
     }
 
-    m_pBaseBuffer = m_pTargetBuffer8 = reinterpret_cast<uint8_t *>(m_pFrameBuffer->GetBuffer());
-    m_pBuffer = m_pBaseBuffer + DISPLAY_WIDTH * (DISPLAY_HEIGHT / 2);
-    m_pTargetBuffer32 = reinterpret_cast<uint32_t *>(m_pTargetBuffer8);
-
-    // Initialise the screen
-    std::memset(m_pBaseBuffer, static_cast<int>((m_border << 0x04u) | m_border), m_pFrameBuffer->GetSize());
-
-    /*
-     * Create a pixel value lookup table to draw the screen as fast we possibly can. This section was adapted from
-     * sample code by José Luis Sanchez of ZXBaremulator (https://zxmini.speccy.org/en/index.html) fame.
-     *
-     * The attribute byte format is as follows:
-     *
-     *  | F | B | P2 | P1 | P0 | I2 | I1 | I0 |
-     *
-     * F sets the attribute FLASH mode where flashing is done by swapping the ink and paper colours
-     * B sets the attribute BRIGHTNESS mode
-     * P2 to P0 is the PAPER colour
-     * I2 to I0 is the INK colour
-     *
-     * The lookup table maps an attribute byte and a character (8 pixel) mask byte into a 32-bit value where each
-     * nibble represents a 4-bit depth pixel colour on screen. If the colour depth was to change, we would need to
-     * amend the way we create this lookup table.
-     *
-     * To look up a cached value, we need to perform the following operation:
-     *
-     *      uint8_t colour = attribute & (flash) ? 0xFFu : 0x7Fu;
-     *      uint32_t pixels = *m_pScrTable[colour][character];
-     */
-    m_pScrTable = reinterpret_cast<uint32_t (*)[256][256]>(new uint32_t[256 * 256]);
+    createRenderer();
+    if (m_pRenderer == nullptr) {
+        CLogger::Get()->Write("[Display]", LogError, "Unsupported colour depth: %u", m_pFrameBuffer->GetDepth());
+        return false;
+    }
+    ZxView::setColourDepth(m_pRenderer->depth());
+
+    // Split the framebuffer into 3 frames if it is large enough, one above the other
+    const uint32_t frameSize = DISPLAY_CELLS * m_pRenderer->depth();
+    auto *pBuffer = reinterpret_cast<uint8_t *>(m_pFrameBuffer->GetBuffer());
+    m_bTripleBuffered = m_pFrameBuffer->GetSize() >= frameSize * ZxTripleBuffer::BUFFERS;
+    for (uint32_t i = 0; i < ZxTripleBuffer::BUFFERS; i++) {
+        m_pFrames[i] = m_bTripleBuffered ? pBuffer + frameSize * i : pBuffer;
+        // Initialise the screen
+        m_pRenderer->fillCells(m_pFrames[i], 0, DISPLAY_CELLS, static_cast<uint8_t>(m_border));
+    }
+    m_pTargetBuffer8 = m_pFrames[m_frames.back()];
+    if (m_bTripleBuffered) {
+        m_pFrameBuffer->SetVirtualOffset(0, m_frames.front() * DISPLAY_HEIGHT);
+    }
 
-    /* Iterate over all the possible attribute values...
-     *
-     * We compute all the normal attributes (cache table position 0..127) followed by the flashed attributes
-     * (cache table position 128..255).
-     */
-    for (uint32_t attr = 0; attr < 256; attr++) {
+    if (m_pStepStates == nullptr) {
+        setHardwareModel(&model48K);
+    }
 
-        /* The ink and paper values are unpacked like this:
-         *
-         *  ink:   | F | B | P2 | P1 | P0 | I2 | I1 | I0 |  -->  | 0 | 0 | 0 | 0 | B | I2 | I1 | I0 |
-         *  paper: | F | B | P2 | P1 | P0 | I2 | I1 | I0 |  -->  | 0 | 0 | 0 | 0 | B | P2 | P1 | P0 |
-         */
-        uint32_t ink = (attr & 0b01000000) >> 3 | (attr & 0b00000111);
-        uint32_t paper = (attr & 0b01111000) >> 3;
-        uint32_t flash = attr >> 7;
-
-        // Each 8-bit character mask can take on 256 possible values from 0 to 255.
-        for (uint32_t character = 0; character < 256; character++) {
-            /* Iterate over each of the 8 pixels in the character, shifting the target value by one nibble to the
-             * left in each iteration. Then apply the ink or paper value to the rightmost nibble depending on
-             * whether the character pixel is on or off.
-             */
-            for (uint32_t mask = 0b10000000; mask > 0; mask >>= 1) {
-                *m_pScrTable[attr][character] <<= 4;
-                *m_pScrTable[attr][character] |= flash ? ((character & mask) ? paper : ink) : ((character & mask) ? ink : paper);
-            }
-            // Swap the 32 bit cached value depending on whether the machine is big or little endian.
-            *m_pScrTable[attr][character] = bswap32(*m_pScrTable[attr][character]);
+    return true;
+}
+
+
+/*
+ * Builds the scanline rendering tables for the given hardware model.  The ULA fetches the bitmap and attribute bytes
+ * for each group of 8 pixels 4 T-states apart, starting at the first screen byte and moving one screen line (e.g. 224
+ * T-states on a 48K machine) down for every pixel line.
+ */
+void ZxDisplay::setHardwareModel(ZxHardwareModel *pModel) {
+
+    assert(pModel != nullptr);
+
+    if (m_pStepStates == nullptr) {
+        m_pStepStates = new uint32_t[SCREEN_HEIGHT * (SCREEN_WIDTH / 8)];
+    }
+
+    uint32_t step = 0;
+    for (uint32_t line = 0; line < SCREEN_HEIGHT; line++) {
+        uint32_t tstates = pModel->tStatesToFirstScreenByte() + line * pModel->tStatesPerScreenLine();
+        for (uint32_t column = 0; column < (SCREEN_WIDTH / 8); column++) {
+            m_pStepStates[step++] = tstates + column * 4;
         }
     }
 
-    /* Pre-compute the border fill value used to set 8 pixels (e.g. 4 bytes when working in 4-bit depth) at a time.
-     * This is effectively 4 bytes where all 8 nibbles (4 bits) are identical.
-     * Border colours do not use brightness.
+    m_step = 0;
+    m_nextScreenFetch = (m_renderMode == RenderMode::Scanline) ? m_pStepStates[0] : NO_EVENT;
+
+    /* Map every 4 T-state slot in the frame to the first display cell drawn at or after it.  The top left display
+     * cell is drawn TOP_BORDER lines and LEFT_BORDER / 2 T-states ahead of the first screen byte, and each line draws
+     * 44 cells in 176 T-states before the horizontal retrace.
      */
-    for (uint8_t border = 0; border < 8; border++) {
-        for (uint8_t nibble = 0; nibble < 8; nibble++) {
-            m_borderColour[border] = (m_borderColour[border] << 4) | border;
+    const uint32_t tstatesPerLine = pModel->tStatesPerScreenLine();
+    const uint32_t firstCell = pModel->tStatesToFirstScreenByte() - TOP_BORDER * tstatesPerLine - LEFT_BORDER / 2;
+
+    delete[] m_pStates2Border;
+    m_states2BorderSize = pModel->tStatesPerScreenFrame() / 4 + 1;
+    m_pStates2Border = new uint16_t[m_states2BorderSize];
+
+    for (uint32_t slot = 0; slot < m_states2BorderSize; slot++) {
+        uint32_t tstates = slot * 4;
+        uint32_t cell = 0;
+        if (tstates > firstCell) {
+            uint32_t line = (tstates - firstCell) / tstatesPerLine;
+            uint32_t column = (((tstates - firstCell) % tstatesPerLine) + 3) / 4;
+            if (column >= DISPLAY_WIDTH / 8) {
+                line++;
+                column = 0;
+            }
+            cell = (line < DISPLAY_HEIGHT) ? line * (DISPLAY_WIDTH / 8) + column : DISPLAY_CELLS;
         }
+        m_pStates2Border[slot] = static_cast<uint16_t>(cell);
     }
 
-    //m_firstBorderUpdate = ((64 - screenGeometry.border().top()) * spectrumModel.tstatesLine) - screenGeometry.border().left() / 2;
-    m_firstBorderUpdate = ((64 - TOP_BORDER) * 224) - (LEFT_BORDER / 2);
-    //m_lastBorderUpdate = (255 + BOTTOM_BORDER) * Clock::getInstance().getTstatesPerScreenLine() + 128 + RIGHT_BORDER;
-    m_lastBorderUpdate = ((255 + BOTTOM_BORDER) * 224) + 128 + RIGHT_BORDER;
-    CLogger::Get()->Write("[Display]", LogDebug," m_lastBorderUpdate: %d", m_lastBorderUpdate);
+    m_borderLogSize = 0;
+    m_borderCell = 0;
+}
 
-    return true;
+
+void ZxDisplay::setRenderMode(RenderMode renderMode) {
+
+    m_renderMode = renderMode;
+    m_step = 0;
+    m_nextScreenFetch = (m_renderMode == RenderMode::Scanline && m_pStepStates != nullptr) ? m_pStepStates[0] : NO_EVENT;
+}
+
+
+/*
+ * Selects the pixel lookup table used to draw the screen at 4 bits per pixel.  All the strategies draw exactly the same
+ * pixels; the full table needs no arithmetic per screen byte but takes 256 KB, which is larger than the cache of the
+ * Raspberry Pi Zero/1, whereas the mask/fill and nibble tables fit in the L1 data cache and are generated at compile
+ * time.  The full table is released when it is no longer selected.
+ */
+void ZxDisplay::setLookupStrategy(LookupStrategy lookupStrategy) {
+
+    m_lookupStrategy = lookupStrategy;
+
+    if (m_pRenderer != nullptr && m_pRenderer->depth() == 4) {
+        createRenderer();
+    }
+}
+
+
+/*
+ * Creates the output stage for the colour depth of the framebuffer, so that every frame is drawn in the native pixel
+ * format of the framebuffer in a single pass.
+ */
+void ZxDisplay::createRenderer() {
+
+    const uint32_t cellsPerLine = DISPLAY_WIDTH / 8;
+    const uint32_t firstScreenCell = TOP_BORDER * cellsPerLine + LEFT_BORDER / 8;
+
+    delete m_pRenderer;
+    m_pRenderer = nullptr;
+
+    switch (m_pFrameBuffer->GetDepth()) {
+        case 4:
+            if (m_lookupStrategy == LookupStrategy::FullTable) {
+                m_pRenderer = new ZxPixelRenderer<ZxIndexed4Format<ZxFullTableLookup>>(cellsPerLine, firstScreenCell);
+            } else if (m_lookupStrategy == LookupStrategy::Nibble) {
+                m_pRenderer = new ZxPixelRenderer<ZxIndexed4Format<ZxNibbleLookup>>(cellsPerLine, firstScreenCell);
+            } else {
+                m_pRenderer = new ZxPixelRenderer<ZxIndexed4Format<ZxMaskFillLookup>>(cellsPerLine, firstScreenCell);
+            }
+            break;
+        case 8:
+            m_pRenderer = new ZxPixelRenderer<ZxPackedFormat<uint8_t>>(cellsPerLine, firstScreenCell);
+            break;
+        case 16:
+            m_pRenderer = new ZxPixelRenderer<ZxPackedFormat<uint16_t>>(cellsPerLine, firstScreenCell);
+            break;
+        case 32:
+            m_pRenderer = new ZxPixelRenderer<ZxPackedFormat<uint32_t>>(cellsPerLine, firstScreenCell);
+            break;
+        default:
+            break;
+    }
 }
 
 
 void ZxDisplay::update(bool flash) {
 
-    assert(m_pBaseBuffer != nullptr);
-    assert(m_pBuffer != nullptr);
+    assert(m_pTargetBuffer8 != nullptr);
     assert(m_pVideoMem != nullptr);
 
 //    CLogger::Get()->Write("[Display]", LogDebug,"(update display) Frame: %5d; T-states: %5d",
 //                          Clock::getInstance().getFrames(), Clock::getInstance().getTstates());
 
-    if (m_bDoubleBufferingEnabled) {
-        if (m_bVSync) {
-            // In VSync mode we swap the target frame each we refresh the screen
-            m_pFrameBuffer->SetVirtualOffset(0, m_bBufferSwapped ? DISPLAY_HEIGHT : 0);
-            m_pFrameBuffer->WaitForVerticalSync();
-            m_bBufferSwapped = !m_bBufferSwapped;
-        } else {
-            m_pFrameBuffer->SetVirtualOffset(0, DISPLAY_HEIGHT);
-            // In non-vsync mode, we just copy from the hidden buffer to the base buffer
-            memcpy(m_pBaseBuffer, m_pBuffer, (DISPLAY_WIDTH * DISPLAY_HEIGHT) / 2 /* 2 pixels per byte */);
-        }
+    if (m_bDrawBorder) {
+        drawBorder(NO_EVENT);
+    } else {
+        skipBorder();
+    }
+    m_borderCell = 0;
+
+    if (m_renderMode == RenderMode::Scanline && !m_bFrameSkipped) {
+        // Draw the screen bytes that the ULA fetched after the last write to video memory
+        updateScreen(NO_EVENT - 1);
+    } else {
+        /* Draw the whole screen area in one go using the current contents of video memory, which is also how scanline
+         * rendering catches up with a frame that followed a skipped one.
+         */
+        m_pRenderer->drawScreen(m_pTargetBuffer8, m_pVideoMem, 0, SCREEN_HEIGHT * (SCREEN_WIDTH / 8),
+                                flashMask[flash]);
     }
 
-    /*
-     * Determine the location of the next target buffer.  If double buffering is not enabled, the next target buffer
-     * will always be the base buffer.
-     */
-    m_pTargetBuffer8 = (m_bDoubleBufferingEnabled && m_bBufferSwapped) ? m_pBuffer : m_pBaseBuffer;
-    m_pTargetBuffer32 = reinterpret_cast<uint32_t *>(m_pTargetBuffer8);
-
-    /*
-     * Calculate the index into the frame buffer to perform fast translation of ZX Spectrum video memory to Raspberry Pi
-     * framebuffer memory. The framebuffer pointer has 32 bits per element, e.g. 8 pixels since each pixel takes 4 bits.
-     *
-     *      48 lines * 352 pixels per line + 48 border pixels = 16944 pixels
-     *      16944 pixels offset / 8 pixels per array element = 2118 array index = 0x0846 HEX
-     */
-    int bufIdx = 0x0846;
-
-    // Offset into the ZX Spectrum colour attribute memory (6144 bytes)
-    int attribute = 0x1800;
-
-    static uint8_t flashMask[] = {0x7Fu, 0xFFu};
-
-    updateBorder(m_border, m_lastBorderUpdate);
-
-    // BEGIN DEBUG (place a flashing checkered box in the top right corner of the spectrum video memory)
-//    uint32_t xblock = 0x0000;
-//    uint32_t xcolumn = 0x001F;
-//    uint32_t xrow = 0x0000;
-//    for (uint32_t xline = 0; xline < 8; xline++) {
-//        m_pVideoMem[xblock + xrow + xcolumn + xline * 0x0100] = flash
-//                ? ((xline % 2 == 0) ? 0xAA : 0x55)
-//                : ((xline % 2 == 0) ? 0x55 : 0xAA);
-//    }
-//    m_pVideoMem[attribute + xcolumn] = flash ? 0xAA : 0x55;
-    // END DEBUG
-
-    // The ZX Spectrum screen is made up of 3 blocks of 2048 (0x0800) bytes each
-    for (uint32_t block = 0x0000; block < 0x1800; block += 0x0800) {
-        for (uint32_t row = 0x0000; row < 0x0100; row += 0x0020) {
-            for (uint32_t column = 0x0000; column < 0x0020; column++) {
-                uint8_t colour = m_pVideoMem[attribute++] & flashMask[flash];
-                for (uint32_t line = 0; line < 8; line++) {
-                    m_pTargetBuffer32[bufIdx + column + line * 0x2C] = *m_pScrTable[colour][m_pVideoMem[block + row + column + line * 0x0100]];
-                }
-            }
-            bufIdx += 0x0160;
-        }
+    if (m_renderMode == RenderMode::Scanline) {
+        // Rewind the fetch cursor for the next frame.  The flash state only takes effect from the next frame onwards.
+        m_flashMask = flashMask[flash];
+        m_step = 0;
+        m_nextScreenFetch = m_pStepStates[0];
     }
+    m_bFrameSkipped = false;
 
 //    // BEGIN DEBUG
 //    auto label = new ZxLabel(ZxRect(1, 1, 1, 1), (flash ? "O" : "X"));
@@ -234,11 +287,113 @@ void ZxDisplay::update(bool flash) {
 //    delete label;
 //    // END DEBUG
 
+    completeFrame();
+}
+
+
+/*
+ * Ends the frame that has just been emulated without drawing it, e.g. to run faster than real time, keeping track of
+ * the border colour.  Scanline rendering stops drawing the screen bytes as they are fetched until the next call to
+ * update(), which then draws the whole screen in one go, so skipped frames cost next to nothing.
+ */
+void ZxDisplay::skip() {
+
+    m_borderLogSize = 0;
+    m_frameBorder = static_cast<uint8_t>(m_border);
+
+    if (m_renderMode == RenderMode::Deferred) {
+        // Leave the drawing state alone, as render() may be drawing an earlier frame on another core
+        return;
+    }
+
+    m_borderCell = 0;
+    m_drawnBorder = static_cast<uint8_t>(m_border);
+    m_step = 0;
+    m_nextScreenFetch = NO_EVENT;
+    m_bFrameSkipped = true;
+}
+
+
+/*
+ * Goes back to the given border colour when the machine state is restored, dropping the frame emulated since then.
+ */
+void ZxDisplay::rewind(uint8_t border) {
+
+    m_border = border;
+    skip();
+}
+
+
+/*
+ * Takes a snapshot of the frame that has just been emulated, i.e. the video memory and the border changes made during
+ * the frame, and starts logging the border changes of the next frame.  This costs a 6912 byte copy plus the size of
+ * the border log, so the drawing itself can be moved off the emulation core.
+ */
+void ZxDisplay::capture(FrameSnapshot &snapshot, bool flash) {
+
+    assert(m_pVideoMem != nullptr);
+
+    memcpy(snapshot.videoMemory, m_pVideoMem, VIDEO_MEMORY_SIZE);
+    memcpy(snapshot.borderLog, m_pBorderLog, m_borderLogSize * sizeof(BorderChange));
+    snapshot.borderLogSize = m_borderLogSize;
+    snapshot.border = m_frameBorder;
+    snapshot.flash = flash;
+    snapshot.drawBorder = m_bDrawBorder;
+
+    m_borderLogSize = 0;
+    m_frameBorder = static_cast<uint8_t>(m_border);
+}
+
+
+void ZxDisplay::render(const FrameSnapshot &snapshot) {
+
+    assert(m_pTargetBuffer8 != nullptr);
+
+    if (snapshot.drawBorder) {
+        m_borderCell = 0;
+        m_drawnBorder = snapshot.border;
+        drawBorder(snapshot.borderLog, snapshot.borderLogSize, NO_EVENT);
+    }
+    m_borderCell = 0;
+
+    m_pRenderer->drawScreen(m_pTargetBuffer8, snapshot.videoMemory, 0, SCREEN_HEIGHT * (SCREEN_WIDTH / 8),
+                            flashMask[snapshot.flash]);
+
+    completeFrame();
+}
+
+
+/*
+ * Hands the frame just drawn over to the frame listener, draws the UI on top of it and, when triple buffered, publishes
+ * it and moves on to the next free buffer.
+ */
+void ZxDisplay::completeFrame() {
+
+    if (m_pFrameListener != nullptr) {
+        m_pFrameListener->frameCompleted(m_pTargetBuffer8, m_pRenderer->depth());
+    }
+
     if (m_pZxView != nullptr) {
         m_pZxView->draw(m_pTargetBuffer8);
     }
 
-    m_lastBorderChange = m_firstBorderUpdate;
+    /* Every frame is drawn in full, border included unless turned off, so the next one can go straight into the
+     * buffer handed back by the presenter.
+     */
+    if (m_bTripleBuffered) {
+        m_pTargetBuffer8 = m_pFrames[m_frames.publish()];
+    }
+}
+
+
+bool ZxDisplay::present() {
+
+    if (!m_bTripleBuffered || !m_frames.take()) {
+        return false;
+    }
+
+    m_pFrameBuffer->SetVirtualOffset(0, m_frames.front() * DISPLAY_HEIGHT);
+    return true;
 }
 
 
@@ -257,52 +412,112 @@ void ZxDisplay::update(bool flash) {
  *       48 lines for the top border
  *      192 lines to draw the 192 screen pixels
  *       56 lines for the bottom border (out of which only 48 lines are actually visible in the real machine)
+ *
+ * Border changes are only recorded here.  They are drawn in runs at the end of the frame by drawBorder(), so the cost
+ * of a border change does not depend on how many T-states have passed since the previous one.
  */
 void ZxDisplay::updateBorder(uint8_t border, uint32_t tstates) {
 
-//    CLogger::Get()->Write("[Display]", LogDebug,
-//                          "(update border #1) m_lastBorderChange: %5d; T-states: %5d; portFE: %d (%s)",
-//                          m_lastBorderChange, tstates, m_border, m_paletteColourName[m_border & 0x07],
-//                          tstates, border, m_paletteColourName[border & 0x07]);
-
-    if ((tstates >= m_lastBorderChange) && (m_lastBorderChange <= m_lastBorderUpdate)) {
-
-//        CLogger::Get()->Write("[Display]", LogDebug,
-//                              "(update border #2) m_lastBorderChange: %5d; T-states: %5d; portFE: %d (%s)",
-//                              m_lastBorderChange, tstates, m_border, m_paletteColourName[m_border & 0x07],
-//                              tstates, border, m_paletteColourName[border & 0x07]);
-
-        auto clock = Clock::getInstance();
-
-        // Draw the border 8 pixels (e.g. 4 bytes) at a time
-        while (m_lastBorderChange < tstates) {
-
-            uint32_t offset = (m_lastBorderChange - 176) % clock.getTstatesPerScreenFrame();
-            uint32_t row = offset / clock.getTstatesPerScreenLine();
-            uint32_t col = offset % clock.getTstatesPerScreenLine();
-
-            //CLogger::Get()->Write("[ZxDisplay]", LogDebug,"[BORDER] row: %3d, column: %3d, border: 0x%02X, colour: %-14s", row, col, m_border, m_paletteColourName[border]);
-
-            /*
-             * Determine whether the current T-state falls within the border area and paint it using the cached border
-             * fill colour if so.
-             */
-            if ((col < 24) || (col >= 152 && col < 176) || (row < 48) || (row >= 240 && row < 296)) {
-                /*
-                 * When calculating the offset into the screen buffer we need to take into account the 48 T-states used to
-                 * return the electron beam to the start of the line and divide both the column and the row by 4 (bytes)
-                 * since we are drawing 8 pixels at a time.
-                 */
-                uint32_t baseAddress = row * ((clock.getTstatesPerScreenLine() - 48) / 4) + (col / 4);
-                m_pTargetBuffer32[baseAddress] = m_borderColour[m_border];
+    if (m_borderLogSize == BORDER_LOG_SIZE) {
+        if (m_renderMode == RenderMode::Deferred) {
+            // Nothing can be drawn until the frame ends, so the last change is superseded by this one
+            m_borderLogSize--;
+        } else {
+            drawBorder(tstates);
+        }
+    }
+
+    m_pBorderLog[m_borderLogSize++] = { tstates, border };
+    m_border = border;
+}
+
+
+/*
+ * Draws the border changes logged so far, and the border up to the given T-state, in runs of the same colour.
+ */
+void ZxDisplay::drawBorder(uint32_t tstates) {
+
+    drawBorder(m_pBorderLog, m_borderLogSize, tstates);
+    m_borderLogSize = 0;
+}
+
+
+void ZxDisplay::drawBorder(const BorderChange *pBorderLog, uint32_t borderLogSize, uint32_t tstates) {
+
+    for (uint32_t i = 0; i < borderLogSize; i++) {
+        uint32_t cell = borderCell(pBorderLog[i].tstates);
+        if (cell > m_borderCell) {
+            fillBorder(m_borderCell, cell, m_drawnBorder);
+            m_borderCell = cell;
+        }
+        m_drawnBorder = pBorderLog[i].border;
+    }
+
+    uint32_t cell = borderCell(tstates);
+    if (cell > m_borderCell) {
+        fillBorder(m_borderCell, cell, m_drawnBorder);
+        m_borderCell = cell;
+    }
+}
+
+
+/*
+ * Drops the border changes logged so far without drawing them, keeping track of the border colour.
+ */
+void ZxDisplay::skipBorder() {
+
+    m_borderLogSize = 0;
+    m_drawnBorder = static_cast<uint8_t>(m_border);
+}
+
+
+/*
+ * Fills the border cells in the given range of display cells, skipping the cells that belong to the screen area.
+ * Border cells come in contiguous spans: the top border up to the left border of the first screen line, the right
+ * border of each screen line together with the left border of the next one, and the bottom border.  Each span is
+ * filled with a single call to the output stage.
+ */
+void ZxDisplay::fillBorder(uint32_t fromCell, uint32_t toCell, uint8_t border) {
+
+    const uint32_t cellsPerLine = DISPLAY_WIDTH / 8;
+    const uint32_t leftCells = LEFT_BORDER / 8;
+    const uint32_t rightCell = (LEFT_BORDER + SCREEN_WIDTH) / 8;
+    const uint32_t firstScreenCell = TOP_BORDER * cellsPerLine + leftCells;
+    const uint32_t lastScreenCell = (TOP_BORDER + SCREEN_HEIGHT - 1) * cellsPerLine + rightCell;
+
+    while (fromCell < toCell) {
+        uint32_t spanEnd = toCell;
+        if (fromCell < firstScreenCell) {
+            spanEnd = std::min(toCell, firstScreenCell);
+        } else if (fromCell < lastScreenCell) {
+            uint32_t line = fromCell / cellsPerLine;
+            uint32_t column = fromCell - line * cellsPerLine;
+            if (column >= leftCells && column < rightCell) {
+                // Skip the screen area
+                fromCell = line * cellsPerLine + rightCell;
+                continue;
             }
-            m_lastBorderChange += 4;
+            spanEnd = std::min(toCell, ((column < leftCells) ? line : line + 1) * cellsPerLine + leftCells);
         }
 
+        m_pRenderer->fillCells(m_pTargetBuffer8, fromCell, spanEnd, border);
+        fromCell = spanEnd;
     }
+}
 
-    m_lastBorderChange = tstates;
-    m_border = border;
+
+/*
+ * Draws every screen byte fetched by the ULA up to (and including) the given T-state in a single batch.
+ */
+void ZxDisplay::updateScreen(uint32_t tstates) {
+
+    uint32_t fromStep = m_step;
+    while (m_nextScreenFetch <= tstates) {
+        m_step++;
+        m_nextScreenFetch = (m_step < SCREEN_HEIGHT * (SCREEN_WIDTH / 8)) ? m_pStepStates[m_step] : NO_EVENT;
+    }
+
+    m_pRenderer->drawScreen(m_pTargetBuffer8, m_pVideoMem, fromStep, m_step, m_flashMask);
 }
 
 
@@ -310,3 +525,8 @@ void ZxDisplay::setUI(ZxView *pZxView) {
 
     this->m_pZxView = pZxView;
 }
+
+void ZxDisplay::setFrameListener(ZxFrameListener *pFrameListener) {
+
+    m_pFrameListener = pFrameListener;
+}
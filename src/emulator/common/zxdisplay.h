@@ -22,23 +22,105 @@
 #include <cstdint>
 #include <circle/bcmframebuffer.h>
 #include <circle/types.h>
+#include "zxdisplayrenderer.h"
+#include "zxframelistener.h"
+#include "zxtriplebuffer.h"
 
 class ZxView;
+class ZxHardwareModel;
 
 class ZxDisplay {
 public:
+    /* Frame rendering draws the whole screen in one go when the frame ends, whereas scanline rendering draws each
+     * group of 8 pixels at the T-state where the ULA would fetch it, so that mid-frame changes to the video memory
+     * (e.g. multicolour effects) show up on screen.  Deferred rendering draws nothing while the frame is emulated:
+     * capture() takes a snapshot of the frame when it ends and render() draws it later, e.g. on another core.
+     */
+    enum class RenderMode {
+        Frame,
+        Scanline,
+        Deferred
+    };
+
+    // Pixel lookup tables used to draw the screen at 4 bits per pixel, see zxdisplaylookup.h for the memory footprint
+    // of each one.
+    enum class LookupStrategy {
+        FullTable,
+        MaskFill,
+        Nibble
+    };
+
+#if ZX_DISPLAY_LOOKUP_FULL_TABLE
+    static const LookupStrategy DEFAULT_LOOKUP_STRATEGY = LookupStrategy::FullTable;
+#elif ZX_DISPLAY_LOOKUP_NIBBLE
+    static const LookupStrategy DEFAULT_LOOKUP_STRATEGY = LookupStrategy::Nibble;
+#else
+    static const LookupStrategy DEFAULT_LOOKUP_STRATEGY = LookupStrategy::MaskFill;
+#endif
+
     ZxDisplay();
     ~ZxDisplay();
 
     bool Initialize(uint8_t *pVideoMem, CBcmFrameBuffer *pFrameBuffer);
+    void setHardwareModel(ZxHardwareModel *pModel);
+    void setRenderMode(RenderMode renderMode);
+    void setLookupStrategy(LookupStrategy lookupStrategy);
+    LookupStrategy getLookupStrategy() const {
+        return m_lookupStrategy;
+    }
     void update(bool flash);
+    void skip();
+    void rewind(uint8_t border);
+    /* With the border turned off, frames only draw the screen area and the border keeps whatever the frame buffer
+     * last held, which saves drawing the border changes when the host cannot keep up.
+     */
+    void setDrawBorder(bool drawBorder) {
+        m_bDrawBorder = drawBorder;
+    }
+
+    /* Presentation side of the frame hand-off, which may run on a different core or thread from update().  When the
+     * framebuffer has room for 3 frames (i.e. a virtual height of 3 x DISPLAY_HEIGHT), update() renders each frame
+     * into a free buffer and hands it over through a ZxTripleBuffer, so neither side ever copies a frame or waits for
+     * the other.  present() makes the latest complete frame the front buffer and shows it by moving the virtual offset
+     * of the framebuffer, returning false if there is no new frame.  Front ends that copy the frame to the screen
+     * themselves read it from getFrontBuffer().  With a smaller framebuffer the display renders straight into the only
+     * frame, which is always the front buffer.
+     */
+    bool present();
+    [[nodiscard]] const uint8_t *getFrontBuffer() const {
+        return m_pFrames[m_frames.front()];
+    }
+    [[nodiscard]] bool isTripleBuffered() const {
+        return m_bTripleBuffered;
+    }
     void updateBorder(uint8_t portFE, uint32_t tstates);
 
+    /* Must be called before the emulated CPU writes to video memory (0x4000 to 0x5AFF) so that every screen byte
+     * the ULA has already fetched by then is drawn with its old contents. This is a single comparison unless there
+     * are pending screen fetches, so the rendering cost is driven by video memory writes rather than by T-states.
+     */
+    void videoMemoryWrite(uint32_t tstates) {
+        if (tstates >= m_nextScreenFetch) {
+            updateScreen(tstates);
+        }
+    }
+
+    /* Switches the video memory that the ULA displays at the given T-state, e.g. to the second screen of the 128K.  The
+     * screen bytes already fetched by then are drawn from the old one.
+     */
+    void setVideoMemory(uint8_t *pVideoMem, uint32_t tstates) {
+        videoMemoryWrite(tstates);
+        m_pVideoMem = pVideoMem;
+    }
+
     void setUI(ZxView *pZxView);
     ZxView *getUI() {
         return m_pZxView;
     };
 
+    // The listener is given every completed frame, without the UI, at the end of update().
+    void setFrameListener(ZxFrameListener *pFrameListener);
+
     /* These are the visible screen dimensions, which are smaller than the actual dimensions suggested by the
      * screen timings since it takes the electron beam some time to fly back to the beginning or top of the screen:
      *
@@ -60,69 +142,105 @@ public:
     static const uint32_t BOTTOM_BORDER = 56;
     static const uint32_t SCREEN_HEIGHT = 192;
     static const uint32_t DISPLAY_HEIGHT = TOP_BORDER + SCREEN_HEIGHT + BOTTOM_BORDER;
+    /* Default colour depth of the framebuffer.  The display draws straight into framebuffers with a colour depth of
+     * 4, 8, 16 (RGB565) or 32 (XRGB8888) bits per pixel, see zxdisplayrenderer.h.
+     */
     static const uint32_t COLOUR_DEPTH = 4;
 
+    // Marks the absence of any further screen fetch events in the current frame.
+    static const uint32_t NO_EVENT = 0xFFFFFFFFu;
+
+    // Number of 8 pixel cells in the visible display area, i.e. 44 cells per line x 296 lines.
+    static const uint32_t DISPLAY_CELLS = (DISPLAY_WIDTH / 8) * DISPLAY_HEIGHT;
+
+    // Capacity of the border change log.  An OUT instruction takes at least 11 T-states, so this is enough for a
+    // border change on every instruction of a 48K or 128K frame.
+    static const uint32_t BORDER_LOG_SIZE = 8192;
+
+    // Bitmap and attributes, i.e. 0x4000 to 0x5AFF
+    static const uint32_t VIDEO_MEMORY_SIZE = 0x1B00;
+
+    struct BorderChange {
+        uint32_t tstates;
+        uint8_t border;
+    };
+
+    // Everything needed to draw a frame after it has been emulated
+    struct FrameSnapshot {
+        uint8_t videoMemory[VIDEO_MEMORY_SIZE];
+        BorderChange borderLog[BORDER_LOG_SIZE];
+        uint32_t borderLogSize;
+        // Border colour at the start of the frame
+        uint8_t border;
+        bool flash;
+        bool drawBorder;
+    };
+
+    /* Deferred rendering.  capture() is called on the emulation side when a frame ends, instead of update(), and
+     * render() draws the snapshot into the next free buffer, hands it over to present() and must not run at the same
+     * time as update().
+     */
+    void capture(FrameSnapshot &snapshot, bool flash);
+    void render(const FrameSnapshot &snapshot);
+
 private:
+    void updateScreen(uint32_t tstates);
+    void createRenderer();
+    void drawBorder(uint32_t tstates);
+    void drawBorder(const BorderChange *pBorderLog, uint32_t borderLogSize, uint32_t tstates);
+    void fillBorder(uint32_t fromCell, uint32_t toCell, uint8_t border);
+    void skipBorder();
+    void completeFrame();
+
+    uint32_t borderCell(uint32_t tstates) const {
+        uint32_t slot = tstates >> 2;
+        return (slot < m_states2BorderSize) ? m_pStates2Border[slot] : DISPLAY_CELLS;
+    }
+
     ZxView *m_pZxView;
+    ZxFrameListener *m_pFrameListener;
     CBcmFrameBuffer *m_pFrameBuffer;
-    uint32_t (*m_pScrTable)[256][256];  // screen pixel lookup table
+    LookupStrategy m_lookupStrategy;
+    // Output stage for the colour depth of the framebuffer
+    ZxDisplayRenderer *m_pRenderer;
     uint8_t *m_pVideoMem;               // Spectrum video memory
     uint32_t m_border;                   // Border colour index
-    bool m_bDoubleBufferingEnabled;
-    bool m_bVSync;
-    bool m_bBufferSwapped;
+    RenderMode m_renderMode;
+    uint8_t m_flashMask;
 
-    uint8_t *m_pBaseBuffer;
-    uint8_t *m_pBuffer;
+    // Frame buffers within the framebuffer, all the same one unless triple buffered, and the one being rendered
+    uint8_t *m_pFrames[ZxTripleBuffer::BUFFERS];
+    bool m_bTripleBuffered;
+    ZxTripleBuffer m_frames;
     uint8_t *m_pTargetBuffer8;
-    uint32_t *m_pTargetBuffer32;
-
-    // T-state at which the border was last changed (though port 0xFEu) on screen.
-    uint32_t m_lastBorderChange;
-    uint32_t m_firstBorderUpdate;
-    uint32_t m_lastBorderUpdate;
-
-    // Border colour cache. Each item in this array represents 8 pixels
-    uint32_t m_borderColour[8] = { 0 };
-
-    const uint16_t m_palette[16] = {
-        0x0000u, // black
-        0x0010u, // blue
-        0x8000u, // red
-        0x8010u, // magenta
-        0x0400u, // green
-        0x0410u, // cyan
-        0x8400u, // yellow
-        0x8410u, // white
-        0x0000u, // black
-        0x001Fu, // bright blue
-        0xF800u, // bright red
-        0xF81Fu, // bright magenta
-        0x07E0u, // bright green
-        0x07FFu, // bright cyan
-        0xFFE0u, // bright yellow
-        0xFFFFu // bright white
-    };
 
-public:
-    [[maybe_unused]] const char *m_paletteColourName[16] = {
-        "black",
-        "blue",
-        "red",
-        "magenta",
-        "green",
-        "cyan",
-        "yellow",
-        "white",
-        "black",
-        "bright blue",
-        "bright red",
-        "bright magenta",
-        "bright green",
-        "bright cyan",
-        "bright yellow",
-        "bright white"
-    };
+    /* Border timeline for the active hardware model.  Each entry in m_pStates2Border maps a 4 T-state slot in the
+     * frame to the first display cell (line * 44 + column) that the ULA draws at or after that slot, so that the
+     * cells between two border changes can be filled in a single run.  Border changes made through port 0xFE are
+     * recorded in m_pBorderLog and drawn at the end of the frame, or earlier if the log fills up.
+     */
+    uint16_t *m_pStates2Border;
+    uint32_t m_states2BorderSize;
+    BorderChange *m_pBorderLog;
+    uint32_t m_borderLogSize;
+    // First display cell not yet drawn in the current frame and the border colour to draw it with.
+    uint32_t m_borderCell;
+    uint8_t m_drawnBorder;
+    // Border colour at the start of the frame being emulated, only used by deferred rendering
+    uint8_t m_frameBorder;
+    // Set by skip() until the next frame is drawn
+    bool m_bFrameSkipped;
+    bool m_bDrawBorder;
+
+    /* Scanline rendering table for the active hardware model.  m_pStepStates holds the T-state at which the ULA
+     * fetches each of the 6144 screen bytes, in fetch order, i.e. step = line * 32 + column.
+     *
+     * m_step is the index of the next screen byte to be drawn and m_nextScreenFetch the T-state at which it is
+     * fetched, or NO_EVENT if the whole screen has been drawn.
+     */
+    uint32_t *m_pStepStates;
+    uint32_t m_step;
+    uint32_t m_nextScreenFetch;
 
 };
 
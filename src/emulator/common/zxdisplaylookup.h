@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXDISPLAYLOOKUP_H
+#define ZXDISPLAYLOOKUP_H
+
+#include <cstdint>
+
+/*
+ * Pixel lookup strategies used to turn a ZX Spectrum attribute byte and a character (8 pixel) mask byte into 8 pixels
+ * at 4 bits per pixel, i.e. a 32-bit value where each nibble represents a pixel colour index on screen.
+ *
+ * The attribute byte format is as follows:
+ *
+ *  | F | B | P2 | P1 | P0 | I2 | I1 | I0 |
+ *
+ * F sets the attribute FLASH mode where flashing is done by swapping the ink and paper colours
+ * B sets the attribute BRIGHTNESS mode
+ * P2 to P0 is the PAPER colour
+ * I2 to I0 is the INK colour
+ *
+ * The caller masks out the F bit when the flash is off, so attributes 128 to 255 always hold the flashed (i.e.
+ * swapped) colours.  All strategies produce the same output; they only differ in how much memory they use:
+ *
+ * - ZxFullTableLookup:  one precomputed value for every attribute and character combination (256 KB), adapted from
+ *                       sample code by José Luis Sanchez of ZXBaremulator (https://zxmini.speccy.org/en/index.html)
+ *                       fame.  This is larger than the L2 cache of a Raspberry Pi Zero/1 and any L1 cache.
+ * - ZxMaskFillLookup:   a 256 entry character expansion mask combined with per-attribute ink and paper fills (3 KB).
+ * - ZxNibbleLookup:     a 16 entry table per attribute mapping 4 pixels at a time (8 KB).
+ *
+ * The full table is only built, on the heap, when it is selected since it would otherwise add 256 KB to the kernel
+ * image.
+ */
+
+/*
+ * The framebuffer stores the leftmost pixel in the high nibble of the lowest byte.  Values are built with the leftmost
+ * pixel in the most significant nibble, so they need swapping into memory order on little endian machines.
+ */
+constexpr uint32_t zxFrameBufferOrder(uint32_t pixels) {
+#if BYTE_SWAP_DISABLED
+    return pixels;
+#else
+    return ((pixels & 0x000000FFu) << 24) | ((pixels & 0x0000FF00u) << 8) |
+           ((pixels & 0x00FF0000u) >> 8) | ((pixels & 0xFF000000u) >> 24);
+#endif
+}
+
+/* The ink and paper values are unpacked like this, swapping them around for flashing attributes:
+ *
+ *  ink:   | F | B | P2 | P1 | P0 | I2 | I1 | I0 |  -->  | 0 | 0 | 0 | 0 | B | I2 | I1 | I0 |
+ *  paper: | F | B | P2 | P1 | P0 | I2 | I1 | I0 |  -->  | 0 | 0 | 0 | 0 | B | P2 | P1 | P0 |
+ */
+constexpr uint32_t zxInk(uint32_t attr) {
+    return (attr & 0x80u) ? ((attr & 0b01111000u) >> 3) : ((attr & 0b01000000u) >> 3 | (attr & 0b00000111u));
+}
+
+constexpr uint32_t zxPaper(uint32_t attr) {
+    return (attr & 0x80u) ? ((attr & 0b01000000u) >> 3 | (attr & 0b00000111u)) : ((attr & 0b01111000u) >> 3);
+}
+
+// Replicates a 4-bit colour index across all 8 nibbles of a 32-bit value.
+constexpr uint32_t zxFill(uint32_t colour) {
+    return colour * 0x11111111u;
+}
+
+/*
+ * Expands the given pixels into a value where each nibble is 0xF when its pixel is set and 0x0 otherwise, leftmost
+ * pixel first.
+ */
+constexpr uint32_t zxExpandMask(uint32_t character, uint32_t pixels) {
+    uint32_t value = 0;
+    for (uint32_t mask = 1u << (pixels - 1); mask > 0; mask >>= 1) {
+        value = (value << 4) | ((character & mask) ? 0xFu : 0x0u);
+    }
+    return value;
+}
+
+
+class ZxFullTableLookup {
+
+public:
+    ZxFullTableLookup() : m_pTable(new uint32_t[256 * 256]) {
+        for (uint32_t attr = 0; attr < 256; attr++) {
+            for (uint32_t character = 0; character < 256; character++) {
+                uint32_t mask = zxExpandMask(character, 8);
+                m_pTable[(attr << 8) | character] =
+                        zxFrameBufferOrder((mask & zxFill(zxInk(attr))) | (~mask & zxFill(zxPaper(attr))));
+            }
+        }
+    }
+
+    ~ZxFullTableLookup() {
+        delete[] m_pTable;
+    }
+
+    ZxFullTableLookup(const ZxFullTableLookup &) = delete;
+    ZxFullTableLookup &operator=(const ZxFullTableLookup &) = delete;
+
+    [[nodiscard]] uint32_t pixels(uint8_t attr, uint8_t character) const {
+        return m_pTable[(attr << 8) | character];
+    }
+
+private:
+    uint32_t *m_pTable;
+
+};
+
+
+/*
+ * The mask/fill and nibble tables below are generated at compile time and live in read-only data, so selecting either
+ * strategy costs nothing at start up.
+ */
+struct ZxMaskFillTables {
+    uint32_t mask[256];
+    uint32_t ink[256];
+    uint32_t paper[256];
+
+    constexpr ZxMaskFillTables() : mask(), ink(), paper() {
+        for (uint32_t i = 0; i < 256; i++) {
+            mask[i] = zxFrameBufferOrder(zxExpandMask(i, 8));
+            ink[i] = zxFill(zxInk(i));
+            paper[i] = zxFill(zxPaper(i));
+        }
+    }
+};
+
+
+class ZxMaskFillLookup {
+
+public:
+    [[nodiscard]] constexpr uint32_t pixels(uint8_t attr, uint8_t character) const {
+        uint32_t mask = s_tables.mask[character];
+        return (mask & s_tables.ink[attr]) | (~mask & s_tables.paper[attr]);
+    }
+
+private:
+    static constexpr ZxMaskFillTables s_tables{};
+
+};
+
+
+struct ZxNibbleTables {
+    uint16_t nibble[256][16];
+
+    constexpr ZxNibbleTables() : nibble() {
+        for (uint32_t attr = 0; attr < 256; attr++) {
+            for (uint32_t i = 0; i < 16; i++) {
+                uint32_t mask = zxExpandMask(i, 4);
+                uint32_t half = ((mask & zxFill(zxInk(attr))) | (~mask & zxFill(zxPaper(attr)))) & 0xFFFFu;
+#if BYTE_SWAP_DISABLED
+                nibble[attr][i] = static_cast<uint16_t>(half);
+#else
+                // Keep the 4 pixels (2 bytes) in framebuffer byte order
+                nibble[attr][i] = static_cast<uint16_t>((half >> 8) | (half << 8));
+#endif
+            }
+        }
+    }
+};
+
+
+class ZxNibbleLookup {
+
+public:
+    [[nodiscard]] constexpr uint32_t pixels(uint8_t attr, uint8_t character) const {
+        const uint16_t *nibbles = s_tables.nibble[attr];
+#if BYTE_SWAP_DISABLED
+        return (static_cast<uint32_t>(nibbles[character >> 4]) << 16) | nibbles[character & 0x0Fu];
+#else
+        return nibbles[character >> 4] | (static_cast<uint32_t>(nibbles[character & 0x0Fu]) << 16);
+#endif
+    }
+
+private:
+    static constexpr ZxNibbleTables s_tables{};
+
+};
+
+
+#endif // ZXDISPLAYLOOKUP_H
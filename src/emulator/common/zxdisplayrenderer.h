@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXDISPLAYRENDERER_H
+#define ZXDISPLAYRENDERER_H
+
+#include <cstdint>
+#include <cstring>
+#include "zxdisplaylookup.h"
+
+/*
+ * Output stage of the display: draws ZX Spectrum screen bytes and border cells straight into a framebuffer in its
+ * native pixel format, so that front ends never need to convert the frame a second time.  A cell is a group of 8
+ * horizontally adjacent pixels, i.e. one screen byte, and takes DEPTH bytes in the framebuffer.
+ *
+ * The following pixel formats are supported:
+ *
+ *  4 bpp:  2 palette indexes per byte, leftmost pixel in the high nibble (Raspberry Pi default).
+ *  8 bpp:  1 palette index per byte.
+ * 16 bpp:  RGB565.
+ * 32 bpp:  XRGB8888, i.e. 0xFFRRGGBB as a native 32-bit integer (e.g. QImage::Format_RGB32).
+ */
+
+// ZX Spectrum colour palette in RGB565 format
+static constexpr uint16_t zxPaletteRGB565[16] = {
+    0x0000u, // black
+    0x0010u, // blue
+    0x8000u, // red
+    0x8010u, // magenta
+    0x0400u, // green
+    0x0410u, // cyan
+    0x8400u, // yellow
+    0x8410u, // white
+    0x0000u, // black
+    0x001Fu, // bright blue
+    0xF800u, // bright red
+    0xF81Fu, // bright magenta
+    0x07E0u, // bright green
+    0x07FFu, // bright cyan
+    0xFFE0u, // bright yellow
+    0xFFFFu  // bright white
+};
+
+// Names of the palette colours, for logging
+static constexpr const char *zxPaletteColourName[16] = {
+    "black",
+    "blue",
+    "red",
+    "magenta",
+    "green",
+    "cyan",
+    "yellow",
+    "white",
+    "black",
+    "bright blue",
+    "bright red",
+    "bright magenta",
+    "bright green",
+    "bright cyan",
+    "bright yellow",
+    "bright white"
+};
+
+constexpr uint32_t zxRGB565ToXRGB8888(uint16_t rgb565) {
+    return 0xFF000000u |
+           static_cast<uint32_t>(rgb565 >> 11 & 0x1Fu) << (16 + 3) |   // red
+           static_cast<uint32_t>(rgb565 >> 5 & 0x3Fu) << (8 + 2) |     // green
+           static_cast<uint32_t>(rgb565 & 0x1Fu) << (0 + 3);           // blue
+}
+
+/*
+ * Returns the native pixel value of a palette colour for the given colour depth.  Indexed formats return the index.
+ */
+constexpr uint32_t zxNativeColour(uint32_t depth, uint8_t colour) {
+    return (depth == 32) ? zxRGB565ToXRGB8888(zxPaletteRGB565[colour & 0x0Fu])
+                         : ((depth == 16) ? zxPaletteRGB565[colour & 0x0Fu] : (colour & 0x0Fu));
+}
+
+/*
+ * Offset into video memory of the first byte of each of the 192 screen lines, generated at compile time.  The video
+ * memory address of each pixel line is | 0 | 1 | 0 | Y7 | Y6 | Y2 | Y1 | Y0 | Y5 | Y4 | Y3 | X4 ... X0 |
+ */
+struct ZxScreenAddressTable {
+    uint16_t offset[192];
+
+    constexpr ZxScreenAddressTable() : offset() {
+        for (uint32_t line = 0; line < 192; line++) {
+            offset[line] = static_cast<uint16_t>(((line & 0xC0u) << 5) | ((line & 0x07u) << 8) | ((line & 0x38u) << 2));
+        }
+    }
+};
+
+static constexpr ZxScreenAddressTable zxScreenAddress{};
+
+
+/*
+ * 4 bits per pixel format, using one of the pixel lookup strategies in zxdisplaylookup.h.
+ */
+template<typename Lookup>
+class ZxIndexed4Format {
+
+public:
+    static const uint32_t DEPTH = 4;
+
+    void drawCell(uint8_t *pCell, uint8_t attr, uint8_t bitmap) const {
+        *reinterpret_cast<uint32_t *>(pCell) = m_lookup.pixels(attr, bitmap);
+    }
+
+    void fillCells(uint8_t *pCell, uint32_t cells, uint8_t colour) const {
+        std::memset(pCell, static_cast<int>((colour << 0x04u) | colour), cells * (DEPTH * 8 / 8));
+    }
+
+private:
+    Lookup m_lookup;
+
+};
+
+
+/*
+ * 8, 16 and 32 bits per pixel formats, where each pixel is stored in its own (native) integer.  The ink and paper
+ * values of each attribute are looked up once per cell and each pixel is then selected without branching.
+ */
+template<typename Pixel>
+class ZxPackedFormat {
+
+public:
+    static const uint32_t DEPTH = sizeof(Pixel) * 8;
+
+    ZxPackedFormat() : m_ink(), m_paper(), m_colour() {
+        for (uint32_t colour = 0; colour < 16; colour++) {
+            m_colour[colour] = static_cast<Pixel>(zxNativeColour(DEPTH, colour));
+        }
+        for (uint32_t attr = 0; attr < 256; attr++) {
+            m_ink[attr] = m_colour[zxInk(attr)];
+            m_paper[attr] = m_colour[zxPaper(attr)];
+        }
+    }
+
+    void drawCell(uint8_t *pCell, uint8_t attr, uint8_t bitmap) const {
+        auto *pPixel = reinterpret_cast<Pixel *>(pCell);
+        const Pixel ink = m_ink[attr];
+        const Pixel paper = m_paper[attr];
+        const Pixel diff = ink ^ paper;
+        for (uint32_t pixel = 0; pixel < 8; pixel++) {
+            // 0 - 1 sets all the bits of the pixel when the bitmap bit is set
+            pPixel[pixel] = paper ^ (diff & static_cast<Pixel>(0u - ((bitmap >> (7 - pixel)) & 0x01u)));
+        }
+    }
+
+    void fillCells(uint8_t *pCell, uint32_t cells, uint8_t colour) const {
+        auto *pPixel = reinterpret_cast<Pixel *>(pCell);
+        const Pixel value = m_colour[colour & 0x0Fu];
+        for (uint32_t pixel = 0; pixel < cells * 8; pixel++) {
+            pPixel[pixel] = value;
+        }
+    }
+
+private:
+    Pixel m_ink[256];
+    Pixel m_paper[256];
+    Pixel m_colour[16];
+
+};
+
+
+class ZxDisplayRenderer {
+
+public:
+    virtual ~ZxDisplayRenderer() = default;
+
+    [[nodiscard]] virtual uint32_t depth() const = 0;
+
+    /*
+     * Draws the screen bytes from step fromStep up to (but excluding) step toStep, where step = line * 32 + column,
+     * using the current contents of video memory.
+     */
+    virtual void drawScreen(uint8_t *pTarget, const uint8_t *pVideoMem, uint32_t fromStep, uint32_t toStep,
+                            uint8_t flashMask) const = 0;
+
+    // Fills the display cells from fromCell up to (but excluding) toCell with the given palette colour.
+    virtual void fillCells(uint8_t *pTarget, uint32_t fromCell, uint32_t toCell, uint8_t colour) const = 0;
+
+};
+
+
+template<typename PixelFormat>
+class ZxPixelRenderer : public ZxDisplayRenderer {
+
+public:
+    /*
+     * cellsPerLine is the number of cells in a display line and firstScreenCell the display cell of the top left
+     * screen byte.
+     */
+    ZxPixelRenderer(uint32_t cellsPerLine, uint32_t firstScreenCell)
+            : m_cellsPerLine(cellsPerLine), m_firstScreenCell(firstScreenCell) {
+    }
+
+    [[nodiscard]] uint32_t depth() const override {
+        return PixelFormat::DEPTH;
+    }
+
+    void drawScreen(uint8_t *pTarget, const uint8_t *pVideoMem, uint32_t fromStep, uint32_t toStep,
+                    uint8_t flashMask) const override {
+        for (uint32_t step = fromStep; step < toStep; step++) {
+            uint32_t line = step >> 5;
+            uint32_t column = step & 0x1Fu;
+            uint8_t attr = pVideoMem[0x1800 + ((line >> 3) << 5) + column] & flashMask;
+            uint32_t cell = m_firstScreenCell + line * m_cellsPerLine + column;
+            m_format.drawCell(pTarget + cell * PixelFormat::DEPTH, attr,
+                              pVideoMem[zxScreenAddress.offset[line] + column]);
+        }
+    }
+
+    void fillCells(uint8_t *pTarget, uint32_t fromCell, uint32_t toCell, uint8_t colour) const override {
+        m_format.fillCells(pTarget + fromCell * PixelFormat::DEPTH, toCell - fromCell, colour);
+    }
+
+private:
+    PixelFormat m_format;
+    uint32_t m_cellsPerLine;
+    uint32_t m_firstScreenCell;
+
+};
+
+
+#endif // ZXDISPLAYRENDERER_H
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXFRAMELISTENER_H
+#define ZXRASPBERRY_ZXFRAMELISTENER_H
+
+#include <cstdint>
+
+
+/*
+ * Receives every frame completed by the display, before any UI is drawn on top of it, e.g. to stream or record the
+ * emulator output.  The frame is DISPLAY_WIDTH x DISPLAY_HEIGHT pixels in the native format of the framebuffer and is
+ * only valid for the duration of the call.
+ */
+class ZxFrameListener {
+
+public:
+    virtual ~ZxFrameListener() = default;
+
+    virtual void frameCompleted(const uint8_t *pFrame, uint32_t depth) = 0;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXFRAMELISTENER_H
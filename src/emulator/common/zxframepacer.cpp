@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include "zxframepacer.h"
+
+
+ZxFramePacer::ZxFramePacer(ZxPacingTimer &timer, uint32_t ticksPerSecond, uint32_t tStatesPerFrame,
+                           uint32_t clockFrequency) :
+        m_timer(timer),
+        m_ticksPerSecond(ticksPerSecond),
+        m_clockFrequency(clockFrequency) {
+
+    uint64_t period = static_cast<uint64_t>(tStatesPerFrame) * ticksPerSecond;
+    m_period = static_cast<uint32_t>(period / clockFrequency);
+    m_periodFraction = static_cast<uint32_t>(period % clockFrequency);
+    m_bucketWidth = (m_period >= 64) ? m_period / 64 : 1;
+
+    reset();
+}
+
+
+void ZxFramePacer::reset() {
+
+    m_deadline = m_timer.clockTicks();
+    m_deadlineFraction = 0;
+    m_adjustmentFraction = 0;
+    m_frameStart = m_deadline;
+
+    m_frames = 0;
+    m_framesLate = 0;
+    m_framesDropped = 0;
+    m_resyncs = 0;
+
+    memset(m_histogram, 0, sizeof(m_histogram));
+    m_frameTimeMin = 0;
+    m_frameTimeMax = 0;
+    m_frameTimeTotal = 0;
+
+    m_speedStart = m_deadline;
+    m_speedFrames = 0;
+    m_speedPercent = 0;
+}
+
+
+bool ZxFramePacer::endFrame() {
+
+    uint32_t now = m_timer.clockTicks();
+    record(now - m_frameStart);
+    measureSpeed(now);
+
+    if (m_bTurbo) {
+        // Run the next frame straight away and keep the schedule at the current time
+        m_deadline = now;
+        m_deadlineFraction = 0;
+        m_frameStart = now;
+        return true;
+    }
+
+    m_deadline += m_period;
+    m_deadlineFraction += m_periodFraction;
+    if (m_deadlineFraction >= m_clockFrequency) {
+        m_deadlineFraction -= m_clockFrequency;
+        m_deadline++;
+    }
+
+    // A faster rate brings the deadline forward, in whole ticks, and the rest of the adjustment waits for later frames
+    m_adjustmentFraction += static_cast<int64_t>(m_period) * m_rateAdjustment;
+    auto adjustment = static_cast<int32_t>(m_adjustmentFraction / 1000000);
+    m_adjustmentFraction -= static_cast<int64_t>(adjustment) * 1000000;
+    m_deadline -= static_cast<uint32_t>(adjustment);
+
+    // The difference is taken as a signed value so that the tick counter can wrap around
+    auto late = static_cast<int32_t>(now - m_deadline);
+
+    if (late < 0) {
+        m_timer.waitTicks(static_cast<uint32_t>(-late));
+        m_frameStart = m_deadline;
+        return true;
+    }
+
+    m_framesLate++;
+    m_frameStart = now;
+
+    if (static_cast<uint32_t>(late) > m_period * MAX_CATCH_UP_FRAMES) {
+        // Too far behind to catch up, so carry on from now
+        m_deadline = now;
+        m_deadlineFraction = 0;
+        m_resyncs++;
+        return true;
+    }
+
+    if (static_cast<uint32_t>(late) >= m_period) {
+        m_framesDropped++;
+        return false;
+    }
+
+    return true;
+}
+
+
+void ZxFramePacer::record(uint32_t frameTime) {
+
+    uint32_t bucket = frameTime / m_bucketWidth;
+    m_histogram[(bucket < HISTOGRAM_BUCKETS) ? bucket : HISTOGRAM_BUCKETS - 1]++;
+
+    if (m_frames == 0 || frameTime < m_frameTimeMin) {
+        m_frameTimeMin = frameTime;
+    }
+    if (frameTime > m_frameTimeMax) {
+        m_frameTimeMax = frameTime;
+    }
+    m_frameTimeTotal += frameTime;
+    m_frames++;
+}
+
+
+void ZxFramePacer::measureSpeed(uint32_t now) {
+
+    m_speedFrames++;
+
+    uint32_t elapsed = now - m_speedStart;
+    if (elapsed >= m_ticksPerSecond) {
+        m_speedPercent = static_cast<uint32_t>(static_cast<uint64_t>(m_speedFrames) * m_period * 100 / elapsed);
+        m_speedStart = now;
+        m_speedFrames = 0;
+    }
+}
+
+
+uint32_t ZxFramePacer::frameTimeMin() const {
+
+    return m_frameTimeMin;
+}
+
+
+uint32_t ZxFramePacer::frameTimeMax() const {
+
+    return m_frameTimeMax;
+}
+
+
+uint32_t ZxFramePacer::frameTimeAverage() const {
+
+    return (m_frames > 0) ? static_cast<uint32_t>(m_frameTimeTotal / m_frames) : 0;
+}
+
+
+uint32_t ZxFramePacer::frameTimePercentile(uint32_t percentile) const {
+
+    if (m_frames == 0) {
+        return 0;
+    }
+
+    // Number of frames at or below the percentile, rounded up
+    uint64_t target = (static_cast<uint64_t>(m_frames) * percentile + 99) / 100;
+    uint64_t count = 0;
+    for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS - 1; bucket++) {
+        count += m_histogram[bucket];
+        if (count >= target) {
+            uint32_t upperBound = (bucket + 1) * m_bucketWidth;
+            return (upperBound < m_frameTimeMax) ? upperBound : m_frameTimeMax;
+        }
+    }
+
+    // The last bucket is open ended
+    return m_frameTimeMax;
+}
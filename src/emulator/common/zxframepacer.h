@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXFRAMEPACER_H
+#define ZXFRAMEPACER_H
+
+#include <cstdint>
+
+
+/*
+ * Time source of the frame pacer, e.g. Circle's CTimer on the Raspberry Pi or a fake timer in the unit tests.  The
+ * tick counter is free running and may wrap around.
+ */
+class ZxPacingTimer {
+
+public:
+    virtual ~ZxPacingTimer() = default;
+
+    virtual uint32_t clockTicks() = 0;
+    virtual void waitTicks(uint32_t ticks) = 0;
+
+};
+
+
+/*
+ * Paces the emulation to the frame rate of the emulated machine, e.g. 3500000 / 69888 = 50.08 Hz for the 48K model.
+ *
+ * Every frame has an absolute deadline, one frame period after the previous one, and the fraction of a tick left over
+ * by each period is carried into the next, so the emulation never drifts from the real frame rate however long it
+ * runs.  When a frame finishes early the pacer waits for its deadline.  When it overruns, the pacer does not wait, so
+ * the following frames catch up, and asks the caller not to present frames while it is a whole frame or more behind.
+ * If it falls more than MAX_CATCH_UP_FRAMES behind, e.g. after a debugger break, it gives up catching up and starts
+ * again from the current time.
+ *
+ * The frame rate can be nudged by a few parts per million, e.g. by ZxAudioRateControl to follow the audio clock of the
+ * host rather than the system timer; the deadlines then move by a fraction of the period, which is carried over too.
+ *
+ * In turbo mode the pacer never waits, so the emulation runs as fast as the host allows, and the schedule follows the
+ * current time so that leaving turbo mode does not trigger a catch-up.
+ *
+ * The time that each frame takes to run, from the end of the previous wait to endFrame(), is recorded in a histogram
+ * that covers up to 2 frame periods in steps of 1/64 of a period.  The speed of the emulation relative to the real
+ * machine is measured over windows of about a second.
+ */
+class ZxFramePacer {
+
+public:
+    static const uint32_t MAX_CATCH_UP_FRAMES = 5;
+    static const uint32_t HISTOGRAM_BUCKETS = 128;
+
+    ZxFramePacer(ZxPacingTimer &timer, uint32_t ticksPerSecond, uint32_t tStatesPerFrame, uint32_t clockFrequency);
+
+    // Starts pacing from the current time and clears the statistics
+    void reset();
+
+    /* Called at the end of every emulated frame; waits until the frame is due and returns true if the frame should be
+     * presented or false if it should be dropped to catch up.
+     */
+    bool endFrame();
+
+    void setTurbo(bool turbo) {
+        m_bTurbo = turbo;
+    }
+
+    [[nodiscard]] bool isTurbo() const {
+        return m_bTurbo;
+    }
+
+    // Speeds the frames up (positive) or slows them down (negative) by the given parts per million, from the next one
+    void setRateAdjustment(int32_t adjustment) {
+        m_rateAdjustment = adjustment;
+    }
+
+    [[nodiscard]] int32_t rateAdjustment() const {
+        return m_rateAdjustment;
+    }
+
+    // Emulated time over real time in the last measurement window, in percent, e.g. 100 at full speed
+    [[nodiscard]] uint32_t speedPercent() const {
+        return m_speedPercent;
+    }
+
+    [[nodiscard]] uint32_t framePeriod() const {
+        return m_period;
+    }
+
+    [[nodiscard]] uint32_t frames() const {
+        return m_frames;
+    }
+
+    [[nodiscard]] uint32_t framesLate() const {
+        return m_framesLate;
+    }
+
+    [[nodiscard]] uint32_t framesDropped() const {
+        return m_framesDropped;
+    }
+
+    [[nodiscard]] uint32_t resyncs() const {
+        return m_resyncs;
+    }
+
+    // Frame time statistics in timer ticks
+    [[nodiscard]] uint32_t frameTimeMin() const;
+    [[nodiscard]] uint32_t frameTimeMax() const;
+    [[nodiscard]] uint32_t frameTimeAverage() const;
+    // Upper bound of the histogram bucket that holds the given percentile, e.g. 99
+    [[nodiscard]] uint32_t frameTimePercentile(uint32_t percentile) const;
+
+private:
+    void record(uint32_t frameTime);
+
+    void measureSpeed(uint32_t now);
+
+    ZxPacingTimer &m_timer;
+    uint32_t m_ticksPerSecond;
+    bool m_bTurbo = false;
+
+    // Frame period in whole ticks plus a fraction in units of 1 / m_clockFrequency ticks
+    uint32_t m_period;
+    uint32_t m_periodFraction;
+    uint32_t m_clockFrequency;
+
+    uint32_t m_deadline = 0;
+    uint32_t m_deadlineFraction = 0;
+    // Rate adjustment in parts per million and the part of a tick that it has not yet moved the deadlines by
+    int32_t m_rateAdjustment = 0;
+    int64_t m_adjustmentFraction = 0;
+    uint32_t m_frameStart = 0;
+
+    uint32_t m_frames = 0;
+    uint32_t m_framesLate = 0;
+    uint32_t m_framesDropped = 0;
+    uint32_t m_resyncs = 0;
+
+    uint32_t m_bucketWidth;
+    uint32_t m_histogram[HISTOGRAM_BUCKETS] = { 0 };
+    uint32_t m_frameTimeMin = 0;
+    uint32_t m_frameTimeMax = 0;
+    uint64_t m_frameTimeTotal = 0;
+
+    uint32_t m_speedStart = 0;
+    uint32_t m_speedFrames = 0;
+    uint32_t m_speedPercent = 0;
+};
+
+
+#endif // ZXFRAMEPACER_H
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXINPUTQUEUE_H
+#define ZXINPUTQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include "zxspscring.h"
+
+
+/*
+ * State of the input ports after a change reported by the keyboard or the gamepad, stamped with the time of the report.
+ */
+struct ZxInputEvent {
+    uint32_t timestamp;                  // Host timer ticks
+    uint8_t keyboard[8];                 // Half rows of the keyboard, ports 0xFEFE to 0x7FFE, active low
+    uint8_t kempston;                    // Kempston joystick, port 0x1F, active high
+};
+
+
+/*
+ * Bounded lock-free queue of input events between a single producer, e.g. the USB interrupt handlers, and a single
+ * consumer, the emulation, which applies each event at the T-state matching its timestamp rather than once per frame.
+ *
+ * Each frame is emulated in a burst at the start of its period, so host time is mapped onto the frame one frame late:
+ * startFrame() gives the host time at which the frame starts, and an event that arrived a third of a frame period after
+ * the start of the previous frame is due a third of the way through this one.  Input lags by a frame but keeps its
+ * timing within the frame.  Events that arrive during the burst are due in the next frame, and events that are older
+ * than the previous frame are applied straight away.  The producer drops events while the queue is full.
+ */
+class ZxInputQueue {
+
+public:
+    static const uint32_t CAPACITY = 64;
+    static const uint32_t NO_EVENT = UINT32_MAX;
+
+    ZxInputQueue(uint32_t ticksPerFrame, uint32_t tStatesPerFrame) :
+            m_ticksPerFrame(ticksPerFrame),
+            m_tStatesPerFrame(tStatesPerFrame),
+            m_ring(CAPACITY),
+            m_dropped(0) {
+    }
+
+    ZxInputQueue(const ZxInputQueue &) = delete;
+    ZxInputQueue &operator=(const ZxInputQueue &) = delete;
+
+    // Producer side; returns false, dropping the event, if the queue is full
+    bool push(const ZxInputEvent &event) {
+        ZxInputEvent *pSlot = m_ring.back();
+        if (pSlot == nullptr) {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        *pSlot = event;
+        m_ring.push();
+        return true;
+    }
+
+    // Consumer side
+    void startFrame(uint32_t frameStart) {
+        m_previousStart = m_bStarted ? m_frameStart : frameStart - m_ticksPerFrame;
+        m_frameStart = frameStart;
+        m_bStarted = true;
+    }
+
+    // T-state of the current frame at which the oldest event is due, or NO_EVENT if the queue is empty
+    [[nodiscard]] uint32_t nextTstates() const {
+        const ZxInputEvent *pEvent = m_ring.front();
+        if (pEvent == nullptr) {
+            return NO_EVENT;
+        }
+        uint32_t timestamp = pEvent->timestamp;
+        auto offset = static_cast<int32_t>(timestamp - m_previousStart);
+        if (offset <= 0) {
+            return 0;
+        }
+        uint64_t tstates = static_cast<uint64_t>(offset) * m_tStatesPerFrame / m_ticksPerFrame;
+        // The previous frame may have lasted longer than a period, but what happened during it is due in this frame
+        if (static_cast<int32_t>(timestamp - m_frameStart) < 0 && tstates >= m_tStatesPerFrame) {
+            return m_tStatesPerFrame - 1;
+        }
+        return (tstates < NO_EVENT) ? static_cast<uint32_t>(tstates) : NO_EVENT - 1;
+    }
+
+    bool pop(ZxInputEvent &event) {
+        const ZxInputEvent *pEvent = m_ring.front();
+        if (pEvent == nullptr) {
+            return false;
+        }
+        event = *pEvent;
+        m_ring.pop();
+        return true;
+    }
+
+    [[nodiscard]] uint32_t dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    const uint32_t m_ticksPerFrame;
+    const uint32_t m_tStatesPerFrame;
+    uint32_t m_frameStart = 0;
+    uint32_t m_previousStart = 0;
+    bool m_bStarted = false;
+    ZxSpscRing<ZxInputEvent> m_ring;
+    std::atomic<uint32_t> m_dropped;
+
+};
+
+
+#endif // ZXINPUTQUEUE_H
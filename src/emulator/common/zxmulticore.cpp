@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cassert>
+#include <circle/timer.h>
+#include "zxmulticore.h"
+
+#ifdef ARM_ALLOW_MULTI_CORE
+
+
+ZxMultiCore::ZxMultiCore(CMemorySystem *pMemorySystem) :
+        CMultiCoreSupport(pMemorySystem),
+        m_pTasks{},
+        m_bStop(false),
+        m_running(CORES - 1),
+        m_bStarted(false) {
+}
+
+
+ZxMultiCore::~ZxMultiCore() {
+
+    stop();
+}
+
+
+void ZxMultiCore::assign(unsigned nCore, ZxCoreTask *pTask) {
+
+    assert(nCore > 0 && nCore < CORES);
+    assert(!m_bStarted);
+    m_pTasks[nCore] = pTask;
+}
+
+
+bool ZxMultiCore::start() {
+
+    m_bStarted = Initialize();
+    return m_bStarted;
+}
+
+
+void ZxMultiCore::stop() {
+
+    m_bStop = true;
+
+    if (m_bStarted) {
+        while (m_running > 0) {
+            CTimer::SimpleusDelay(IDLE_DELAY);
+        }
+        m_bStarted = false;
+    }
+}
+
+
+void ZxMultiCore::Run(unsigned nCore) {
+
+    ZxCoreTask *pTask = m_pTasks[nCore];
+
+    while (pTask != nullptr && !m_bStop) {
+        if (!pTask->step()) {
+            CTimer::SimpleusDelay(IDLE_DELAY);
+        }
+    }
+
+    m_running--;
+}
+
+#endif // ARM_ALLOW_MULTI_CORE
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXMULTICORE_H
+#define ZXMULTICORE_H
+
+#include <atomic>
+#include <circle/multicore.h>
+
+/*
+ * Work that a secondary core runs over and over again, one slice at a time.
+ */
+class ZxCoreTask {
+
+public:
+    virtual ~ZxCoreTask() = default;
+
+    // Does the next slice of work, returning false if there was nothing to do
+    virtual bool step() = 0;
+
+};
+
+
+#ifdef ARM_ALLOW_MULTI_CORE
+
+/*
+ * Runs a task on each of the secondary cores of the Raspberry Pi 2 and later, or on a thread per core on the desktop,
+ * leaving core 0 to the emulation.  A core with nothing to do waits IDLE_DELAY microseconds before trying again, which
+ * bounds the latency of its task without keeping the core (or the host) busy.  Cores without a task stop straight away.
+ */
+class ZxMultiCore : public CMultiCoreSupport {
+
+public:
+    static const unsigned IDLE_DELAY = 100;
+
+    explicit ZxMultiCore(CMemorySystem *pMemorySystem);
+    ~ZxMultiCore() override;
+
+    ZxMultiCore(const ZxMultiCore &) = delete;
+    ZxMultiCore &operator=(const ZxMultiCore &) = delete;
+
+    // Assigns a task to one of the secondary cores, i.e. 1 to CORES - 1, before the cores are started
+    void assign(unsigned nCore, ZxCoreTask *pTask);
+
+    bool start();
+    // Asks the tasks to finish and waits until every secondary core has stopped
+    void stop();
+
+    void Run(unsigned nCore) override;
+
+private:
+    ZxCoreTask *m_pTasks[CORES];
+    std::atomic<bool> m_bStop;
+    std::atomic<unsigned> m_running;
+    bool m_bStarted;
+};
+
+#endif // ARM_ALLOW_MULTI_CORE
+
+#endif // ZXMULTICORE_H
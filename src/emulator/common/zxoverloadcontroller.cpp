@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "zxoverloadcontroller.h"
+
+
+ZxOverloadController::ZxOverloadController(ZxPacingTimer &timer, uint32_t framePeriod) :
+        m_timer(timer),
+        m_period(framePeriod) {
+
+    reset();
+}
+
+
+void ZxOverloadController::reset() {
+
+    m_level = Level::Full;
+    m_bRender = true;
+
+    m_windowFrames = 0;
+    m_windowRenders = 0;
+    m_windowEmulation = 0;
+    m_windowRender = 0;
+    m_emulationCost = 0;
+    m_renderCost = 0;
+
+    m_frames = 0;
+    m_degradations = 0;
+    m_recoveries = 0;
+    m_bordersSkipped = 0;
+    m_rendersSkipped = 0;
+}
+
+
+uint32_t ZxOverloadController::renderInterval(Level level) {
+
+    switch (level) {
+        case Level::SkipAlternateRender:
+            return 2;
+        case Level::SkipPresent:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+
+void ZxOverloadController::beginFrame() {
+
+    m_frameStart = m_timer.clockTicks();
+
+    m_bRender = (m_frames % renderInterval(m_level)) == 0;
+
+    if (!drawBorder()) {
+        m_bordersSkipped++;
+    }
+    if (!m_bRender) {
+        m_rendersSkipped++;
+    }
+}
+
+
+void ZxOverloadController::emulationDone() {
+
+    m_renderStart = m_timer.clockTicks();
+}
+
+
+void ZxOverloadController::endFrame() {
+
+    uint32_t now = m_timer.clockTicks();
+
+    m_windowEmulation += m_renderStart - m_frameStart;
+    if (m_bRender) {
+        m_windowRender += now - m_renderStart;
+        m_windowRenders++;
+    }
+    m_frames++;
+
+    if (++m_windowFrames == WINDOW_FRAMES) {
+        endWindow();
+    }
+}
+
+
+void ZxOverloadController::endWindow() {
+
+    m_emulationCost = static_cast<uint32_t>(m_windowEmulation / m_windowFrames);
+    m_renderCost = (m_windowRenders > 0) ? static_cast<uint32_t>(m_windowRender / m_windowRenders) : 0;
+
+    uint64_t budget = static_cast<uint64_t>(m_period) * m_windowFrames;
+    uint64_t cost = m_windowEmulation + m_windowRender;
+
+    if (cost * 100 > budget * OVERLOAD_PERCENT) {
+        if (m_level != Level::SkipPresent) {
+            m_level = static_cast<Level>(static_cast<uint8_t>(m_level) + 1);
+            m_degradations++;
+        }
+    } else if (m_level != Level::Full) {
+        // Cost of an average frame one level up, where a larger share of the frames is drawn
+        auto up = static_cast<Level>(static_cast<uint8_t>(m_level) - 1);
+        uint64_t predicted = m_emulationCost + m_renderCost / renderInterval(up);
+        if (predicted * 100 < static_cast<uint64_t>(m_period) * RECOVERY_PERCENT) {
+            m_level = up;
+            m_recoveries++;
+        }
+    }
+
+    m_windowFrames = 0;
+    m_windowRenders = 0;
+    m_windowEmulation = 0;
+    m_windowRender = 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXOVERLOADCONTROLLER_H
+#define ZXOVERLOADCONTROLLER_H
+
+#include <cstdint>
+#include "zxframepacer.h"
+
+
+/*
+ * Keeps the emulation at full speed on hosts that cannot emulate and draw every frame within the frame period, e.g. a
+ * Raspberry Pi Zero or 1 running a game with heavy border effects, by giving up on parts of the drawing in steps:
+ *
+ *      Full:                every frame is drawn and presented
+ *      SkipBorder:          the border is no longer redrawn, so it keeps whatever the frame buffer last held
+ *      SkipAlternateRender: as above, and only every other frame is drawn
+ *      SkipPresent:         as above, and only one frame in four is drawn and presented
+ *
+ * The cost of emulating and drawing each frame is measured over windows of WINDOW_FRAMES frames.  When a window
+ * averages more than OVERLOAD_PERCENT of the frame period, the controller moves one level down the ladder.  It moves
+ * back up when the cost predicted for the level above, from the emulation cost and the cost of each drawn frame,
+ * stays under RECOVERY_PERCENT of the period, which leaves enough headroom not to bounce between two levels.
+ */
+class ZxOverloadController {
+
+public:
+    enum class Level : uint8_t {
+        Full,
+        SkipBorder,
+        SkipAlternateRender,
+        SkipPresent
+    };
+
+    static const uint32_t WINDOW_FRAMES = 25;
+    static const uint32_t OVERLOAD_PERCENT = 95;
+    static const uint32_t RECOVERY_PERCENT = 80;
+
+    ZxOverloadController(ZxPacingTimer &timer, uint32_t framePeriod);
+
+    // Goes back to the top of the ladder and clears the counters
+    void reset();
+
+    /* Called before emulating each frame; decides whether the frame draws its border and whether it is drawn at all.
+     * Frames that are not drawn are not presented either.
+     */
+    void beginFrame();
+    // Called once the frame has been emulated, before it is drawn
+    void emulationDone();
+    // Called once the frame has been drawn and presented; moves up or down the ladder at the end of each window
+    void endFrame();
+
+    [[nodiscard]] bool drawBorder() const {
+        return m_level == Level::Full;
+    }
+
+    [[nodiscard]] bool renderFrame() const {
+        return m_bRender;
+    }
+
+    [[nodiscard]] Level level() const {
+        return m_level;
+    }
+
+    [[nodiscard]] uint32_t frames() const {
+        return m_frames;
+    }
+
+    // Windows in which the frames went over budget, i.e. the number of times the controller moved down the ladder
+    [[nodiscard]] uint32_t degradations() const {
+        return m_degradations;
+    }
+
+    [[nodiscard]] uint32_t recoveries() const {
+        return m_recoveries;
+    }
+
+    [[nodiscard]] uint32_t bordersSkipped() const {
+        return m_bordersSkipped;
+    }
+
+    [[nodiscard]] uint32_t rendersSkipped() const {
+        return m_rendersSkipped;
+    }
+
+    // Average costs in the last complete window, in timer ticks
+    [[nodiscard]] uint32_t emulationCost() const {
+        return m_emulationCost;
+    }
+
+    [[nodiscard]] uint32_t renderCost() const {
+        return m_renderCost;
+    }
+
+private:
+    // One frame in this many is drawn at the given level
+    static uint32_t renderInterval(Level level);
+
+    void endWindow();
+
+    ZxPacingTimer &m_timer;
+    uint32_t m_period;
+
+    Level m_level = Level::Full;
+    bool m_bRender = true;
+
+    uint32_t m_frameStart = 0;
+    uint32_t m_renderStart = 0;
+
+    // Totals for the current window
+    uint32_t m_windowFrames = 0;
+    uint32_t m_windowRenders = 0;
+    uint64_t m_windowEmulation = 0;
+    uint64_t m_windowRender = 0;
+
+    uint32_t m_emulationCost = 0;
+    uint32_t m_renderCost = 0;
+
+    uint32_t m_frames = 0;
+    uint32_t m_degradations = 0;
+    uint32_t m_recoveries = 0;
+    uint32_t m_bordersSkipped = 0;
+    uint32_t m_rendersSkipped = 0;
+};
+
+
+#endif // ZXOVERLOADCONTROLLER_H
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "zxrenderpipeline.h"
+
+
+ZxRenderPipeline::ZxRenderPipeline(ZxDisplay &display) :
+        m_display(display),
+        m_pSnapshots(new ZxDisplay::FrameSnapshot[ZxTripleBuffer::BUFFERS]) {
+
+    m_display.setRenderMode(ZxDisplay::RenderMode::Deferred);
+}
+
+
+ZxRenderPipeline::~ZxRenderPipeline() {
+
+    delete[] m_pSnapshots;
+}
+
+
+void ZxRenderPipeline::capture(bool flash) {
+
+    m_display.capture(m_pSnapshots[m_snapshots.back()], flash);
+    m_snapshots.publish();
+}
+
+
+bool ZxRenderPipeline::step() {
+
+    if (!m_snapshots.take()) {
+        return false;
+    }
+
+    m_display.render(m_pSnapshots[m_snapshots.front()]);
+    return true;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRENDERPIPELINE_H
+#define ZXRENDERPIPELINE_H
+
+#include <cstdint>
+#include "zxdisplay.h"
+#include "zxmulticore.h"
+#include "zxtriplebuffer.h"
+
+
+/*
+ * Moves the drawing of the display off the emulation core.  When a frame ends, the emulation core calls capture(),
+ * which takes a snapshot of the video memory and of the border changes made during the frame, and the rendering core
+ * calls step() over and over again, which draws the latest snapshot into the display and hands it over to present().
+ *
+ * The snapshots go through their own ZxTripleBuffer, so neither side ever waits for the other: if the renderer falls
+ * behind, it skips straight to the latest frame.  The display is switched to deferred rendering, which means that
+ * changes to the video memory in the middle of a frame (e.g. multicolour effects) are drawn as they are when the frame
+ * ends.
+ */
+class ZxRenderPipeline : public ZxCoreTask {
+
+public:
+    explicit ZxRenderPipeline(ZxDisplay &display);
+    ~ZxRenderPipeline() override;
+
+    ZxRenderPipeline(const ZxRenderPipeline &) = delete;
+    ZxRenderPipeline &operator=(const ZxRenderPipeline &) = delete;
+
+    // Emulation side
+    void capture(bool flash);
+
+    // Rendering side; returns false if there was no new frame to draw
+    bool step() override;
+
+private:
+    ZxDisplay &m_display;
+    ZxDisplay::FrameSnapshot *m_pSnapshots;
+    ZxTripleBuffer m_snapshots;
+};
+
+
+#endif // ZXRENDERPIPELINE_H
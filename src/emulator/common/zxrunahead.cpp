@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "zxrunahead.h"
+#include "clock.h"
+#include "zxdisplay.h"
+#include "hardware/zxhardwaremodel.h"
+
+
+ZxRunAhead::ZxRunAhead(Z80emu &z80emu, ZxHardwareModel &model, ZxPacingTimer &timer, uint32_t framePeriod) :
+        m_z80emu(z80emu),
+        m_model(model),
+        m_timer(timer),
+        m_period(framePeriod),
+        m_pState(new Z80emu::MachineState()) {
+}
+
+
+ZxRunAhead::~ZxRunAhead() {
+
+    delete m_pState;
+}
+
+
+void ZxRunAhead::setFrames(uint32_t frames) {
+
+    m_frames = (frames < MAX_FRAMES) ? frames : MAX_FRAMES;
+}
+
+
+void ZxRunAhead::emulateFrame() {
+
+    m_z80emu.execute(m_model.tStatesPerScreenFrame());
+    Clock::getInstance().endFrame();
+}
+
+
+void ZxRunAhead::runFrame(ZxDisplay &display) {
+
+    // Emulating the frames ahead and drawing the last one has to fit in the frame period, with some headroom
+    uint64_t cost = static_cast<uint64_t>(m_frameCost) * (m_frames + 1) + m_renderCost;
+    uint32_t limit = m_bActive ? DISABLE_PERCENT : ENABLE_PERCENT;
+    m_bActive = m_bEnabled && m_frames > 0 && cost * 100 <= static_cast<uint64_t>(m_period) * limit;
+
+    uint32_t start = m_timer.clockTicks();
+    emulateFrame();
+    uint32_t frameCost = m_timer.clockTicks() - start;
+    m_frameCost = (m_frameCost == 0) ? frameCost : (m_frameCost * 7 + frameCost) / 8;
+
+    m_bRewind = m_bActive;
+    if (!m_bActive) {
+        return;
+    }
+
+    // Nobody sees the real frame, only the last one emulated ahead of it
+    display.skip();
+    m_z80emu.saveState(*m_pState);
+
+    /* Everybody hears the real frame, though: the frames ahead are heard once the real machine gets to them.  The sound
+     * only comes back on after the rewind, so that it carries on from the registers of the real machine.
+     */
+    m_bSilent = m_z80emu.isSilent();
+    m_z80emu.setSilent(true);
+    for (uint32_t frame = 0; frame < m_frames; frame++) {
+        if (frame > 0) {
+            display.skip();
+        }
+        emulateFrame();
+        m_framesAhead++;
+    }
+}
+
+
+void ZxRunAhead::rewind() {
+
+    if (m_bRewind) {
+        m_z80emu.restoreState(*m_pState);
+        m_z80emu.setSilent(m_bSilent);
+        m_bRewind = false;
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRUNAHEAD_H
+#define ZXRUNAHEAD_H
+
+#include <cstdint>
+#include "Z80emu.h"
+#include "zxframepacer.h"
+
+class ZxDisplay;
+class ZxHardwareModel;
+
+
+/*
+ * Cuts the input lag by showing a frame from the near future.  Input is sampled once per frame and the frame is drawn
+ * after it has been emulated, so a key press only shows on screen one or two frames later.  With run-ahead, each frame
+ * of the real machine is emulated without drawing it, the machine state is saved, and the given number of frames is
+ * emulated ahead with the same input.  The last of these is drawn and presented, and the state is then restored so
+ * the real machine carries on from where it was.
+ *
+ * Run-ahead costs one extra frame of emulation per frame ahead, so it only runs while the host has the headroom: the
+ * cost of emulating a frame of the real machine is measured every frame and run-ahead stops when the frames ahead plus
+ * drawing would take more than DISABLE_PERCENT of the frame period, and starts again under ENABLE_PERCENT.
+ */
+class ZxRunAhead {
+
+public:
+    static const uint32_t MAX_FRAMES = 4;
+    static const uint32_t ENABLE_PERCENT = 75;
+    static const uint32_t DISABLE_PERCENT = 90;
+
+    ZxRunAhead(Z80emu &z80emu, ZxHardwareModel &model, ZxPacingTimer &timer, uint32_t framePeriod);
+    ~ZxRunAhead();
+
+    // Number of frames to run ahead, 0 (the default) to turn run-ahead off
+    void setFrames(uint32_t frames);
+
+    [[nodiscard]] uint32_t frames() const {
+        return m_frames;
+    }
+
+    // Allows run-ahead, e.g. unless the emulation is already struggling or running in turbo mode
+    void setEnabled(bool enabled) {
+        m_bEnabled = enabled;
+    }
+
+    // Time taken to draw a frame, which has to fit in the frame period along with the frames ahead
+    void setRenderCost(uint32_t renderCost) {
+        m_renderCost = renderCost;
+    }
+
+    /* Emulates the next frame of the real machine and, while run-ahead is active, the frames ahead of it.  The frame
+     * left to draw is the last one emulated; call rewind() once it has been drawn.
+     */
+    void runFrame(ZxDisplay &display);
+    // Goes back to the end of the real frame if the last call to runFrame() ran ahead
+    void rewind();
+
+    [[nodiscard]] bool isActive() const {
+        return m_bActive;
+    }
+
+    // Average time taken to emulate a frame of the real machine, in timer ticks
+    [[nodiscard]] uint32_t frameCost() const {
+        return m_frameCost;
+    }
+
+    [[nodiscard]] uint32_t framesAhead() const {
+        return m_framesAhead;
+    }
+
+private:
+    void emulateFrame();
+
+    Z80emu &m_z80emu;
+    ZxHardwareModel &m_model;
+    ZxPacingTimer &m_timer;
+    uint32_t m_period;
+    Z80emu::MachineState *m_pState;
+
+    uint32_t m_frames = 0;
+    bool m_bEnabled = true;
+    bool m_bActive = false;
+    bool m_bRewind = false;
+    // Whether the machine was silent before running ahead
+    bool m_bSilent = false;
+    uint32_t m_renderCost = 0;
+    uint32_t m_frameCost = 0;
+    // Frames emulated ahead of the real machine since start-up
+    uint32_t m_framesAhead = 0;
+};
+
+
+#endif // ZXRUNAHEAD_H
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <circle/logger.h>
+#include "zxscheduler.h"
+
+static const char msgFromScheduler[] = "[Events ]";
+
+
+bool ZxScheduler::schedule(ZxEventHandler *pHandler, uint32_t event, uint64_t tstates, bool reserved) {
+
+    uint32_t index = find(pHandler, event);
+    if (index < m_size) {
+        remove(index);
+    } else if (m_size >= (reserved ? CAPACITY : CAPACITY - RESERVED)) {
+        // Only the first one is logged, as a device that overflows the scheduler is likely to do so again and again
+        if (m_dropped++ == 0) {
+            CLogger::Get()->Write(msgFromScheduler, LogError, "Scheduler full: event %u dropped", event);
+        }
+        return false;
+    }
+
+    index = m_size++;
+    m_events[index] = { tstates, m_sequence++, event, pHandler };
+    siftUp(index);
+    return true;
+}
+
+
+void ZxScheduler::cancel(ZxEventHandler *pHandler, uint32_t event) {
+
+    uint32_t index = find(pHandler, event);
+    if (index < m_size) {
+        remove(index);
+    }
+}
+
+
+void ZxScheduler::runUntil(uint64_t tstates) {
+
+    while (m_size > 0 && m_events[0].deadline <= tstates) {
+        Entry entry = m_events[0];
+        remove(0);
+        entry.pHandler->handleEvent(entry.event, entry.deadline);
+    }
+}
+
+
+/*
+ * Returns the index of the pending event in the heap, or m_size if it is not pending.  There are only a handful of
+ * events, so a linear search is cheaper than keeping an index.
+ */
+uint32_t ZxScheduler::find(const ZxEventHandler *pHandler, uint32_t event) const {
+
+    uint32_t index = 0;
+    while (index < m_size && (m_events[index].pHandler != pHandler || m_events[index].event != event)) {
+        index++;
+    }
+    return index;
+}
+
+
+void ZxScheduler::remove(uint32_t index) {
+
+    m_size--;
+    if (index == m_size) {
+        return;
+    }
+
+    // Fill the gap with the last entry and move it up or down to its place
+    m_events[index] = m_events[m_size];
+    if (index > 0 && before(m_events[index], m_events[(index - 1) / 2])) {
+        siftUp(index);
+    } else {
+        siftDown(index);
+    }
+}
+
+
+void ZxScheduler::siftUp(uint32_t index) {
+
+    Entry entry = m_events[index];
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (!before(entry, m_events[parent])) {
+            break;
+        }
+        m_events[index] = m_events[parent];
+        index = parent;
+    }
+    m_events[index] = entry;
+}
+
+
+void ZxScheduler::siftDown(uint32_t index) {
+
+    Entry entry = m_events[index];
+    for (;;) {
+        uint32_t child = index * 2 + 1;
+        if (child >= m_size) {
+            break;
+        }
+        if (child + 1 < m_size && before(m_events[child + 1], m_events[child])) {
+            child++;
+        }
+        if (!before(m_events[child], entry)) {
+            break;
+        }
+        m_events[index] = m_events[child];
+        index = child;
+    }
+    m_events[index] = entry;
+}
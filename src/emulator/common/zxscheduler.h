@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXSCHEDULER_H
+#define ZXSCHEDULER_H
+
+#include <cstdint>
+
+
+/*
+ * Receives the events scheduled for it, e.g. the start of the ULA interrupt or the end of a frame.  The handler tells
+ * its events apart by the identifier it scheduled them with.
+ */
+class ZxEventHandler {
+
+public:
+    virtual ~ZxEventHandler() = default;
+
+    // The T-state is the deadline that the event was scheduled for, which execution may have gone past by a few T-states
+    virtual void handleEvent(uint32_t event, uint64_t tstates) = 0;
+
+};
+
+
+/*
+ * Keeps the timed events of the emulated machine in order of their deadline, in absolute T-states since the machine
+ * was started, so that the CPU can run flat out until the next one is due rather than polling every device after each
+ * instruction.  New timed devices only have to schedule their events.
+ *
+ * Each handler has at most one pending deadline per event identifier: scheduling an event that is already pending
+ * moves it.  Events that fall due at the same T-state are handled in the order they were scheduled.  Handlers may
+ * schedule further events, e.g. the next occurrence of a periodic one, while they handle an event.
+ *
+ * The events are kept in a binary min-heap of fixed size, so scheduling never allocates memory and the whole queue can
+ * be copied with the rest of the machine state.  A new event that does not fit is dropped, logged and counted rather
+ * than written past the heap, so a device that schedules too many events cannot corrupt the machine.  The last RESERVED
+ * slots are kept for reserved events, e.g. the end of the frame, which devices cannot crowd out.
+ */
+class ZxScheduler {
+
+public:
+    static const uint32_t CAPACITY = 16;
+    static const uint32_t RESERVED = 4;
+    static const uint64_t NO_EVENT = UINT64_MAX;
+
+    /* Schedules the event for the given absolute T-state, replacing its pending deadline if it has one.  Returns false,
+     * dropping the event, if it is not pending and the scheduler is full, which for events that are not reserved means
+     * that only the reserved slots are left.
+     */
+    bool schedule(ZxEventHandler *pHandler, uint32_t event, uint64_t tstates, bool reserved = false);
+
+    // Drops the pending deadline of the event, if it has one
+    void cancel(ZxEventHandler *pHandler, uint32_t event);
+
+    void clear() {
+        m_size = 0;
+    }
+
+    // Handles, in order, every event that is due by the given T-state, including those scheduled on the way
+    void runUntil(uint64_t tstates);
+
+    // Absolute T-state of the next deadline, or NO_EVENT if nothing is scheduled
+    [[nodiscard]] uint64_t nextDeadline() const {
+        return (m_size > 0) ? m_events[0].deadline : NO_EVENT;
+    }
+
+    [[nodiscard]] bool isScheduled(const ZxEventHandler *pHandler, uint32_t event) const {
+        return find(pHandler, event) < m_size;
+    }
+
+    [[nodiscard]] uint32_t size() const {
+        return m_size;
+    }
+
+    [[nodiscard]] uint32_t dropped() const {
+        return m_dropped;
+    }
+
+private:
+    struct Entry {
+        uint64_t deadline;
+        uint32_t sequence;
+        uint32_t event;
+        ZxEventHandler *pHandler;
+    };
+
+    [[nodiscard]] static bool before(const Entry &a, const Entry &b) {
+        // The sequence number breaks ties and is compared as a signed difference so that it can wrap around
+        return a.deadline < b.deadline ||
+               (a.deadline == b.deadline && static_cast<int32_t>(a.sequence - b.sequence) < 0);
+    }
+
+    [[nodiscard]] uint32_t find(const ZxEventHandler *pHandler, uint32_t event) const;
+    void remove(uint32_t index);
+    void siftUp(uint32_t index);
+    void siftDown(uint32_t index);
+
+    Entry m_events[CAPACITY] = {};
+    uint32_t m_size = 0;
+    uint32_t m_sequence = 0;
+    uint32_t m_dropped = 0;
+
+};
+
+
+#endif // ZXSCHEDULER_H
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXSPSCRING_H
+#define ZXRASPBERRY_ZXSPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+
+/*
+ * Bounded lock-free ring between a single producer and a single consumer, which never wait for each other: the producer
+ * finds the ring full or the consumer finds it empty and each decides what to do about it.  The items are allocated up
+ * front, so either side can fill or read a slot in place (back() and push(), front() and pop()) or copy several items at
+ * once (write() and read()).
+ */
+template<typename T>
+class ZxSpscRing {
+
+public:
+    // The capacity is rounded up to a power of two
+    explicit ZxSpscRing(uint32_t capacity) :
+            m_capacity(roundUp(capacity)),
+            m_pItems(new T[m_capacity]()) {
+    }
+
+    ~ZxSpscRing() {
+        delete[] m_pItems;
+    }
+
+    ZxSpscRing(const ZxSpscRing &) = delete;
+    ZxSpscRing &operator=(const ZxSpscRing &) = delete;
+
+    // Producer side; the slot to fill next, or nullptr if the ring is full
+    T *back() {
+        uint32_t tail = m_tail.value.load(std::memory_order_relaxed);
+        bool full = (tail - m_head.value.load(std::memory_order_acquire)) == m_capacity;
+        return full ? nullptr : &m_pItems[tail & (m_capacity - 1)];
+    }
+
+    // Hands the slot returned by back() over to the consumer
+    void push() {
+        m_tail.value.store(m_tail.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Returns the number of items written, which is less than asked for if the ring fills up
+    uint32_t write(const T *pItems, uint32_t count) {
+        uint32_t tail = m_tail.value.load(std::memory_order_relaxed);
+        uint32_t space = m_capacity - (tail - m_head.value.load(std::memory_order_acquire));
+        count = (count < space) ? count : space;
+        // The items wrap around the end of the ring
+        uint32_t offset = tail & (m_capacity - 1);
+        uint32_t first = (count < m_capacity - offset) ? count : m_capacity - offset;
+        std::copy(pItems, pItems + first, m_pItems + offset);
+        std::copy(pItems + first, pItems + count, m_pItems);
+        m_tail.value.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side; the oldest item, or nullptr if the ring is empty
+    T *front() {
+        uint32_t head = m_head.value.load(std::memory_order_relaxed);
+        bool empty = head == m_tail.value.load(std::memory_order_acquire);
+        return empty ? nullptr : &m_pItems[head & (m_capacity - 1)];
+    }
+
+    [[nodiscard]] const T *front() const {
+        return const_cast<ZxSpscRing *>(this)->front();
+    }
+
+    // Gives the slot returned by front() back to the producer
+    void pop() {
+        m_head.value.store(m_head.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Returns the number of items read, which is less than asked for if the ring runs dry
+    uint32_t read(T *pItems, uint32_t count) {
+        uint32_t head = m_head.value.load(std::memory_order_relaxed);
+        uint32_t available = m_tail.value.load(std::memory_order_acquire) - head;
+        count = (count < available) ? count : available;
+        uint32_t offset = head & (m_capacity - 1);
+        uint32_t first = (count < m_capacity - offset) ? count : m_capacity - offset;
+        std::copy(m_pItems + offset, m_pItems + offset + first, pItems);
+        std::copy(m_pItems, m_pItems + count - first, pItems + first);
+        m_head.value.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Items waiting to be read
+    [[nodiscard]] uint32_t available() const {
+        return m_tail.value.load(std::memory_order_acquire) - m_head.value.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] uint32_t capacity() const {
+        return m_capacity;
+    }
+
+    // Every slot in storage order, regardless of the indexes, to set the slots up before the ring is used
+    T &slot(uint32_t index) {
+        return m_pItems[index];
+    }
+
+private:
+    static uint32_t roundUp(uint32_t capacity) {
+        uint32_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    static const uint32_t CACHE_LINE = 64;
+
+    struct Index {
+        std::atomic<uint32_t> value{0};
+        uint8_t padding[CACHE_LINE - sizeof(std::atomic<uint32_t>)];
+    };
+
+    /* The indexes only ever increase (wrapping around).  Each one is written by one side only, so they come first and
+     * are padded out to a cache line each: they are then a cache line apart from each other and from the fields that
+     * both sides read, without over-aligning the ring, which would need the C++17 aligned operator new that the bare
+     * metal runtime does not provide.
+     */
+    Index m_head;
+    Index m_tail;
+    const uint32_t m_capacity;
+    T *m_pItems;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXSPSCRING_H
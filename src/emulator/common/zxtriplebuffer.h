@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXTRIPLEBUFFER_H
+#define ZXTRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Lock-free triple buffer index hand-off between a producer, which renders frames, and a consumer, which presents them.
+ *
+ * Each side owns one of the three buffers (the back buffer and the front buffer) and the third one is in the middle.
+ * The producer publishes a complete frame by swapping its back buffer with the middle one, so it always has a free
+ * buffer to render the next frame into.  The consumer takes the latest complete frame, if there is a new one, by
+ * swapping its front buffer with the middle one.  Each swap is a single atomic exchange, so neither side ever copies a
+ * frame or waits for the other; a frame that is published before the previous one has been taken simply replaces it.
+ */
+class ZxTripleBuffer {
+
+public:
+    static const uint32_t BUFFERS = 3;
+
+    // Buffer index of the producer
+    [[nodiscard]] uint32_t back() const {
+        return m_back;
+    }
+
+    // Buffer index of the consumer
+    [[nodiscard]] uint32_t front() const {
+        return m_front;
+    }
+
+    // Producer side: hands the back buffer over as the latest frame and returns the new back buffer
+    uint32_t publish() {
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+        return m_back;
+    }
+
+    // Consumer side: makes the latest frame the front buffer; returns false, keeping the front buffer, if there is none
+    bool take() {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+private:
+    // The middle buffer index is tagged with this bit when it holds a frame that has not been taken yet
+    static const uint32_t FRESH = 0x4u;
+    static const uint32_t INDEX = 0x3u;
+
+    /* m_back is only used by the producer and m_front by the consumer.  They are not padded out to separate cache
+     * lines, since there are only two swaps per frame and over-aligned objects need the C++17 aligned operator new,
+     * which the bare metal runtime does not provide.
+     */
+    uint32_t m_back = 0;
+    std::atomic<uint32_t> m_middle{1};
+    uint32_t m_front = 2;
+
+};
+
+#endif // ZXTRIPLEBUFFER_H
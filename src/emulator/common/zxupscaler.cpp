@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cassert>
+#include <cstring>
+#include "zxupscaler.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ZX_UPSCALER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ZX_UPSCALER_NEON 1
+#endif
+
+
+// Average of each byte of a and b, rounding up like the SSE2 and NEON byte averages
+static inline uint32_t average(uint32_t a, uint32_t b) {
+    return (a | b) - (((a ^ b) >> 1) & 0x7F7F7F7Fu);
+}
+
+static inline uint32_t blur(uint32_t left, uint32_t pixel, uint32_t right) {
+    return average(pixel, average(left, right));
+}
+
+// Scales the red, green and blue components by brightness / 256, keeping the top byte
+static inline uint32_t darken(uint32_t pixel, uint32_t brightness) {
+    return (((pixel & 0x00FF00FFu) * brightness >> 8) & 0x00FF00FFu) |
+           (((pixel & 0x0000FF00u) * brightness >> 8) & 0x0000FF00u) | (pixel & 0xFF000000u);
+}
+
+
+static void blurLine(const uint32_t *pSource, uint32_t *pTarget, uint32_t width) {
+    pTarget[0] = blur(pSource[0], pSource[0], pSource[width > 1 ? 1 : 0]);
+    for (uint32_t x = 1; x + 1 < width; x++) {
+        pTarget[x] = blur(pSource[x - 1], pSource[x], pSource[x + 1]);
+    }
+    if (width > 1) {
+        pTarget[width - 1] = blur(pSource[width - 2], pSource[width - 1], pSource[width - 1]);
+    }
+}
+
+static void expandLine(const uint32_t *pSource, uint32_t *pTarget, uint32_t width, uint32_t scale) {
+    for (uint32_t x = 0; x < width; x++) {
+        for (uint32_t i = 0; i < scale; i++) {
+            *pTarget++ = pSource[x];
+        }
+    }
+}
+
+static void darkenLine(const uint32_t *pSource, uint32_t *pTarget, uint32_t width, uint32_t brightness) {
+    for (uint32_t x = 0; x < width; x++) {
+        pTarget[x] = darken(pSource[x], brightness);
+    }
+}
+
+
+#if ZX_UPSCALER_SSE2
+
+static void blurLineVectorised(const uint32_t *pSource, uint32_t *pTarget, uint32_t width) {
+    pTarget[0] = blur(pSource[0], pSource[0], pSource[width > 1 ? 1 : 0]);
+    uint32_t x = 1;
+    for (; x + 5 <= width; x += 4) {
+        __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pSource[x - 1]));
+        __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pSource[x]));
+        __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pSource[x + 1]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&pTarget[x]), _mm_avg_epu8(pixel, _mm_avg_epu8(left, right)));
+    }
+    for (; x < width; x++) {
+        pTarget[x] = blur(pSource[x - 1], pSource[x], pSource[(x + 1 < width) ? x + 1 : x]);
+    }
+}
+
+static void expandLineVectorised(const uint32_t *pSource, uint32_t *pTarget, uint32_t width, uint32_t scale) {
+    uint32_t x = 0;
+    auto *pOut = reinterpret_cast<__m128i *>(pTarget);
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pSource[x]));
+        switch (scale) {
+            case 1:
+                _mm_storeu_si128(pOut++, pixels);
+                break;
+            case 2:
+                _mm_storeu_si128(pOut++, _mm_unpacklo_epi32(pixels, pixels));
+                _mm_storeu_si128(pOut++, _mm_unpackhi_epi32(pixels, pixels));
+                break;
+            case 3:
+                // p0 p0 p0 p1 | p1 p1 p2 p2 | p2 p3 p3 p3
+                _mm_storeu_si128(pOut++, _mm_shuffle_epi32(pixels, 0x40));
+                _mm_storeu_si128(pOut++, _mm_shuffle_epi32(pixels, 0xA5));
+                _mm_storeu_si128(pOut++, _mm_shuffle_epi32(pixels, 0xFE));
+                break;
+            default:
+                _mm_storeu_si128(pOut++, _mm_shuffle_epi32(pixels, 0x00));
+                _mm_storeu_si128(pOut++, _mm_shuffle_epi32(pixels, 0x55));
+                _mm_storeu_si128(pOut++, _mm_shuffle_epi32(pixels, 0xAA));
+                _mm_storeu_si128(pOut++, _mm_shuffle_epi32(pixels, 0xFF));
+                break;
+        }
+    }
+    expandLine(&pSource[x], &pTarget[x * scale], width - x, scale);
+}
+
+static void darkenLineVectorised(const uint32_t *pSource, uint32_t *pTarget, uint32_t width, uint32_t brightness) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i factor = _mm_set1_epi16(static_cast<int16_t>(brightness));
+    const __m128i top = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u));
+    uint32_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pSource[x]));
+        __m128i low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), factor), 8);
+        __m128i high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), factor), 8);
+        __m128i dark = _mm_packus_epi16(low, high);
+        dark = _mm_or_si128(_mm_andnot_si128(top, dark), _mm_and_si128(top, pixels));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&pTarget[x]), dark);
+    }
+    darkenLine(&pSource[x], &pTarget[x], width - x, brightness);
+}
+
+#elif ZX_UPSCALER_NEON
+
+static void blurLineVectorised(const uint32_t *pSource, uint32_t *pTarget, uint32_t width) {
+    pTarget[0] = blur(pSource[0], pSource[0], pSource[width > 1 ? 1 : 0]);
+    uint32_t x = 1;
+    for (; x + 5 <= width; x += 4) {
+        uint8x16_t left = vreinterpretq_u8_u32(vld1q_u32(&pSource[x - 1]));
+        uint8x16_t pixel = vreinterpretq_u8_u32(vld1q_u32(&pSource[x]));
+        uint8x16_t right = vreinterpretq_u8_u32(vld1q_u32(&pSource[x + 1]));
+        vst1q_u32(&pTarget[x], vreinterpretq_u32_u8(vrhaddq_u8(pixel, vrhaddq_u8(left, right))));
+    }
+    for (; x < width; x++) {
+        pTarget[x] = blur(pSource[x - 1], pSource[x], pSource[(x + 1 < width) ? x + 1 : x]);
+    }
+}
+
+static void expandLineVectorised(const uint32_t *pSource, uint32_t *pTarget, uint32_t width, uint32_t scale) {
+    uint32_t x = 0;
+    uint32_t *pOut = pTarget;
+    // The interleaving stores write each of the 4 pixels scale times in a row
+    for (; x + 4 <= width; x += 4, pOut += 4 * scale) {
+        uint32x4_t pixels = vld1q_u32(&pSource[x]);
+        switch (scale) {
+            case 1:
+                vst1q_u32(pOut, pixels);
+                break;
+            case 2:
+                vst2q_u32(pOut, (uint32x4x2_t{{ pixels, pixels }}));
+                break;
+            case 3:
+                vst3q_u32(pOut, (uint32x4x3_t{{ pixels, pixels, pixels }}));
+                break;
+            default:
+                vst4q_u32(pOut, (uint32x4x4_t{{ pixels, pixels, pixels, pixels }}));
+                break;
+        }
+    }
+    expandLine(&pSource[x], &pTarget[x * scale], width - x, scale);
+}
+
+static void darkenLineVectorised(const uint32_t *pSource, uint32_t *pTarget, uint32_t width, uint32_t brightness) {
+    const uint8x8_t factor = vdup_n_u8(static_cast<uint8_t>(brightness));
+    const uint32x4_t top = vdupq_n_u32(0xFF000000u);
+    uint32_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        uint32x4_t pixels = vld1q_u32(&pSource[x]);
+        uint8x16_t bytes = vreinterpretq_u8_u32(pixels);
+        uint8x16_t dark = vcombine_u8(vshrn_n_u16(vmull_u8(vget_low_u8(bytes), factor), 8),
+                                      vshrn_n_u16(vmull_u8(vget_high_u8(bytes), factor), 8));
+        vst1q_u32(&pTarget[x], vbslq_u32(top, pixels, vreinterpretq_u32_u8(dark)));
+    }
+    darkenLine(&pSource[x], &pTarget[x], width - x, brightness);
+}
+
+#endif
+
+
+ZxUpscaler::ZxUpscaler(uint32_t width, uint32_t height, uint32_t scale) :
+        m_width(width),
+        m_height(height),
+        m_scale(MIN_SCALE),
+        m_bBlur(false),
+        m_scanlineBrightness(NO_SCANLINES),
+        m_bVectorised(isVectorised()),
+        m_pLine(new uint32_t[width]) {
+    setScale(scale);
+}
+
+ZxUpscaler::~ZxUpscaler() {
+    delete[] m_pLine;
+}
+
+bool ZxUpscaler::isVectorised() {
+#if ZX_UPSCALER_SSE2 || ZX_UPSCALER_NEON
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ZxUpscaler::setScale(uint32_t scale) {
+    m_scale = (scale < MIN_SCALE) ? MIN_SCALE : ((scale > MAX_SCALE) ? MAX_SCALE : scale);
+}
+
+void ZxUpscaler::process(const uint32_t *pSource, uint32_t *pTarget, uint32_t targetPitch) {
+
+    assert(targetPitch >= targetWidth());
+
+    const uint32_t targetWidth = m_width * m_scale;
+    const bool scanlines = m_scale > 1 && m_scanlineBrightness < NO_SCANLINES;
+
+    for (uint32_t y = 0; y < m_height; y++) {
+        const uint32_t *pLine = &pSource[y * m_width];
+        uint32_t *pFirst = &pTarget[y * m_scale * targetPitch];
+
+#if ZX_UPSCALER_SSE2 || ZX_UPSCALER_NEON
+        if (m_bVectorised) {
+            if (m_bBlur) {
+                blurLineVectorised(pLine, m_pLine, m_width);
+                pLine = m_pLine;
+            }
+            expandLineVectorised(pLine, pFirst, m_width, m_scale);
+            if (scanlines) {
+                darkenLineVectorised(pFirst, pFirst + (m_scale - 1) * targetPitch, targetWidth, m_scanlineBrightness);
+            }
+        } else
+#endif
+        {
+            if (m_bBlur) {
+                blurLine(pLine, m_pLine, m_width);
+                pLine = m_pLine;
+            }
+            expandLine(pLine, pFirst, m_width, m_scale);
+            if (scanlines) {
+                darkenLine(pFirst, pFirst + (m_scale - 1) * targetPitch, targetWidth, m_scanlineBrightness);
+            }
+        }
+
+        for (uint32_t line = 1; line < (scanlines ? m_scale - 1 : m_scale); line++) {
+            std::memcpy(pFirst + line * targetPitch, pFirst, targetWidth * sizeof(uint32_t));
+        }
+    }
+}
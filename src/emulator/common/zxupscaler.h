@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXUPSCALER_H
+#define ZXUPSCALER_H
+
+#include <cstdint>
+
+/*
+ * Optional post-process stage run on a completed XRGB8888 (32 bpp) frame, e.g. the framebuffer after
+ * ZxDisplay::update(), which writes an integer 2x, 3x or 4x upscaled copy into a buffer provided by the caller:
+ *
+ * - blur:       each pixel is blended with its left and right neighbours, as avg(pixel, avg(left, right)) with byte
+ *               averages rounding up, i.e. roughly (left + 2 * pixel + right) / 4, to soften the sharp colour edges.
+ * - scanlines:  the last line of every scaled line is darkened to brightness / 256 of its colour, as on a CRT.  This
+ *               needs a scale of 2 or more.
+ *
+ * Each source line is processed once into the first target line, which is then copied (or darkened) into the rest,
+ * so the cost is dominated by the size of the target.  SSE2 is used on x86 and NEON on ARM when the compiler targets
+ * them (e.g. not on the ARMv6 based Raspberry Pi Zero/1), with a plain C++ fallback that produces the same output.
+ */
+class ZxUpscaler {
+
+public:
+    static const uint32_t MIN_SCALE = 1;
+    static const uint32_t MAX_SCALE = 4;
+    // Scanline brightness that leaves the scanlines untouched
+    static const uint32_t NO_SCANLINES = 256;
+
+    ZxUpscaler(uint32_t width, uint32_t height, uint32_t scale);
+    ~ZxUpscaler();
+
+    ZxUpscaler(const ZxUpscaler &) = delete;
+    ZxUpscaler &operator=(const ZxUpscaler &) = delete;
+
+    void setScale(uint32_t scale);
+    uint32_t getScale() const {
+        return m_scale;
+    }
+
+    void setBlur(bool blur) {
+        m_bBlur = blur;
+    }
+
+    void setScanlineBrightness(uint32_t brightness) {
+        m_scanlineBrightness = (brightness < NO_SCANLINES) ? brightness : NO_SCANLINES;
+    }
+
+    // Only used to compare the vectorised code with the fallback
+    void setVectorised(bool vectorised) {
+        m_bVectorised = vectorised && isVectorised();
+    }
+
+    static bool isVectorised();
+
+    uint32_t targetWidth() const {
+        return m_width * m_scale;
+    }
+
+    uint32_t targetHeight() const {
+        return m_height * m_scale;
+    }
+
+    /* Upscales the source frame, width x height pixels, into the target frame, targetWidth() x targetHeight() pixels
+     * with targetPitch pixels per line.
+     */
+    void process(const uint32_t *pSource, uint32_t *pTarget, uint32_t targetPitch);
+
+private:
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_scale;
+    bool m_bBlur;
+    uint32_t m_scanlineBrightness;
+    bool m_bVectorised;
+    // Line buffer holding the blurred source line
+    uint32_t *m_pLine;
+
+};
+
+#endif // ZXUPSCALER_H
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <circle/bcmframebuffer.h>
+#include <zx48k_rom.h>
+#include "common/clock.h"
+#include "common/Z80emu.h"
+#include "common/zxdisplay.h"
+#include "common/zxdisplayrenderer.h"
+#include "common/zxframepacer.h"
+#include "common/audio/zxaudiobuffer.h"
+#include "common/audio/zxay.h"
+#include "common/audio/zxbeeper.h"
+#include "common/audio/zxtapefile.h"
+#include "common/audio/zxtapeinput.h"
+#include "common/audio/zxwavwriter.h"
+#include "common/hardware/zxhardwaremodel48k.h"
+#include "common/hardware/zxhardwaremodel128k.h"
+#include "zxchronotimer.h"
+
+
+/*
+ * Headless runner of the emulator core for Linux build and test servers.  It loads a ROM and, optionally, a snapshot,
+ * runs a number of frames as fast as possible or in real time, and reports how fast the emulation ran, e.g.
+ *
+ *   zxheadless --frames 3000 --scanline --dump final.ppm --wav beeper.wav aquaplane.sna
+ *   zxheadless --frames 15000 --tape game.wav --dump loaded.ppm
+ *   zxheadless --model 128k --rom 128.rom game128.sna
+ */
+
+static const uint32_t DEFAULT_FRAMES = 500;
+static const uint32_t ROM_SIZE = 0x4000;
+// Samples between the emulation and the WAV writer, enough for the writer to keep up however fast the emulation runs
+static const uint32_t AUDIO_BUFFER_SIZE = 1u << 18;
+
+
+// Time taken by one phase of the frame loop, in microseconds
+struct Phase {
+    const char *name;
+    uint64_t total = 0;
+    uint32_t max = 0;
+
+    void add(uint32_t time) {
+        total += time;
+        max = (time > max) ? time : max;
+    }
+};
+
+
+struct Options {
+    const char *pRomFile = nullptr;
+    const char *pSnapshotFile = nullptr;
+    const char *pDumpFile = nullptr;
+    const char *pWavFile = nullptr;
+    const char *pTapeFile = nullptr;
+    uint32_t frames = DEFAULT_FRAMES;
+    uint32_t depth = 4;
+    bool realTime = false;
+    bool scanline = false;
+    bool model128K = false;
+};
+
+
+static void usage(const char *pProgram) {
+
+    fprintf(stderr,
+            "Usage: %s [options] [snapshot.sna]\n"
+            "  --model <model>   hardware model to emulate: 48k or 128k (default 48k)\n"
+            "  --rom <file>      ROM image to load instead of the built-in 48K ROM; the 128K needs both of its ROMs\n"
+            "  --frames <n>      number of frames to run (default %u)\n"
+            "  --realtime        run at the speed of the real machine rather than as fast as possible\n"
+            "  --scanline        draw the screen as the ULA fetches it rather than once per frame\n"
+            "  --depth <bits>    framebuffer colour depth: 4, 8, 16 or 32 (default 4, as on the Raspberry Pi)\n"
+            "  --dump <file>     write the final frame to a binary PPM file\n"
+            "  --wav <file>      record the sound of the beeper and the AY chip to a WAV file\n"
+            "  --tape <file>     play a WAV recording of a tape into the EAR input from the first frame\n",
+            pProgram, DEFAULT_FRAMES);
+}
+
+
+static bool parseOptions(int argc, char *argv[], Options &options) {
+
+    for (int i = 1; i < argc; i++) {
+        const char *pArg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(pArg, "--model") == 0 && hasValue) {
+            const char *pModel = argv[++i];
+            if (strcmp(pModel, "128k") == 0) {
+                options.model128K = true;
+            } else if (strcmp(pModel, "48k") != 0) {
+                return false;
+            }
+        } else if (strcmp(pArg, "--rom") == 0 && hasValue) {
+            options.pRomFile = argv[++i];
+        } else if (strcmp(pArg, "--frames") == 0 && hasValue) {
+            options.frames = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(pArg, "--depth") == 0 && hasValue) {
+            options.depth = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(pArg, "--dump") == 0 && hasValue) {
+            options.pDumpFile = argv[++i];
+        } else if (strcmp(pArg, "--wav") == 0 && hasValue) {
+            options.pWavFile = argv[++i];
+        } else if (strcmp(pArg, "--tape") == 0 && hasValue) {
+            options.pTapeFile = argv[++i];
+        } else if (strcmp(pArg, "--realtime") == 0) {
+            options.realTime = true;
+        } else if (strcmp(pArg, "--scanline") == 0) {
+            options.scanline = true;
+        } else if (pArg[0] != '-' && options.pSnapshotFile == nullptr) {
+            options.pSnapshotFile = pArg;
+        } else {
+            return false;
+        }
+    }
+
+    return options.frames > 0 && (!options.model128K || options.pRomFile != nullptr) &&
+           (options.depth == 4 || options.depth == 8 || options.depth == 16 || options.depth == 32);
+}
+
+
+static bool loadFile(const char *pFileName, std::vector<uint8_t> &data) {
+
+    FILE *pFile = fopen(pFileName, "rb");
+    if (pFile == nullptr) {
+        return false;
+    }
+
+    uint8_t buffer[16384];
+    size_t size;
+    data.clear();
+    while ((size = fread(buffer, 1, sizeof(buffer), pFile)) > 0) {
+        data.insert(data.end(), buffer, buffer + size);
+    }
+    bool ok = ferror(pFile) == 0;
+    fclose(pFile);
+    return ok;
+}
+
+
+/*
+ * Writes the frame, in the native format of the framebuffer, as a binary PPM image.
+ */
+static bool dumpFrame(const char *pFileName, const uint8_t *pFrame, uint32_t depth) {
+
+    FILE *pFile = fopen(pFileName, "wb");
+    if (pFile == nullptr) {
+        return false;
+    }
+
+    const uint32_t pixels = ZxDisplay::DISPLAY_WIDTH * ZxDisplay::DISPLAY_HEIGHT;
+    std::vector<uint8_t> rgb;
+    rgb.reserve(pixels * 3);
+    for (uint32_t i = 0; i < pixels; i++) {
+        uint32_t xrgb;
+        switch (depth) {
+            case 4:
+                xrgb = zxRGB565ToXRGB8888(zxPaletteRGB565[(pFrame[i / 2] >> ((i & 1) ? 0 : 4)) & 0x0Fu]);
+                break;
+            case 8:
+                xrgb = zxRGB565ToXRGB8888(zxPaletteRGB565[pFrame[i] & 0x0Fu]);
+                break;
+            case 16:
+                xrgb = zxRGB565ToXRGB8888(reinterpret_cast<const uint16_t *>(pFrame)[i]);
+                break;
+            default:
+                xrgb = reinterpret_cast<const uint32_t *>(pFrame)[i];
+                break;
+        }
+        rgb.push_back(static_cast<uint8_t>(xrgb >> 16));
+        rgb.push_back(static_cast<uint8_t>(xrgb >> 8));
+        rgb.push_back(static_cast<uint8_t>(xrgb));
+    }
+
+    fprintf(pFile, "P6\n%u %u\n255\n", ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT);
+    bool ok = fwrite(rgb.data(), 1, rgb.size(), pFile) == rgb.size();
+    return (fclose(pFile) == 0) && ok;
+}
+
+
+int main(int argc, char *argv[]) {
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ZxHardwareModel48k model48K;
+    ZxHardwareModel128k model128K;
+    ZxHardwareModel &model = options.model128K ? static_cast<ZxHardwareModel &>(model128K) : model48K;
+
+    std::vector<uint8_t> rom(zx48k_rom, zx48k_rom + zx48k_rom_len);
+    const uint32_t romSize = model.romPages() * ROM_SIZE;
+    if (options.pRomFile != nullptr && (!loadFile(options.pRomFile, rom) || rom.size() != romSize)) {
+        fprintf(stderr, "Unable to load a %uK ROM image from %s\n", romSize / 1024, options.pRomFile);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> snapshot;
+    if (options.pSnapshotFile != nullptr && !loadFile(options.pSnapshotFile, snapshot)) {
+        fprintf(stderr, "Unable to read the snapshot %s\n", options.pSnapshotFile);
+        return EXIT_FAILURE;
+    }
+
+    auto *pZxDisplay = new ZxDisplay();
+    Z80emu z80emu(pZxDisplay);
+    z80emu.setHardwareModel(&model);
+    Clock::getInstance().setSpectrumModel(&model);
+
+    // The display owns the framebuffer
+    auto *pFrameBuffer = new CBcmFrameBuffer(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, options.depth);
+    pZxDisplay->Initialize(z80emu.getRam() + 0x4000, pFrameBuffer);
+    pZxDisplay->setHardwareModel(&model);
+    pZxDisplay->setRenderMode(options.scanline ? ZxDisplay::RenderMode::Scanline : ZxDisplay::RenderMode::Frame);
+
+    z80emu.loadRom(rom.data(), rom.size());
+    if (options.pSnapshotFile != nullptr && !z80emu.loadSnapshot(snapshot.data(), snapshot.size())) {
+        fprintf(stderr, "Unable to load a %s SNA snapshot from %s\n", model.hasMemoryPaging() ? "48K or 128K" : "48K",
+                options.pSnapshotFile);
+        return EXIT_FAILURE;
+    }
+
+    ZxAudioBuffer audioBuffer(AUDIO_BUFFER_SIZE);
+    ZxBeeper beeper(audioBuffer, model.clockFrequency(), model.tStatesPerScreenFrame(),
+                    ZxAudioSink::DEFAULT_SAMPLE_RATE);
+    ZxAY ay(model.clockFrequency(), model.tStatesPerScreenFrame(), beeper.sampleRate());
+    ZxWavWriter wavWriter(audioBuffer, beeper.sampleRate());
+    if (options.pWavFile != nullptr) {
+        if (!wavWriter.start(options.pWavFile)) {
+            fprintf(stderr, "Unable to write the sound to %s\n", options.pWavFile);
+            delete pZxDisplay;
+            return EXIT_FAILURE;
+        }
+        z80emu.setBeeper(&beeper);
+        z80emu.setAY(&ay);
+    }
+
+    // The recording is streamed from the file as the tape plays
+    ZxTapeFile tapeFile;
+    ZxTapeInput tape(model.clockFrequency());
+    if (options.pTapeFile != nullptr) {
+        if (!tapeFile.open(options.pTapeFile) || !tape.insert(&tapeFile)) {
+            fprintf(stderr, "Unable to play a PCM WAV recording from %s\n", options.pTapeFile);
+            delete pZxDisplay;
+            return EXIT_FAILURE;
+        }
+        tape.play(Clock::getInstance().getAbsTstates());
+        z80emu.setTape(&tape);
+    }
+
+    ZxChronoTimer timer;
+    ZxFramePacer framePacer(timer, ZxChronoTimer::TICKS_PER_SECOND, model.tStatesPerScreenFrame(),
+                            model.clockFrequency());
+    Phase emulation{ "emulation" };
+    Phase rendering{ "rendering" };
+    Phase waiting{ "waiting" };
+    bool flash = false;
+
+    uint32_t start = timer.clockTicks();
+    framePacer.reset();
+    for (uint32_t frame = 1; frame <= options.frames; frame++) {
+        uint32_t phaseStart = timer.clockTicks();
+        z80emu.execute(model.tStatesPerScreenFrame());
+        Clock::getInstance().endFrame();
+        uint32_t now = timer.clockTicks();
+        emulation.add(now - phaseStart);
+
+        // The flash changes its state every 16 screen frames
+        if (frame % 16 == 0) {
+            flash = !flash;
+        }
+        phaseStart = now;
+        pZxDisplay->update(flash);
+        pZxDisplay->present();
+        now = timer.clockTicks();
+        rendering.add(now - phaseStart);
+
+        if (options.realTime) {
+            phaseStart = now;
+            framePacer.endFrame();
+            waiting.add(timer.clockTicks() - phaseStart);
+        }
+    }
+    uint32_t elapsed = timer.clockTicks() - start;
+    elapsed = (elapsed > 0) ? elapsed : 1;
+
+    uint64_t tstates = static_cast<uint64_t>(options.frames) * model.tStatesPerScreenFrame();
+    printf("Frames: %u in %.3f s, %.1f frames per second\n", options.frames, elapsed / 1e6,
+           options.frames * 1e6 / elapsed);
+    printf("Emulated clock: %.2f MHz, %.2fx real time\n", static_cast<double>(tstates) / elapsed,
+           static_cast<double>(tstates) * 1e6 / elapsed / model.clockFrequency());
+    for (const Phase *pPhase : { &emulation, &rendering, &waiting }) {
+        if (pPhase->total > 0) {
+            printf("  %-10s avg %7.1f us, max %7u us per frame\n", pPhase->name,
+                   static_cast<double>(pPhase->total) / options.frames, pPhase->max);
+        }
+    }
+    if (options.realTime) {
+        printf("Frames late: %u, dropped %u, resyncs %u\n", framePacer.framesLate(), framePacer.framesDropped(),
+               framePacer.resyncs());
+    }
+
+    if (options.pTapeFile != nullptr) {
+        printf("Tape: %llu edges%s\n", static_cast<unsigned long long>(tape.edges()),
+               tape.ended() ? ", played to the end" : "");
+    }
+
+    int result = EXIT_SUCCESS;
+    if (options.pWavFile != nullptr) {
+        wavWriter.stop();
+        printf("Audio: %u samples written, %u dropped\n", wavWriter.samplesWritten(), audioBuffer.overruns());
+        if (wavWriter.writeFailed()) {
+            fprintf(stderr, "Unable to write the sound to %s\n", options.pWavFile);
+            result = EXIT_FAILURE;
+        }
+    }
+    if (options.pDumpFile != nullptr && !dumpFrame(options.pDumpFile, pZxDisplay->getFrontBuffer(), options.depth)) {
+        fprintf(stderr, "Unable to write the final frame to %s\n", options.pDumpFile);
+        result = EXIT_FAILURE;
+    }
+
+    delete pZxDisplay;
+    return result;
+}
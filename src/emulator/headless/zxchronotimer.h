@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXCHRONOTIMER_H
+#define ZXRASPBERRY_ZXCHRONOTIMER_H
+
+#include <chrono>
+#include <thread>
+#include "common/zxframepacer.h"
+
+
+/*
+ * Frame pacer time source backed by the monotonic clock of the host, in microseconds like the Circle system timer.
+ */
+class ZxChronoTimer : public ZxPacingTimer {
+
+public:
+    static const uint32_t TICKS_PER_SECOND = 1000000;
+
+    uint32_t clockTicks() override {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    }
+
+    void waitTicks(uint32_t ticks) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(ticks));
+    }
+
+};
+
+
+#endif //ZXRASPBERRY_ZXCHRONOTIMER_H
@@ -34,12 +34,15 @@ int main(int argc, char *argv[]) {
     parser.addHelpOption();
     parser.addVersionOption();
     parser.addPositionalArgument("program-file", QCoreApplication::translate("program-file", "Program file to run."));
+    QCommandLineOption captureOption("capture", QCoreApplication::translate("capture",
+            "Record the screen to <file>, as Y4M video if it ends in .y4m or as raw RGB24 frames otherwise."), "file");
+    parser.addOption(captureOption);
     parser.process(application);
     const QStringList args = parser.positionalArguments();
     // Position 0, if present, should contain the full path to the ZX Spectrum program to run
     const QString &programFile = args.value(0);
 
-    auto *emulatorWindow = new ZxEmulatorWindow(programFile);
+    auto *emulatorWindow = new ZxEmulatorWindow(programFile, parser.value(captureOption));
     emulatorWindow->show();
 
     return QApplication::exec();
@@ -22,6 +22,7 @@
 #include "common/gui/zxdialog.h"
 #include "common/gui/zxlabel.h"
 #include "common/gui/zxrect.h"
+#include "common/zxupscaler.h"
 #include "circle/bcmframebuffer.h"
 #include <QPainter>
 #include <QtGlobal>
@@ -36,8 +37,14 @@ ZxEmulatorScreen::ZxEmulatorScreen(Z80emu *z80emu, ZxDisplay *pZxDisplay, QWidge
     m_antiAliased = false;
     setBackgroundRole(QPalette::Base);
     setAutoFillBackground(true);
-    m_pBcmFrameBuffer = new CBcmFrameBuffer(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, ZxDisplay::COLOUR_DEPTH);
+    /* Draw the frames in XRGB8888 format, which is the native pixel format of QImage::Format_RGB32, with room for 3
+     * frames so that the display can triple buffer them.
+     */
+    m_pBcmFrameBuffer = new CBcmFrameBuffer(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, 32,
+                                            ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT * ZxTripleBuffer::BUFFERS);
     m_pZxDisplay->Initialize(&m_pZ80emu->getRam()[0x4000], m_pBcmFrameBuffer);
+    m_pUpscaler = new ZxUpscaler(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, m_scale);
+    m_pScaledFrame = new uint32_t[m_pUpscaler->targetWidth() * m_pUpscaler->targetHeight()];
     m_pZxKeyboard = new ZxKeyboard();
 
     // Set the focus on this widget so that we can get keyboard events
@@ -46,7 +53,11 @@ ZxEmulatorScreen::ZxEmulatorScreen(Z80emu *z80emu, ZxDisplay *pZxDisplay, QWidge
 
 ZxEmulatorScreen::~ZxEmulatorScreen() {
 
+    delete m_pZxDisplay->getUI();
+    m_pZxDisplay->setUI(nullptr);
     delete m_pZxKeyboard;
+    delete[] m_pScaledFrame;
+    delete m_pUpscaler;
 }
 
 
@@ -68,12 +79,51 @@ QSize ZxEmulatorScreen::sizeHint() const {
 }
 
 
+ZxView *ZxEmulatorScreen::createAboutDialog() {
+
+    auto zxDialog = new ZxDialog(ZxRect(2, 12, 40, 10), "About ZX Raspberry");
+
+    /*
+     * The default printable characters (32 (space) to 127 (copyright)) are stored at the end of the Spectrum's ROM at
+     * memory address 15616 (0x3D00) to 16383 (0x3FFF) and are referenced by the system variable CHARS which can be
+     * found at memory address 23606/7. Interestingly, the value in CHARS is actually 256 bytes lower than the first
+     * byte of the space character so that referencing a printable ASCII character does not need to consider the first
+     * 32 characters. As such, the CHARS value (by default) holds the address 15360 (0x3C00).
+     *
+     * The UDG characters (Gr-A to Gr-U) are stored at the end of the Spectrum's RAM at memory address 65368 (0xFF58)
+     * to 65535 (0xFFFF). As such, POKEing this address range has immediate effect on the UDG characters. The USR
+     * keyword (when followed by a single quoted character) provides a quick method to reference these addresses from
+     * BASIC. As with the printable characters, the location of the UDG characters is stored in the system variable UDG.
+     *
+     * Reference: https://enacademic.com/dic.nsf/enwiki/513468
+     */
+    zxDialog->insert(new ZxLabel(ZxRect(1, 2, 1, 1), "ZX Raspberry version 0.0.1"));
+    zxDialog->insert(new ZxLabel(ZxRect(1, 3, 1, 1), "Copyright \x7F 2020-2024 Jose Hernandez"));
+    zxDialog->insert(new ZxLabel(ZxRect(1, 6, 1, 1), "Build date: " __DATE__ " " __TIME__));
+
+    return zxDialog;
+}
+
+
 void ZxEmulatorScreen::keyPressEvent(QKeyEvent *event) {
 
     if (event->key() == Qt::Key_F1) {
         m_showDialog = !m_showDialog;
         qDebug() << ((m_showDialog) ? "Showing About box" : "Hiding about box");
-        repaint();
+        // The display draws the dialog on top of every frame until it is removed
+        delete m_pZxDisplay->getUI();
+        m_pZxDisplay->setUI(m_showDialog ? createAboutDialog() : nullptr);
+    }
+    else if (event->key() == Qt::Key_F2) {
+        m_scanlines = !m_scanlines;
+        m_pUpscaler->setScanlineBrightness(m_scanlines ? 160 : ZxUpscaler::NO_SCANLINES);
+    }
+    else if (event->key() == Qt::Key_F3) {
+        m_blur = !m_blur;
+        m_pUpscaler->setBlur(m_blur);
+    }
+    else if (event->key() == Qt::Key_F4) {
+        emit turboToggled();
     }
     else {
         m_pZxKeyboard->keyPressEvent(*m_pZ80emu, *event);
@@ -87,73 +137,45 @@ void ZxEmulatorScreen::keyReleaseEvent(QKeyEvent *event) {
 }
 
 
-void ZxEmulatorScreen::paintEvent(QPaintEvent * /* event */) {
-
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing, m_antiAliased);
-    painter.save();
+/*
+ * Renders the frame just emulated into a free buffer and hands it over to paintEvent(), which always shows the latest
+ * complete frame, so that emulation and painting do not need to run in lock step. Frames that nobody will see, such as
+ * most of those emulated in turbo mode, can be skipped by passing draw = false.
+ */
+void ZxEmulatorScreen::renderFrame(bool draw) {
 
     // The flash changes state every 16 screen frames
     if (++m_frameCounter % 16 == 0) {
         m_flash = !m_flash;
     }
 
-    m_pZxDisplay->update(m_flash);
-
-    if (m_showDialog) {
-        auto zxDialog = ZxDialog(ZxRect(2, 12, 40, 10), "About ZX Raspberry");
-
-        /*
-         * The default printable characters (32 (space) to 127 (copyright)) are stored at the end of the Spectrum's ROM at
-         * memory address 15616 (0x3D00) to 16383 (0x3FFF) and are referenced by the system variable CHARS which can be
-         * found at memory address 23606/7. Interestingly, the value in CHARS is actually 256 bytes lower than the first
-         * byte of the space character so that referencing a printable ASCII character does not need to consider the first
-         * 32 characters. As such, the CHARS value (by default) holds the address 15360 (0x3C00).
-         *
-         * The UDG characters (Gr-A to Gr-U) are stored at the end of the Spectrum's RAM at memory address 65368 (0xFF58)
-         * to 65535 (0xFFFF). As such, POKEing this address range has immediate effect on the UDG characters. The USR
-         * keyword (when followed by a single quoted character) provides a quick method to reference these addresses from
-         * BASIC. As with the printable characters, the location of the UDG characters is stored in the system variable UDG.
-         *
-         * Reference: https://enacademic.com/dic.nsf/enwiki/513468
-         */
-        zxDialog.insert(new ZxLabel(ZxRect(1, 2, 1, 1), "ZX Raspberry version 0.0.1"));
-        zxDialog.insert(new ZxLabel(ZxRect(1, 3, 1, 1), "Copyright \x7F 2020-2024 Jose Hernandez"));
-        zxDialog.insert(new ZxLabel(ZxRect(1, 6, 1, 1), "Build date: " __DATE__ " " __TIME__));
-
-        zxDialog.draw(reinterpret_cast<uint8_t *>(m_pBcmFrameBuffer->GetBuffer()));
+    if (draw) {
+        m_pZxDisplay->update(m_flash);
+    } else {
+        m_pZxDisplay->skip();
     }
+}
 
-/* Reads Raspberry Pi framebuffer and turns it into a QImage object.
- *
- * Image data in the framebuffer is stored linearly starting with pixel (0,0) on the top left and the moving right
- * and down one pixel at a time.  In our particular example we have 2 pixels per byte and the bytes are out of
- * sequence because they are stored as a single 32-bit unsigned integer instead of 4 individual bytes.
- */
-#if BYTE_SWAP_DISABLED
-    for (int i = 0; i < 296; i++) {
-        for (int j = 0; j < 44; j++) {
-            for (int k=0; k<4; k++) {
-                uint8_t byte = videoMemory.at( (i * 176) + (j * 4) + (3 - k) );
-                image.setPixel( (j * 8) + (k * 2), i, m_pBcmFrameBuffer->palette[(byte & 0xF0u) >> 0x04u] );
-                image.setPixel( (j * 8) + (k * 2) + 1 , i, m_pBcmFrameBuffer->palette[byte & 0x0Fu] );
-            }
-        }
-    }
-#else
-    // Iterate over all rows. i.e. 0 to 296
-    for (int i = 0x0000; i < 0x0128; i++) {
-        // Iterate over all columns 2 pixels at a time. i.e. 0 to 176 (176 pixel pairs = 352 screen width / 2)
-        for (int j = 0x0000; j < 0x00B0; j++) {
-            uint8_t byte = reinterpret_cast<char *>(m_pBcmFrameBuffer->GetBuffer())[(i * 0x00B0) + j];
-            image.setPixel((j * 2), i, m_pBcmFrameBuffer->palette[(byte & 0xF0u) >> 0x04u]);
-            image.setPixel((j * 2) + 1, i, m_pBcmFrameBuffer->palette[byte & 0x0Fu]);
-        }
-    }
-#endif
+
+void ZxEmulatorScreen::paintEvent(QPaintEvent * /* event */) {
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing, m_antiAliased);
+    painter.save();
+
+    m_pZxDisplay->present();
+
+    /* Scales the framebuffer up, which the display draws straight in XRGB8888 format, and wraps the result in a QImage
+     * object, so that QPainter only needs to copy it to the screen.
+     */
+    m_pUpscaler->process(reinterpret_cast<const uint32_t *>(m_pZxDisplay->getFrontBuffer()), m_pScaledFrame,
+                         m_pUpscaler->targetWidth());
+    QImage image(reinterpret_cast<const uchar *>(m_pScaledFrame),
+                 static_cast<int>(m_pUpscaler->targetWidth()), static_cast<int>(m_pUpscaler->targetHeight()),
+                 static_cast<qsizetype>(m_pUpscaler->targetWidth() * 4), QImage::Format_RGB32);
 
     // http://www.zxdesign.info/vidparam.shtml
-    painter.drawImage(QRect(0, 0, static_cast<int>(m_scale * 352), static_cast<int>(m_scale * 296)), image);
+    painter.drawImage(QPoint(0, 0), image);
 
     painter.restore();
     painter.setRenderHint(QPainter::Antialiasing, false);
@@ -27,7 +27,9 @@
 
 class CBcmFrameBuffer;
 class Z80emu;
+class ZxUpscaler;
 class ZxKeyboard;
+class ZxView;
 
 class ZxEmulatorScreen : public QWidget {
 Q_OBJECT
@@ -39,6 +41,12 @@ public:
     [[nodiscard]] QSize minimumSizeHint() const override;
     [[nodiscard]] QSize sizeHint() const override;
 
+    void renderFrame(bool draw = true);
+
+signals:
+    // F4 was pressed to switch turbo mode on or off
+    void turboToggled();
+
 public slots:
 
 protected:
@@ -47,8 +55,12 @@ protected:
     void keyReleaseEvent(QKeyEvent *event) override;
 
 private:
+    static ZxView *createAboutDialog();
+
     bool m_antiAliased = false;
     bool m_showDialog = false;
+    bool m_scanlines = false;
+    bool m_blur = false;
     uint8_t m_scale = 3;
     bool m_flash = false;
     uint32_t m_frameCounter = 0;
@@ -57,8 +69,9 @@ private:
     ZxKeyboard *m_pZxKeyboard;
     ZxDisplay *m_pZxDisplay;
     CBcmFrameBuffer *m_pBcmFrameBuffer = nullptr;
-
-    QImage image = QImage(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, QImage::Format_RGB32);
+    // Post-process stage that scales the framebuffer m_scale times into m_pScaledFrame
+    ZxUpscaler *m_pUpscaler = nullptr;
+    uint32_t *m_pScaledFrame = nullptr;
 };
 
 #endif // SCREEN_H
@@ -25,9 +25,20 @@
 #include <common/hardware/zxhardwaremodel48k.h>
 #include <zx48k_rom.h>
 #include <common/Z80emu.h>
+#include <common/zxdisplay.h>
+#include <common/stream/zxvideocapture.h>
 
 
-ZxEmulatorWindow::ZxEmulatorWindow(QString programFile) : m_programFile(std::move(programFile)) {
+// Frame period at the standard 50Hz refresh rate, in milliseconds
+static const int FRAME_INTERVAL = 20;
+// Time spent emulating in each turbo mode timer event before handing control back to the event loop
+static const qint64 TURBO_SLICE = 15;
+
+
+ZxEmulatorWindow::ZxEmulatorWindow(QString programFile, QString captureFile) :
+        m_programFile(std::move(programFile)),
+        m_captureFile(std::move(captureFile)),
+        m_pCapture(nullptr) {
 
     qDebug() << "Program to run: " << ((m_programFile != nullptr) ? m_programFile : "NONE");
 
@@ -35,8 +46,11 @@ ZxEmulatorWindow::ZxEmulatorWindow(QString programFile) : m_programFile(std::mov
     m_pZ80emu = new Z80emu(m_pZxDisplay);
     m_timer = new QTimer(this);
     m_model = new ZxHardwareModel48k();
+    m_pZ80emu->setHardwareModel(m_model);
     Clock::getInstance().setSpectrumModel(m_model);
     m_pScreen = new ZxEmulatorScreen(m_pZ80emu, m_pZxDisplay, this);
+    m_pZxDisplay->setHardwareModel(m_model);
+    m_pZxDisplay->setRenderMode(ZxDisplay::RenderMode::Scanline);
     auto *mainLayout = new QGridLayout;
 
     mainLayout->setColumnStretch(0, 1);
@@ -45,12 +59,18 @@ ZxEmulatorWindow::ZxEmulatorWindow(QString programFile) : m_programFile(std::mov
     setLayout(mainLayout);
 
     setWindowTitle(tr("ZX Raspberry - a bare metal ZX Spectrum Emulator for Raspberry Pi"));
+    QObject::connect(m_pScreen, &ZxEmulatorScreen::turboToggled, this, [this]() { setTurbo(!m_turbo); });
     QTimer::singleShot(0, this, SLOT(initialise()));
 }
 
 
 ZxEmulatorWindow::~ZxEmulatorWindow() {
 
+    if (m_pCapture != nullptr) {
+        m_pZxDisplay->setFrameListener(nullptr);
+        m_pCapture->stop();
+        delete m_pCapture;
+    }
     delete m_pScreen;
     delete m_pZ80emu;
     delete m_model;
@@ -66,25 +86,93 @@ void ZxEmulatorWindow::initialise() {
         QFile programFile(m_programFile);
             if (programFile.open(QIODevice::ReadOnly)) {
                 QByteArray data = programFile.readAll();
-                m_pZ80emu->loadSnapshot(reinterpret_cast<uint8_t *>(data.data()), static_cast<int32_t>(data.size()));
+                auto *pSnapshot = reinterpret_cast<uint8_t *>(data.data());
+                if (!m_pZ80emu->loadSnapshot(pSnapshot, static_cast<size_t>(data.size()))) {
+                    qDebug() << "Not a 48K SNA snapshot:" << m_programFile;
+                }
             } else {
                 qDebug() << "Unable to find program file" << m_programFile;
             }
     }
 
+    if (!m_captureFile.isEmpty()) {
+        // The screen draws into a 32 bpp framebuffer
+        m_pCapture = new ZxVideoCapture(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, 32);
+        auto format = m_captureFile.endsWith(".y4m", Qt::CaseInsensitive) ? ZxVideoCapture::Format::Y4M
+                                                                           : ZxVideoCapture::Format::Raw;
+        if (m_pCapture->start(m_captureFile.toLocal8Bit().constData(), format)) {
+            m_pZxDisplay->setFrameListener(m_pCapture);
+            // The window is not deleted on exit, so finish writing the file when the application quits
+            QObject::connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+                m_pZxDisplay->setFrameListener(nullptr);
+                m_pCapture->stop();
+                qDebug() << "Video capture:" << m_pCapture->framesWritten() << "frames written,"
+                         << m_pCapture->framesDropped() << "dropped";
+            });
+        } else {
+            qDebug() << "Unable to create video capture file" << m_captureFile;
+        }
+    }
+
     m_timer->setTimerType(Qt::PreciseTimer);
     QObject::connect(m_timer, &QTimer::timeout, this, &ZxEmulatorWindow::execute);
 
     // Call timer every 20 milliseconds to simulate a 50Hz refresh rate
-    m_timer->start(20);
+    m_timer->start(m_turbo ? 0 : FRAME_INTERVAL);
+}
+
+
+void ZxEmulatorWindow::setTurbo(bool turbo) {
+
+    if (turbo == m_turbo) {
+        return;
+    }
+
+    m_turbo = turbo;
+    qDebug() << "Turbo mode" << (m_turbo ? "on" : "off");
+
+    // A zero interval timer fires whenever the event loop is idle
+    m_timer->setInterval(m_turbo ? 0 : FRAME_INTERVAL);
+    m_speedFrames = 0;
+    m_speedTimer.start();
+    if (!m_turbo) {
+        setWindowTitle(tr("ZX Raspberry - a bare metal ZX Spectrum Emulator for Raspberry Pi"));
+    }
 }
 
 
 void ZxEmulatorWindow::execute() {
 
-    m_pZ80emu->execute(m_model->tStatesPerScreenFrame());
-    Clock::getInstance().endFrame();
-    m_pScreen->repaint();
+    if (m_turbo) {
+        // Emulate as many frames as fit in the time slice, but only draw the last one as that is the one painted
+        QElapsedTimer slice;
+        slice.start();
+        bool last;
+        do {
+            m_pZ80emu->execute(m_model->tStatesPerScreenFrame());
+            Clock::getInstance().endFrame();
+            m_speedFrames++;
+            last = slice.elapsed() >= TURBO_SLICE;
+            m_pScreen->renderFrame(last);
+        } while (!last);
+
+        // Report the emulated speed as a multiple of real time about once a second
+        if (m_speedTimer.elapsed() >= 1000) {
+            double emulated = static_cast<double>(m_speedFrames) * m_model->tStatesPerScreenFrame() /
+                              m_model->clockFrequency();
+            double speed = emulated * 1000.0 / static_cast<double>(m_speedTimer.elapsed());
+            qDebug() << "Turbo mode:" << speed << "x real time";
+            setWindowTitle(tr("ZX Raspberry - turbo %1x").arg(speed, 0, 'f', 1));
+            m_speedFrames = 0;
+            m_speedTimer.restart();
+        }
+    } else {
+        m_pZ80emu->execute(m_model->tStatesPerScreenFrame());
+        Clock::getInstance().endFrame();
+        m_pScreen->renderFrame();
+    }
+    // Schedule a repaint rather than painting straight away; the screen shows the latest frame when it is painted
+    m_pScreen->update();
 }
 
 
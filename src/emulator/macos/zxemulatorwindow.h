@@ -19,6 +19,7 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
+#include <QElapsedTimer>
 #include <QWidget>
 
 
@@ -27,14 +28,19 @@ class ZxEmulatorScreen;
 class Z80emu;
 class ZxHardwareModel;
 class ZxDisplay;
+class ZxVideoCapture;
 
 class ZxEmulatorWindow : public QWidget {
 Q_OBJECT
 
 public:
-    explicit ZxEmulatorWindow(QString programFile);
+    explicit ZxEmulatorWindow(QString programFile, QString captureFile = QString());
     ~ZxEmulatorWindow() override;
 
+    // Runs the emulation as fast as the host allows, drawing only the last frame emulated before each repaint
+    void setTurbo(bool turbo);
+    [[nodiscard]] bool isTurbo() const { return m_turbo; }
+
 private slots:
     void initialise();
 
@@ -48,6 +54,12 @@ private:
     ZxHardwareModel *m_model;
     Z80emu *m_pZ80emu;
     QString m_programFile;
+    QString m_captureFile;
+    ZxVideoCapture *m_pCapture;
+    bool m_turbo = false;
+    // Emulated frames and wall clock time since the speed was last reported
+    QElapsedTimer m_speedTimer;
+    uint32_t m_speedFrames = 0;
 
     void execute();
 
@@ -23,7 +23,8 @@ bool JoystickAdapter::isAxisButtonReleased(const TGamePadState &pState, TGamePad
     return !isAxisButtonPressed(pState, button, axis);
 }
 
-bool JoystickAdapter::isAxisButtonPressed(const TGamePadState &pState, TGamePadButton button, TGamePadAxis axis) {
+bool JoystickAdapter::isAxisButtonPressed(const TGamePadState &pState, TGamePadButton button,
+                                          TGamePadAxis /* axis */) {
 
 //    if (axis < m_GamePadState.naxes) {
 //        CString Value;
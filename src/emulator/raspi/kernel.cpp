@@ -41,10 +41,29 @@
 #include "kernel.h"
 #include "Z80emu.h"
 #include "zxula.h"
+#include "zxcircletimer.h"
+#include "zxinputpoller.h"
+#include "zxpwmsound.h"
+#include "common/audio/zxaudiobuffer.h"
+#include "common/audio/zxaudioratecontrol.h"
+#include "common/audio/zxay.h"
+#include "common/audio/zxbeeper.h"
+#include "common/zxinputqueue.h"
+#include "common/zxoverloadcontroller.h"
+#include "common/zxrenderpipeline.h"
+#include "common/zxrunahead.h"
 #include "common/hardware/zxhardwaremodel48k.h"
 
 #define DEVICE_INDEX    1        // "upad1"
 
+// Only one in this many frames is drawn in turbo mode
+static const uint32_t TURBO_RENDER_INTERVAL = 8;
+
+// Samples between the emulation and the audio output, about 170 ms at 48 kHz
+static const uint32_t AUDIO_BUFFER_SIZE = 8192;
+// Level of the audio buffer that the emulation keeps to, about 3 frames or 64 ms at 48 kHz
+static const uint32_t AUDIO_TARGET_LEVEL = 3072;
+
 static const char FromKernel[] = "kernel";
 
 CKernel *CKernel::s_pThis = nullptr;
@@ -55,7 +74,7 @@ CKernel::CKernel() :
         m_Logger(m_Options.GetLogLevel(), &m_Timer),
         m_USBHCI(&m_Interrupt, &m_Timer),
         m_ucModifiers(0),
-        m_rawKeys({0, 0, 0, 0, 0, 0}),
+        m_rawKeys{0, 0, 0, 0, 0, 0},
         m_pGamePad(nullptr),
         m_ShutdownMode(ShutdownNone) {
 
@@ -111,11 +130,11 @@ bool CKernel::Initialize() {
         m_Logger.Write(FromKernel, LogNotice, "Initialising display frame buffer");
         /*
          * Our framebuffer uses a 4 bit palette to represent 16 colours that can be displayed on a ZX Spectrum at
-         * anyone time.
+         * anyone time.  Its virtual height holds 3 frames so that the display can triple buffer them.
          */
         m_pFrameBuffer = new CBcmFrameBuffer(
                 ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, ZxDisplay::COLOUR_DEPTH,
-                ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT * 2, 0,
+                ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT * ZxTripleBuffer::BUFFERS, 0,
                 true);
         bOK = (m_pFrameBuffer != nullptr);
     }
@@ -130,20 +149,7 @@ bool CKernel::Initialize() {
 }
 
 
-unsigned clockTicksToMicroSeconds(unsigned ticks) {
-//    float numerator = 1000000.0f;
-//    float denominator = 700000000;
-//    float us_per_tick = numerator / denominator;
-//    float us_per_tick = 700;
-    float us_per_tick = 1500;
-
-    unsigned us = ticks / us_per_tick;
-
-    return us;
-}
-
-
-[[noreturn]] TShutdownMode CKernel::Run() {
+TShutdownMode CKernel::Run() {
 
     /*
      * Configure push button 3 on the Maker pHAT board to work in pull up input model as described in the
@@ -154,15 +160,14 @@ unsigned clockTicksToMicroSeconds(unsigned ticks) {
     m_Logger.Write(FromKernel, LogNotice, "Reboot button enabled: press SW3 (GPIO 20) on Maker pHAT to reboot");
 
     spectrumModel = new ZxHardwareModel48k();
+    z80emu->setHardwareModel(spectrumModel);
     Clock::getInstance().setSpectrumModel(spectrumModel);
 
-    // FIXME: the next few variables belong in the specific hardware class
-    stepStates = new uint32_t[BITMAP_DATA_SIZE];
-    states2scr = new uint32_t[spectrumModel->tStatesPerScreenFrame() + 100];
-    states2border = new uint32_t[spectrumModel->tStatesPerScreenFrame() + 100];
-    delayTstates = new uint8_t[spectrumModel->tStatesPerScreenFrame() + 200];
-
-//    buildScreenTables48k();
+    /* Draw the screen as the ULA fetches it rather than once per frame so that mid-frame changes to the video memory
+     * (e.g. multicolour effects) are displayed correctly.
+     */
+    m_pZxDisplay->setHardwareModel(spectrumModel);
+    m_pZxDisplay->setRenderMode(ZxDisplay::RenderMode::Scanline);
 
 //  CUSBKeyboardDevice *pKeyboard = (CUSBKeyboardDevice *) CDeviceNameService::Get()->GetDevice("ukbd1", FALSE);
     CUSBKeyboardDevice *pKeyboard = (CUSBKeyboardDevice *) m_DeviceNameService.GetDevice("ukbd1", FALSE);
@@ -215,7 +220,9 @@ unsigned clockTicksToMicroSeconds(unsigned ticks) {
 //    z80emu->loadSnapshot(overscan_sna, overscan_sna_len);
 //    z80emu->loadSnapshot(test_2scrn_y_ay8192_sna, test_2scrn_y_ay8192_sna_len);
 //    z80emu->loadSnapshot(automania_sna, automania_sna_len);
-    z80emu->loadSnapshot(testkeys_sna, testkeys_sna_len);
+    if (!z80emu->loadSnapshot(testkeys_sna, testkeys_sna_len)) {
+        m_Logger.Write(FromKernel, LogError, "Invalid SNA snapshot");
+    }
 //    z80emu->loadSnapshot(fpga48all_sna, fpga48all_sna_len);
 
     CCPUThrottle *ccpuThrottle = new CCPUThrottle(CPUSpeedUnknown);
@@ -223,22 +230,93 @@ unsigned clockTicksToMicroSeconds(unsigned ticks) {
     m_Logger.Write(FromKernel, LogNotice, "ZX Spectrum 48K frame rate: 50.08Hz");
     unsigned clockRate = ccpuThrottle->GetClockRate();
     m_Logger.Write(FromKernel, LogNotice, "Host CPU clock rate is %uHz", clockRate);
-    const unsigned clockTicksPerFrame = clockRate / 50;  // Raspberry Pi clock ticks per frame
-    m_Logger.Write(FromKernel, LogNotice, "Host CPU clock ticks per ZX Spectrum frame: %u", clockTicksPerFrame);
-    m_Logger.Write(FromKernel, LogNotice, "Host CPU clock ticks per microsecond: %u", clockRate / 1000000);
+
+    /* Pace the frames against absolute deadlines on the system timer, which runs at CLOCKHZ regardless of the CPU
+     * clock, so that the emulation keeps to the real frame rate of the model.
+     */
+    ZxCircleTimer pacingTimer(m_Timer);
+    ZxFramePacer framePacer(pacingTimer, CLOCKHZ, spectrumModel->tStatesPerScreenFrame(),
+                            spectrumModel->clockFrequency());
+    m_Logger.Write(FromKernel, LogNotice, "System timer ticks per ZX Spectrum frame: %u", framePacer.framePeriod());
+    bool presentFrame = true;
+
+    // Gives up on drawing parts of the frames when emulating and drawing them takes longer than the frame period
+    ZxOverloadController overloadController(pacingTimer, framePacer.framePeriod());
+    ZxOverloadController::Level overloadLevel = overloadController.level();
+
+    /* Show frames from the near future to make up for the input lag, as many as set by the "runahead" option in
+     * cmdline.txt, e.g. runahead=1, and only while the host has the time to spare.
+     */
+    ZxRunAhead runAhead(*z80emu, *spectrumModel, pacingTimer, framePacer.framePeriod());
+    runAhead.setFrames(m_Options.GetAppOptionDecimal("runahead", 0));
+    m_Logger.Write(FromKernel, LogNotice, "Run-ahead frames: %u", runAhead.frames());
 
     bool flash = false;
     uint32_t frameCounter = 0;
-    step = 0;
 
-    std::unique_ptr<ZxUla> zxUla(new ZxUla(*z80emu, *m_pFrameBuffer));
+    /* The state of the input ports is queued every time the keyboard or gamepad reports a change, by the input poller
+     * or else the USB interrupt handlers, and the emulation applies each change at the T-state matching its time.
+     */
+    ZxInputQueue inputQueue(framePacer.framePeriod(), spectrumModel->tStatesPerScreenFrame());
+    z80emu->setInputQueue(&inputQueue);
+    std::unique_ptr<ZxUla> zxUla(new ZxUla(*z80emu, *m_pFrameBuffer, inputQueue));
+    m_pZxUla = zxUla.get();
+    refreshInput();
+
+    /* The beeper turns the EAR and MIC bits written during each frame into samples once the frame ends, mixed with
+     * those of the AY chip, and the PWM audio output plays them from the audio buffer.
+     */
+    ZxAudioBuffer audioBuffer(AUDIO_BUFFER_SIZE);
+    ZxBeeper beeper(audioBuffer, spectrumModel->clockFrequency(), spectrumModel->tStatesPerScreenFrame(),
+                    ZxAudioSink::DEFAULT_SAMPLE_RATE);
+    z80emu->setBeeper(&beeper);
+    ZxAY ay(spectrumModel->clockFrequency(), spectrumModel->tStatesPerScreenFrame(), beeper.sampleRate());
+    z80emu->setAY(&ay);
+    ZxPWMSound sound(&m_Interrupt, audioBuffer, beeper.sampleRate());
+    const bool audioClock = sound.start();
+    if (!audioClock) {
+        m_Logger.Write(FromKernel, LogWarning, "Cannot start the sound output");
+    }
 
-    uint32_t nextEvent = stepStates[0];
+    /* The audio clock drives the pace of the emulation: the rate control keeps the audio buffer at its target level by
+     * nudging the frame rate of the pacer, so that the emulation makes samples exactly as fast as the audio output
+     * plays them.  Without sound, the pacer keeps to the system timer alone.
+     */
+    ZxAudioRateControl rateControl(AUDIO_TARGET_LEVEL);
 
 #ifdef DEBUG
     m_Logger.Write(FromKernel, LogNotice, "T-states per frame: %u", spectrumModel->tStatesPerScreenFrame());
 #endif // DEBUG
 
+    // The keyboard is only looked up at start-up, so the message is set up once, before the display is in use
+    if (pKeyboard == nullptr) {
+        auto zxMessage = new ZxGroup({2, 30, 38, 2});
+        auto zxLabel1 = new ZxLabel({0, 0, 36, 1}, "Keyboard not found!");
+        auto zxLabel2 = new ZxLabel({0, 1, 36, 1}, "Please connect keyboard to continue.");
+        zxMessage->insert(zxLabel1);
+        zxMessage->insert(zxLabel2);
+        m_pZxDisplay->setUI(zxMessage);
+    }
+
+#ifdef ARM_ALLOW_MULTI_CORE
+    /* Leave core 0 to the emulation alone: core 1 draws each frame from a snapshot of the video memory and border
+     * changes taken when the frame ends, and core 2 queues the keyboard and gamepad reports as input events.  Drawing
+     * from a snapshot replaces the scanline rendering set up above.
+     */
+    ZxRenderPipeline renderPipeline(*m_pZxDisplay);
+    ZxInputPoller inputPoller(*zxUla, m_inputReports, m_ucModifiers, m_rawKeys, m_GamePadState, DEVICE_INDEX + 1);
+    ZxMultiCore multiCore(CMemorySystem::Get());
+    multiCore.assign(1, &renderPipeline);
+    multiCore.assign(2, &inputPoller);
+    if (!multiCore.start()) {
+        m_Logger.Write(FromKernel, LogPanic, "Cannot start the secondary cores");
+    }
+#endif // ARM_ALLOW_MULTI_CORE
+
+    // Start pacing from the first frame rather than from the time the pacer was set up
+    framePacer.reset();
+    overloadController.reset();
+
     while (m_ShutdownMode == ShutdownNone) {
 //#ifdef DEBUG
 //        m_Logger.Write(FromKernel, LogNotice, "Running CPU instructions. Frame: %d", frameCounter);
@@ -249,7 +327,9 @@ unsigned clockTicksToMicroSeconds(unsigned ticks) {
          */
         (flash) ? m_ActLED.On() : m_ActLED.Off();
 
-        unsigned startClockTicks = m_Timer.GetClockTicks();
+        // Turbo mode is toggled from the keyboard or gamepad, and is silent as the sound would not keep up
+        framePacer.setTurbo(zxUla->isTurbo());
+        z80emu->setSilent(framePacer.isTurbo());
 
         /* https://stackoverflow.com/questions/112439/cpu-emulation-and-locking-to-a-specific-clock-speed
          *
@@ -279,32 +359,19 @@ unsigned clockTicksToMicroSeconds(unsigned ticks) {
          * int64_t numberOfStatesRemainingInFrame = 70908 - 228 - z80emu->getStates();
          */
 
-        /* Refresh keyboard and gamepad IO.  A more accurate version of the emulator may want to check the state of
-         * the keyboard and gamepad when the IO ports are read by the ULA.
-         */
-        zxUla->refreshInit();
-        zxUla->refreshKeyboard(m_ucModifiers, m_rawKeys);
-        zxUla->refreshGamepad(DEVICE_INDEX + 1, m_GamePadState);
-        zxUla->refreshDone();
+        // Input events are due a frame late, at their time relative to the start of the previous frame
+        inputQueue.startFrame(pacingTimer.clockTicks());
 
         zxUla->scanLineReset();
 
-//        while (step < BITMAP_DATA_SIZE) {
-//            z80emu->run(stepStates[step]);
-//            if (Clock::getInstance().getTstates() >= nextEvent) {
-//                nextEvent = step < stepStates.length ? stepStates[step] : NO_EVENT;
-//                m_pZxDisplay->updateBorder(Clock::getInstance().getTstates());
-//            }
-//        }
-
         /* Execute a frame's worth of T-states.  This will be roughly 20ms on a 48K ZX Spectrum.
          * 20ms * 50 = 3.5MHz
          */
-        z80emu->execute(spectrumModel->tStatesPerScreenFrame());
+        overloadController.beginFrame();
 
-        Clock::getInstance().endFrame();
-//        step = 0;
-//        nextEvent = stepStates[0];
+        runAhead.setEnabled(!framePacer.isTurbo() && overloadController.level() == ZxOverloadController::Level::Full);
+        runAhead.setRenderCost(overloadController.renderCost());
+        runAhead.runFrame(*m_pZxDisplay);
 
         /* A single ZX Spectrum display row takes 224 T-States, including the horizontal fly-back. For every T-State,
          * 2 pixels are written to the display, so 128 T-States will pass for the 256 pixels in a display row. The ZX
@@ -322,24 +389,76 @@ unsigned clockTicksToMicroSeconds(unsigned ticks) {
 //        m_Logger.Write(FromKernel, LogNotice, "Refreshing video framebuffer");
 //#endif // DEBUG
 
-        if (pKeyboard == nullptr && m_pZxDisplay->getUI() == nullptr) {
-            auto zxMessage = new ZxGroup({2, 30, 38, 2});
-            auto zxLabel1 = new ZxLabel({0, 0, 36, 1}, "Keyboard not found!");
-            auto zxLabel2 = new ZxLabel({0, 1, 36, 1}, "Please connect keyboard to continue.");
-            zxMessage->insert(zxLabel1);
-            zxMessage->insert(zxLabel2);
-            m_pZxDisplay->setUI(zxMessage);
-        } else if (pKeyboard != nullptr && m_pZxDisplay->getUI() != nullptr) {
-            delete m_pZxDisplay->getUI();
-            m_pZxDisplay->setUI(nullptr);
+        overloadController.emulationDone();
+
+        /* Turbo mode only draws one frame in TURBO_RENDER_INTERVAL, so most of the time goes into the emulation.
+         * Otherwise the overload controller decides what to draw.
+         */
+        bool renderFrame = framePacer.isTurbo() ? frameCounter % TURBO_RENDER_INTERVAL == 0
+                                                : overloadController.renderFrame();
+        m_pZxDisplay->setDrawBorder(overloadController.drawBorder());
+        if (!renderFrame) {
+            m_pZxDisplay->skip();
+        } else {
+#ifdef ARM_ALLOW_MULTI_CORE
+            renderPipeline.capture(flash);
+#else
+            m_pZxDisplay->update(flash);
+#endif // ARM_ALLOW_MULTI_CORE
+        }
+        /* Show the frame just completed, unless the emulation is catching up after an overrun; this only moves the
+         * virtual offset of the framebuffer.
+         */
+        if (presentFrame && renderFrame) {
+            m_pZxDisplay->present();
+        }
+        runAhead.rewind();
+        overloadController.endFrame();
+
+        if (overloadController.level() != overloadLevel) {
+            overloadLevel = overloadController.level();
+            m_Logger.Write(FromKernel, LogWarning, "Overload level %u: emulation %u us, rendering %u us per frame",
+                           static_cast<unsigned>(overloadLevel), overloadController.emulationCost(),
+                           overloadController.renderCost());
         }
 
-        m_pZxDisplay->update(flash);
+        // Follow the audio clock, unless there is no sound or turbo mode is making none
+        if (audioClock && !framePacer.isTurbo()) {
+            framePacer.setRateAdjustment(rateControl.update(audioBuffer.available()));
+        } else {
+            rateControl.reset();
+            framePacer.setRateAdjustment(0);
+        }
+
+        // Wait for the frame to be due, or carry straight on if it is late
+        presentFrame = framePacer.endFrame();
+
+        if (framePacer.isTurbo() && frameCounter % 500 == 0) {
+            m_Logger.Write(FromKernel, LogNotice, "Turbo mode: %u.%02ux real time",
+                           framePacer.speedPercent() / 100, framePacer.speedPercent() % 100);
+        }
 
-        unsigned endClockTicks = m_Timer.GetClockTicks();
-        unsigned usDelay = clockTicksToMicroSeconds(clockTicksPerFrame - (endClockTicks - startClockTicks));
-//        m_Logger.Write (FromKernel, LogNotice, "Delay (microseconds): %u", usDelay);
-        m_Timer.usDelay(usDelay);
+#ifdef DEBUG
+        if (framePacer.frames() % 500 == 0) {
+            m_Logger.Write(FromKernel, LogNotice,
+                           "Frame time (us): min %u, avg %u, p99 %u, max %u; late %u, dropped %u, resyncs %u",
+                           framePacer.frameTimeMin(), framePacer.frameTimeAverage(),
+                           framePacer.frameTimePercentile(99), framePacer.frameTimeMax(),
+                           framePacer.framesLate(), framePacer.framesDropped(), framePacer.resyncs());
+            m_Logger.Write(FromKernel, LogNotice,
+                           "Overload level %u: degradations %u, recoveries %u; borders skipped %u, renders skipped %u",
+                           static_cast<unsigned>(overloadController.level()), overloadController.degradations(),
+                           overloadController.recoveries(), overloadController.bordersSkipped(),
+                           overloadController.rendersSkipped());
+            m_Logger.Write(FromKernel, LogNotice, "Run-ahead %s: %u us per frame, %u frames ahead",
+                           runAhead.isActive() ? "active" : "inactive", runAhead.frameCost(), runAhead.framesAhead());
+            m_Logger.Write(FromKernel, LogNotice, "Input events dropped: %u", inputQueue.dropped());
+            m_Logger.Write(FromKernel, LogNotice,
+                           "Audio samples buffered %u (average %u), dropped %u; underruns %u; rate adjustment %d ppm",
+                           audioBuffer.available(), rateControl.averageLevel(), audioBuffer.overruns(),
+                           sound.underruns(), rateControl.adjustment());
+        }
+#endif // DEBUG
 
         // Check whether GPIO pin 20, SW3 on the Maker pHAT, has been pressed and reboot the Raspberry Pi if so.
         if (m_ResetPin.Read() == 0) {
@@ -351,6 +470,12 @@ unsigned clockTicksToMicroSeconds(unsigned ticks) {
         }
     }
 
+    // Stop the USB handlers from using the ULA, and the emulation the beeper and the AY chip, before they go away
+    m_pZxUla = nullptr;
+    sound.stop();
+    z80emu->setAY(nullptr);
+    z80emu->setBeeper(nullptr);
+
     return m_ShutdownMode;
 }
 
@@ -376,6 +501,7 @@ void CKernel::KeyStatusHandlerRaw(unsigned char ucModifiers, const unsigned char
     assert (s_pThis != nullptr);
     s_pThis->m_ucModifiers = ucModifiers;
     memcpy(&s_pThis->m_rawKeys, RawKeys, 6 * sizeof(unsigned char));
+    s_pThis->inputReported();
 }
 
 
@@ -389,4 +515,38 @@ void CKernel::gamePadStatusHandler(unsigned nDeviceIndex, const TGamePadState *p
     assert (s_pThis != nullptr);
     assert (pState != nullptr);
     memcpy(&s_pThis->m_GamePadState, pState, sizeof *pState);
+    s_pThis->inputReported();
+}
+
+
+/*
+ * Called by the USB interrupt handlers once they have stored a report.  With the secondary cores running, the input
+ * poller on core 2 picks the report up; otherwise the handler queues it straight away.
+ */
+void CKernel::inputReported() {
+
+#ifdef ARM_ALLOW_MULTI_CORE
+    m_inputReports.fetch_add(1, std::memory_order_release);
+#else
+    refreshInput();
+#endif // ARM_ALLOW_MULTI_CORE
+}
+
+
+/*
+ * Works out the state of the input ports from the last keyboard and gamepad reports and queues it for the emulation.
+ * This runs at start-up and then in the USB interrupt handlers, which never run at the same time, so there is only
+ * one producer for the input queue at a time.
+ */
+void CKernel::refreshInput() {
+
+    ZxUla *pZxUla = m_pZxUla;
+    if (pZxUla == nullptr) {
+        return;
+    }
+
+    pZxUla->refreshInit();
+    pZxUla->refreshKeyboard(m_ucModifiers, m_rawKeys);
+    pZxUla->refreshGamepad(DEVICE_INDEX + 1, m_GamePadState);
+    pZxUla->refreshDone();
 }
@@ -19,6 +19,7 @@
 #ifndef KERNEL_H
 #define KERNEL_H
 
+#include <atomic>
 #include <memory>
 #include <circle/memory.h>
 #include <circle/actled.h>
@@ -40,6 +41,7 @@
 class CBcmFrameBuffer;
 class Z80emu;
 class ZxHardwareModel;
+class ZxUla;
 
 enum TShutdownMode {
     ShutdownNone,
@@ -53,7 +55,7 @@ public:
     ~CKernel();
     bool Initialize();
 
-    [[noreturn]] TShutdownMode Run();
+    TShutdownMode Run();
 
 private:
 
@@ -98,6 +100,14 @@ private:
     // TODO: move the gamepad handling routines to their own class
     static void gamePadStatusHandler(unsigned nDeviceIndex, const TGamePadState *pState);
 
+    void inputReported();
+    void refreshInput();
+
+    // Set while the emulation runs, so that the USB handlers can queue input events
+    ZxUla * volatile m_pZxUla{};
+    // Keyboard and gamepad reports stored so far, for the input poller to tell when there is a new one
+    std::atomic<unsigned> m_inputReports{0};
+
     ZxHardwareModel *spectrumModel{};
 
     /* The Spectrum screen memory map is split into two sections:
@@ -107,34 +117,6 @@ private:
     int BITMAP_DATA_SIZE = 0x1800;      // 6144 bytes
     int ATTRIBUTE_DATA_SIZE = 0x0300;   // 768 bytes
 
-//    int tStatesToScreenPixel48k(int tstates);
-//    void buildScreenTables48k();
-
-    // Tabla que contiene la dirección de pantalla del primer byte de cada
-    // carácter en la columna cero.
-    uint32_t *scrAddr = new uint32_t[ZxDisplay::SCREEN_HEIGHT];
-
-    // Tabla de traslación entre t-states y la dirección de la pantalla del
-    // Spectrum que se vuelca en ese t-state o -1 si no le corresponde ninguna.
-    uint32_t *states2scr{};
-    // Tabla de traslación de t-states al pixel correspondiente del borde.
-    uint32_t *states2border{};
-
-    uint8_t *delayTstates{};
-
-    // T-state sequence we need to run to update the screen
-    uint32_t *stepStates{};
-    uint32_t step{};
-    // Constante que indica que no hay un evento próximo
-    // El valor de la constante debe ser mayor que cualquier spectrumModel.tstatesframe
-    uint32_t NO_EVENT = 0xFFFFFFFF;
-    // t-states del próximo evento
-    uint32_t nextEvent = NO_EVENT;
-
-    uint32_t firstBorderUpdate{};
-    uint32_t lastBorderUpdate{};
-    int borderMode{};
-
 };
 
 #endif // KERNEL_H
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXCIRCLETIMER_H
+#define ZXRASPBERRY_ZXCIRCLETIMER_H
+
+#include <circle/timer.h>
+#include "common/zxframepacer.h"
+
+
+/*
+ * Frame pacer time source backed by the Circle system timer, which ticks at CLOCKHZ (1 MHz).
+ */
+class ZxCircleTimer : public ZxPacingTimer {
+
+public:
+    explicit ZxCircleTimer(CTimer &timer) : m_timer(timer) {
+    }
+
+    uint32_t clockTicks() override {
+        return m_timer.GetClockTicks();
+    }
+
+    void waitTicks(uint32_t ticks) override {
+        m_timer.usDelay(ticks * (1000000 / CLOCKHZ));
+    }
+
+private:
+    CTimer &m_timer;
+};
+
+
+#endif //ZXRASPBERRY_ZXCIRCLETIMER_H
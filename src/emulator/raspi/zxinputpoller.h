@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020-2022 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXINPUTPOLLER_H
+#define ZXRASPBERRY_ZXINPUTPOLLER_H
+
+#include <atomic>
+#include <circle/timer.h>
+#include <circle/usb/usbgamepad.h>
+#include "common/zxmulticore.h"
+#include "zxula.h"
+
+
+/*
+ * Works out the state of the keyboard and gamepad ports from the reports last stored by the USB interrupt handlers and
+ * queues it for the emulation, so that this is done on a secondary core rather than in the interrupt handlers on the
+ * emulation core.  The handlers count the reports they store, and the reports are looked at again once per
+ * millisecond, which is how often the USB devices report their state at most, if the count has changed.  A report
+ * that is read while a handler is still storing it is read again at the next poll, since the count changes after it.
+ */
+class ZxInputPoller : public ZxCoreTask {
+
+public:
+    static const unsigned POLL_INTERVAL = CLOCKHZ / 1000;
+
+    ZxInputPoller(ZxUla &zxUla, const std::atomic<unsigned> &reports, const unsigned char &ucModifiers,
+                  const unsigned char *pRawKeys, const TGamePadState &gamePadState, unsigned nDeviceIndex) :
+            m_zxUla(zxUla),
+            m_reports(reports),
+            m_ucModifiers(ucModifiers),
+            m_pRawKeys(pRawKeys),
+            m_gamePadState(gamePadState),
+            m_nDeviceIndex(nDeviceIndex),
+            m_lastPoll(CTimer::GetClockTicks()),
+            // Look at the reports straight away, in case one came in before the poller started
+            m_lastReports(reports.load(std::memory_order_acquire) - 1) {
+    }
+
+    bool step() override {
+        unsigned now = CTimer::GetClockTicks();
+        if (now - m_lastPoll < POLL_INTERVAL) {
+            return false;
+        }
+        m_lastPoll = now;
+
+        unsigned reports = m_reports.load(std::memory_order_acquire);
+        if (reports == m_lastReports) {
+            return false;
+        }
+        m_lastReports = reports;
+
+        m_zxUla.refreshInit();
+        m_zxUla.refreshKeyboard(m_ucModifiers, m_pRawKeys);
+        m_zxUla.refreshGamepad(m_nDeviceIndex, m_gamePadState);
+        m_zxUla.refreshDone();
+        return true;
+    }
+
+private:
+    ZxUla &m_zxUla;
+    const std::atomic<unsigned> &m_reports;
+    const unsigned char &m_ucModifiers;
+    const unsigned char *m_pRawKeys;
+    const TGamePadState &m_gamePadState;
+    unsigned m_nDeviceIndex;
+    unsigned m_lastPoll;
+    unsigned m_lastReports;
+};
+
+
+#endif //ZXRASPBERRY_ZXINPUTPOLLER_H
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "zxpwmsound.h"
+#include "common/audio/zxaudiobuffer.h"
+
+// The Spectrum 48K runs at about 50 frames per second
+static const uint32_t FRAMES_PER_SECOND = 50;
+
+
+ZxPWMSound::ZxPWMSound(CInterruptSystem *pInterrupt, ZxAudioBuffer &buffer, uint32_t sampleRate) :
+        CPWMSoundBaseDevice(pInterrupt, sampleRate, CHUNK_SIZE),
+        m_buffer(buffer),
+        m_sampleRate(sampleRate),
+        m_startLevel(sampleRate * START_FRAMES / FRAMES_PER_SECOND),
+        m_rangeMin(GetRangeMin()),
+        m_range(GetRangeMax() - GetRangeMin()),
+        m_samples(),
+        m_lastSample(0),
+        m_bWaiting(true),
+        m_underruns(0) {
+}
+
+ZxPWMSound::~ZxPWMSound() {
+    stop();
+}
+
+bool ZxPWMSound::start() {
+    return Start();
+}
+
+void ZxPWMSound::stop() {
+    Cancel();
+}
+
+/*
+ * Called from the DMA interrupt handler: both channels play the same sample, scaled to the range of the PWM output.
+ */
+unsigned ZxPWMSound::GetChunk(u32 *pBuffer, unsigned nChunkSize) {
+
+    const uint32_t count = (nChunkSize < CHUNK_SIZE) ? nChunkSize / 2 : CHUNK_SIZE / 2;
+    uint32_t samples = 0;
+    if (m_bWaiting) {
+        m_bWaiting = m_buffer.available() < m_startLevel;
+    }
+    if (!m_bWaiting) {
+        samples = m_buffer.read(m_samples, count);
+        if (samples < count) {
+            m_underruns = m_underruns + 1;
+            m_bWaiting = true;
+        }
+    }
+    if (samples > 0) {
+        m_lastSample = m_samples[samples - 1];
+    }
+    for (uint32_t i = samples; i < count; i++) {
+        m_samples[i] = m_lastSample;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        auto value = static_cast<u32>(m_rangeMin + (((m_samples[i] + 32768) * m_range) >> 16));
+        *pBuffer++ = value;
+        *pBuffer++ = value;
+    }
+
+    return count * 2;
+}
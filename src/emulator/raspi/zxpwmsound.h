@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 Jose Hernandez
+ *
+ * This file is part of ZxRaspberry.
+ *
+ * ZxRaspberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ZxRaspberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ZxRaspberry.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef ZXRASPBERRY_ZXPWMSOUND_H
+#define ZXRASPBERRY_ZXPWMSOUND_H
+
+#include <circle/interrupt.h>
+#include <circle/sound/pwmsoundbasedevice.h>
+#include <circle/types.h>
+#include "common/audio/zxaudiosink.h"
+
+class ZxAudioBuffer;
+
+
+/*
+ * Plays the samples of the emulation on the PWM audio output of the Raspberry Pi, i.e. the headphone jack.  Circle
+ * asks for the next chunk of samples from the DMA interrupt handler, which takes them out of the audio buffer.
+ *
+ * The output starts once the buffer holds START_FRAMES frames of samples, so that there is always some sound in hand
+ * while the emulation works on the next frame.  If the buffer runs dry all the same, the last sample is held rather
+ * than dropping to silence, which would click, and the output waits for the buffer to fill up again.
+ */
+class ZxPWMSound : public CPWMSoundBaseDevice, public ZxAudioSink {
+
+public:
+    // Interleaved left and right samples per chunk, i.e. 512 samples or about 11 ms at 48 kHz
+    static const unsigned CHUNK_SIZE = 1024;
+    static const uint32_t START_FRAMES = 2;
+
+    ZxPWMSound(CInterruptSystem *pInterrupt, ZxAudioBuffer &buffer, uint32_t sampleRate);
+    ~ZxPWMSound() override;
+
+    bool start();
+    void stop() override;
+
+    [[nodiscard]] uint32_t sampleRate() const override {
+        return m_sampleRate;
+    }
+
+    [[nodiscard]] uint32_t underruns() const override {
+        return m_underruns;
+    }
+
+protected:
+    unsigned GetChunk(u32 *pBuffer, unsigned nChunkSize) override;
+
+private:
+    ZxAudioBuffer &m_buffer;
+    const uint32_t m_sampleRate;
+    const uint32_t m_startLevel;
+    const int m_rangeMin;
+    const int m_range;
+    int16_t m_samples[CHUNK_SIZE / 2];
+    int16_t m_lastSample;
+    bool m_bWaiting;
+    volatile uint32_t m_underruns;
+
+};
+
+
+#endif //ZXRASPBERRY_ZXPWMSOUND_H
@@ -19,6 +19,9 @@
 #include <circle/bcmframebuffer.h>
 #include <circle/logger.h>
 #include <circle/startup.h>
+#include <circle/string.h>
+#include <circle/timer.h>
+#include <circle/util.h>
 #include <circle/usb/usbgamepad.h>
 #include "common/gui/zxlabel.h"
 #include "z80.h"
@@ -29,7 +32,11 @@
 
 static const char FromUla[] = "ULA";
 
-ZxUla::ZxUla(Z80emu &zxRaspberry, CBcmFrameBuffer &frameBuffer) : m_zxRaspberry(zxRaspberry), m_frameBuffer(frameBuffer) {
+ZxUla::ZxUla(Z80emu &zxRaspberry, CBcmFrameBuffer &frameBuffer, ZxInputQueue &inputQueue) :
+        m_zxRaspberry(zxRaspberry),
+        m_frameBuffer(frameBuffer),
+        m_inputQueue(inputQueue),
+        m_lastEvent({0, {0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu}, 0x00u}) {
 
     isSwitchingGamePadAdapter = false;
 }
@@ -69,26 +76,30 @@ void ZxUla::refreshInit() {
 }
 
 void ZxUla::refreshDone() {
-    refreshPort(0x011F, port_011F);
-    refreshPort(0xF7FE, port_F7FE);
-    refreshPort(0xFBFE, port_FBFE);
-    refreshPort(0xFDFE, port_FDFE);
-    refreshPort(0xFEFE, port_FEFE);
-    refreshPort(0xEFFE, port_EFFE);
-    refreshPort(0xDFFE, port_DFFE);
-    refreshPort(0xBFFE, port_BFFE);
-    refreshPort(0x7FFE, port_7FFE);
-}
 
-void ZxUla::refreshPort(uint16_t port, uint8_t value) {
-#ifdef DEBUG
-    if ((((port & 0x00FE) == 0x00FE) && (value != 0xFFu)) || ((port == 0x011F) && (value != 0x00u))) {
-        CString Message;
-        Message.Format("Updating port '%04X' = '%02X'", port, value);
-        CLogger::Get()->Write(FromUla, LogNotice, Message);
+    // Half rows in the order of the address line that selects them, A8 to A15
+    ZxInputEvent event = {
+        CTimer::GetClockTicks(),
+        { port_FEFE, port_FDFE, port_FBFE, port_F7FE, port_EFFE, port_DFFE, port_BFFE, port_7FFE },
+        port_011F
+    };
+
+    // The gamepad reports its state periodically, changed or not
+    if (memcmp(event.keyboard, m_lastEvent.keyboard, sizeof(event.keyboard)) == 0 &&
+        event.kempston == m_lastEvent.kempston) {
+        return;
     }
+
+#ifdef DEBUG
+    CLogger::Get()->Write(FromUla, LogNotice, "Input ports FEFE-7FFE: %02X %02X %02X %02X %02X %02X %02X %02X; 011F: %02X",
+                          port_FEFE, port_FDFE, port_FBFE, port_F7FE, port_EFFE, port_DFFE, port_BFFE, port_7FFE,
+                          port_011F);
 #endif // DEBUG
-    m_zxRaspberry.internalOutPort(port, value);
+
+    // Nothing to do if the queue is full but try again with the next report
+    if (m_inputQueue.push(event)) {
+        m_lastEvent = event;
+    }
 }
 
 //   Using shift keys and a combination of modes the Spectrum 40-key keyboard
@@ -127,7 +138,8 @@ void ZxUla::refreshKeyboard(unsigned char ucModifiers, const unsigned char RawKe
 #endif // DEBUG
 
     // call the keyboard adapter using ZXOperations rather than zxRaspberry
-    boolean hasValue = false;
+    [[maybe_unused]] boolean hasValue = false;
+    bool turboKeyDown = false;
 
     // Detect Ctrl+Alt+Delete and reboot the device
     if ((ucModifiers == 0x05) && (RawKeys[0] == 0x63)) {
@@ -297,10 +309,21 @@ void ZxUla::refreshKeyboard(unsigned char ucModifiers, const unsigned char RawKe
                 case 0x2C: // BREAK SPACE
                     port_7FFE &= KEY_PRESSED_BIT0;
                     break;
+
+                case 0x45: // F12 -> toggle turbo mode
+                    turboKeyDown = true;
+                    break;
             }
         }
     }
 
+    // Toggle turbo mode once per key press rather than for as long as the key is held down
+    if (turboKeyDown && !isTurboKeyDown) {
+        m_bTurbo = !m_bTurbo;
+        CLogger::Get()->Write(FromUla, LogNotice, "Turbo mode %s", m_bTurbo ? "on" : "off");
+    }
+    isTurboKeyDown = turboKeyDown;
+
 #ifdef DEBUG
     if (hasValue) {
         CLogger::Get()->Write(FromUla, LogNotice, Message);
@@ -326,7 +349,7 @@ enum ZxGamePadMode {
     Q_A_O_P_SPACE_M
 };
 
-void ZxUla::refreshGamepad(unsigned nDeviceIndex, const TGamePadState &pState) {
+void ZxUla::refreshGamepad(unsigned /* nDeviceIndex */, const TGamePadState &pState) {
 
 #ifdef DEBUG
     if (pState.buttons != 0) {
@@ -336,7 +359,7 @@ void ZxUla::refreshGamepad(unsigned nDeviceIndex, const TGamePadState &pState) {
     }
 #endif // DEBUG
 
-    // The 'share' button on a PS4 controller makes the emulator cycle through joystick emulation modes
+    // The 'PS' button on a PS4 controller makes the emulator cycle through joystick emulation modes
 //    if (isAxisButtonPressed(pState, GamePadButtonShare, GamePadAxisButtonUp)) {
     if (isAxisButtonPressed(pState, GamePadButtonPS, GamePadAxisButtonUp)) {
         if (!isSwitchingGamePadAdapter) {
@@ -362,6 +385,14 @@ void ZxUla::refreshGamepad(unsigned nDeviceIndex, const TGamePadState &pState) {
         isSwitchingGamePadAdapter = false;
     }
 
+    // The 'share' button on a PS4 controller toggles turbo mode
+    bool turboButtonDown = isAxisButtonPressed(pState, GamePadButtonShare, GamePadAxisButtonUp);
+    if (turboButtonDown && !isTurboButtonDown) {
+        m_bTurbo = !m_bTurbo;
+        CLogger::Get()->Write(FromUla, LogNotice, "Turbo mode %s", m_bTurbo ? "on" : "off");
+    }
+    isTurboButtonDown = turboButtonDown;
+
     // Kempston Joystick bit pattern: 000FUDLR
     // https://worldofspectrum.org/faq/reference/peripherals.htm
     // https://chuntey.wordpress.com/2010/01/06/using-kempston-joystick-in-your-own-basic-programs/
@@ -443,7 +474,7 @@ bool ZxUla::isAxisButtonReleased(const TGamePadState &pState, TGamePadButton but
     return !isAxisButtonPressed(pState, button, axis);
 }
 
-bool ZxUla::isAxisButtonPressed(const TGamePadState &pState, TGamePadButton button, TGamePadAxis axis) {
+bool ZxUla::isAxisButtonPressed(const TGamePadState &pState, TGamePadButton button, TGamePadAxis /* axis */) {
 
 //    if (axis < m_GamePadState.naxes) {
 //        CString Value;
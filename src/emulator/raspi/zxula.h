@@ -19,6 +19,7 @@
 #ifndef ZXULA_H
 #define ZXULA_H
 
+#include <atomic>
 #include <vector>
 #include "gamepad/JoystickAdapter.h"
 #include "gamepad/NoneGamePadAdapter.h"
@@ -28,6 +29,7 @@
 #include "gamepad/Sinclair2GamePadAdapter.h"
 #include "gamepad/CursorJoystickAdapter.h"
 #include "gamepad/KeyboardGamePadAdapter.h"
+#include "common/zxinputqueue.h"
 
 class Z80emu;
 class CBcmFrameBuffer;
@@ -35,19 +37,34 @@ class CBcmFrameBuffer;
 class ZxUla {
 
 public:
-    ZxUla(Z80emu &zxRaspberry, CBcmFrameBuffer &frameBuffer);
+    ZxUla(Z80emu &zxRaspberry, CBcmFrameBuffer &frameBuffer, ZxInputQueue &inputQueue);
 
     void scanLineReset();
     void scanLineNext();
 
+    /* Works out the state of the keyboard and joystick ports from the keyboard and gamepad reports.  refreshDone()
+     * queues the new state, stamped with the current time, if it differs from the last one queued.
+     */
     void refreshInit();
     void refreshKeyboard(unsigned char ucModifiers, const unsigned char rawKeys[6]);
     void refreshGamepad(unsigned nDeviceIndex, const TGamePadState &pState);
     void refreshDone();
 
+    /* Turbo mode, in which the emulator runs as fast as it can, is toggled with F12 on the keyboard or the share
+     * button on the gamepad.  The input may be refreshed on a different core from the one that reads the mode.
+     */
+    void setTurbo(bool turbo) {
+        m_bTurbo = turbo;
+    }
+    [[nodiscard]] bool isTurbo() const {
+        return m_bTurbo;
+    }
+
 private:
     Z80emu &m_zxRaspberry;
     CBcmFrameBuffer &m_frameBuffer;
+    ZxInputQueue &m_inputQueue;
+    ZxInputEvent m_lastEvent;
 
 // TODO:
 //    struct PortCache {
@@ -72,7 +89,6 @@ private:
     uint8_t port_BFFE = 0xFFu;
     uint8_t port_7FFE = 0xFFu;
 
-    void refreshPort(uint16_t port, uint8_t value);
     bool isAxisButtonPressed(const TGamePadState &pState, TGamePadButton Button, TGamePadAxis Axis);
     bool isAxisButtonReleased(const TGamePadState &pState, TGamePadButton Button, TGamePadAxis Axis);
 
@@ -91,6 +107,10 @@ private:
     uint8_t currentGamePadAdapter = 0;
     bool isSwitchingGamePadAdapter = false;
 
+    std::atomic<bool> m_bTurbo{false};
+    bool isTurboKeyDown = false;
+    bool isTurboButtonDown = false;
+
 };
 
 
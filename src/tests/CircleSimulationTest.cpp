@@ -0,0 +1,131 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_CIRCLESIMULATIONTEST_CPP
+#define ZXRASPBERRY_CIRCLESIMULATIONTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <circle/devicenameservice.h>
+#include <circle/gpiopin.h>
+#include <circle/koptions.h>
+#include <circle/simulation.h>
+#include <circle/timer.h>
+#include <circle/usb/usbgamepad.h>
+#include <circle/usb/usbhcidevice.h>
+#include <circle/usb/usbkeyboard.h>
+
+
+static std::vector<std::string> s_reports;
+
+static void keyStatusHandlerRaw(unsigned char ucModifiers, const unsigned char RawKeys[6]) {
+    char report[32];
+    snprintf(report, sizeof report, "keys %02X %02X %02X", ucModifiers, RawKeys[0], RawKeys[1]);
+    s_reports.emplace_back(report);
+}
+
+static void gamePadStatusHandler(unsigned nDeviceIndex, const TGamePadState *pState) {
+    char report[32];
+    snprintf(report, sizeof report, "upad%u %04X", nDeviceIndex + 1, pState->buttons);
+    s_reports.emplace_back(report);
+}
+
+// The simulation runs in virtual time, set up the first time that it is used
+static CSimulation &simulation() {
+    setenv("ZX_SIM_TIME", "virtual", 1);
+    return CSimulation::Get();
+}
+
+// Adds an event due the given number of milliseconds from now
+static bool addEvent(unsigned nMilliSeconds, const char *pAction) {
+    std::string line = std::to_string(CTimer::GetClockTicks() / 1000 + nMilliSeconds) + " " + pAction;
+    return simulation().AddEvent(line.c_str());
+}
+
+
+TEST_SUITE("Circle simulation") {
+
+    TEST_CASE("Virtual time only moves on when waiting") {
+        simulation();
+        unsigned start = CTimer::GetClockTicks();
+
+        CHECK(CTimer::GetClockTicks() == start);
+        CTimer::SimpleMsDelay(20);
+        CHECK(CTimer::GetClockTicks() == start + 20000);
+        CTimer::SimpleusDelay(5);
+        CHECK(CTimer::GetClockTicks() == start + 20005);
+    }
+
+    TEST_CASE("The USB devices are driven by the script once the events are due") {
+        CDeviceNameService deviceNameService;
+        CUSBHCIDevice usbHCI(nullptr, nullptr);
+        REQUIRE(usbHCI.Initialize());
+
+        auto *pKeyboard = (CUSBKeyboardDevice *) deviceNameService.GetDevice("ukbd1", FALSE);
+        auto *pGamePad = (CUSBGamePadDevice *) deviceNameService.GetDevice("upad", 1, FALSE);
+        REQUIRE(pKeyboard != nullptr);
+        REQUIRE(pGamePad != nullptr);
+        CHECK(deviceNameService.GetDevice("upad2", FALSE) == nullptr);
+        CHECK(deviceNameService.GetDevice("ukbd1", TRUE) == nullptr);
+        pKeyboard->RegisterKeyStatusHandlerRaw(keyStatusHandlerRaw);
+        pGamePad->RegisterStatusHandler(gamePadStatusHandler);
+        s_reports.clear();
+
+        // Added out of order, but played in order of time
+        REQUIRE(addEvent(30, "keys 0x02 0x1E 0x14"));
+        REQUIRE(addEvent(10, "buttons 0x200"));
+        REQUIRE(addEvent(40, "keys 0"));
+
+        CTimer::SimpleMsDelay(5);
+        CHECK(s_reports.empty());
+
+        CTimer::SimpleMsDelay(30);
+        REQUIRE(s_reports.size() == 2);
+        CHECK(s_reports[0] == "upad1 0200");
+        CHECK(s_reports[1] == "keys 02 1E 14");
+
+        CTimer::SimpleMsDelay(10);
+        REQUIRE(s_reports.size() == 3);
+        CHECK(s_reports[2] == "keys 00 00 00");
+        CHECK(simulation().PendingEvents() == 0);
+    }
+
+    TEST_CASE("GPIO input pins read as their pull resistor sets them until the script drives them") {
+        CGPIOPin resetPin(20, GPIOModeInputPullUp);
+        CGPIOPin otherPin(21, GPIOModeInputPullDown);
+        REQUIRE(addEvent(100, "gpio 20 0"));
+
+        CHECK(resetPin.Read() == HIGH);
+        CHECK(otherPin.Read() == LOW);
+        CTimer::SimpleMsDelay(100);
+        CHECK(resetPin.Read() == LOW);
+        CHECK(otherPin.Read() == LOW);
+    }
+
+    TEST_CASE("Lines that are not events are rejected") {
+        CHECK_FALSE(simulation().AddEvent("keys 0x00"));
+        CHECK_FALSE(simulation().AddEvent("100 press 0x1E"));
+        CHECK_FALSE(simulation().AddEvent("100 buttons"));
+        CHECK_FALSE(simulation().AddEvent("100 gpio 20"));
+        CHECK(simulation().PendingEvents() == 0);
+    }
+
+    TEST_CASE("Kernel options come from the simulated command line") {
+        setenv("ZX_SIM_CMDLINE", "loglevel=2  runahead=3 width=wide", 1);
+        CKernelOptions options;
+
+        CHECK(CKernelOptions::Get() == &options);
+        CHECK(options.GetLogLevel() == 2);
+        CHECK(options.GetAppOptionDecimal("runahead", 0) == 3);
+        CHECK(options.GetAppOptionDecimal("width", 7) == 7);
+        CHECK(options.GetAppOptionDecimal("height", 5) == 5);
+        CHECK(std::string(options.GetAppOptionString("width")) == "wide");
+    }
+}
+
+#endif // ZXRASPBERRY_CIRCLESIMULATIONTEST_CPP
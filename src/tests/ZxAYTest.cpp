@@ -0,0 +1,319 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXAYTEST_CPP
+#define ZXRASPBERRY_ZXAYTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+#include "clock.h"
+#include "audio/zxaudiobuffer.h"
+#include "audio/zxay.h"
+#include "audio/zxbeeper.h"
+#include "audio/zxwavwriter.h"
+#include "hardware/zxhardwaremodel128k.h"
+#include "ZxTestFiles.h"
+#include "ZxTestMachine.h"
+
+static const uint32_t CLOCK_FREQUENCY = 3500000;
+static const uint32_t TSTATES_PER_FRAME = 69888;
+static const uint32_t SAMPLE_RATE = 48000;
+static const uint32_t BUFFER_SIZE = 1u << 20;
+// Tone period of 250 ticks: 1.75 MHz / (16 * 250)
+static const double TONE_FREQUENCY = 437.5;
+
+struct RegisterWrite {
+    uint8_t reg;
+    uint8_t value;
+};
+
+static void writeAll(ZxAY &ay, const std::vector<RegisterWrite> &writes, uint32_t tstates = 0) {
+    for (const RegisterWrite &write : writes) {
+        ay.write(write.reg, write.value, tstates);
+    }
+}
+
+static std::vector<int16_t> runFrames(ZxAY &ay, uint32_t frames) {
+    std::vector<int16_t> samples;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        uint32_t count = ay.endFrame(TSTATES_PER_FRAME);
+        samples.insert(samples.end(), ay.frame(), ay.frame() + count);
+    }
+    return samples;
+}
+
+// Times that the samples go up through the given level
+static uint32_t crossings(const std::vector<int16_t> &samples, size_t from, int32_t level) {
+    uint32_t count = 0;
+    for (size_t i = from + 1; i < samples.size(); i++) {
+        count += (samples[i - 1] < level && samples[i] >= level) ? 1 : 0;
+    }
+    return count;
+}
+
+// Channel A playing its tone at full volume, the other channels and the noise switched off
+static const std::vector<RegisterWrite> TONE_A = {
+        { ZxAY::TONE_A_FINE, 250 }, { ZxAY::TONE_A_COARSE, 0 }, { ZxAY::MIXER, 0x3E }, { ZxAY::VOLUME_A, 0x0F }
+};
+
+// Writes two AY registers through the ports and reads one of them back into 0x9100
+static const std::vector<uint8_t> AY_PORTS_PROGRAM = {
+        0x01, 0xFD, 0xFF,       // LD BC,0xFFFD
+        0x3E, 0x01,             // LD A,1
+        0xED, 0x79,             // OUT (C),A        select the coarse tone period of channel A
+        0x06, 0xBF,             // LD B,0xBF
+        0x3E, 0xFF,             // LD A,0xFF
+        0xED, 0x79,             // OUT (C),A        which only has 4 bits
+        0x06, 0xFF,             // LD B,0xFF
+        0xED, 0x78,             // IN A,(C)
+        0x32, 0x00, 0x91,       // LD (0x9100),A
+        0x3E, 0x07,             // LD A,7
+        0xED, 0x79,             // OUT (C),A        select the mixer
+        0x06, 0xBF,             // LD B,0xBF
+        0x3E, 0x38,             // LD A,0x38
+        0xED, 0x79,             // OUT (C),A
+        0x18, 0xFE              // JR $
+};
+
+
+TEST_SUITE("AY-3-8912 sound chip") {
+
+    TEST_CASE("A tone is heard at the frequency of its period") {
+        ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        writeAll(ay, TONE_A);
+        auto samples = runFrames(ay, 100);
+
+        CHECK(*std::max_element(samples.begin(), samples.end()) == ZxAY::VOLUME);
+        CHECK(*std::min_element(samples.begin(), samples.end()) == 0);
+        double expected = TONE_FREQUENCY * static_cast<double>(samples.size()) / SAMPLE_RATE;
+        CHECK(std::abs(crossings(samples, 0, ZxAY::VOLUME / 2) - expected) < expected / 100);
+    }
+
+    TEST_CASE("Channels switched off in the mixer hold their volume and channels with no volume are silent") {
+        ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        writeAll(ay, { { ZxAY::TONE_B_FINE, 100 }, { ZxAY::VOLUME_B, 0x0F }, { ZxAY::TONE_C_FINE, 100 },
+                       { ZxAY::MIXER, 0x3F } });
+        auto samples = runFrames(ay, 10);
+
+        // With tone and noise switched off, channels B and C are held at their volume
+        CHECK(std::all_of(samples.begin() + 100, samples.end(), [](int16_t sample) {
+            return sample == ZxAY::VOLUME;
+        }));
+    }
+
+    TEST_CASE("The noise is a random level") {
+        ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        writeAll(ay, { { ZxAY::NOISE_PERIOD, 1 }, { ZxAY::MIXER, 0x37 }, { ZxAY::VOLUME_A, 0x0F } });
+        auto samples = runFrames(ay, 10);
+
+        std::set<int16_t> levels(samples.begin(), samples.end());
+        CHECK(levels.size() > 100);
+        CHECK(*levels.begin() >= 0);
+        CHECK(*levels.rbegin() <= ZxAY::VOLUME);
+    }
+
+    TEST_CASE("The envelope ramps up and holds, or ramps down and stops") {
+        // A step every 200 ticks: the ramp takes 16 * 200 * 16 = 51200 T-states
+        const std::vector<RegisterWrite> envelope = {
+                { ZxAY::ENVELOPE_FINE, 100 }, { ZxAY::ENVELOPE_COARSE, 0 }, { ZxAY::MIXER, 0x3F },
+                { ZxAY::VOLUME_A, 0x10 }
+        };
+        ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        writeAll(ay, envelope);
+        ay.write(ZxAY::ENVELOPE_SHAPE, 0x0D, 0);
+        auto attack = runFrames(ay, 3);
+
+        CHECK(std::is_sorted(attack.begin(), attack.end()));
+        CHECK(attack[10] < ZxAY::VOLUME / 100);
+        CHECK(attack.back() == ZxAY::VOLUME);
+
+        writeAll(ay, { { ZxAY::ENVELOPE_SHAPE, 0x00 } });
+        auto decay = runFrames(ay, 3);
+        CHECK(std::is_sorted(decay.rbegin(), decay.rend()));
+        CHECK(decay.back() == 0);
+
+        // Writing the shape starts the envelope again, even if it is the same shape
+        writeAll(ay, { { ZxAY::ENVELOPE_SHAPE, 0x0E } });
+        auto triangle = runFrames(ay, 4);
+        CHECK(crossings(triangle, 0, ZxAY::VOLUME / 2) >= 2);
+    }
+
+    TEST_CASE("Writes are heard at their T-state") {
+        ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        writeAll(ay, { { ZxAY::MIXER, 0x3F } });
+        ay.write(ZxAY::VOLUME_A, 0x0F, TSTATES_PER_FRAME / 2);
+        auto samples = runFrames(ay, 1);
+
+        // Half a frame is 479.2 samples, and the output lags TAPS ticks, 3.5 samples, behind
+        auto loud = std::find_if(samples.begin(), samples.end(), [](int16_t sample) {
+            return sample >= ZxAY::VOLUME / 2;
+        });
+        CHECK((loud - samples.begin()) >= 480);
+        CHECK((loud - samples.begin()) <= 485);
+        CHECK(samples.back() == ZxAY::VOLUME);
+    }
+
+    TEST_CASE("As many samples as the beeper makes for the same frames") {
+        ZxAudioBuffer buffer(BUFFER_SIZE);
+        ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+
+        uint64_t samples = 0;
+        bool same = true;
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            uint32_t frameTstates = TSTATES_PER_FRAME + frame % 23;
+            uint32_t count = ay.endFrame(frameTstates);
+            beeper.endFrame(frameTstates, ay.frame(), count);
+            samples += count;
+            same = same && beeper.samples() == samples;
+        }
+        CHECK(same);
+    }
+
+    TEST_CASE("Writes past the capacity of a frame are dropped and counted") {
+        ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+
+        for (uint32_t i = 0; i < ZxAY::MAX_WRITES + 10; i++) {
+            ay.write(ZxAY::VOLUME_A, static_cast<uint8_t>(i), i * 8);
+        }
+        CHECK(ay.writesDropped() == 10);
+        ay.endFrame(TSTATES_PER_FRAME);
+        CHECK(ay.writesDropped() == 10);
+    }
+
+    TEST_CASE("The vectorised mixer and filter give the same samples as the plain ones") {
+        if (!ZxAY::isVectorised()) {
+            return;
+        }
+
+        std::vector<int16_t> samples[2];
+        for (bool vectorised : { false, true }) {
+            ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+            ay.setVectorised(vectorised);
+            writeAll(ay, { { ZxAY::TONE_A_FINE, 57 }, { ZxAY::TONE_B_FINE, 113 }, { ZxAY::TONE_C_COARSE, 1 },
+                           { ZxAY::NOISE_PERIOD, 7 }, { ZxAY::MIXER, 0x2A }, { ZxAY::VOLUME_A, 0x10 },
+                           { ZxAY::VOLUME_B, 0x0B }, { ZxAY::VOLUME_C, 0x07 }, { ZxAY::ENVELOPE_FINE, 40 },
+                           { ZxAY::ENVELOPE_SHAPE, 0x0A } });
+            for (uint32_t tstates = 1000; tstates < TSTATES_PER_FRAME; tstates += 7777) {
+                ay.write(ZxAY::VOLUME_C, static_cast<uint8_t>(tstates & 0x0F), tstates);
+            }
+            samples[vectorised ? 1 : 0] = runFrames(ay, 20);
+        }
+        CHECK(samples[0] == samples[1]);
+    }
+
+    TEST_CASE("The AY ports select, write and read the registers") {
+        ZxTestMachine<ZxHardwareModel128k> machine;
+        Z80emu &z80emu = machine.z80emu;
+        REQUIRE(machine.load(AY_PORTS_PROGRAM));
+
+        const uint32_t frameTstates = machine.model.tStatesPerScreenFrame();
+        ZxAudioBuffer buffer(BUFFER_SIZE);
+        ZxBeeper beeper(buffer, machine.model.clockFrequency(), frameTstates, SAMPLE_RATE);
+        ZxAY ay(machine.model.clockFrequency(), frameTstates, SAMPLE_RATE);
+        z80emu.setBeeper(&beeper);
+        z80emu.setAY(&ay);
+        z80emu.execute(frameTstates);
+        Clock::getInstance().endFrame();
+
+        Z80emu::MachineState state;
+        z80emu.saveState(state);
+        CHECK(z80emu.peek8(0x9100) == 0x0F);
+        CHECK(state.aySelected == 7);
+        CHECK(state.ayRegisters[ZxAY::TONE_A_COARSE] == 0x0F);
+        CHECK(state.ayRegisters[ZxAY::MIXER] == 0x38);
+        CHECK(beeper.samples() > 0);
+        z80emu.setAY(nullptr);
+        z80emu.setBeeper(nullptr);
+    }
+
+    TEST_CASE("The 48K has no AY, so its AY ports read the floating bus") {
+        ZxTestMachine<> machine;
+        Z80emu &z80emu = machine.z80emu;
+        REQUIRE(machine.load(AY_PORTS_PROGRAM));
+        z80emu.execute(machine.model.tStatesPerScreenFrame());
+        Clock::getInstance().endFrame();
+
+        Z80emu::MachineState state;
+        z80emu.saveState(state);
+        // The port is read in the top border, where the ULA fetches nothing
+        CHECK(z80emu.peek8(0x9100) == 0xFF);
+        CHECK(state.aySelected == 0);
+        CHECK(state.ayRegisters[ZxAY::TONE_A_COARSE] == 0);
+        CHECK(state.ayRegisters[ZxAY::MIXER] == 0);
+    }
+
+    TEST_CASE("The WAV writer records the AY chip mixed with the beeper") {
+        const std::string fileName = "zxay_test.wav";
+        ZxAudioBuffer buffer(BUFFER_SIZE);
+        ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        ZxWavWriter writer(buffer, SAMPLE_RATE);
+        REQUIRE(writer.start(fileName.c_str()));
+        writeAll(ay, TONE_A);
+        const uint32_t frames = 100;
+        for (uint32_t frame = 0; frame < frames; frame++) {
+            uint32_t count = ay.endFrame(TSTATES_PER_FRAME);
+            beeper.endFrame(TSTATES_PER_FRAME, ay.frame(), count);
+        }
+        writer.stop();
+
+        CHECK_FALSE(writer.writeFailed());
+        CHECK(buffer.overruns() == 0);
+        auto data = readFile(fileName);
+        REQUIRE(data.size() == 44 + writer.samplesWritten() * 2);
+        CHECK(std::string(data.begin(), data.begin() + 4) == "RIFF");
+        CHECK(readLE(data, 24, 4) == SAMPLE_RATE);
+        CHECK(readLE(data, 40, 4) == writer.samplesWritten() * 2);
+
+        // The beeper filters out the DC level of the tone, which then swings around zero
+        std::vector<int16_t> samples;
+        for (size_t offset = 44; offset < data.size(); offset += 2) {
+            samples.push_back(static_cast<int16_t>(readLE(data, offset, 2)));
+        }
+        const size_t settled = SAMPLE_RATE / 2;
+        double expected = TONE_FREQUENCY * static_cast<double>(samples.size() - settled) / SAMPLE_RATE;
+        CHECK(std::abs(crossings(samples, settled, 0) - expected) < expected / 100);
+        CHECK(*std::max_element(samples.begin() + settled, samples.end()) > ZxAY::VOLUME / 3);
+        CHECK(*std::min_element(samples.begin() + settled, samples.end()) < -ZxAY::VOLUME / 3);
+        std::remove(fileName.c_str());
+    }
+
+    TEST_CASE("AY cost per frame") {
+        // Not an assertion: report the cost of a frame with all three channels, noise and envelope, plain and vectorised
+        const uint32_t frames = 1000;
+        for (bool vectorised : { false, true }) {
+            if (vectorised && !ZxAY::isVectorised()) {
+                continue;
+            }
+            ZxAY ay(CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+            ay.setVectorised(vectorised);
+            writeAll(ay, { { ZxAY::TONE_A_FINE, 120 }, { ZxAY::TONE_B_FINE, 180 }, { ZxAY::TONE_C_FINE, 30 },
+                           { ZxAY::NOISE_PERIOD, 3 }, { ZxAY::MIXER, 0x18 }, { ZxAY::VOLUME_A, 0x0F },
+                           { ZxAY::VOLUME_B, 0x0C }, { ZxAY::VOLUME_C, 0x10 }, { ZxAY::ENVELOPE_FINE, 10 },
+                           { ZxAY::ENVELOPE_SHAPE, 0x0C } });
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                // A music player changes the notes once a frame
+                for (uint8_t channel = 0; channel < 3; channel++) {
+                    ay.write(ZxAY::TONE_A_FINE + channel * 2, static_cast<uint8_t>(30 + (frame + channel * 20) % 200),
+                             1000 + channel * 24);
+                }
+                ay.endFrame(TSTATES_PER_FRAME);
+            }
+            auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+            std::printf("AY %-10s: %7.2f us per frame\n", vectorised ? "vectorised" : "plain", elapsed.count() / frames);
+        }
+    }
+}
+
+#endif // ZXRASPBERRY_ZXAYTEST_CPP
@@ -0,0 +1,104 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXAUDIOBUFFERTEST_CPP
+#define ZXRASPBERRY_ZXAUDIOBUFFERTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <thread>
+#include <vector>
+#include "audio/zxaudiobuffer.h"
+
+
+TEST_SUITE("ZX audio buffer") {
+
+    TEST_CASE("The capacity is rounded up to a power of two") {
+        ZxAudioBuffer buffer(1000);
+
+        CHECK(buffer.capacity() == 1024);
+        CHECK(buffer.available() == 0);
+    }
+
+    TEST_CASE("Samples come out in the order they went in, across the end of the ring") {
+        ZxAudioBuffer buffer(16);
+        int16_t samples[12];
+        int16_t read[12];
+        int16_t next = 0;
+        int16_t expected = 0;
+
+        for (uint32_t round = 0; round < 10; round++) {
+            for (int16_t &sample : samples) {
+                sample = next++;
+            }
+            REQUIRE(buffer.write(samples, 12) == 12);
+            CHECK(buffer.available() == 12);
+            REQUIRE(buffer.read(read, 12) == 12);
+            for (int16_t sample : read) {
+                CHECK(sample == expected++);
+            }
+        }
+        CHECK(buffer.overruns() == 0);
+    }
+
+    TEST_CASE("Samples written into a full buffer are dropped and counted") {
+        ZxAudioBuffer buffer(16);
+        int16_t samples[24] = {};
+        int16_t read[24];
+
+        CHECK(buffer.write(samples, 24) == 16);
+        CHECK(buffer.overruns() == 8);
+        CHECK(buffer.write(samples, 1) == 0);
+        CHECK(buffer.overruns() == 9);
+
+        // Reading runs short once the buffer is empty
+        CHECK(buffer.read(read, 24) == 16);
+        CHECK(buffer.read(read, 24) == 0);
+    }
+
+    TEST_CASE("Samples cross from the emulation thread to the audio sink in order") {
+        static const uint32_t SAMPLES = 1000000;
+        static const uint32_t FRAME = 958;
+        ZxAudioBuffer buffer(4096);
+
+        std::thread emulation([&buffer]() {
+            std::vector<int16_t> frame(FRAME);
+            uint32_t written = 0;
+            while (written < SAMPLES) {
+                uint32_t count = (SAMPLES - written < FRAME) ? SAMPLES - written : FRAME;
+                for (uint32_t i = 0; i < count; i++) {
+                    frame[i] = static_cast<int16_t>(written + i);
+                }
+                // Wait for room rather than drop samples, so that every sample can be checked
+                while (buffer.capacity() - buffer.available() < count) {
+                    std::this_thread::yield();
+                }
+                written += buffer.write(frame.data(), count);
+            }
+        });
+
+        uint32_t received = 0;
+        uint32_t corrupted = 0;
+        int16_t chunk[512];
+        while (received < SAMPLES) {
+            uint32_t count = buffer.read(chunk, 512);
+            if (count == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                corrupted += (chunk[i] != static_cast<int16_t>(received + i)) ? 1 : 0;
+            }
+            received += count;
+        }
+        emulation.join();
+
+        CHECK(corrupted == 0);
+        CHECK(buffer.overruns() == 0);
+        CHECK(buffer.available() == 0);
+    }
+}
+
+#endif // ZXRASPBERRY_ZXAUDIOBUFFERTEST_CPP
@@ -0,0 +1,217 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXAUDIORATECONTROLTEST_CPP
+#define ZXRASPBERRY_ZXAUDIORATECONTROLTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <cstdio>
+#include <cstdlib>
+#include "zxframepacer.h"
+#include "audio/zxaudiobuffer.h"
+#include "audio/zxaudioratecontrol.h"
+#include "audio/zxaudiosink.h"
+#include "audio/zxbeeper.h"
+
+static const uint32_t TICKS_PER_SECOND = 1000000;
+static const uint32_t CLOCK_FREQUENCY = 3500000;
+static const uint32_t TSTATES_PER_FRAME = 69888;
+static const uint32_t SAMPLE_RATE = 48000;
+// As on the Raspberry Pi: the audio buffer, the level that the emulation keeps it to and the chunks of the PWM output
+static const uint32_t BUFFER_SIZE = 8192;
+static const uint32_t TARGET_LEVEL = 3072;
+static const uint32_t CHUNK_SIZE = 1024;
+static const uint32_t START_LEVEL = SAMPLE_RATE * 2 / 50;
+// Time taken to emulate each frame, in microseconds
+static const uint32_t EMULATION_COST = 4000;
+
+/*
+ * Timer that only moves when told to, either by the emulated frame taking some time to run or by the pacer waiting.
+ */
+class FakeTimer : public ZxPacingTimer {
+
+public:
+    uint32_t clockTicks() override {
+        return m_ticks;
+    }
+
+    void waitTicks(uint32_t ticks) override {
+        m_ticks += ticks;
+    }
+
+    uint32_t m_ticks = 0;
+};
+
+/*
+ * Audio output that, like the PWM sound device, takes CHUNK_SIZE samples at a time from the buffer, at a sample rate
+ * that is a few parts per million off the one that the emulation makes samples for.  It waits for START_LEVEL samples
+ * before it starts playing, and whenever the buffer is short of a whole chunk, which is heard as a pop.
+ */
+class SimulatedSink : public ZxAudioSink {
+
+public:
+    SimulatedSink(ZxAudioBuffer &buffer, int32_t error) :
+            m_buffer(buffer),
+            m_chunkPeriod(static_cast<double>(CHUNK_SIZE) * TICKS_PER_SECOND / (SAMPLE_RATE * (1.0 + error / 1e6))) {
+    }
+
+    // Plays the chunks that are due up to the given time, in timer ticks
+    void runUntil(uint32_t ticks) {
+        while (m_nextChunk <= ticks) {
+            m_nextChunk += m_chunkPeriod;
+            if (!m_bPlaying) {
+                m_bPlaying = m_buffer.available() >= START_LEVEL;
+                continue;
+            }
+            int16_t chunk[CHUNK_SIZE];
+            if (m_buffer.read(chunk, CHUNK_SIZE) < CHUNK_SIZE) {
+                m_underruns++;
+                m_bPlaying = false;
+            }
+        }
+    }
+
+    [[nodiscard]] uint32_t sampleRate() const override {
+        return SAMPLE_RATE;
+    }
+
+    void stop() override {
+        m_bPlaying = false;
+    }
+
+    [[nodiscard]] uint32_t underruns() const override {
+        return m_underruns;
+    }
+
+private:
+    ZxAudioBuffer &m_buffer;
+    double m_chunkPeriod;
+    double m_nextChunk = 0.0;
+    bool m_bPlaying = false;
+    uint32_t m_underruns = 0;
+};
+
+struct Result {
+    uint32_t underruns;
+    uint32_t overruns;
+    // Level of the buffer and rate adjustment once settled, i.e. over the last half of the run
+    uint32_t minLevel;
+    uint32_t maxLevel;
+    int32_t adjustment;
+    // Largest change of the rate adjustment from one frame to the next, once settled
+    int32_t maxStep;
+};
+
+/*
+ * Emulates a 48K playing a 1 kHz tone on the beeper for the given number of seconds, paced by the system timer, with
+ * or without the rate control, while the sink plays its sound at a rate off by the given parts per million.
+ */
+static Result simulate(int32_t sinkError, uint32_t seconds, bool rateControl) {
+    FakeTimer timer;
+    ZxFramePacer pacer(timer, TICKS_PER_SECOND, TSTATES_PER_FRAME, CLOCK_FREQUENCY);
+    ZxAudioBuffer buffer(BUFFER_SIZE);
+    ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+    SimulatedSink sink(buffer, sinkError);
+    ZxAudioRateControl control(TARGET_LEVEL);
+
+    Result result = { 0, 0, BUFFER_SIZE, 0, 0, 0 };
+    const uint32_t frames = seconds * 50;
+    uint64_t nextEdge = 0;
+    uint8_t ear = 0x10;
+    int32_t lastAdjustment = 0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        const uint64_t frameStart = static_cast<uint64_t>(frame) * TSTATES_PER_FRAME;
+        for (; nextEdge < frameStart + TSTATES_PER_FRAME; nextEdge += CLOCK_FREQUENCY / 2000) {
+            beeper.write(ear, static_cast<uint32_t>(nextEdge - frameStart));
+            ear ^= 0x10u;
+        }
+        timer.m_ticks += EMULATION_COST;
+        sink.runUntil(timer.m_ticks);
+        beeper.endFrame(TSTATES_PER_FRAME);
+
+        if (rateControl) {
+            pacer.setRateAdjustment(control.update(buffer.available()));
+        }
+        if (frame >= frames / 2) {
+            result.minLevel = (buffer.available() < result.minLevel) ? buffer.available() : result.minLevel;
+            result.maxLevel = (buffer.available() > result.maxLevel) ? buffer.available() : result.maxLevel;
+            int32_t step = std::abs(pacer.rateAdjustment() - lastAdjustment);
+            result.maxStep = (step > result.maxStep) ? step : result.maxStep;
+        }
+        lastAdjustment = pacer.rateAdjustment();
+
+        pacer.endFrame();
+        sink.runUntil(timer.m_ticks);
+    }
+
+    result.underruns = sink.underruns();
+    result.overruns = buffer.overruns();
+    result.adjustment = pacer.rateAdjustment();
+    return result;
+}
+
+
+TEST_SUITE("Dynamic audio rate control") {
+
+    TEST_CASE("The adjustment follows the average level of the buffer, up to the largest adjustment") {
+        ZxAudioRateControl control(TARGET_LEVEL);
+        CHECK(control.update(TARGET_LEVEL) == 0);
+
+        // A single chunk taken out barely moves the adjustment
+        int32_t adjustment = control.update(TARGET_LEVEL - CHUNK_SIZE);
+        CHECK(adjustment > 0);
+        CHECK(adjustment < ZxAudioRateControl::MAX_ADJUSTMENT / 10);
+
+        // A quarter of the target level below it is half the largest adjustment, once the average has caught up
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            adjustment = control.update(TARGET_LEVEL * 3 / 4);
+        }
+        CHECK(control.averageLevel() == TARGET_LEVEL * 3 / 4);
+        CHECK(adjustment == ZxAudioRateControl::MAX_ADJUSTMENT / 2);
+
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            adjustment = control.update(0);
+        }
+        CHECK(adjustment == ZxAudioRateControl::MAX_ADJUSTMENT);
+
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            adjustment = control.update(BUFFER_SIZE);
+        }
+        CHECK(adjustment == -ZxAudioRateControl::MAX_ADJUSTMENT);
+
+        control.reset();
+        CHECK(control.adjustment() == 0);
+        CHECK(control.averageLevel() == TARGET_LEVEL);
+    }
+
+    TEST_CASE("Paced by the system timer alone, an audio clock a little off runs out of samples or of room") {
+        // 0.2% fast drains the buffer by 96 samples a second, and 0.2% slow fills it
+        Result fast = simulate(2000, 120, false);
+        CHECK(fast.underruns > 0);
+
+        Result slow = simulate(-2000, 120, false);
+        CHECK(slow.overruns > 0);
+    }
+
+    TEST_CASE("Following the audio clock keeps the buffer level bounded with no underruns or overruns") {
+        for (int32_t sinkError : { -3000, -2000, -63, 0, 63, 2000, 3000 }) {
+            Result result = simulate(sinkError, 600, true);
+
+            CHECK(result.underruns == 0);
+            CHECK(result.overruns == 0);
+            // The buffer settles where the adjustment makes up for the error of the sink, and never runs low
+            CHECK(std::abs(result.adjustment - sinkError) < 150);
+            CHECK(result.minLevel > CHUNK_SIZE / 2);
+            CHECK(result.maxLevel < BUFFER_SIZE - 2 * CHUNK_SIZE);
+            // The pitch glides by a few parts per million a frame rather than jumping
+            CHECK(result.maxStep < 100);
+            std::printf("Audio clock %+5d ppm: adjustment %+5d ppm, buffer %4u to %4u samples\n", sinkError,
+                        result.adjustment, result.minLevel, result.maxLevel);
+        }
+    }
+}
+
+#endif // ZXRASPBERRY_ZXAUDIORATECONTROLTEST_CPP
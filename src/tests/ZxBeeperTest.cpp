@@ -0,0 +1,207 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXBEEPERTEST_CPP
+#define ZXRASPBERRY_ZXBEEPERTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "audio/zxaudiobuffer.h"
+#include "audio/zxbeeper.h"
+#include "audio/zxwavwriter.h"
+#include "ZxTestFiles.h"
+
+static const uint32_t CLOCK_FREQUENCY = 3500000;
+static const uint32_t TSTATES_PER_FRAME = 69888;
+static const uint32_t SAMPLE_RATE = 48000;
+static const uint32_t BUFFER_SIZE = 1u << 20;
+
+static std::vector<int16_t> readAll(ZxAudioBuffer &buffer) {
+    std::vector<int16_t> samples(buffer.available());
+    samples.resize(buffer.read(samples.data(), static_cast<uint32_t>(samples.size())));
+    return samples;
+}
+
+/*
+ * Toggles the EAR bit every halfPeriod T-states for the given number of frames, as a beeper engine would.
+ */
+static void playSquareWave(ZxBeeper &beeper, uint32_t halfPeriod, uint32_t frames) {
+    uint64_t next = halfPeriod;
+    uint8_t value = 0x10;
+    for (uint64_t frameStart = 0; frameStart < static_cast<uint64_t>(frames) * TSTATES_PER_FRAME;
+         frameStart += TSTATES_PER_FRAME) {
+        while (next < frameStart + TSTATES_PER_FRAME) {
+            beeper.write(value, static_cast<uint32_t>(next - frameStart));
+            value ^= 0x10u;
+            next += halfPeriod;
+        }
+        beeper.endFrame(TSTATES_PER_FRAME);
+    }
+}
+
+
+TEST_SUITE("ZX beeper") {
+
+    TEST_CASE("Frames keep the fraction of a sample that they end on and are silent without changes") {
+        ZxAudioBuffer buffer(BUFFER_SIZE);
+        ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+
+        // 69888 T-states at 3.5 MHz are 958.464 samples at 48 kHz
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            beeper.endFrame(TSTATES_PER_FRAME);
+        }
+        auto samples = readAll(buffer);
+        CHECK(samples.size() >= 958463);
+        CHECK(samples.size() <= 958464);
+        CHECK(beeper.samples() == samples.size());
+
+        uint32_t noise = 0;
+        for (int16_t sample : samples) {
+            noise += (sample != 0) ? 1 : 0;
+        }
+        CHECK(noise == 0);
+    }
+
+    TEST_CASE("A square wave is heard at its frequency, free of DC and with no more than the ringing of a step") {
+        ZxAudioBuffer buffer(BUFFER_SIZE);
+        ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+
+        // 1 kHz for about a second
+        playSquareWave(beeper, CLOCK_FREQUENCY / 2000, 50);
+        auto samples = readAll(buffer);
+
+        // Leave the DC filter some time to settle
+        const size_t settled = SAMPLE_RATE / 5;
+        REQUIRE(samples.size() > settled + SAMPLE_RATE / 2);
+        uint32_t crossings = 0;
+        int32_t peak = 0;
+        int64_t sum = 0;
+        for (size_t i = settled; i < samples.size(); i++) {
+            crossings += ((samples[i - 1] < 0) != (samples[i] < 0)) ? 1 : 0;
+            peak = std::max(peak, std::abs(static_cast<int32_t>(samples[i])));
+            sum += samples[i];
+        }
+        auto milliseconds = static_cast<uint32_t>((samples.size() - settled) * 1000 / SAMPLE_RATE);
+        CHECK(crossings >= milliseconds * 2 - 2);
+        CHECK(crossings <= milliseconds * 2 + 2);
+
+        // Half of the swing of the EAR bit either way, plus the overshoot of a band-limited step
+        CHECK(peak > ZxBeeper::VOLUME / 2 * 9 / 10);
+        CHECK(peak < ZxBeeper::VOLUME / 2 * 12 / 10);
+        CHECK(std::abs(sum / static_cast<int64_t>(samples.size() - settled)) < ZxBeeper::VOLUME / 100);
+    }
+
+    TEST_CASE("Changes are heard at their exact time, between samples") {
+        // 100 T-states per sample
+        const uint32_t sampleRate = CLOCK_FREQUENCY / 100;
+        std::vector<int16_t> steps[3];
+        const uint32_t times[3] = { 1000, 1100, 1050 };
+        for (uint32_t i = 0; i < 3; i++) {
+            ZxAudioBuffer buffer(BUFFER_SIZE);
+            ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, sampleRate);
+            beeper.write(0x10, times[i]);
+            beeper.endFrame(TSTATES_PER_FRAME);
+            steps[i] = readAll(buffer);
+        }
+
+        // A change one sample later gives the same samples one sample later
+        bool shifted = true;
+        for (size_t i = 0; i + 1 < steps[0].size(); i++) {
+            shifted = shifted && steps[1][i + 1] == steps[0][i];
+        }
+        CHECK(shifted);
+
+        // A change half way through a sample is heard half way between: the samples differ from both, and the area
+        // under the step, which shrinks by one sample's worth of level per sample of delay, lies between both
+        int64_t areas[3] = { 0, 0, 0 };
+        bool different = false;
+        for (size_t i = 0; i < 40; i++) {
+            for (uint32_t j = 0; j < 3; j++) {
+                areas[j] += steps[j][i];
+            }
+            different = different || (steps[2][i] != steps[0][i] && steps[2][i] != steps[1][i]);
+        }
+        CHECK(areas[1] < areas[2]);
+        CHECK(areas[2] < areas[0]);
+        CHECK(std::abs(2 * areas[2] - areas[0] - areas[1]) < (areas[0] - areas[1]) / 4);
+        CHECK(different);
+    }
+
+    TEST_CASE("Changes past the capacity of a frame are dropped and counted") {
+        ZxAudioBuffer buffer(BUFFER_SIZE);
+        ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+
+        for (uint32_t i = 0; i < ZxBeeper::MAX_EDGES + 10; i++) {
+            beeper.write((i % 2 == 0) ? 0x10 : 0x00, i * 4);
+        }
+        // Writes that do not change the EAR or MIC bits, e.g. to change the border, are not changes
+        beeper.write(0x07, 0);
+        CHECK(beeper.edgesDropped() == 10);
+        beeper.endFrame(TSTATES_PER_FRAME);
+        CHECK(beeper.edgesDropped() == 10);
+    }
+
+    TEST_CASE("The WAV writer writes every sample to a 16-bit mono PCM file") {
+        const std::string fileName = "zxbeeper_test.wav";
+        ZxAudioBuffer expectedBuffer(BUFFER_SIZE);
+        ZxBeeper expectedBeeper(expectedBuffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        playSquareWave(expectedBeeper, 3500, 100);
+        auto expected = readAll(expectedBuffer);
+
+        ZxAudioBuffer buffer(BUFFER_SIZE);
+        ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        ZxWavWriter writer(buffer, SAMPLE_RATE);
+        REQUIRE(writer.start(fileName.c_str()));
+        CHECK_FALSE(writer.start(fileName.c_str()));
+        playSquareWave(beeper, 3500, 100);
+        writer.stop();
+
+        CHECK_FALSE(writer.writeFailed());
+        CHECK(buffer.overruns() == 0);
+        CHECK(writer.samplesWritten() == expected.size());
+
+        auto data = readFile(fileName);
+        REQUIRE(data.size() == 44 + expected.size() * 2);
+        CHECK(std::string(data.begin(), data.begin() + 4) == "RIFF");
+        CHECK(readLE(data, 4, 4) == data.size() - 8);
+        CHECK(std::string(data.begin() + 8, data.begin() + 16) == "WAVEfmt ");
+        CHECK(readLE(data, 20, 2) == 1);
+        CHECK(readLE(data, 22, 2) == 1);
+        CHECK(readLE(data, 24, 4) == SAMPLE_RATE);
+        CHECK(readLE(data, 34, 2) == 16);
+        CHECK(std::string(data.begin() + 36, data.begin() + 40) == "data");
+        CHECK(readLE(data, 40, 4) == expected.size() * 2);
+
+        bool same = true;
+        for (size_t i = 0; i < expected.size(); i++) {
+            same = same && static_cast<int16_t>(readLE(data, 44 + i * 2, 2)) == expected[i];
+        }
+        CHECK(same);
+        std::remove(fileName.c_str());
+    }
+
+    TEST_CASE("Beeper cost per frame") {
+        // Not an assertion: report the cost of a frame of beeper music writing to the port every 100 T-states
+        ZxAudioBuffer buffer(BUFFER_SIZE);
+        ZxBeeper beeper(buffer, CLOCK_FREQUENCY, TSTATES_PER_FRAME, SAMPLE_RATE);
+        const uint32_t frames = 1000;
+        for (uint32_t halfPeriod : { 100u, 1000u, 10000u }) {
+            auto start = std::chrono::steady_clock::now();
+            playSquareWave(beeper, halfPeriod, frames);
+            auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+            readAll(buffer);
+            std::printf("Beeper with %4u changes per frame: %7.2f us per frame\n", TSTATES_PER_FRAME / halfPeriod,
+                        elapsed.count() / frames);
+        }
+    }
+}
+
+#endif // ZXRASPBERRY_ZXBEEPERTEST_CPP
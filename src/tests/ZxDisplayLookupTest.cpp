@@ -0,0 +1,148 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXDISPLAYLOOKUPTEST_CPP
+#define ZXRASPBERRY_ZXDISPLAYLOOKUPTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include "zxdisplayrenderer.h"
+#include "BruceLeeScr.h"
+#include "ViajeAlCentroDeLaTierraScr.h"
+#include "aquaplane_sna.h"
+#include "automania_sna.h"
+#include "overscan_sna.h"
+
+// The RAM dump in a 48K snapshot starts after the 27 byte header, so the screen is the first 6912 bytes
+static const uint32_t SNA_HEADER_SIZE = 27;
+
+/*
+ * Straightforward implementation of the pixel lookup, one pixel at a time, writing the pixels to memory in the same
+ * order as the framebuffer, i.e. 2 pixels per byte with the leftmost pixel in the high nibble.
+ */
+static uint32_t referencePixels(uint8_t attr, uint8_t character) {
+    uint32_t ink = (attr & 0b01000000) >> 3 | (attr & 0b00000111);
+    uint32_t paper = (attr & 0b01111000) >> 3;
+    bool flash = (attr & 0x80) != 0;
+    uint8_t bytes[4] = { 0 };
+    for (uint32_t pixel = 0; pixel < 8; pixel++) {
+        bool on = (character & (0x80 >> pixel)) != 0;
+        uint32_t colour = (on != flash) ? ink : paper;
+        bytes[pixel / 2] |= static_cast<uint8_t>(colour << ((pixel % 2) ? 0 : 4));
+    }
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+/*
+ * Draws the screen area of a ZX Spectrum screen dump into a 4 bits per pixel, 256 x 192 pixel buffer.
+ */
+template<typename Lookup>
+static void drawScreen(const Lookup &lookup, const uint8_t *pScreen, uint32_t *pBuffer) {
+    for (uint32_t line = 0; line < 192; line++) {
+        uint32_t addr = ((line & 0xC0u) << 5) | ((line & 0x07u) << 8) | ((line & 0x38u) << 2);
+        const uint8_t *pAttr = pScreen + 0x1800 + ((line >> 3) << 5);
+        for (uint32_t column = 0; column < 32; column++) {
+            *pBuffer++ = lookup.pixels(pAttr[column] & 0x7F, pScreen[addr + column]);
+        }
+    }
+}
+
+template<typename Lookup>
+static double benchmark(const Lookup &lookup, const uint8_t *const *pScreens, uint32_t screens, uint32_t *pBuffer) {
+    const uint32_t frames = 500;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        drawScreen(lookup, pScreens[frame % screens], pBuffer);
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+    return elapsed.count() / frames;
+}
+
+TEST_SUITE("ZX display lookup") {
+
+    ZxFullTableLookup fullTableLookup;
+    ZxMaskFillLookup maskFillLookup;
+    ZxNibbleLookup nibbleLookup;
+
+    TEST_CASE("All lookup strategies match the reference pixels") {
+        uint32_t mismatches = 0;
+        for (uint32_t attr = 0; attr < 256; attr++) {
+            for (uint32_t character = 0; character < 256; character++) {
+                uint32_t expected = referencePixels(attr, character);
+                mismatches += (fullTableLookup.pixels(attr, character) != expected) ? 1 : 0;
+                mismatches += (maskFillLookup.pixels(attr, character) != expected) ? 1 : 0;
+                mismatches += (nibbleLookup.pixels(attr, character) != expected) ? 1 : 0;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("All lookup strategies draw the same screens") {
+        const uint8_t *screens[] = {
+                BruceLee_scr,
+                ViajeAlCentroDeLaTierra_scr,
+                aquaplane_sna + SNA_HEADER_SIZE,
+                automania_sna + SNA_HEADER_SIZE,
+                overscan_sna + SNA_HEADER_SIZE
+        };
+        const uint32_t count = sizeof(screens) / sizeof(screens[0]);
+        static uint32_t expected[6144];
+        static uint32_t buffer[6144];
+
+        for (auto pScreen : screens) {
+            drawScreen(fullTableLookup, pScreen, expected);
+            drawScreen(maskFillLookup, pScreen, buffer);
+            CHECK(std::memcmp(expected, buffer, sizeof(buffer)) == 0);
+            drawScreen(nibbleLookup, pScreen, buffer);
+            CHECK(std::memcmp(expected, buffer, sizeof(buffer)) == 0);
+        }
+
+        // Not an assertion: report the time taken to draw a screen with each strategy on this machine
+        std::printf("Screen draw time (full table, 256 KB): %8.2f us\n", benchmark(fullTableLookup, screens, count, buffer));
+        std::printf("Screen draw time (mask/fill, 3 KB):    %8.2f us\n", benchmark(maskFillLookup, screens, count, buffer));
+        std::printf("Screen draw time (nibble, 8 KB):       %8.2f us\n", benchmark(nibbleLookup, screens, count, buffer));
+    }
+
+    TEST_CASE("All pixel formats draw the same display") {
+        // 44 cells per line, 296 lines, with the screen starting 48 lines down and 6 cells across
+        const uint32_t cells = 44 * 296;
+        const uint32_t firstScreenCell = 48 * 44 + 6;
+        static uint8_t indexed4[cells * 4];
+        static uint8_t indexed8[cells * 8];
+        static uint16_t rgb565[cells * 8];
+        static uint32_t xrgb8888[cells * 8];
+
+        ZxPixelRenderer<ZxIndexed4Format<ZxMaskFillLookup>> renderer4(44, firstScreenCell);
+        ZxPixelRenderer<ZxPackedFormat<uint8_t>> renderer8(44, firstScreenCell);
+        ZxPixelRenderer<ZxPackedFormat<uint16_t>> renderer16(44, firstScreenCell);
+        ZxPixelRenderer<ZxPackedFormat<uint32_t>> renderer32(44, firstScreenCell);
+
+        for (ZxDisplayRenderer *renderer : std::initializer_list<ZxDisplayRenderer *>{
+                &renderer4, &renderer8, &renderer16, &renderer32}) {
+            auto *pTarget = (renderer->depth() == 4) ? indexed4 : (renderer->depth() == 8) ? indexed8 :
+                    (renderer->depth() == 16) ? reinterpret_cast<uint8_t *>(rgb565) : reinterpret_cast<uint8_t *>(xrgb8888);
+            renderer->fillCells(pTarget, 0, cells, 0x05);
+            renderer->drawScreen(pTarget, BruceLee_scr, 0, 6144, 0xFF);
+        }
+
+        uint32_t mismatches = 0;
+        for (uint32_t pixel = 0; pixel < cells * 8; pixel++) {
+            uint8_t colour = (pixel & 1) ? (indexed4[pixel / 2] & 0x0F) : (indexed4[pixel / 2] >> 4);
+            mismatches += (indexed8[pixel] != colour) ? 1 : 0;
+            mismatches += (rgb565[pixel] != zxPaletteRGB565[colour]) ? 1 : 0;
+            mismatches += (xrgb8888[pixel] != zxRGB565ToXRGB8888(zxPaletteRGB565[colour])) ? 1 : 0;
+        }
+        CHECK(mismatches == 0);
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXDISPLAYLOOKUPTEST_CPP
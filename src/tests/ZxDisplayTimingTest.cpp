@@ -0,0 +1,191 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXDISPLAYTIMINGTEST_CPP
+#define ZXRASPBERRY_ZXDISPLAYTIMINGTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <algorithm>
+#include <vector>
+#include <circle/bcmframebuffer.h>
+#include "zxdisplay.h"
+#include "zxdisplayrenderer.h"
+#include "hardware/zxhardwaremodel48k.h"
+#include "hardware/zxhardwaremodel128k.h"
+
+static const uint8_t BLACK = 0;
+static const uint8_t RED = 2;
+static const uint8_t WHITE = 7;
+// Black ink on white paper
+static const uint8_t ATTRIBUTE = 0x38;
+static const uint32_t ATTRIBUTES = 0x1800;
+
+/*
+ * Display drawing scanline by scanline into a single 32 bits per pixel frame, from a blank white screen.
+ */
+struct Display {
+    explicit Display(ZxHardwareModel &model) : model(model), videoMemory(0x4000, 0) {
+        std::fill(videoMemory.begin() + ATTRIBUTES, videoMemory.begin() + ZxDisplay::VIDEO_MEMORY_SIZE, ATTRIBUTE);
+        display.Initialize(videoMemory.data(),
+                           new CBcmFrameBuffer(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, 32));
+        display.setHardwareModel(&model);
+        display.setRenderMode(ZxDisplay::RenderMode::Scanline);
+    }
+
+    // T-state at which the ULA fetches the screen byte at the given pixel line and column of 8 pixels
+    [[nodiscard]] uint32_t fetchTstates(uint32_t line, uint32_t column) const {
+        return model.tStatesToFirstScreenByte() + line * model.tStatesPerScreenLine() + column * 4;
+    }
+
+    // T-state at which the ULA draws the 8 pixels at the given line and column of the whole display, border included
+    [[nodiscard]] uint32_t cellTstates(uint32_t line, uint32_t column) const {
+        return fetchTstates(0, 0) - ZxDisplay::TOP_BORDER * model.tStatesPerScreenLine() - ZxDisplay::LEFT_BORDER / 2 +
+               line * model.tStatesPerScreenLine() + column * 4;
+    }
+
+    // Writes a byte of the bitmap, as the CPU does, at the given T-state
+    void writeBitmap(uint32_t line, uint32_t column, uint8_t value, uint32_t tstates) {
+        display.videoMemoryWrite(tstates);
+        videoMemory[zxScreenAddress.offset[line] + column] = value;
+    }
+
+    [[nodiscard]] uint32_t pixel(uint32_t x, uint32_t y) const {
+        return reinterpret_cast<const uint32_t *>(display.getFrontBuffer())[y * ZxDisplay::DISPLAY_WIDTH + x];
+    }
+
+    // Whether all 8 pixels of the given cell of the display are of the colour
+    [[nodiscard]] bool isCell(uint32_t line, uint32_t column, uint8_t colour) const {
+        bool same = true;
+        for (uint32_t x = column * 8; x < column * 8 + 8; x++) {
+            same = same && pixel(x, line) == zxNativeColour(32, colour);
+        }
+        return same;
+    }
+
+    // Whether all 8 pixels of the screen byte at the given pixel line and column are of the colour
+    [[nodiscard]] bool isScreenByte(uint32_t line, uint32_t column, uint8_t colour) const {
+        return isCell(ZxDisplay::TOP_BORDER + line, ZxDisplay::LEFT_BORDER / 8 + column, colour);
+    }
+
+    ZxHardwareModel &model;
+    std::vector<uint8_t> videoMemory;
+    ZxDisplay display;
+};
+
+
+TEST_SUITE("ZX display timing") {
+
+    TEST_CASE("A write to video memory shows in the frame only if it comes before the ULA fetches the byte") {
+        ZxHardwareModel48k model48K;
+        ZxHardwareModel128k model128K;
+        ZxHardwareModel *models[] = { &model48K, &model128K };
+        for (ZxHardwareModel *pModel : models) {
+            Display display(*pModel);
+
+            // In T-state order, as the CPU writes them
+            display.writeBitmap(0, 0, 0xFF, display.fetchTstates(0, 0) - 1);
+            display.writeBitmap(0, 1, 0xFF, display.fetchTstates(0, 1));
+            display.writeBitmap(100, 31, 0xFF, display.fetchTstates(100, 31) - 1);
+            display.writeBitmap(101, 0, 0xFF, display.fetchTstates(101, 0));
+            display.writeBitmap(191, 30, 0xFF, display.fetchTstates(191, 30) - 1);
+            display.writeBitmap(191, 31, 0xFF, display.fetchTstates(191, 31));
+            display.display.update(false);
+
+            CHECK(display.isScreenByte(0, 0, BLACK));
+            CHECK(display.isScreenByte(0, 1, WHITE));
+            CHECK(display.isScreenByte(100, 31, BLACK));
+            CHECK(display.isScreenByte(101, 0, WHITE));
+            CHECK(display.isScreenByte(191, 30, BLACK));
+            CHECK(display.isScreenByte(191, 31, WHITE));
+            // Neighbours fetched before and after are left alone
+            CHECK(display.isScreenByte(100, 30, WHITE));
+            CHECK(display.isScreenByte(101, 1, WHITE));
+
+            // The writes made after the fetch show in the next frame
+            display.display.update(false);
+            CHECK(display.isScreenByte(0, 1, BLACK));
+            CHECK(display.isScreenByte(101, 0, BLACK));
+            CHECK(display.isScreenByte(191, 31, BLACK));
+        }
+    }
+
+    TEST_CASE("A write to the attributes colours the bytes of the cell fetched after it") {
+        ZxHardwareModel48k model;
+        Display display(model);
+        for (uint32_t line = 8; line < 16; line++) {
+            display.videoMemory[zxScreenAddress.offset[line] + 5] = 0xFF;
+        }
+
+        // Red ink from the fourth pixel line of the character row onwards
+        display.display.videoMemoryWrite(display.fetchTstates(11, 5) - 1);
+        display.videoMemory[ATTRIBUTES + 32 + 5] = ATTRIBUTE | RED;
+        display.display.update(false);
+
+        for (uint32_t line = 8; line < 16; line++) {
+            CHECK(display.isScreenByte(line, 5, (line < 11) ? BLACK : RED));
+        }
+    }
+
+    TEST_CASE("A border change takes effect from the cell that the ULA draws in its 4 T-state slot") {
+        ZxHardwareModel48k model48K;
+        ZxHardwareModel128k model128K;
+        ZxHardwareModel *models[] = { &model48K, &model128K };
+        for (ZxHardwareModel *pModel : models) {
+            Display display(*pModel);
+
+            // A cell of the top border, and one of the right border next to the screen
+            for (auto cell : { std::make_pair(20u, 20u), std::make_pair(100u, 40u) }) {
+                const uint32_t line = cell.first;
+                const uint32_t column = cell.second;
+                const uint32_t tstates = display.cellTstates(line, column);
+
+                // The previous slot, the first and last T-states of the cell's slot, and the next slot
+                const int32_t offsets[] = { -1, 0, 3, 4 };
+                const uint32_t firstRed[] = { column - 1, column, column, column + 1 };
+                for (uint32_t i = 0; i < 4; i++) {
+                    display.display.updateBorder(WHITE, 0);
+                    display.display.updateBorder(RED, tstates + offsets[i]);
+                    display.display.update(false);
+
+                    for (uint32_t c = column - 2; c <= column + 2; c++) {
+                        CHECK(display.isCell(line, c, (c < firstRed[i]) ? WHITE : RED));
+                    }
+                }
+            }
+        }
+    }
+
+    TEST_CASE("The border log is drawn in runs of cells, also when it fills up before the frame ends") {
+        ZxHardwareModel48k model;
+        Display display(model);
+
+        // More changes than the log holds, every 7 T-states to fall on every T-state of a slot
+        const uint32_t changes = ZxDisplay::BORDER_LOG_SIZE + 500;
+        for (uint32_t i = 0; i < changes; i++) {
+            display.display.updateBorder(static_cast<uint8_t>(i % 8), i * 7);
+        }
+        display.display.update(false);
+
+        // Each cell takes the colour of the last change made by the end of its slot
+        const uint32_t cellsPerLine = ZxDisplay::DISPLAY_WIDTH / 8;
+        uint32_t wrong = 0;
+        for (uint32_t line = 0; line < ZxDisplay::DISPLAY_HEIGHT; line++) {
+            for (uint32_t column = 0; column < cellsPerLine; column++) {
+                bool screen = line >= ZxDisplay::TOP_BORDER && line < ZxDisplay::TOP_BORDER + ZxDisplay::SCREEN_HEIGHT &&
+                              column >= ZxDisplay::LEFT_BORDER / 8 &&
+                              column < (ZxDisplay::LEFT_BORDER + ZxDisplay::SCREEN_WIDTH) / 8;
+                if (screen) {
+                    continue;
+                }
+                uint32_t last = std::min((display.cellTstates(line, column) + 3) / 7, changes - 1);
+                wrong += display.isCell(line, column, static_cast<uint8_t>(last % 8)) ? 0 : 1;
+            }
+        }
+        CHECK(wrong == 0);
+    }
+}
+
+#endif // ZXRASPBERRY_ZXDISPLAYTIMINGTEST_CPP
@@ -0,0 +1,66 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXFLOATINGBUSTEST_CPP
+#define ZXRASPBERRY_ZXFLOATINGBUSTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include "hardware/zxfloatingbus.h"
+#include "hardware/zxhardwaremodel48k.h"
+
+
+TEST_SUITE("ZX floating bus") {
+
+    ZxHardwareModel48k model;
+    ZxFloatingBus floatingBus(model);
+
+    TEST_CASE("The ULA fetch pattern matches the documented 48K timings") {
+        // Bitmap byte, attribute, next bitmap byte and its attribute, then 4 idle T-states
+        CHECK(floatingBus.address(14338) == 0x4000);
+        CHECK(floatingBus.address(14339) == 0x5800);
+        CHECK(floatingBus.address(14340) == 0x4001);
+        CHECK(floatingBus.address(14341) == 0x5801);
+        for (uint32_t tstates = 14342; tstates < 14346; tstates++) {
+            CHECK(floatingBus.address(tstates) == ZxFloatingBus::IDLE);
+        }
+        CHECK(floatingBus.address(14346) == 0x4002);
+        CHECK(floatingBus.address(14338 + 15 * 8 + 3) == 0x581F);
+
+        // The second screen line is 256 bytes further into the bitmap but shares the attributes of the first
+        CHECK(floatingBus.address(14338 + 224) == 0x4100);
+        CHECK(floatingBus.address(14339 + 224) == 0x5800);
+        // The ninth line starts the second character row
+        CHECK(floatingBus.address(14338 + 8 * 224) == 0x4020);
+        CHECK(floatingBus.address(14339 + 8 * 224) == 0x5820);
+        // The last byte of the last line
+        CHECK(floatingBus.address(14338 + 191 * 224 + 15 * 8 + 3) == 0x5AFF);
+    }
+
+    TEST_CASE("The bus is idle outside the screen area") {
+        uint32_t fetches = 0;
+        for (uint32_t tstates = 0; tstates < model.tStatesPerScreenFrame() + 1000; tstates++) {
+            fetches += (floatingBus.address(tstates) != ZxFloatingBus::IDLE) ? 1 : 0;
+        }
+        // 192 lines of 32 bitmap and 32 attribute fetches each
+        CHECK(fetches == 192 * 64);
+        CHECK(floatingBus.address(14337) == ZxFloatingBus::IDLE);
+        CHECK(floatingBus.address(14338 + 128) == ZxFloatingBus::IDLE);
+        CHECK(floatingBus.address(14338 + 192 * 224) == ZxFloatingBus::IDLE);
+    }
+
+    TEST_CASE("Reads return the fetched byte or 0xFF") {
+        static uint8_t memory[0x10000];
+        memory[0x4000] = 0x3C;
+        memory[0x5800] = 0x47;
+        CHECK(floatingBus.read(memory, 14338) == 0x3C);
+        CHECK(floatingBus.read(memory, 14339) == 0x47);
+        CHECK(floatingBus.read(memory, 14342) == 0xFF);
+        CHECK(floatingBus.read(memory, 0) == 0xFF);
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXFLOATINGBUSTEST_CPP
@@ -0,0 +1,196 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXFRAMEPACERTEST_CPP
+#define ZXRASPBERRY_ZXFRAMEPACERTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include "zxframepacer.h"
+
+// The Circle system timer ticks once per microsecond
+static const uint32_t TICKS_PER_SECOND = 1000000;
+static const uint32_t TSTATES_PER_FRAME_48K = 69888;
+static const uint32_t CLOCK_FREQUENCY_48K = 3500000;
+static const uint32_t TSTATES_PER_FRAME_128K = 70908;
+static const uint32_t CLOCK_FREQUENCY_128K = 3546900;
+
+/*
+ * Timer that only moves when told to, either by the emulated frame taking some time to run or by the pacer waiting.
+ */
+class FakeTimer : public ZxPacingTimer {
+
+public:
+    explicit FakeTimer(uint32_t ticks = 0) : m_ticks(ticks) {
+    }
+
+    uint32_t clockTicks() override {
+        return m_ticks;
+    }
+
+    void waitTicks(uint32_t ticks) override {
+        m_ticks += ticks;
+        m_waited += ticks;
+    }
+
+    void run(uint32_t ticks) {
+        m_ticks += ticks;
+    }
+
+    uint32_t m_ticks;
+    uint64_t m_waited = 0;
+};
+
+
+TEST_SUITE("ZX frame pacer") {
+
+    TEST_CASE("Frames are paced at the real 48K frame rate") {
+        FakeTimer timer;
+        ZxFramePacer pacer(timer, TICKS_PER_SECOND, TSTATES_PER_FRAME_48K, CLOCK_FREQUENCY_48K);
+
+        // 69888 / 3.5 MHz = 19968 us, i.e. 50.08 Hz rather than 50 Hz
+        CHECK(pacer.framePeriod() == 19968);
+
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            timer.run(5000);
+            CHECK(pacer.endFrame());
+        }
+        CHECK(timer.m_ticks == 1000 * 19968);
+        CHECK(pacer.framesLate() == 0);
+        CHECK(pacer.frameTimeMin() == 5000);
+        CHECK(pacer.frameTimeAverage() == 5000);
+    }
+
+    TEST_CASE("The fractional part of the frame period does not drift") {
+        FakeTimer timer;
+        ZxFramePacer pacer(timer, TICKS_PER_SECOND, TSTATES_PER_FRAME_128K, CLOCK_FREQUENCY_128K);
+
+        // 70908 / 3.5469 MHz = 19991.54 us
+        CHECK(pacer.framePeriod() == 19991);
+
+        const uint32_t frames = 50000;
+        for (uint32_t frame = 0; frame < frames; frame++) {
+            timer.run(1000);
+            pacer.endFrame();
+        }
+        uint64_t expected = static_cast<uint64_t>(frames) * TSTATES_PER_FRAME_128K * TICKS_PER_SECOND / CLOCK_FREQUENCY_128K;
+        CHECK(timer.m_ticks == expected);
+    }
+
+    TEST_CASE("An overrun is caught up without waiting and dropped frames are reported") {
+        FakeTimer timer;
+        ZxFramePacer pacer(timer, TICKS_PER_SECOND, TSTATES_PER_FRAME_48K, CLOCK_FREQUENCY_48K);
+
+        timer.run(5000);
+        CHECK(pacer.endFrame());
+
+        // A frame that takes two and a half periods leaves the pacer a period and a half behind
+        timer.run(19968 * 5 / 2);
+        CHECK_FALSE(pacer.endFrame());
+        CHECK(pacer.framesLate() == 1);
+        CHECK(pacer.framesDropped() == 1);
+
+        // Fast frames then run without waiting until they are back on schedule
+        uint64_t waited = timer.m_waited;
+        timer.run(5000);
+        CHECK(pacer.endFrame());
+        CHECK(timer.m_waited == waited);
+        for (uint32_t frame = 0; frame < 10; frame++) {
+            timer.run(5000);
+            CHECK(pacer.endFrame());
+        }
+
+        // Back on the original schedule, 13 frames after the start
+        CHECK(timer.m_ticks == 13 * 19968);
+        CHECK(pacer.resyncs() == 0);
+    }
+
+    TEST_CASE("Falling too far behind restarts the schedule") {
+        FakeTimer timer(0xFFFF0000u);
+        ZxFramePacer pacer(timer, TICKS_PER_SECOND, TSTATES_PER_FRAME_48K, CLOCK_FREQUENCY_48K);
+
+        timer.run(19968 * (ZxFramePacer::MAX_CATCH_UP_FRAMES + 2));
+        CHECK(pacer.endFrame());
+        CHECK(pacer.resyncs() == 1);
+
+        // The next frame is due a period after the overrun, across the wrap around of the tick counter
+        uint32_t start = timer.m_ticks;
+        timer.run(5000);
+        CHECK(pacer.endFrame());
+        CHECK(timer.m_ticks - start == 19968);
+    }
+
+    TEST_CASE("The histogram reports the frame time percentiles") {
+        FakeTimer timer;
+        ZxFramePacer pacer(timer, TICKS_PER_SECOND, TSTATES_PER_FRAME_48K, CLOCK_FREQUENCY_48K);
+
+        // 98 quick frames and 2 slow ones
+        for (uint32_t frame = 0; frame < 100; frame++) {
+            timer.run((frame % 50 == 49) ? 15000 : 3000);
+            pacer.endFrame();
+        }
+
+        // Each bucket is 19968 / 64 = 312 ticks wide
+        CHECK(pacer.frameTimeMin() == 3000);
+        CHECK(pacer.frameTimeMax() == 15000);
+        CHECK(pacer.frameTimeAverage() == (98 * 3000 + 2 * 15000) / 100);
+        CHECK(pacer.frameTimePercentile(50) == 3120);
+        CHECK(pacer.frameTimePercentile(98) == 3120);
+        CHECK(pacer.frameTimePercentile(99) == 15000);
+
+        pacer.reset();
+        CHECK(pacer.frames() == 0);
+        CHECK(pacer.frameTimePercentile(99) == 0);
+    }
+
+    TEST_CASE("Turbo mode runs unthrottled and reports the speed") {
+        FakeTimer timer;
+        ZxFramePacer pacer(timer, TICKS_PER_SECOND, TSTATES_PER_FRAME_48K, CLOCK_FREQUENCY_48K);
+
+        pacer.setTurbo(true);
+        CHECK(pacer.isTurbo());
+
+        // Frames that take a quarter of the period run at four times real time without ever waiting
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            timer.run(19968 / 4);
+            CHECK(pacer.endFrame());
+        }
+        CHECK(timer.m_waited == 0);
+        CHECK(pacer.speedPercent() == 400);
+
+        // Leaving turbo mode paces from the current time rather than waiting for the skipped frames
+        pacer.setTurbo(false);
+        uint32_t start = timer.m_ticks;
+        timer.run(5000);
+        CHECK(pacer.endFrame());
+        CHECK(timer.m_ticks - start == 19968);
+    }
+
+    TEST_CASE("A rate adjustment moves the deadlines by parts per million of the period") {
+        FakeTimer timer;
+        ZxFramePacer pacer(timer, TICKS_PER_SECOND, TSTATES_PER_FRAME_48K, CLOCK_FREQUENCY_48K);
+
+        // 0.1% faster takes 19.968 ticks off every frame, carried over as a fraction until it makes a whole tick
+        pacer.setRateAdjustment(1000);
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            timer.run(5000);
+            CHECK(pacer.endFrame());
+        }
+        CHECK(timer.m_ticks == 1000 * 19968 - 19968);
+
+        // 0.25% slower
+        pacer.setRateAdjustment(-2500);
+        uint32_t start = timer.m_ticks;
+        for (uint32_t frame = 0; frame < 1000; frame++) {
+            timer.run(5000);
+            CHECK(pacer.endFrame());
+        }
+        CHECK(timer.m_ticks - start == 1000 * 19968 + 49920);
+        CHECK(pacer.framesLate() == 0);
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXFRAMEPACERTEST_CPP
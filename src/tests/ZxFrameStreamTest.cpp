@@ -0,0 +1,242 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXFRAMESTREAMTEST_CPP
+#define ZXRASPBERRY_ZXFRAMESTREAMTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#include "zxdisplayrenderer.h"
+#include "stream/zxframeencoder.h"
+#include "stream/zxframedecoder.h"
+#include "BruceLeeScr.h"
+#include "ViajeAlCentroDeLaTierraScr.h"
+#include "aquaplane_sna.h"
+
+// The RAM dump in a 48K snapshot starts after the 27 byte header, so the screen is the first 6912 bytes
+static const uint32_t SNA_HEADER_SIZE = 27;
+
+// 44 cells per line, 296 lines, with the screen starting 48 lines down and 6 cells across
+static const uint32_t WIDTH = 352;
+static const uint32_t HEIGHT = 296;
+static const uint32_t CELLS = 44 * 296;
+static const uint32_t FIRST_SCREEN_CELL = 48 * 44 + 6;
+
+/*
+ * Collects the encoded stream in memory.
+ */
+class MemorySink : public ZxFrameSink {
+
+public:
+    bool write(const uint8_t *pData, uint32_t size) override {
+        if (failNextWrite) {
+            failNextWrite = false;
+            return false;
+        }
+        stream.insert(stream.end(), pData, pData + size);
+        return true;
+    }
+
+    std::vector<uint8_t> stream;
+    bool failNextWrite = false;
+
+};
+
+/*
+ * Renders a sequence of frames: two screens, each shown for a few frames with flashing attributes and border changes,
+ * and a frame with some unrelated changes in the middle of the screen.
+ */
+static std::vector<std::vector<uint8_t>> renderFrames(ZxDisplayRenderer &renderer) {
+    const uint8_t *screens[] = { BruceLee_scr, ViajeAlCentroDeLaTierra_scr, aquaplane_sna + SNA_HEADER_SIZE };
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<uint8_t> frame(CELLS * renderer.depth());
+
+    for (uint32_t i = 0; i < 12; i++) {
+        renderer.fillCells(frame.data(), 0, CELLS, (i / 2) % 8);
+        renderer.drawScreen(frame.data(), screens[i / 4], 0, 6144, (i & 1) ? 0xFF : 0x7F);
+        // Stripes of border colour half way down the display, as loading a program would do
+        for (uint32_t line = 0; line < HEIGHT; line += 4) {
+            renderer.fillCells(frame.data(), line * 44, line * 44 + (i % 3), (i + line) % 8);
+        }
+        frames.push_back(frame);
+        if (i == 5) {
+            for (uint32_t byte = 20000; byte < frame.size(); byte += 97) {
+                frame[byte] ^= 0x5A;
+            }
+            frames.push_back(frame);
+        }
+    }
+    return frames;
+}
+
+/*
+ * Decodes the stream a few bytes at a time, as it would arrive from a pipe or a serial link, and returns the frames.
+ */
+static std::vector<std::vector<uint8_t>> decodeStream(const std::vector<uint8_t> &stream, uint32_t chunkSize) {
+    ZxFrameDecoder decoder;
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<uint8_t> received;
+    uint32_t offset = 0;
+
+    for (uint32_t sent = 0; sent < stream.size(); ) {
+        uint32_t chunk = std::min<uint32_t>(chunkSize, static_cast<uint32_t>(stream.size()) - sent);
+        received.insert(received.end(), stream.begin() + sent, stream.begin() + sent + chunk);
+        sent += chunk;
+
+        int32_t consumed;
+        while ((consumed = decoder.decode(received.data() + offset, received.size() - offset)) > 0) {
+            offset += consumed;
+            if (decoder.frameReady()) {
+                frames.emplace_back(decoder.frame(), decoder.frame() + decoder.frameSize());
+            }
+        }
+        if (consumed < 0) {
+            break;
+        }
+    }
+    CHECK(offset == stream.size());
+    return frames;
+}
+
+TEST_SUITE("ZX frame stream") {
+
+    TEST_CASE("Frames survive an encode/decode round trip at every colour depth") {
+        ZxPixelRenderer<ZxIndexed4Format<ZxMaskFillLookup>> renderer4(44, FIRST_SCREEN_CELL);
+        ZxPixelRenderer<ZxPackedFormat<uint8_t>> renderer8(44, FIRST_SCREEN_CELL);
+        ZxPixelRenderer<ZxPackedFormat<uint16_t>> renderer16(44, FIRST_SCREEN_CELL);
+        ZxPixelRenderer<ZxPackedFormat<uint32_t>> renderer32(44, FIRST_SCREEN_CELL);
+
+        for (ZxDisplayRenderer *renderer : std::initializer_list<ZxDisplayRenderer *>{
+                &renderer4, &renderer8, &renderer16, &renderer32}) {
+            auto frames = renderFrames(*renderer);
+            MemorySink sink;
+            ZxFrameEncoder encoder(WIDTH, HEIGHT, renderer->depth(), &sink, 5);
+
+            for (auto &frame : frames) {
+                encoder.frameCompleted(frame.data(), renderer->depth());
+            }
+            CHECK(encoder.frameNumber() == frames.size());
+            CHECK(encoder.bytesWritten() == sink.stream.size());
+
+            for (uint32_t chunkSize : { 1u, 7u, 4096u }) {
+                auto decoded = decodeStream(sink.stream, chunkSize);
+                REQUIRE(decoded.size() == frames.size());
+                for (size_t i = 0; i < frames.size(); i++) {
+                    CHECK(decoded[i] == frames[i]);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("A static screen produces an empty delta") {
+        ZxPixelRenderer<ZxIndexed4Format<ZxMaskFillLookup>> renderer(44, FIRST_SCREEN_CELL);
+        std::vector<uint8_t> frame(CELLS * 4);
+        renderer.fillCells(frame.data(), 0, CELLS, 1);
+        renderer.drawScreen(frame.data(), BruceLee_scr, 0, 6144, 0x7F);
+
+        MemorySink sink;
+        ZxFrameEncoder encoder(WIDTH, HEIGHT, 4, &sink);
+        encoder.frameCompleted(frame.data(), 4);
+        size_t keyFrameSize = sink.stream.size();
+        const uint32_t frames = 250;
+        for (uint32_t i = 0; i < frames; i++) {
+            encoder.frameCompleted(frame.data(), 4);
+        }
+
+        // Only the record header is written for each unchanged frame
+        CHECK(sink.stream.size() - keyFrameSize == frames * 9);
+        CHECK(keyFrameSize < frame.size());
+
+        // Not an assertion: report the time taken to encode a changed and an unchanged frame on this machine
+        std::vector<uint8_t> other(frame.size());
+        renderer.fillCells(other.data(), 0, CELLS, 2);
+        renderer.drawScreen(other.data(), ViajeAlCentroDeLaTierra_scr, 0, 6144, 0x7F);
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < frames; i++) {
+            encoder.encode((i & 1) ? frame.data() : other.data(), false);
+        }
+        auto changed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < frames; i++) {
+            encoder.encode(frame.data(), false);
+        }
+        auto unchanged = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        std::printf("Frame encode time (changed screen):   %8.2f us\n", changed.count() / frames);
+        std::printf("Frame encode time (unchanged screen): %8.2f us\n", unchanged.count() / frames);
+    }
+
+    TEST_CASE("The decoder waits for a key frame when joining a stream") {
+        ZxPixelRenderer<ZxPackedFormat<uint8_t>> renderer(44, FIRST_SCREEN_CELL);
+        auto frames = renderFrames(renderer);
+        MemorySink sink;
+        ZxFrameEncoder encoder(WIDTH, HEIGHT, 8, &sink, 0);
+
+        encoder.frameCompleted(frames[0].data(), 8);
+        encoder.frameCompleted(frames[1].data(), 8);
+        // Lose a record on the way: the encoder starts over from a key frame
+        sink.failNextWrite = true;
+        encoder.frameCompleted(frames[2].data(), 8);
+        size_t lost = sink.stream.size();
+        encoder.frameCompleted(frames[3].data(), 8);
+        encoder.frameCompleted(frames[4].data(), 8);
+        CHECK(sink.stream[lost] == 'K');
+
+        auto decoded = decodeStream(sink.stream, 64);
+        REQUIRE(decoded.size() == 4);
+        CHECK(decoded[3] == frames[4]);
+
+        // Drop the first key frame, keeping the stream header
+        std::vector<uint8_t> joined(sink.stream.begin(), sink.stream.begin() + 10);
+        uint32_t firstRecordSize = 9 + (sink.stream[15] | (sink.stream[16] << 8) | (sink.stream[17] << 16));
+        joined.insert(joined.end(), sink.stream.begin() + 10 + firstRecordSize, sink.stream.end());
+        decoded = decodeStream(joined, 64);
+        REQUIRE(decoded.size() == 2);
+        CHECK(decoded[0] == frames[3]);
+        CHECK(decoded[1] == frames[4]);
+    }
+
+    TEST_CASE("Words are written little endian whatever the host") {
+        const uint32_t words[8] = { 0x11223344, 0, 0, 0, 0, 0, 0, 0x55667788 };
+        MemorySink sink;
+        ZxFrameEncoder encoder(8, 1, 32, &sink);
+        encoder.frameCompleted(reinterpret_cast<const uint8_t *>(words), 32);
+
+        // A COPY of the first word, a SKIP of the six unchanged ones and a COPY of the last
+        const std::vector<uint8_t> payload = { (1 << 2) | 1, 0x44, 0x33, 0x22, 0x11, 6 << 2, (1 << 2) | 1,
+                                               0x88, 0x77, 0x66, 0x55 };
+        REQUIRE(sink.stream.size() == 10 + 9 + payload.size());
+        CHECK(std::equal(payload.begin(), payload.end(), sink.stream.begin() + 19));
+    }
+
+    TEST_CASE("Invalid streams are rejected") {
+        ZxFrameDecoder decoder;
+        const uint8_t badMagic[] = { 'Z', 'X', 'F', 'X', 1, 0x60, 0x01, 0x28, 0x01, 4 };
+        CHECK(decoder.decode(badMagic, sizeof(badMagic)) == -1);
+        // 65535 x 65535 at 32 bits, whose size only looks valid once it wraps around in 32 bits
+        const uint8_t tooLarge[] = { 'Z', 'X', 'F', 'S', 1, 0xFF, 0xFF, 0xFF, 0xFF, 32 };
+        CHECK(ZxFrameDecoder().decode(tooLarge, sizeof(tooLarge)) == -1);
+
+        const uint8_t header[] = { 'Z', 'X', 'F', 'S', 1, 0x60, 0x01, 0x28, 0x01, 4 };
+        CHECK(decoder.decode(header, 5) == 0);
+        CHECK(decoder.decode(header, sizeof(header)) == 10);
+        CHECK(decoder.frameSize() == WIDTH * HEIGHT / 2);
+
+        // A COPY of 2 words running past the end of the payload, and a SKIP past the end of the frame
+        const uint8_t truncated[] = { 'K', 0, 0, 0, 0, 5, 0, 0, 0, (2 << 2) | 1, 1, 2, 3, 4 };
+        CHECK(decoder.decode(truncated, sizeof(truncated)) == -1);
+        const uint8_t overrun[] = { 'K', 0, 0, 0, 0, 3, 0, 0, 0, 0xFC, 0xFF, 0x7F };
+        CHECK(decoder.decode(overrun, sizeof(overrun)) == -1);
+        CHECK_FALSE(decoder.frameReady());
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXFRAMESTREAMTEST_CPP
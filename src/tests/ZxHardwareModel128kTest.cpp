@@ -0,0 +1,392 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXHARDWAREMODEL128KTEST_CPP
+#define ZXRASPBERRY_ZXHARDWAREMODEL128KTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <algorithm>
+#include <vector>
+#include <circle/bcmframebuffer.h>
+#include "clock.h"
+#include "Z80emu.h"
+#include "zxdisplay.h"
+#include "hardware/zxhardwaremodel48k.h"
+#include "hardware/zxhardwaremodel128k.h"
+#include "zx48k_rom.h"
+
+static const uint32_t BANK_SIZE = 0x4000;
+static const uint32_t SNA_48K_SIZE = 27 + 3 * BANK_SIZE;
+// Offset of the byte that tells each ROM and bank apart
+static const uint32_t MARKER = 0x2000;
+static const uint8_t ROM0_MARKER = 0xA0;
+static const uint8_t ROM1_MARKER = 0xB1;
+
+/*
+ * Stand-in for the two ROMs of the 128K: both count the interrupts at 0x9100 and tell themselves apart at 0x3FFF.
+ */
+static std::vector<uint8_t> fakeRoms() {
+    const std::vector<uint8_t> isr = {
+            0xF5,                   // PUSH AF
+            0x3A, 0x00, 0x91,       // LD A,(0x9100)
+            0x3C,                   // INC A
+            0x32, 0x00, 0x91,       // LD (0x9100),A
+            0xF1,                   // POP AF
+            0xFB,                   // EI
+            0xC9                    // RET
+    };
+    std::vector<uint8_t> roms(2 * BANK_SIZE, 0);
+    std::copy(isr.begin(), isr.end(), roms.begin() + 0x38);
+    std::copy(isr.begin(), isr.end(), roms.begin() + BANK_SIZE + 0x38);
+    roms[BANK_SIZE - 1] = ROM0_MARKER;
+    roms[2 * BANK_SIZE - 1] = ROM1_MARKER;
+    return roms;
+}
+
+/*
+ * Eight banks with their number at MARKER, and the program at 0x8000, i.e. in bank 2.
+ */
+static std::vector<std::vector<uint8_t>> makeBanks(const std::vector<uint8_t> &program) {
+    std::vector<std::vector<uint8_t>> banks(8, std::vector<uint8_t>(BANK_SIZE, 0));
+    for (uint32_t bank = 0; bank < 8; bank++) {
+        banks[bank][MARKER] = static_cast<uint8_t>(0x10 + bank);
+    }
+    std::copy(program.begin(), program.end(), banks[2].begin());
+    return banks;
+}
+
+/*
+ * 128K SNA snapshot with interrupts off, IM 1 and the stack at 0x9000, that starts running at the given PC.
+ */
+static std::vector<uint8_t> snapshot128K(const std::vector<std::vector<uint8_t>> &banks, uint8_t paging,
+                                         uint16_t pc = 0x8000) {
+    const uint32_t pagedBank = paging & 0x07u;
+    std::vector<uint8_t> snapshot(27, 0);
+    snapshot[24] = 0x90;
+    snapshot[25] = 0x01;
+    for (uint32_t bank : { 5u, 2u, pagedBank }) {
+        snapshot.insert(snapshot.end(), banks[bank].begin(), banks[bank].end());
+    }
+    snapshot.push_back(static_cast<uint8_t>(pc));
+    snapshot.push_back(static_cast<uint8_t>(pc >> 8));
+    snapshot.push_back(paging);
+    snapshot.push_back(0);
+    for (uint32_t bank = 0; bank < 8; bank++) {
+        if (bank != 5 && bank != 2 && bank != pagedBank) {
+            snapshot.insert(snapshot.end(), banks[bank].begin(), banks[bank].end());
+        }
+    }
+    return snapshot;
+}
+
+/*
+ * 48K SNA snapshot that returns to a program at 0x8000 through the stack at 0x9000, with interrupts off.
+ */
+static std::vector<uint8_t> snapshot48K(const std::vector<uint8_t> &program) {
+    std::vector<uint8_t> snapshot(SNA_48K_SIZE, 0);
+    snapshot[24] = 0x90;
+    snapshot[25] = 0x01;
+    snapshot[27 + 0x5000] = 0x00;
+    snapshot[27 + 0x5001] = 0x80;
+    std::copy(program.begin(), program.end(), snapshot.begin() + 27 + 0x4000);
+    return snapshot;
+}
+
+struct Machine {
+    explicit Machine(ZxHardwareModel &model) : model(model), z80emu(&display) {
+        Clock::getInstance().setSpectrumModel(&model);
+        z80emu.setHardwareModel(&model);
+        display.Initialize(z80emu.getRam() + 0x4000,
+                           new CBcmFrameBuffer(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, 32));
+        display.setHardwareModel(&model);
+        if (model.hasMemoryPaging()) {
+            std::vector<uint8_t> roms = fakeRoms();
+            z80emu.loadRom(roms.data(), roms.size());
+        } else {
+            z80emu.loadRom(zx48k_rom, zx48k_rom_len);
+        }
+    }
+
+    void load(const std::vector<uint8_t> &snapshot) {
+        REQUIRE(z80emu.loadSnapshot(snapshot.data(), snapshot.size()));
+    }
+
+    Z80 cpu() {
+        auto *pState = new Z80emu::MachineState();
+        z80emu.saveState(*pState);
+        Z80 cpu = pState->cpu;
+        delete pState;
+        return cpu;
+    }
+
+    void runFrames(uint32_t frames) {
+        for (uint32_t frame = 0; frame < frames; frame++) {
+            z80emu.execute(model.tStatesPerScreenFrame());
+            Clock::getInstance().endFrame();
+        }
+    }
+
+    ZxHardwareModel &model;
+    ZxDisplay display;
+    Z80emu z80emu;
+};
+
+
+TEST_SUITE("ZX Spectrum 128K") {
+
+    TEST_CASE("The 128K times its frames, lines and interrupts as the real machine") {
+        ZxHardwareModel128k model;
+        CHECK(model.clockFrequency() == 3546900);
+        CHECK(model.tStatesPerScreenFrame() == 70908);
+        CHECK(model.tStatesPerScreenLine() == 228);
+        CHECK(model.tStatesPerScreenFrame() == 311 * model.tStatesPerScreenLine());
+        CHECK(model.lengthINT() == 36);
+        CHECK(model.tStatesToFirstContention() == 14361);
+        CHECK(model.romPages() == 2);
+        CHECK(model.ramPages() == 8);
+        CHECK(model.hasMemoryPaging());
+
+        ZxHardwareModel48k model48K;
+        CHECK(model48K.tStatesToFirstContention() == 14335);
+        CHECK(model48K.ramPages() == 3);
+        CHECK_FALSE(model48K.hasMemoryPaging());
+    }
+
+    TEST_CASE("A 128K snapshot puts every bank in its place and resumes at its PC") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        for (uint8_t paging : { 0x03, 0x05, 0x12 }) {
+            machine.load(snapshot128K(makeBanks({}), paging, 0x1234));
+            CHECK(machine.z80emu.getPaging() == paging);
+            CHECK(machine.cpu().getRegPC() == 0x1234);
+            for (uint32_t bank = 0; bank < 8; bank++) {
+                CHECK(machine.z80emu.getRamBank(bank)[MARKER] == 0x10 + bank);
+            }
+            CHECK(machine.z80emu.peek8(0x4000 + MARKER) == 0x15);
+            CHECK(machine.z80emu.peek8(0x8000 + MARKER) == 0x12);
+            CHECK(machine.z80emu.peek8(0xC000 + MARKER) == 0x10 + (paging & 0x07));
+            CHECK(machine.z80emu.peek8(0x3FFF) == (((paging & 0x10) != 0) ? ROM1_MARKER : ROM0_MARKER));
+        }
+    }
+
+    TEST_CASE("Port 0x7FFD pages the banks and the ROMs in place, until it is locked") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        const std::vector<uint8_t> program = {
+                0x01, 0xFD, 0x7F,       // LD BC,0x7FFD
+                0x3E, 0x01,             // LD A,1
+                0xED, 0x79,             // OUT (C),A        bank 1
+                0x3A, 0x00, 0xE0,       // LD A,(0xE000)
+                0x32, 0x00, 0x90,       // LD (0x9000),A
+                0x3E, 0x04,             // LD A,4
+                0xED, 0x79,             // OUT (C),A        bank 4
+                0x3A, 0x00, 0xE0,       // LD A,(0xE000)
+                0x32, 0x01, 0x90,       // LD (0x9001),A
+                0x3E, 0x55,             // LD A,0x55
+                0x32, 0x01, 0xC0,       // LD (0xC001),A    written to bank 4
+                0x3E, 0x01,             // LD A,1
+                0xED, 0x79,             // OUT (C),A        bank 1 again
+                0x3A, 0x01, 0xC0,       // LD A,(0xC001)
+                0x32, 0x02, 0x90,       // LD (0x9002),A
+                0x3E, 0x10,             // LD A,0x10
+                0xED, 0x79,             // OUT (C),A        48K BASIC
+                0x3A, 0xFF, 0x3F,       // LD A,(0x3FFF)
+                0x32, 0x03, 0x90,       // LD (0x9003),A
+                0x3E, 0x26,             // LD A,0x26
+                0xED, 0x79,             // OUT (C),A        bank 6, 128K editor and locked
+                0x3E, 0x17,             // LD A,0x17
+                0xED, 0x79,             // OUT (C),A        ignored
+                0x3A, 0xFF, 0x3F,       // LD A,(0x3FFF)
+                0x32, 0x04, 0x90,       // LD (0x9004),A
+                0x3A, 0x00, 0xE0,       // LD A,(0xE000)
+                0x32, 0x05, 0x90,       // LD (0x9005),A
+                0x18, 0xFE              // JR $
+        };
+        machine.load(snapshot128K(makeBanks(program), 0x00));
+        machine.runFrames(1);
+
+        const uint8_t *pBank2 = machine.z80emu.getRamBank(2);
+        CHECK(pBank2[0x1000] == 0x11);
+        CHECK(pBank2[0x1001] == 0x14);
+        CHECK(pBank2[0x1002] == 0x00);
+        CHECK(pBank2[0x1003] == ROM1_MARKER);
+        CHECK(pBank2[0x1004] == ROM0_MARKER);
+        CHECK(pBank2[0x1005] == 0x16);
+        CHECK(machine.z80emu.getRamBank(4)[0x0001] == 0x55);
+        CHECK(machine.z80emu.getRamBank(1)[0x0001] == 0x00);
+        CHECK(machine.z80emu.getPaging() == 0x26);
+
+        // Only a reset unlocks the paging
+        std::vector<uint8_t> roms = fakeRoms();
+        machine.z80emu.loadRom(roms.data(), roms.size());
+        CHECK(machine.z80emu.getPaging() == 0x00);
+        CHECK(machine.z80emu.peek8(0xC000 + MARKER) == 0x10);
+    }
+
+    TEST_CASE("The ULA displays the screen in bank 7 when it is selected") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        const std::vector<uint8_t> program = {
+                0x01, 0xFD, 0x7F,       // LD BC,0x7FFD
+                0x3E, 0x08,             // LD A,0x08
+                0xED, 0x79,             // OUT (C),A        shadow screen
+                0x18, 0xFE              // JR $
+        };
+        auto banks = makeBanks(program);
+        std::fill(banks[5].begin(), banks[5].begin() + ZxDisplay::VIDEO_MEMORY_SIZE, 0x00);
+        std::fill(banks[7].begin(), banks[7].begin() + ZxDisplay::VIDEO_MEMORY_SIZE, 0xAA);
+        machine.load(snapshot128K(banks, 0x00));
+
+        auto *pSnapshot = new ZxDisplay::FrameSnapshot();
+        machine.runFrames(1);
+        machine.display.capture(*pSnapshot, false);
+        CHECK(std::all_of(pSnapshot->videoMemory, pSnapshot->videoMemory + ZxDisplay::VIDEO_MEMORY_SIZE,
+                          [](uint8_t byte) { return byte == 0xAA; }));
+
+        // Back to the normal screen, which the program sees at 0x4000 all along
+        machine.load(snapshot128K(banks, 0x08, 0x8007));
+        machine.z80emu.poke8(0x4000, 0x55);
+        machine.load(snapshot128K(banks, 0x00, 0x8007));
+        machine.runFrames(1);
+        machine.display.capture(*pSnapshot, false);
+        CHECK(pSnapshot->videoMemory[0] == 0x00);
+        CHECK(pSnapshot->videoMemory[1] == 0x00);
+        delete pSnapshot;
+    }
+
+    TEST_CASE("The odd banks are contended wherever they are paged in") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        const std::vector<uint8_t> program = {
+                0x03,                   // INC BC           count the turns of the loop
+                0x2A, 0x00, 0xC1,       // LD HL,(0xC100)
+                0x18, 0xFA              // JR -6
+        };
+        uint32_t counts[8];
+        for (uint8_t bank = 0; bank < 8; bank++) {
+            machine.load(snapshot128K(makeBanks(program), bank));
+            machine.runFrames(1);
+            counts[bank] = machine.cpu().getRegBC();
+        }
+
+        CHECK(counts[1] < counts[0]);
+        for (uint32_t bank = 2; bank < 8; bank++) {
+            CHECK(counts[bank] == counts[bank % 2]);
+        }
+    }
+
+    TEST_CASE("An interrupt is raised once a frame of 70908 T-states") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        const std::vector<uint8_t> program = {
+                0xFB,                   // EI
+                0x76,                   // HALT
+                0x18, 0xFD              // JR -3
+        };
+        machine.load(snapshot128K(makeBanks(program), 0x00));
+        machine.runFrames(50);
+        // Interrupts 69888 T-states apart would have been one more
+        CHECK(machine.z80emu.getRamBank(2)[0x1100] == 50);
+    }
+
+    TEST_CASE("The paging is saved and restored with the whole RAM") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        machine.load(snapshot128K(makeBanks({}), 0x13));
+        auto *pState = new Z80emu::MachineState();
+        machine.z80emu.saveState(*pState);
+        CHECK(pState->paging == 0x13);
+
+        auto banks = makeBanks({});
+        for (auto &contents : banks) {
+            contents[MARKER] = 0xEE;
+        }
+        machine.load(snapshot128K(banks, 0x0C));
+        CHECK(machine.z80emu.peek8(0xC000 + MARKER) == 0xEE);
+
+        machine.z80emu.restoreState(*pState);
+        CHECK(machine.z80emu.getPaging() == 0x13);
+        CHECK(machine.z80emu.peek8(0xC000 + MARKER) == 0x13);
+        CHECK(machine.z80emu.peek8(0x3FFF) == ROM1_MARKER);
+        for (uint32_t bank = 0; bank < 8; bank++) {
+            CHECK(machine.z80emu.getRamBank(bank)[MARKER] == 0x10 + bank);
+        }
+        delete pState;
+    }
+
+    TEST_CASE("A 48K snapshot runs on the 128K with 48K BASIC paged in and the paging locked") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        machine.load(snapshot48K({ 0x18, 0xFE }));
+        CHECK(machine.z80emu.getPaging() == 0x30);
+        CHECK(machine.z80emu.peek8(0x3FFF) == ROM1_MARKER);
+    }
+
+    TEST_CASE("Snapshots that are truncated or for a model with more RAM are refused, leaving the machine as it was") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        machine.load(snapshot128K(makeBanks({}), 0x13));
+
+        auto snapshot = snapshot128K(makeBanks({}), 0x04);
+        for (size_t size : { static_cast<size_t>(0), static_cast<size_t>(26), static_cast<size_t>(SNA_48K_SIZE - 1),
+                             static_cast<size_t>(SNA_48K_SIZE + 3), snapshot.size() - 1, snapshot.size() + BANK_SIZE }) {
+            std::vector<uint8_t> wrong(snapshot.begin(), snapshot.begin() + std::min(size, snapshot.size()));
+            wrong.resize(size, 0);
+            CHECK_FALSE(machine.z80emu.loadSnapshot(wrong.data(), wrong.size()));
+        }
+        // Bank 5 paged in needs the longer file, with six more banks
+        CHECK_FALSE(machine.z80emu.loadSnapshot(snapshot128K(makeBanks({}), 0x05).data(), snapshot.size()));
+        CHECK(machine.z80emu.getPaging() == 0x13);
+
+        ZxHardwareModel48k model48K;
+        Machine machine48K(model48K);
+        CHECK_FALSE(machine48K.z80emu.loadSnapshot(snapshot.data(), snapshot.size()));
+        CHECK(machine48K.z80emu.loadSnapshot(snapshot48K({}).data(), SNA_48K_SIZE));
+    }
+
+    TEST_CASE("Words written to the ROM leave it as it was, whichever byte lands in it") {
+        ZxHardwareModel128k model;
+        Machine machine(model);
+        const std::vector<uint8_t> program = {
+                0x21, 0x5A, 0xA5,       // LD HL,0xA55A
+                0x31, 0x02, 0x00,       // LD SP,0x0002
+                0xE5,                   // PUSH HL          both bytes in the ROM
+                0x22, 0xFF, 0x3F,       // LD (0x3FFF),HL   the low byte in the ROM
+                0x31, 0x01, 0x00,       // LD SP,0x0001
+                0xE5,                   // PUSH HL          the high byte in the ROM, the low byte wraps around to 0xFFFF
+                0x18, 0xFE              // JR $
+        };
+        machine.load(snapshot128K(makeBanks(program), 0x10));
+        machine.runFrames(1);
+
+        CHECK(machine.z80emu.peek8(0x0000) == 0x00);
+        CHECK(machine.z80emu.peek8(0x0001) == 0x00);
+        CHECK(machine.z80emu.peek8(0x3FFF) == ROM1_MARKER);
+        CHECK(machine.z80emu.peek8(0x4000) == 0xA5);
+        CHECK(machine.z80emu.peek8(0xFFFF) == 0x5A);
+    }
+
+    TEST_CASE("The 48K has no paging") {
+        ZxHardwareModel48k model;
+        Machine machine(model);
+        const std::vector<uint8_t> program = {
+                0x01, 0xFD, 0x7F,       // LD BC,0x7FFD
+                0x3E, 0x11,             // LD A,0x11
+                0xED, 0x79,             // OUT (C),A
+                0x3A, 0xFF, 0x3F,       // LD A,(0x3FFF)
+                0x32, 0x00, 0x90,       // LD (0x9000),A
+                0x18, 0xFE              // JR $
+        };
+        machine.load(snapshot48K(program));
+        machine.runFrames(1);
+
+        CHECK(machine.z80emu.getPaging() == 0x00);
+        CHECK(machine.z80emu.getRam()[0x9000] == zx48k_rom[0x3FFF]);
+        CHECK(machine.z80emu.getRam() + 0xC000 == machine.z80emu.getRamBank(0));
+    }
+}
+
+#endif // ZXRASPBERRY_ZXHARDWAREMODEL128KTEST_CPP
@@ -0,0 +1,184 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXINPUTQUEUETEST_CPP
+#define ZXRASPBERRY_ZXINPUTQUEUETEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include "zxinputqueue.h"
+
+
+static const uint32_t TICKS_PER_FRAME = 19968;
+static const uint32_t TSTATES_PER_FRAME = 69888;
+
+static ZxInputEvent makeEvent(uint32_t timestamp, uint8_t kempston) {
+    ZxInputEvent event{};
+    event.timestamp = timestamp;
+    memset(event.keyboard, 0xFF, sizeof(event.keyboard));
+    event.kempston = kempston;
+    return event;
+}
+
+
+TEST_SUITE("ZX input event queue") {
+
+    TEST_CASE("An empty queue has no event due") {
+        ZxInputQueue queue(TICKS_PER_FRAME, TSTATES_PER_FRAME);
+        ZxInputEvent event{};
+
+        CHECK(queue.nextTstates() == ZxInputQueue::NO_EVENT);
+        CHECK_FALSE(queue.pop(event));
+    }
+
+    TEST_CASE("Events are due a frame later, at the T-state matching their timestamp") {
+        ZxInputQueue queue(TICKS_PER_FRAME, TSTATES_PER_FRAME);
+        ZxInputEvent event{};
+        queue.startFrame(100000);
+
+        // A third and then two thirds of the way through the frame
+        REQUIRE(queue.push(makeEvent(100000 + TICKS_PER_FRAME / 3, 0x01)));
+        REQUIRE(queue.push(makeEvent(100000 + TICKS_PER_FRAME * 2 / 3, 0x02)));
+        CHECK(queue.nextTstates() >= TSTATES_PER_FRAME);
+        queue.startFrame(100000 + TICKS_PER_FRAME);
+
+        CHECK(queue.nextTstates() == TSTATES_PER_FRAME / 3);
+        REQUIRE(queue.pop(event));
+        CHECK(event.kempston == 0x01);
+        CHECK(queue.nextTstates() == TSTATES_PER_FRAME * 2 / 3);
+        REQUIRE(queue.pop(event));
+        CHECK(event.kempston == 0x02);
+        CHECK(queue.nextTstates() == ZxInputQueue::NO_EVENT);
+    }
+
+    TEST_CASE("Events from before the previous frame are due straight away") {
+        ZxInputQueue queue(TICKS_PER_FRAME, TSTATES_PER_FRAME);
+        queue.startFrame(100000);
+
+        REQUIRE(queue.push(makeEvent(100000 - TICKS_PER_FRAME * 3 / 2, 0x01)));
+        CHECK(queue.nextTstates() == 0);
+    }
+
+    TEST_CASE("Events from a previous frame that ran late are due by the end of the frame") {
+        ZxInputQueue queue(TICKS_PER_FRAME, TSTATES_PER_FRAME);
+        queue.startFrame(100000);
+        queue.startFrame(100000 + TICKS_PER_FRAME * 3 / 2);
+
+        REQUIRE(queue.push(makeEvent(100000 + TICKS_PER_FRAME * 5 / 4, 0x01)));
+        CHECK(queue.nextTstates() == TSTATES_PER_FRAME - 1);
+    }
+
+    TEST_CASE("Timestamps are mapped across the wrap around of the timer") {
+        ZxInputQueue queue(TICKS_PER_FRAME, TSTATES_PER_FRAME);
+        queue.startFrame(UINT32_MAX - TICKS_PER_FRAME / 2 + 1);
+        queue.startFrame(TICKS_PER_FRAME / 2);
+
+        REQUIRE(queue.push(makeEvent(TICKS_PER_FRAME / 4, 0x01)));
+        CHECK(queue.nextTstates() == TSTATES_PER_FRAME * 3 / 4);
+    }
+
+    TEST_CASE("Driven as the kernel drives it, every event keeps its place within the frame, a frame late") {
+        // Each frame is emulated in a burst at the start of its period, polling the queue as the emulator does: at the
+        // T-state of the next event due, and at least once a scan line.  The pacer then waits for the next period.
+        static const uint32_t BURST_TICKS = TICKS_PER_FRAME / 5;
+        static const uint32_t TSTATES_PER_LINE = 224;
+        static const uint32_t FRAMES = 20;
+        static const uint32_t EVENT_INTERVAL = 997;
+        // Start close to the wrap around of the timer
+        const uint32_t firstStart = UINT32_MAX - 5 * TICKS_PER_FRAME;
+        ZxInputQueue queue(TICKS_PER_FRAME, TSTATES_PER_FRAME);
+
+        uint32_t nextEvent = 0;
+        auto arrive = [&](uint32_t now) {
+            while (nextEvent < (FRAMES - 1) * TICKS_PER_FRAME &&
+                   static_cast<int32_t>(now - (firstStart + nextEvent)) >= 0) {
+                REQUIRE(queue.push(makeEvent(firstStart + nextEvent, 0)));
+                nextEvent += EVENT_INTERVAL;
+            }
+        };
+
+        uint32_t applied = 0;
+        uint32_t misplaced = 0;
+        for (uint32_t frame = 0; frame < FRAMES; frame++) {
+            const uint32_t frameStart = firstStart + frame * TICKS_PER_FRAME;
+            queue.startFrame(frameStart);
+            uint32_t tstates = 0;
+            while (tstates < TSTATES_PER_FRAME) {
+                arrive(frameStart + static_cast<uint32_t>(static_cast<uint64_t>(tstates) * BURST_TICKS /
+                                                          TSTATES_PER_FRAME));
+                ZxInputEvent event{};
+                while (queue.nextTstates() <= tstates && queue.pop(event)) {
+                    const uint32_t sinceFirst = event.timestamp - firstStart;
+                    const uint32_t expected = static_cast<uint32_t>(
+                            static_cast<uint64_t>(sinceFirst % TICKS_PER_FRAME) * TSTATES_PER_FRAME / TICKS_PER_FRAME);
+                    misplaced += (sinceFirst / TICKS_PER_FRAME + 1 != frame || tstates != expected) ? 1 : 0;
+                    applied++;
+                }
+                tstates = std::min(queue.nextTstates(), tstates + TSTATES_PER_LINE);
+            }
+            arrive(frameStart + TICKS_PER_FRAME - 1);
+        }
+
+        CHECK(applied == nextEvent / EVENT_INTERVAL);
+        CHECK(applied > 350);
+        CHECK(misplaced == 0);
+    }
+
+    TEST_CASE("Events pushed into a full queue are dropped and counted") {
+        ZxInputQueue queue(TICKS_PER_FRAME, TSTATES_PER_FRAME);
+        ZxInputEvent event{};
+
+        for (uint32_t i = 0; i < ZxInputQueue::CAPACITY; i++) {
+            REQUIRE(queue.push(makeEvent(i, static_cast<uint8_t>(i))));
+        }
+        CHECK_FALSE(queue.push(makeEvent(0, 0xFF)));
+        CHECK(queue.dropped() == 1);
+
+        // Popping one event makes room for another
+        REQUIRE(queue.pop(event));
+        CHECK(event.kempston == 0);
+        CHECK(queue.push(makeEvent(0, 0xFF)));
+        CHECK(queue.dropped() == 1);
+    }
+
+    TEST_CASE("Events cross from the producer thread to the consumer in order") {
+        static const uint32_t EVENTS = 100000;
+        ZxInputQueue queue(TICKS_PER_FRAME, TSTATES_PER_FRAME);
+
+        std::thread producer([&queue]() {
+            for (uint32_t i = 0; i < EVENTS; i++) {
+                ZxInputEvent event = makeEvent(i, static_cast<uint8_t>(i));
+                memset(event.keyboard, static_cast<uint8_t>(i), sizeof(event.keyboard));
+                while (!queue.push(event)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint32_t received = 0;
+        uint32_t corrupted = 0;
+        ZxInputEvent event{};
+        while (received < EVENTS) {
+            if (!queue.pop(event)) {
+                std::this_thread::yield();
+                continue;
+            }
+            corrupted += (event.timestamp != received) ? 1 : 0;
+            for (uint8_t row : event.keyboard) {
+                corrupted += (row != event.kempston || row != static_cast<uint8_t>(received)) ? 1 : 0;
+            }
+            received++;
+        }
+        producer.join();
+
+        CHECK(corrupted == 0);
+        CHECK(queue.nextTstates() == ZxInputQueue::NO_EVENT);
+    }
+}
+
+#endif // ZXRASPBERRY_ZXINPUTQUEUETEST_CPP
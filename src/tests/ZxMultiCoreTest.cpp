@@ -0,0 +1,100 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXMULTICORETEST_CPP
+#define ZXRASPBERRY_ZXMULTICORETEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <atomic>
+#include <thread>
+#include "zxmulticore.h"
+#include "zxtriplebuffer.h"
+
+/*
+ * Consumer side of a frame hand-off, as run by the rendering core: takes the latest frame and checks that the frames
+ * arrive in order.
+ */
+class ConsumerTask : public ZxCoreTask {
+
+public:
+    explicit ConsumerTask(ZxTripleBuffer &frames, const uint32_t *pFrameNumbers) :
+            m_frames(frames), m_pFrameNumbers(pFrameNumbers) {
+    }
+
+    bool step() override {
+        if (!m_frames.take()) {
+            return false;
+        }
+        uint32_t frameNumber = m_pFrameNumbers[m_frames.front()];
+        m_outOfOrder += (frameNumber <= m_lastFrame) ? 1 : 0;
+        m_lastFrame = frameNumber;
+        m_taken++;
+        return true;
+    }
+
+    ZxTripleBuffer &m_frames;
+    const uint32_t *m_pFrameNumbers;
+    std::atomic<uint32_t> m_lastFrame{0};
+    uint32_t m_outOfOrder = 0;
+    std::atomic<uint32_t> m_taken{0};
+};
+
+class CountingTask : public ZxCoreTask {
+
+public:
+    bool step() override {
+        m_steps++;
+        return false;
+    }
+
+    std::atomic<uint32_t> m_steps{0};
+};
+
+
+TEST_SUITE("ZX multi-core support") {
+
+    TEST_CASE("Tasks run on their own cores until they are stopped") {
+        ZxTripleBuffer frames;
+        uint32_t frameNumbers[ZxTripleBuffer::BUFFERS] = { 0 };
+        ConsumerTask consumer(frames, frameNumbers);
+        CountingTask counter;
+
+        ZxMultiCore multiCore(nullptr);
+        multiCore.assign(1, &consumer);
+        multiCore.assign(2, &counter);
+        REQUIRE(multiCore.start());
+
+        // Core 0 produces frames, as the emulation does
+        const uint32_t count = 2000;
+        for (uint32_t frame = 1; frame <= count; frame++) {
+            frameNumbers[frames.back()] = frame;
+            frames.publish();
+            std::this_thread::yield();
+        }
+        while (consumer.m_lastFrame != count) {
+            std::this_thread::yield();
+        }
+
+        multiCore.stop();
+        uint32_t steps = counter.m_steps;
+        CHECK(steps > 0);
+        CHECK(consumer.m_taken > 0);
+        CHECK(consumer.m_outOfOrder == 0);
+
+        // Nothing runs once the cores have stopped
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        CHECK(counter.m_steps == steps);
+    }
+
+    TEST_CASE("Cores can be stopped before they are started") {
+        // Would never return if it waited for cores that were never started
+        ZxMultiCore multiCore(nullptr);
+        multiCore.stop();
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXMULTICORETEST_CPP
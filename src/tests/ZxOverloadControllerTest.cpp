@@ -0,0 +1,115 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXOVERLOADCONTROLLERTEST_CPP
+#define ZXRASPBERRY_ZXOVERLOADCONTROLLERTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include "zxoverloadcontroller.h"
+
+// Frame period of the 48K model in system timer ticks
+static const uint32_t FRAME_PERIOD = 19968;
+
+class FakeTimer : public ZxPacingTimer {
+
+public:
+    uint32_t clockTicks() override {
+        return m_ticks;
+    }
+
+    void waitTicks(uint32_t ticks) override {
+        m_ticks += ticks;
+    }
+
+    uint32_t m_ticks = 0;
+};
+
+/*
+ * Runs a window of frames that take the given time to emulate and, when drawn, to render, and returns how many of them
+ * were drawn.
+ */
+static uint32_t runWindow(ZxOverloadController &controller, FakeTimer &timer, uint32_t emulation, uint32_t render) {
+
+    uint32_t rendered = 0;
+    for (uint32_t frame = 0; frame < ZxOverloadController::WINDOW_FRAMES; frame++) {
+        controller.beginFrame();
+        timer.m_ticks += emulation;
+        controller.emulationDone();
+        if (controller.renderFrame()) {
+            timer.m_ticks += controller.drawBorder() ? render : render * 3 / 4;
+            rendered++;
+        }
+        controller.endFrame();
+    }
+    return rendered;
+}
+
+
+TEST_SUITE("ZX overload controller") {
+
+    TEST_CASE("Frames within budget are drawn in full") {
+        FakeTimer timer;
+        ZxOverloadController controller(timer, FRAME_PERIOD);
+
+        for (uint32_t window = 0; window < 10; window++) {
+            CHECK(runWindow(controller, timer, 10000, 5000) == ZxOverloadController::WINDOW_FRAMES);
+        }
+        CHECK(controller.level() == ZxOverloadController::Level::Full);
+        CHECK(controller.degradations() == 0);
+        CHECK(controller.emulationCost() == 10000);
+        CHECK(controller.renderCost() == 5000);
+    }
+
+    TEST_CASE("An overloaded host steps down the ladder until the frames fit and climbs back up when the load drops") {
+        FakeTimer timer;
+        ZxOverloadController controller(timer, FRAME_PERIOD);
+
+        // 15 ms of emulation plus 12 ms of drawing only fits when one frame in four is drawn
+        runWindow(controller, timer, 15000, 12000);
+        CHECK(controller.level() == ZxOverloadController::Level::SkipBorder);
+        CHECK_FALSE(controller.drawBorder());
+        runWindow(controller, timer, 15000, 12000);
+        CHECK(controller.level() == ZxOverloadController::Level::SkipAlternateRender);
+        runWindow(controller, timer, 15000, 12000);
+        CHECK(controller.level() == ZxOverloadController::Level::SkipPresent);
+
+        CHECK(runWindow(controller, timer, 15000, 12000) <= (ZxOverloadController::WINDOW_FRAMES + 3) / 4);
+        CHECK(controller.level() == ZxOverloadController::Level::SkipPresent);
+        CHECK(controller.degradations() == 3);
+        CHECK(controller.bordersSkipped() == 3 * ZxOverloadController::WINDOW_FRAMES);
+        CHECK(controller.rendersSkipped() > 0);
+
+        // Once the emulation gets cheaper the controller climbs back up one level at a time
+        runWindow(controller, timer, 5000, 8000);
+        CHECK(controller.level() == ZxOverloadController::Level::SkipAlternateRender);
+        runWindow(controller, timer, 5000, 8000);
+        CHECK(controller.level() == ZxOverloadController::Level::SkipBorder);
+        runWindow(controller, timer, 5000, 8000);
+        CHECK(controller.level() == ZxOverloadController::Level::Full);
+        CHECK(controller.recoveries() == 3);
+        CHECK(controller.drawBorder());
+    }
+
+    TEST_CASE("The controller does not climb back up to a level that would overload the host again") {
+        FakeTimer timer;
+        ZxOverloadController controller(timer, FRAME_PERIOD);
+
+        // Drawing every other frame fits, but drawing every frame does not
+        for (uint32_t window = 0; window < 10; window++) {
+            runWindow(controller, timer, 12000, 10000);
+        }
+        CHECK(controller.level() == ZxOverloadController::Level::SkipAlternateRender);
+        CHECK(controller.degradations() == 2);
+        CHECK(controller.recoveries() == 0);
+
+        controller.reset();
+        CHECK(controller.level() == ZxOverloadController::Level::Full);
+        CHECK(controller.frames() == 0);
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXOVERLOADCONTROLLERTEST_CPP
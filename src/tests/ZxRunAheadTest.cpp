@@ -0,0 +1,315 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXRUNAHEADTEST_CPP
+#define ZXRASPBERRY_ZXRUNAHEADTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <circle/bcmframebuffer.h>
+#include "clock.h"
+#include "Z80emu.h"
+#include "zxdisplay.h"
+#include "zxrunahead.h"
+#include "audio/zxaudiobuffer.h"
+#include "audio/zxay.h"
+#include "audio/zxbeeper.h"
+#include "hardware/zxhardwaremodel128k.h"
+#include "hardware/zxhardwaremodel48k.h"
+#include "zx48k_rom.h"
+#include "aquaplane_sna.h"
+
+// Frame period of the 48K model in microseconds
+static const uint32_t FRAME_PERIOD = 19968;
+static const uint32_t FRAME_SIZE = ZxDisplay::DISPLAY_WIDTH * ZxDisplay::DISPLAY_HEIGHT * 4;
+
+// Timer that stands still, so emulating a frame costs nothing
+class FakeTimer : public ZxPacingTimer {
+
+public:
+    uint32_t clockTicks() override {
+        return 0;
+    }
+
+    void waitTicks(uint32_t /* ticks */) override {
+    }
+};
+
+class SteadyTimer : public ZxPacingTimer {
+
+public:
+    uint32_t clockTicks() override {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    }
+
+    void waitTicks(uint32_t /* ticks */) override {
+    }
+};
+
+/*
+ * A 48K Spectrum running Aquaplane, drawn a frame at a time into a 32 bpp framebuffer.
+ */
+struct Machine {
+    Machine() : z80emu(&display) {
+        Clock::getInstance().setSpectrumModel(&model);
+        // The display owns the framebuffer
+        display.Initialize(z80emu.getRam() + 0x4000,
+                           new CBcmFrameBuffer(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, 32));
+        display.setHardwareModel(&model);
+        z80emu.loadRom(zx48k_rom, zx48k_rom_len);
+        REQUIRE(z80emu.loadSnapshot(aquaplane_sna, aquaplane_sna_len));
+    }
+
+    std::vector<uint8_t> frame() const {
+        const uint8_t *pFrame = display.getFrontBuffer();
+        return { pFrame, pFrame + FRAME_SIZE };
+    }
+
+    std::vector<uint8_t> ram() {
+        return { z80emu.getRam() + 0x4000, z80emu.getRam() + 0x10000 };
+    }
+
+    ZxHardwareModel48k model;
+    ZxDisplay display;
+    Z80emu z80emu;
+};
+
+/*
+ * A 128K Spectrum with blank ROMs running, with interrupts off, a program that sets the tone of channel A and restarts
+ * its envelope with a new shape about every frame and a third.
+ */
+struct AYMachine {
+    AYMachine() : z80emu(&display) {
+        Clock::getInstance().setSpectrumModel(&model);
+        z80emu.setHardwareModel(&model);
+        display.Initialize(z80emu.getRam() + 0x4000,
+                           new CBcmFrameBuffer(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, 32));
+        display.setHardwareModel(&model);
+        std::vector<uint8_t> roms(0x8000, 0);
+        z80emu.loadRom(roms.data(), roms.size());
+
+        std::vector<uint8_t> program = { 0x01, 0xFD, 0xFF };        // LD BC,0xFFFD
+        // Channel A plays its tone at the level of the envelope
+        const uint8_t setup[][2] = { { 7, 0x3E }, { 8, 0x10 }, { 11, 40 }, { 12, 0 } };
+        for (const uint8_t *pWrite : setup) {
+            program.insert(program.end(), { 0x06, 0xFF, 0x3E, pWrite[0], 0xED, 0x79,     // OUT (0xFFFD),reg
+                                            0x06, 0xBF, 0x3E, pWrite[1], 0xED, 0x79 });   // OUT (0xBFFD),value
+        }
+        program.insert(program.end(), { 0x1E, 0x00 });                  // LD E,0
+        const size_t loop = program.size();
+        program.insert(program.end(), {
+                0x06, 0xFF, 0x3E, 0x00, 0xED, 0x79,                     // select the fine tone period of channel A
+                0x06, 0xBF, 0x7B, 0x87, 0x87, 0xED, 0x79,               // to E * 4
+                0x06, 0xFF, 0x3E, 0x0D, 0xED, 0x79,                     // select the envelope shape
+                0x06, 0xBF, 0x7B, 0xE6, 0x0F, 0xED, 0x79,               // to E & 0x0F
+                0x1C,                                                   // INC E
+                0x21, 0xAC, 0x0D,                                       // LD HL,3500
+                0x2B, 0x7C, 0xB5, 0x20, 0xFB                            // DEC HL; LD A,H; OR L; JR NZ,-5
+        });
+        program.insert(program.end(), { 0x18, static_cast<uint8_t>(loop - (program.size() + 2)) });  // JR loop
+
+        // A snapshot with interrupts off that returns to the program at 0x9000 through the stack at 0x8000
+        std::vector<uint8_t> snapshot(49152 + 27, 0);
+        snapshot[24] = 0x80;
+        snapshot[27 + 0x4001] = 0x90;
+        std::copy(program.begin(), program.end(), snapshot.begin() + 27 + 0x5000);
+        REQUIRE(z80emu.loadSnapshot(snapshot.data(), snapshot.size()));
+    }
+
+    ZxHardwareModel128k model;
+    ZxDisplay display;
+    Z80emu z80emu;
+};
+
+
+TEST_SUITE("ZX run-ahead") {
+
+    TEST_CASE("Each frame shows the real machine some frames ahead and the real machine is left untouched") {
+        const uint32_t frames = 20;
+        const uint32_t ahead = 2;
+
+        std::vector<std::vector<uint8_t>> expectedFrames;
+        std::vector<uint8_t> expectedRam;
+        {
+            Machine machine;
+            for (uint32_t frame = 0; frame < frames + ahead; frame++) {
+                machine.z80emu.execute(machine.model.tStatesPerScreenFrame());
+                Clock::getInstance().endFrame();
+                machine.display.update(false);
+                expectedFrames.push_back(machine.frame());
+                if (frame + 1 == frames) {
+                    expectedRam = machine.ram();
+                }
+            }
+        }
+
+        Machine machine;
+        FakeTimer timer;
+        ZxRunAhead runAhead(machine.z80emu, machine.model, timer, FRAME_PERIOD);
+        runAhead.setFrames(ahead);
+        for (uint32_t frame = 0; frame < frames; frame++) {
+            runAhead.runFrame(machine.display);
+            CHECK(runAhead.isActive());
+            machine.display.update(false);
+            CHECK(machine.frame() == expectedFrames[frame + ahead]);
+            runAhead.rewind();
+        }
+        CHECK(runAhead.framesAhead() == frames * ahead);
+        CHECK(Clock::getInstance().getFrames() == frames);
+        CHECK(machine.ram() == expectedRam);
+    }
+
+    TEST_CASE("Only the frames of the real machine are heard") {
+        const uint32_t frames = 200;
+
+        std::vector<int16_t> expected;
+        {
+            Machine machine;
+            ZxAudioBuffer buffer(1u << 20);
+            ZxBeeper beeper(buffer, machine.model.clockFrequency(), machine.model.tStatesPerScreenFrame(), 48000);
+            machine.z80emu.setBeeper(&beeper);
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                machine.z80emu.execute(machine.model.tStatesPerScreenFrame());
+                Clock::getInstance().endFrame();
+            }
+            expected.resize(buffer.available());
+            buffer.read(expected.data(), buffer.available());
+        }
+        bool sound = false;
+        for (int16_t sample : expected) {
+            sound = sound || sample != 0;
+        }
+        REQUIRE(sound);
+
+        Machine machine;
+        ZxAudioBuffer buffer(1u << 20);
+        ZxBeeper beeper(buffer, machine.model.clockFrequency(), machine.model.tStatesPerScreenFrame(), 48000);
+        machine.z80emu.setBeeper(&beeper);
+        FakeTimer timer;
+        ZxRunAhead runAhead(machine.z80emu, machine.model, timer, FRAME_PERIOD);
+        runAhead.setFrames(2);
+        for (uint32_t frame = 0; frame < frames; frame++) {
+            runAhead.runFrame(machine.display);
+            runAhead.rewind();
+        }
+        CHECK(runAhead.framesAhead() == frames * 2);
+        CHECK_FALSE(machine.z80emu.isSilent());
+
+        std::vector<int16_t> samples(buffer.available());
+        buffer.read(samples.data(), buffer.available());
+        CHECK(samples == expected);
+    }
+
+    TEST_CASE("Only the frames of the real machine are heard from the AY") {
+        const uint32_t frames = 100;
+
+        std::vector<int16_t> expected;
+        {
+            AYMachine machine;
+            ZxAudioBuffer buffer(1u << 20);
+            ZxBeeper beeper(buffer, machine.model.clockFrequency(), machine.model.tStatesPerScreenFrame(), 48000);
+            ZxAY ay(machine.model.clockFrequency(), machine.model.tStatesPerScreenFrame(), 48000);
+            machine.z80emu.setBeeper(&beeper);
+            machine.z80emu.setAY(&ay);
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                machine.z80emu.execute(machine.model.tStatesPerScreenFrame());
+                Clock::getInstance().endFrame();
+            }
+            expected.resize(buffer.available());
+            buffer.read(expected.data(), buffer.available());
+            machine.z80emu.setAY(nullptr);
+        }
+        bool sound = false;
+        for (int16_t sample : expected) {
+            sound = sound || sample != expected[0];
+        }
+        REQUIRE(sound);
+
+        AYMachine machine;
+        ZxAudioBuffer buffer(1u << 20);
+        ZxBeeper beeper(buffer, machine.model.clockFrequency(), machine.model.tStatesPerScreenFrame(), 48000);
+        ZxAY ay(machine.model.clockFrequency(), machine.model.tStatesPerScreenFrame(), 48000);
+        machine.z80emu.setBeeper(&beeper);
+        machine.z80emu.setAY(&ay);
+        FakeTimer timer;
+        ZxRunAhead runAhead(machine.z80emu, machine.model, timer, FRAME_PERIOD);
+        runAhead.setFrames(2);
+        for (uint32_t frame = 0; frame < frames; frame++) {
+            runAhead.runFrame(machine.display);
+            runAhead.rewind();
+        }
+        CHECK(runAhead.framesAhead() == frames * 2);
+        machine.z80emu.setAY(nullptr);
+
+        std::vector<int16_t> samples(buffer.available());
+        buffer.read(samples.data(), buffer.available());
+        CHECK(samples == expected);
+    }
+
+    TEST_CASE("Run-ahead only runs while the host has the headroom") {
+        Machine machine;
+        FakeTimer timer;
+        ZxRunAhead runAhead(machine.z80emu, machine.model, timer, FRAME_PERIOD);
+
+        // Off by default
+        runAhead.runFrame(machine.display);
+        CHECK_FALSE(runAhead.isActive());
+
+        runAhead.setFrames(1);
+        runAhead.runFrame(machine.display);
+        CHECK(runAhead.isActive());
+        runAhead.rewind();
+
+        // Drawing alone takes most of the frame period
+        runAhead.setRenderCost(FRAME_PERIOD * 95 / 100);
+        runAhead.runFrame(machine.display);
+        CHECK_FALSE(runAhead.isActive());
+
+        runAhead.setRenderCost(0);
+        runAhead.setEnabled(false);
+        runAhead.runFrame(machine.display);
+        CHECK_FALSE(runAhead.isActive());
+        CHECK(runAhead.framesAhead() == 1);
+        CHECK(Clock::getInstance().getFrames() == 4);
+    }
+
+    TEST_CASE("Run-ahead cost per frame and latency saved") {
+        // Not an assertion: report the cost of the state copies and of each frame ahead on this machine
+        Machine machine;
+        Z80emu::MachineState state;
+        const uint32_t copies = 1000;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < copies; i++) {
+            machine.z80emu.saveState(state);
+            machine.z80emu.restoreState(state);
+        }
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        std::printf("Run-ahead state save and restore: %8.2f us\n", elapsed.count() / copies);
+
+        SteadyTimer timer;
+        const uint32_t frames = 100;
+        for (uint32_t ahead = 0; ahead <= 2; ahead++) {
+            ZxRunAhead runAhead(machine.z80emu, machine.model, timer, FRAME_PERIOD);
+            runAhead.setFrames(ahead);
+            start = std::chrono::steady_clock::now();
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                runAhead.runFrame(machine.display);
+                machine.display.update(false);
+                runAhead.rewind();
+            }
+            elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+            std::printf("Run-ahead %u frame(s): %8.2f us per frame, %5.1f frames per second, %2u ms less input lag\n",
+                        ahead, elapsed.count() / frames, frames * 1e6 / elapsed.count(), ahead * FRAME_PERIOD / 1000);
+        }
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXRUNAHEADTEST_CPP
@@ -0,0 +1,215 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXSCHEDULERTEST_CPP
+#define ZXRASPBERRY_ZXSCHEDULERTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <vector>
+#include "clock.h"
+#include "zxscheduler.h"
+#include "ZxTestMachine.h"
+
+
+/*
+ * Records the events that it handles and, optionally, schedules the next occurrence of a periodic event.
+ */
+class RecordingHandler : public ZxEventHandler {
+
+public:
+    struct Record {
+        uint32_t event;
+        uint64_t tstates;
+    };
+
+    explicit RecordingHandler(ZxScheduler &scheduler, uint64_t period = 0) :
+            m_scheduler(scheduler), m_period(period) {
+    }
+
+    void handleEvent(uint32_t event, uint64_t tstates) override {
+        m_records.push_back({ event, tstates });
+        if (m_period > 0) {
+            m_scheduler.schedule(this, event, tstates + m_period);
+        }
+    }
+
+    ZxScheduler &m_scheduler;
+    uint64_t m_period;
+    std::vector<Record> m_records;
+};
+
+
+TEST_SUITE("ZX T-state event scheduler") {
+
+    TEST_CASE("An empty scheduler has no deadline") {
+        ZxScheduler scheduler;
+
+        CHECK(scheduler.nextDeadline() == ZxScheduler::NO_EVENT);
+        scheduler.runUntil(ZxScheduler::NO_EVENT - 1);
+        CHECK(scheduler.size() == 0);
+    }
+
+    TEST_CASE("Events are handled in order of their deadline once they are due") {
+        ZxScheduler scheduler;
+        RecordingHandler handler(scheduler);
+
+        scheduler.schedule(&handler, 3, 300);
+        scheduler.schedule(&handler, 1, 100);
+        scheduler.schedule(&handler, 4, 400);
+        scheduler.schedule(&handler, 2, 200);
+        CHECK(scheduler.nextDeadline() == 100);
+
+        scheduler.runUntil(99);
+        CHECK(handler.m_records.empty());
+
+        scheduler.runUntil(250);
+        REQUIRE(handler.m_records.size() == 2);
+        CHECK(handler.m_records[0].event == 1);
+        CHECK(handler.m_records[0].tstates == 100);
+        CHECK(handler.m_records[1].event == 2);
+        CHECK(scheduler.nextDeadline() == 300);
+
+        scheduler.runUntil(1000);
+        REQUIRE(handler.m_records.size() == 4);
+        CHECK(handler.m_records[2].event == 3);
+        CHECK(handler.m_records[3].event == 4);
+        CHECK(scheduler.nextDeadline() == ZxScheduler::NO_EVENT);
+    }
+
+    TEST_CASE("Events due at the same T-state are handled in the order they were scheduled") {
+        ZxScheduler scheduler;
+        RecordingHandler handler(scheduler);
+
+        for (uint32_t event = 0; event < ZxScheduler::CAPACITY; event++) {
+            scheduler.schedule(&handler, event, 69888, true);
+        }
+        scheduler.runUntil(69888);
+
+        REQUIRE(handler.m_records.size() == ZxScheduler::CAPACITY);
+        for (uint32_t event = 0; event < ZxScheduler::CAPACITY; event++) {
+            CHECK(handler.m_records[event].event == event);
+        }
+    }
+
+    TEST_CASE("Scheduling a pending event moves its deadline") {
+        ZxScheduler scheduler;
+        RecordingHandler first(scheduler);
+        RecordingHandler second(scheduler);
+
+        scheduler.schedule(&first, 0, 100);
+        scheduler.schedule(&second, 0, 200);
+        scheduler.schedule(&first, 0, 300);
+        CHECK(scheduler.size() == 2);
+        CHECK(scheduler.nextDeadline() == 200);
+
+        scheduler.cancel(&second, 0);
+        CHECK_FALSE(scheduler.isScheduled(&second, 0));
+        CHECK(scheduler.isScheduled(&first, 0));
+
+        scheduler.runUntil(1000);
+        CHECK(first.m_records.size() == 1);
+        CHECK(second.m_records.empty());
+    }
+
+    TEST_CASE("Periodic events scheduled while handling are handled in the same run if they are due") {
+        ZxScheduler scheduler;
+        RecordingHandler interrupt(scheduler, 69888);
+        RecordingHandler beeper(scheduler, 1000);
+
+        scheduler.schedule(&interrupt, 0, 0);
+        scheduler.schedule(&beeper, 0, 500);
+        scheduler.runUntil(69888 * 2);
+
+        CHECK(interrupt.m_records.size() == 3);
+        CHECK(beeper.m_records.size() == 140);
+        for (size_t i = 1; i < beeper.m_records.size(); i++) {
+            CHECK(beeper.m_records[i].tstates == beeper.m_records[i - 1].tstates + 1000);
+        }
+        CHECK(scheduler.nextDeadline() == 140500);
+    }
+
+    TEST_CASE("Deadlines carry on past 32 bits") {
+        ZxScheduler scheduler;
+        RecordingHandler handler(scheduler, 69888);
+        const uint64_t start = 0xFFFFFFFFull - 1000;
+
+        scheduler.schedule(&handler, 0, start);
+        scheduler.runUntil(start + 69888 * 10);
+
+        CHECK(handler.m_records.size() == 11);
+        CHECK(scheduler.nextDeadline() == start + 69888 * 11);
+    }
+
+    TEST_CASE("Events that do not fit are dropped and counted, and pending ones can still be moved") {
+        ZxScheduler scheduler;
+        RecordingHandler handler(scheduler);
+
+        const uint32_t shared = ZxScheduler::CAPACITY - ZxScheduler::RESERVED;
+        for (uint32_t event = 0; event < shared; event++) {
+            CHECK(scheduler.schedule(&handler, event, 100 + event));
+        }
+        CHECK_FALSE(scheduler.schedule(&handler, shared, 50));
+        for (uint32_t event = shared; event < ZxScheduler::CAPACITY; event++) {
+            CHECK(scheduler.schedule(&handler, event, 100 + event, true));
+        }
+        CHECK_FALSE(scheduler.schedule(&handler, ZxScheduler::CAPACITY, 50, true));
+        CHECK(scheduler.dropped() == 2);
+        CHECK(scheduler.size() == ZxScheduler::CAPACITY);
+        CHECK(scheduler.nextDeadline() == 100);
+
+        CHECK(scheduler.schedule(&handler, 5, 10));
+        CHECK(scheduler.nextDeadline() == 10);
+        CHECK(scheduler.size() == ZxScheduler::CAPACITY);
+
+        scheduler.runUntil(1000);
+        CHECK(handler.m_records.size() == ZxScheduler::CAPACITY);
+        CHECK(handler.m_records[0].event == 5);
+    }
+
+    TEST_CASE("Frames still end when a device fills the scheduler") {
+        ZxTestMachine<> machine;
+        Z80emu &z80emu = machine.z80emu;
+        REQUIRE(machine.load({ 0x18, 0xFE }));              // JR $
+        ZxScheduler unused;
+        RecordingHandler handler(unused);
+
+        const uint32_t frameTstates = machine.model.tStatesPerScreenFrame();
+        const uint64_t later = Clock::getInstance().getAbsTstates() + 100 * frameTstates;
+        for (uint32_t event = 0; event < ZxScheduler::CAPACITY; event++) {
+            z80emu.schedule(&handler, event, later + event);
+        }
+        auto *pState = new Z80emu::MachineState();
+        z80emu.saveState(*pState);
+        CHECK(pState->scheduler.dropped() >= ZxScheduler::RESERVED);
+        delete pState;
+
+        long frames = Clock::getInstance().getFrames();
+        for (uint32_t frame = 0; frame < 3; frame++) {
+            z80emu.execute(frameTstates);
+            Clock::getInstance().endFrame();
+        }
+        CHECK(Clock::getInstance().getFrames() == frames + 3);
+        CHECK(handler.m_records.empty());
+    }
+
+    TEST_CASE("A copy of the scheduler keeps its own deadlines") {
+        ZxScheduler scheduler;
+        RecordingHandler handler(scheduler);
+
+        scheduler.schedule(&handler, 0, 100);
+        scheduler.schedule(&handler, 1, 200);
+        ZxScheduler saved = scheduler;
+
+        scheduler.runUntil(1000);
+        CHECK(scheduler.size() == 0);
+
+        scheduler = saved;
+        CHECK(scheduler.size() == 2);
+        CHECK(scheduler.nextDeadline() == 100);
+    }
+}
+
+#endif // ZXRASPBERRY_ZXSCHEDULERTEST_CPP
@@ -0,0 +1,349 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXTAPEINPUTTEST_CPP
+#define ZXRASPBERRY_ZXTAPEINPUTTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "clock.h"
+#include "audio/zxtapefile.h"
+#include "audio/zxtapeinput.h"
+#include "audio/zxtapesource.h"
+#include "ZxTestMachine.h"
+
+static const uint32_t CLOCK_FREQUENCY = 3500000;
+static const uint32_t TSTATES_PER_FRAME = 69888;
+
+// Pulses of the ROM saving routine, in T-states
+static const uint32_t PILOT_PULSE = 2168;
+static const uint32_t SYNC1_PULSE = 667;
+static const uint32_t SYNC2_PULSE = 735;
+static const uint32_t ZERO_PULSE = 855;
+static const uint32_t ONE_PULSE = 1710;
+static const uint32_t DATA_PILOT_PULSES = 3223;
+
+
+struct Format {
+    uint32_t sampleRate;
+    uint32_t channels;
+    uint32_t bits;
+    int32_t amplitude;
+    // DC offset and peak of the noise added to the signal
+    int32_t offset;
+    int32_t noise;
+};
+
+static void put16(std::vector<uint8_t> &data, uint32_t value) {
+    data.push_back(static_cast<uint8_t>(value));
+    data.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+static void put32(std::vector<uint8_t> &data, uint32_t value) {
+    put16(data, value);
+    put16(data, value >> 16);
+}
+
+static void putTag(std::vector<uint8_t> &data, const char *pTag) {
+    for (uint32_t i = 0; i < 4; i++) {
+        data.push_back(static_cast<uint8_t>(pTag[i]));
+    }
+}
+
+/*
+ * WAV recording of a square wave made of the given pulses, repeated a number of times and followed by some silence,
+ * generated as it is read, so that it takes no memory however long it is.  The signal starts low and changes at the
+ * end of every pulse.
+ */
+class GeneratedTape : public ZxTapeSource {
+
+public:
+    GeneratedTape(const Format &format, std::vector<uint32_t> pulses, uint32_t repeats = 1,
+                  uint32_t silence = 4410) :
+            m_format(format),
+            m_pulses(std::move(pulses)),
+            m_repeats(repeats) {
+        uint64_t tstates = 0;
+        for (uint32_t pulse : m_pulses) {
+            tstates += pulse;
+        }
+        m_samples = tstates * repeats * format.sampleRate / CLOCK_FREQUENCY + silence;
+        m_pulseEnd = m_pulses.empty() ? UINT64_MAX : m_pulses[0];
+
+        const uint32_t frameSize = format.channels * format.bits / 8;
+        const auto dataSize = static_cast<uint32_t>(m_samples * frameSize);
+        putTag(m_header, "RIFF");
+        put32(m_header, 4 + 8 + 16 + 8 + 6 + 8 + dataSize);
+        putTag(m_header, "WAVE");
+        putTag(m_header, "fmt ");
+        put32(m_header, 16);
+        put16(m_header, 1);
+        put16(m_header, format.channels);
+        put32(m_header, format.sampleRate);
+        put32(m_header, format.sampleRate * frameSize);
+        put16(m_header, frameSize);
+        put16(m_header, format.bits);
+        // A chunk of tags of odd size, padded to an even one, to be skipped
+        putTag(m_header, "LIST");
+        put32(m_header, 5);
+        m_header.insert(m_header.end(), { 'I', 'N', 'F', 'O', '!', 0 });
+        putTag(m_header, "data");
+        put32(m_header, dataSize);
+    }
+
+    uint32_t read(uint8_t *pData, uint32_t size) override {
+        uint32_t count = 0;
+        while (count < size && m_headerRead < m_header.size()) {
+            pData[count++] = m_header[m_headerRead++];
+        }
+        const uint32_t bytes = m_format.bits / 8;
+        while (count + m_format.channels * bytes <= size && m_sample < m_samples) {
+            int32_t value = nextValue();
+            for (uint32_t channel = 0; channel < m_format.channels; channel++) {
+                if (bytes == 1) {
+                    pData[count++] = static_cast<uint8_t>(std::min(std::max(value / 256 + 128, 0), 255));
+                } else {
+                    auto sample = static_cast<uint16_t>(std::min(std::max(value, -32768), 32767));
+                    pData[count++] = static_cast<uint8_t>(sample);
+                    pData[count++] = static_cast<uint8_t>(sample >> 8);
+                }
+            }
+        }
+        m_bytesRead += count;
+        return count;
+    }
+
+    [[nodiscard]] uint64_t bytesRead() const {
+        return m_bytesRead;
+    }
+
+    [[nodiscard]] uint32_t headerSize() const {
+        return static_cast<uint32_t>(m_header.size());
+    }
+
+private:
+    int32_t nextValue() {
+        const uint64_t tstates = m_sample * CLOCK_FREQUENCY / m_format.sampleRate;
+        m_sample++;
+        while (tstates >= m_pulseEnd) {
+            m_bHigh = !m_bHigh;
+            m_pulse++;
+            if (m_pulse == m_pulses.size()) {
+                m_pulse = 0;
+                m_repeats--;
+            }
+            m_pulseEnd = (m_repeats > 0) ? m_pulseEnd + m_pulses[m_pulse] : UINT64_MAX;
+        }
+        m_noise = m_noise * 1103515245u + 12345u;
+        const int32_t noise = (m_format.noise > 0) ?
+                static_cast<int32_t>((m_noise >> 16) % (2 * m_format.noise + 1)) - m_format.noise : 0;
+        return (m_bHigh ? m_format.amplitude : -m_format.amplitude) + m_format.offset + noise;
+    }
+
+    const Format m_format;
+    const std::vector<uint32_t> m_pulses;
+    uint32_t m_repeats;
+    std::vector<uint8_t> m_header;
+    uint32_t m_headerRead = 0;
+    uint64_t m_samples;
+    uint64_t m_sample = 0;
+    size_t m_pulse = 0;
+    uint64_t m_pulseEnd;
+    bool m_bHigh = false;
+    uint32_t m_noise = 1;
+    uint64_t m_bytesRead = 0;
+};
+
+/*
+ * Pulses of a block as saved by the ROM: pilot tone, sync pulses, then two pulses per bit of the flag byte, the data
+ * and the checksum, most significant bit first.
+ */
+static std::vector<uint32_t> romBlock(uint8_t flag, const std::vector<uint8_t> &data) {
+    std::vector<uint32_t> pulses(DATA_PILOT_PULSES, PILOT_PULSE);
+    pulses.push_back(SYNC1_PULSE);
+    pulses.push_back(SYNC2_PULSE);
+    std::vector<uint8_t> bytes = { flag };
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    uint8_t checksum = 0;
+    for (uint8_t byte : bytes) {
+        checksum ^= byte;
+    }
+    bytes.push_back(checksum);
+    for (uint8_t byte : bytes) {
+        for (uint32_t bit = 0; bit < 8; bit++) {
+            const uint32_t pulse = ((byte << bit) & 0x80u) ? ONE_PULSE : ZERO_PULSE;
+            pulses.push_back(pulse);
+            pulses.push_back(pulse);
+        }
+    }
+    return pulses;
+}
+
+/*
+ * Checks that the level reads low just before every change of the signal, up to the given number of changes, and
+ * high just after it, within the time of a sample.
+ */
+static bool followsPulses(ZxTapeInput &tape, const std::vector<uint32_t> &pulses, uint32_t sampleRate) {
+    const uint64_t lag = CLOCK_FREQUENCY / sampleRate + 1;
+    uint64_t tstates = 0;
+    bool high = false;
+    for (uint32_t pulse : pulses) {
+        tstates += pulse;
+        if (tape.level(tstates - 1) != high || tape.level(tstates + lag) == high) {
+            return false;
+        }
+        high = !high;
+    }
+    return true;
+}
+
+
+TEST_SUITE("Tape input") {
+
+    TEST_CASE("The level changes at the edges of the recording, within a sample") {
+        const Format format = { 44100, 1, 16, 12000, 0, 0 };
+        const auto pulses = romBlock(0xFF, { 0x00, 0x55, 0xAA, 0xFF });
+        GeneratedTape recording(format, pulses);
+        ZxTapeInput tape(CLOCK_FREQUENCY);
+        REQUIRE(tape.insert(&recording));
+        CHECK(tape.sampleRate() == 44100);
+        tape.play(0);
+
+        CHECK(followsPulses(tape, pulses, format.sampleRate));
+        CHECK(tape.edges() == pulses.size());
+    }
+
+    TEST_CASE("Noise within the hysteresis makes no edges and the centre follows a DC offset") {
+        // 8-bit stereo, well off centre, with noise nearly as large as the hysteresis
+        const Format format = { 22050, 2, 8, 6000, 3000, ZxTapeInput::HYSTERESIS * 3 / 4 };
+        const auto pulses = romBlock(0x00, { 0x12, 0x34 });
+        GeneratedTape recording(format, pulses);
+        ZxTapeInput tape(CLOCK_FREQUENCY);
+        REQUIRE(tape.insert(&recording));
+        tape.play(0);
+
+        CHECK(followsPulses(tape, pulses, format.sampleRate));
+        tape.level(UINT64_MAX / 2);
+        CHECK(tape.ended());
+        CHECK(tape.edges() == pulses.size());
+    }
+
+    TEST_CASE("Going back in time hears the tape as it was then") {
+        const Format format = { 44100, 1, 16, 12000, 0, 0 };
+        GeneratedTape recording(format, romBlock(0xFF, { 0x0F }));
+        ZxTapeInput tape(CLOCK_FREQUENCY);
+        REQUIRE(tape.insert(&recording));
+        const uint64_t start = 1000000;
+        tape.play(start);
+
+        // Before the tape starts and a few frames into the pilot tone, every 100 T-states
+        std::vector<bool> levels;
+        for (uint64_t tstates = start - 10000; tstates < start + 4 * TSTATES_PER_FRAME; tstates += 100) {
+            levels.push_back(tape.level(tstates));
+        }
+        CHECK(std::count(levels.begin(), levels.end(), true) > 0);
+        CHECK(std::count(levels.begin(), levels.end(), false) > 0);
+
+        bool same = true;
+        size_t i = 0;
+        for (uint64_t tstates = start - 10000; tstates < start + 4 * TSTATES_PER_FRAME; tstates += 100) {
+            same = same && tape.level(tstates) == levels[i++];
+        }
+        CHECK(same);
+    }
+
+    TEST_CASE("Files that are not PCM WAV recordings with 8 or 16-bit samples are refused") {
+        const uint8_t text[] = "Not a WAV file, just some text that is long enough for a header";
+        ZxTapeMemorySource notWav(text, sizeof(text));
+        ZxTapeInput tape(CLOCK_FREQUENCY);
+        CHECK_FALSE(tape.insert(&notWav));
+        CHECK(tape.ended());
+
+        GeneratedTape recording({ 44100, 1, 24, 12000, 0, 0 }, { 1000, 1000 });
+        CHECK_FALSE(tape.insert(&recording));
+
+        ZxTapeFile missing;
+        CHECK_FALSE(missing.open("no_such_tape.wav"));
+        CHECK(missing.read(nullptr, 0) == 0);
+    }
+
+    TEST_CASE("A long recording is streamed in chunks and reads cost nothing between edges") {
+        // Two minutes of pilot tone read every 20 T-states, as tightly as a loader polls the port
+        const Format format = { 44100, 1, 16, 12000, 0, 0 };
+        const uint32_t seconds = 120;
+        const uint32_t repeats = seconds * CLOCK_FREQUENCY / PILOT_PULSE;
+        GeneratedTape recording(format, { PILOT_PULSE }, repeats);
+        ZxTapeInput tape(CLOCK_FREQUENCY);
+        REQUIRE(tape.insert(&recording));
+        tape.play(0);
+
+        bool streamed = true;
+        uint64_t reads = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t tstates = 0; tstates < static_cast<uint64_t>(seconds) * CLOCK_FREQUENCY; tstates += 20) {
+            tape.level(tstates);
+            reads++;
+            // Never more than a chunk of samples ahead of the tape
+            if (tstates % CLOCK_FREQUENCY == 0) {
+                const uint64_t samples = tstates * format.sampleRate / CLOCK_FREQUENCY + 1;
+                streamed = streamed &&
+                           recording.bytesRead() <= recording.headerSize() + (samples + ZxTapeInput::CHUNK_FRAMES) * 2;
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+        CHECK(streamed);
+        CHECK(tape.edges() >= repeats - 1);
+        CHECK(tape.edges() <= repeats);
+        std::printf("Tape input: %llu reads and %llu edges in %.1f ms, %.2f ns per read\n",
+                    static_cast<unsigned long long>(reads), static_cast<unsigned long long>(tape.edges()),
+                    elapsed.count() / 1e6, elapsed.count() / static_cast<double>(reads));
+    }
+
+    TEST_CASE("The ROM loads a block from the tape through the EAR bit of the ULA port") {
+        ZxTestMachine<> machine;
+        Z80emu &z80emu = machine.z80emu;
+        const std::vector<uint8_t> program = {
+                0x31, 0x00, 0x7F,       // LD SP,0x7F00
+                0xDD, 0x21, 0x00, 0xA0, // LD IX,0xA000
+                0x11, 0x00, 0x01,       // LD DE,256
+                0x3E, 0xFF,             // LD A,0xFF
+                0x37,                   // SCF
+                0xCD, 0x56, 0x05,       // CALL LD-BYTES
+                0x9F,                   // SBC A,A          0xFF if the block loaded
+                0x32, 0x00, 0x91,       // LD (0x9100),A
+                0x18, 0xFE              // JR $
+        };
+        REQUIRE(machine.load(program));
+
+        std::vector<uint8_t> data(256);
+        for (uint32_t i = 0; i < data.size(); i++) {
+            data[i] = static_cast<uint8_t>(i * 37 + 11);
+        }
+        GeneratedTape recording({ 44100, 1, 8, 20000, 0, 0 }, romBlock(0xFF, data));
+        ZxTapeInput tape(CLOCK_FREQUENCY);
+        REQUIRE(tape.insert(&recording));
+        tape.play(Clock::getInstance().getAbsTstates());
+        z80emu.setTape(&tape);
+
+        // About two seconds of pilot tone and one and a half of data
+        z80emu.getRam()[0x9100] = 0x55;
+        for (uint32_t frame = 0; frame < 250 && z80emu.getRam()[0x9100] == 0x55; frame++) {
+            z80emu.execute(TSTATES_PER_FRAME);
+            Clock::getInstance().endFrame();
+        }
+        z80emu.setTape(nullptr);
+
+        CHECK(z80emu.getRam()[0x9100] == 0xFF);
+        CHECK(std::equal(data.begin(), data.end(), z80emu.getRam() + 0xA000));
+    }
+}
+
+#endif // ZXRASPBERRY_ZXTAPEINPUTTEST_CPP
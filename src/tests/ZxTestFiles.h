@@ -0,0 +1,37 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXTESTFILES_H
+#define ZXRASPBERRY_ZXTESTFILES_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Little endian value of the given number of bytes at the offset, e.g. a field of a WAV header
+inline uint32_t readLE(const std::vector<uint8_t> &data, size_t offset, uint32_t bytes) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint32_t>(data[offset + i]) << (i * 8);
+    }
+    return value;
+}
+
+// Whole contents of the file, or nothing if it cannot be opened
+inline std::vector<uint8_t> readFile(const std::string &fileName) {
+    std::vector<uint8_t> data;
+    std::FILE *pFile = std::fopen(fileName.c_str(), "rb");
+    if (pFile != nullptr) {
+        uint8_t buffer[65536];
+        size_t size;
+        while ((size = std::fread(buffer, 1, sizeof(buffer), pFile)) > 0) {
+            data.insert(data.end(), buffer, buffer + size);
+        }
+        std::fclose(pFile);
+    }
+    return data;
+}
+
+#endif // ZXRASPBERRY_ZXTESTFILES_H
@@ -0,0 +1,51 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXTESTMACHINE_H
+#define ZXRASPBERRY_ZXTESTMACHINE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <circle/bcmframebuffer.h>
+#include "clock.h"
+#include "Z80emu.h"
+#include "zxdisplay.h"
+#include "hardware/zxhardwaremodel48k.h"
+#include "zx48k_rom.h"
+
+/*
+ * Spectrum with the 48K ROM, drawing into a 32 bpp frame buffer.  On models with paging, the 48K ROM is ROM 1, the one
+ * that 48K snapshots run with, and ROM 0 is blank.
+ */
+template<typename Model = ZxHardwareModel48k>
+struct ZxTestMachine {
+    ZxTestMachine() : z80emu(&display) {
+        Clock::getInstance().setSpectrumModel(&model);
+        z80emu.setHardwareModel(&model);
+        display.Initialize(z80emu.getRam() + 0x4000,
+                           new CBcmFrameBuffer(ZxDisplay::DISPLAY_WIDTH, ZxDisplay::DISPLAY_HEIGHT, 32));
+        display.setHardwareModel(&model);
+        std::vector<uint8_t> roms(model.romPages() * 0x4000 - zx48k_rom_len, 0);
+        roms.insert(roms.end(), zx48k_rom, zx48k_rom + zx48k_rom_len);
+        z80emu.loadRom(roms.data(), roms.size());
+    }
+
+    // Runs the program at 0x9000 from a snapshot with interrupts off, which returns to it through the stack at 0x8000
+    bool load(const std::vector<uint8_t> &program) {
+        std::vector<uint8_t> snapshot(49152 + 27, 0);
+        snapshot[23] = 0x00;
+        snapshot[24] = 0x80;
+        snapshot[27 + 0x4000] = 0x00;
+        snapshot[27 + 0x4001] = 0x90;
+        std::copy(program.begin(), program.end(), snapshot.begin() + 27 + 0x5000);
+        return z80emu.loadSnapshot(snapshot.data(), snapshot.size());
+    }
+
+    Model model;
+    ZxDisplay display;
+    Z80emu z80emu;
+};
+
+#endif // ZXRASPBERRY_ZXTESTMACHINE_H
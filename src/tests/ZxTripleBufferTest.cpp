@@ -0,0 +1,84 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXTRIPLEBUFFERTEST_CPP
+#define ZXRASPBERRY_ZXTRIPLEBUFFERTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <thread>
+#include "zxtriplebuffer.h"
+
+TEST_SUITE("ZX triple buffer") {
+
+    TEST_CASE("The consumer always takes the latest published frame") {
+        ZxTripleBuffer buffers;
+        uint32_t frames[ZxTripleBuffer::BUFFERS] = { 0 };
+
+        // Nothing has been published yet
+        CHECK_FALSE(buffers.take());
+
+        frames[buffers.back()] = 1;
+        buffers.publish();
+        frames[buffers.back()] = 2;
+        buffers.publish();
+        CHECK(buffers.back() != buffers.front());
+
+        // Frame 1 was replaced by frame 2 before it was taken
+        CHECK(buffers.take());
+        CHECK(frames[buffers.front()] == 2);
+        CHECK_FALSE(buffers.take());
+        CHECK(frames[buffers.front()] == 2);
+
+        frames[buffers.back()] = 3;
+        buffers.publish();
+        CHECK(buffers.back() != buffers.front());
+        CHECK(buffers.take());
+        CHECK(frames[buffers.front()] == 3);
+    }
+
+    TEST_CASE("Producer and consumer never share a buffer") {
+        ZxTripleBuffer buffers;
+        // Each frame is written in full by the producer, so a torn frame has different values in it
+        static uint32_t frames[ZxTripleBuffer::BUFFERS][1024];
+        const uint32_t count = 20000;
+        uint32_t torn = 0;
+        uint32_t outOfOrder = 0;
+
+        std::thread consumer([&]() {
+            uint32_t last = 0;
+            while (last < count) {
+                if (buffers.take()) {
+                    const uint32_t *pFrame = frames[buffers.front()];
+                    for (uint32_t i = 1; i < 1024; i++) {
+                        torn += (pFrame[i] != pFrame[0]) ? 1 : 0;
+                    }
+                    outOfOrder += (pFrame[0] <= last) ? 1 : 0;
+                    last = pFrame[0];
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        for (uint32_t frame = 1; frame <= count; frame++) {
+            uint32_t *pFrame = frames[buffers.back()];
+            for (uint32_t i = 0; i < 1024; i++) {
+                pFrame[i] = frame;
+            }
+            buffers.publish();
+            if (frame % 64 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+
+        CHECK(torn == 0);
+        CHECK(outOfOrder == 0);
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXTRIPLEBUFFERTEST_CPP
@@ -0,0 +1,118 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXUPSCALERTEST_CPP
+#define ZXRASPBERRY_ZXUPSCALERTEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "zxdisplayrenderer.h"
+#include "zxupscaler.h"
+#include "BruceLeeScr.h"
+
+// 44 cells per line, 296 lines, with the screen starting 48 lines down and 6 cells across
+static const uint32_t WIDTH = 352;
+static const uint32_t HEIGHT = 296;
+static const uint32_t CELLS = 44 * 296;
+static const uint32_t FIRST_SCREEN_CELL = 48 * 44 + 6;
+
+static std::vector<uint32_t> renderFrame() {
+    ZxPixelRenderer<ZxPackedFormat<uint32_t>> renderer(44, FIRST_SCREEN_CELL);
+    std::vector<uint32_t> frame(CELLS * 8);
+    renderer.fillCells(reinterpret_cast<uint8_t *>(frame.data()), 0, CELLS, 0x02);
+    renderer.drawScreen(reinterpret_cast<uint8_t *>(frame.data()), BruceLee_scr, 0, 6144, 0x7F);
+    return frame;
+}
+
+// Averages each of the 4 bytes of two pixels, rounding up
+static uint32_t average(uint32_t a, uint32_t b) {
+    uint32_t value = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        value |= ((((a >> shift) & 0xFFu) + ((b >> shift) & 0xFFu) + 1) / 2) << shift;
+    }
+    return value;
+}
+
+TEST_SUITE("ZX upscaler") {
+
+    TEST_CASE("Pixels are replicated, blurred and darkened") {
+        const uint32_t source[] = { 0xFF000000u, 0xFFFFFFFFu, 0xFF804020u, 0xFF102030u, 0xFF00FF00u };
+        const uint32_t width = 5;
+        ZxUpscaler upscaler(width, 1, 2);
+        std::vector<uint32_t> target(width * 2 * 2);
+
+        upscaler.process(source, target.data(), width * 2);
+        for (uint32_t x = 0; x < width * 2; x++) {
+            CHECK(target[x] == source[x / 2]);
+            CHECK(target[width * 2 + x] == source[x / 2]);
+        }
+
+        upscaler.setScanlineBrightness(128);
+        upscaler.process(source, target.data(), width * 2);
+        CHECK(target[width * 2 + 2] == 0xFF7F7F7Fu);
+        CHECK(target[width * 2 + 4] == 0xFF402010u);
+
+        upscaler.setScanlineBrightness(ZxUpscaler::NO_SCANLINES);
+        upscaler.setBlur(true);
+        upscaler.process(source, target.data(), width * 2);
+        CHECK(target[0] == average(source[0], average(source[0], source[1])));
+        CHECK(target[4] == average(source[2], average(source[1], source[3])));
+        CHECK(target[9] == average(source[4], average(source[3], source[4])));
+    }
+
+    TEST_CASE("The vectorised and plain upscalers produce the same frames") {
+        auto frame = renderFrame();
+        // An odd width exercises the plain code at the end of each line
+        const uint32_t widths[] = { WIDTH, 13 };
+
+        for (uint32_t width : widths) {
+            for (uint32_t scale = ZxUpscaler::MIN_SCALE; scale <= ZxUpscaler::MAX_SCALE; scale++) {
+                for (uint32_t options = 0; options < 4; options++) {
+                    ZxUpscaler upscaler(width, HEIGHT, scale);
+                    upscaler.setBlur((options & 1) != 0);
+                    upscaler.setScanlineBrightness((options & 2) ? 160 : ZxUpscaler::NO_SCANLINES);
+                    // Leave some room between lines to check that the target pitch is respected
+                    const uint32_t pitch = width * scale + 3;
+                    std::vector<uint32_t> expected(pitch * HEIGHT * scale, 0x12345678u);
+                    std::vector<uint32_t> actual(expected);
+
+                    upscaler.setVectorised(false);
+                    upscaler.process(frame.data(), expected.data(), pitch);
+                    upscaler.setVectorised(true);
+                    upscaler.process(frame.data(), actual.data(), pitch);
+                    CHECK(actual == expected);
+                    CHECK(actual[pitch - 1] == 0x12345678u);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Upscaling a frame 3x with scanlines and blur takes a couple of milliseconds") {
+        auto frame = renderFrame();
+        ZxUpscaler upscaler(WIDTH, HEIGHT, 3);
+        upscaler.setBlur(true);
+        upscaler.setScanlineBrightness(160);
+        std::vector<uint32_t> target(upscaler.targetWidth() * upscaler.targetHeight());
+
+        // Not an assertion: report the time taken to upscale a frame on this machine
+        const uint32_t frames = 200;
+        for (bool vectorised : { false, true }) {
+            upscaler.setVectorised(vectorised);
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < frames; i++) {
+                upscaler.process(frame.data(), target.data(), upscaler.targetWidth());
+            }
+            auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+            std::printf("3x upscale time (%s): %8.2f us\n", vectorised && ZxUpscaler::isVectorised() ? "SIMD " : "plain",
+                        elapsed.count() / frames);
+        }
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXUPSCALERTEST_CPP
@@ -0,0 +1,188 @@
+//
+// Created by José Hernández on 18/10/2026.
+//
+
+#ifndef ZXRASPBERRY_ZXVIDEOCAPTURETEST_CPP
+#define ZXRASPBERRY_ZXVIDEOCAPTURETEST_CPP
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "zxdisplayrenderer.h"
+#include "stream/zxframequeue.h"
+#include "stream/zxvideocapture.h"
+#include "BruceLeeScr.h"
+#include "ZxTestFiles.h"
+
+// 44 cells per line, 296 lines, with the screen starting 48 lines down and 6 cells across
+static const uint32_t WIDTH = 352;
+static const uint32_t HEIGHT = 296;
+static const uint32_t CELLS = 44 * 296;
+static const uint32_t FIRST_SCREEN_CELL = 48 * 44 + 6;
+
+static std::vector<uint8_t> renderFrame(ZxDisplayRenderer &renderer, uint8_t border) {
+    std::vector<uint8_t> frame(CELLS * renderer.depth());
+    renderer.fillCells(frame.data(), 0, CELLS, border);
+    renderer.drawScreen(frame.data(), BruceLee_scr, 0, 6144, 0x7F);
+    return frame;
+}
+
+TEST_SUITE("ZX video capture") {
+
+    TEST_CASE("The frame queue drops frames when full and keeps them in order") {
+        ZxFrameQueue queue(16, 4);
+        for (uint32_t i = 0; i < 4; i++) {
+            ZxFrameQueue::Slot *pSlot = queue.acquire();
+            REQUIRE(pSlot != nullptr);
+            pSlot->frameNumber = i;
+            queue.publish();
+        }
+        CHECK(queue.acquire() == nullptr);
+        CHECK(queue.front()->frameNumber == 0);
+        queue.release();
+        CHECK(queue.acquire() != nullptr);
+
+        // Hand over frames between two threads, checking that the consumer sees every published frame in order
+        ZxFrameQueue shared(sizeof(uint32_t), 8);
+        const uint32_t frames = 100000;
+        uint32_t mismatches = 0;
+        std::thread consumer([&shared, &mismatches]() {
+            for (uint32_t expected = 0; expected < frames; ) {
+                ZxFrameQueue::Slot *pSlot = shared.front();
+                if (pSlot != nullptr) {
+                    uint32_t value;
+                    std::memcpy(&value, pSlot->pFrame, sizeof(value));
+                    mismatches += (value != expected || pSlot->frameNumber != expected) ? 1 : 0;
+                    shared.release();
+                    expected++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        for (uint32_t i = 0; i < frames; ) {
+            ZxFrameQueue::Slot *pSlot = shared.acquire();
+            if (pSlot != nullptr) {
+                std::memcpy(pSlot->pFrame, &i, sizeof(i));
+                pSlot->frameNumber = i;
+                shared.publish();
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("Frames are written as Y4M video") {
+        const std::string fileName = "zxvideocapture_test.y4m";
+        ZxPixelRenderer<ZxPackedFormat<uint32_t>> renderer(44, FIRST_SCREEN_CELL);
+        auto frame = renderFrame(renderer, 0x00);
+
+        ZxVideoCapture capture(WIDTH, HEIGHT, 32);
+        REQUIRE(capture.start(fileName.c_str(), ZxVideoCapture::Format::Y4M));
+        const uint32_t frames = 10;
+        for (uint32_t i = 0; i < frames; i++) {
+            capture.frameCompleted(frame.data(), 32);
+            // Frames of the wrong colour depth are ignored
+            capture.frameCompleted(frame.data(), 16);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        capture.stop();
+        CHECK(capture.framesCaptured() == frames);
+        CHECK(capture.framesWritten() + capture.framesDropped() == frames);
+        CHECK_FALSE(capture.writeFailed());
+
+        auto data = readFile(fileName);
+        const std::string header = "YUV4MPEG2 W352 H296 F3500000:69888 Ip A1:1 C420jpeg\n";
+        const size_t frameSize = 6 + WIDTH * HEIGHT * 3 / 2;
+        REQUIRE(data.size() > header.size());
+        CHECK(std::memcmp(data.data(), header.data(), header.size()) == 0);
+        // Dropped frames, if any, are filled in by repeating the next frame
+        CHECK(data.size() == header.size() + capture.framesWritten() * frameSize +
+                             (frames - capture.framesWritten()) * frameSize);
+
+        // The top left pixel is in the black border: Y = 16, U = V = 128
+        const uint8_t *pFrame = data.data() + header.size();
+        CHECK(std::memcmp(pFrame, "FRAME\n", 6) == 0);
+        CHECK(pFrame[6] == 16);
+        CHECK(pFrame[6 + WIDTH * HEIGHT] == 128);
+        CHECK(pFrame[6 + WIDTH * HEIGHT + WIDTH * HEIGHT / 4] == 128);
+        std::remove(fileName.c_str());
+    }
+
+    TEST_CASE("Frames are written as raw RGB with timestamps") {
+        const std::string fileName = "zxvideocapture_test.rgb";
+        ZxPixelRenderer<ZxIndexed4Format<ZxMaskFillLookup>> renderer4(44, FIRST_SCREEN_CELL);
+        ZxPixelRenderer<ZxPackedFormat<uint32_t>> renderer32(44, FIRST_SCREEN_CELL);
+        auto frame4 = renderFrame(renderer4, 0x02);
+        auto frame32 = renderFrame(renderer32, 0x02);
+
+        ZxVideoCapture capture(WIDTH, HEIGHT, 4);
+        REQUIRE(capture.start(fileName.c_str(), ZxVideoCapture::Format::Raw));
+        CHECK_FALSE(capture.start(fileName.c_str(), ZxVideoCapture::Format::Raw));
+        const uint32_t frames = 5;
+        for (uint32_t i = 0; i < frames; i++) {
+            capture.frameCompleted(frame4.data(), 4);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        capture.stop();
+        REQUIRE(capture.framesWritten() > 0);
+
+        auto data = readFile(fileName);
+        REQUIRE(data.size() == capture.framesWritten() * WIDTH * HEIGHT * 3);
+        uint32_t mismatches = 0;
+        for (uint32_t pixel = 0; pixel < WIDTH * HEIGHT; pixel++) {
+            uint32_t xrgb = reinterpret_cast<const uint32_t *>(frame32.data())[pixel];
+            mismatches += (data[pixel * 3] != ((xrgb >> 16) & 0xFFu)) ? 1 : 0;
+            mismatches += (data[pixel * 3 + 1] != ((xrgb >> 8) & 0xFFu)) ? 1 : 0;
+            mismatches += (data[pixel * 3 + 2] != (xrgb & 0xFFu)) ? 1 : 0;
+        }
+        CHECK(mismatches == 0);
+
+        auto timestamps = readFile(fileName + ".timestamps");
+        std::string text(timestamps.begin(), timestamps.end());
+        uint32_t frameNumber;
+        unsigned long long timestamp;
+        unsigned long long previous = 0;
+        uint32_t lines = 0;
+        for (size_t offset = 0; std::sscanf(text.c_str() + offset, "%u %llu", &frameNumber, &timestamp) == 2;
+             offset = text.find('\n', offset) + 1) {
+            CHECK(timestamp >= previous);
+            previous = timestamp;
+            lines++;
+        }
+        CHECK(lines == capture.framesWritten());
+        std::remove(fileName.c_str());
+        std::remove((fileName + ".timestamps").c_str());
+    }
+
+    TEST_CASE("Stopping straight after a frame still writes it out") {
+        const std::string fileName = "zxvideocapture_stop_test.y4m";
+        ZxPixelRenderer<ZxPackedFormat<uint32_t>> renderer(44, FIRST_SCREEN_CELL);
+        auto frame = renderFrame(renderer, 0x00);
+
+        uint32_t lost = 0;
+        for (uint32_t run = 0; run < 50; run++) {
+            ZxVideoCapture capture(WIDTH, HEIGHT, 32);
+            REQUIRE(capture.start(fileName.c_str(), ZxVideoCapture::Format::Y4M));
+            // Give the writer time to find the queue empty and go to sleep
+            std::this_thread::sleep_for(std::chrono::microseconds(run * 50));
+            capture.frameCompleted(frame.data(), 32);
+            capture.stop();
+            lost += (capture.framesWritten() == 1) ? 0 : 1;
+        }
+        CHECK(lost == 0);
+        std::remove(fileName.c_str());
+    }
+
+}
+
+#endif //ZXRASPBERRY_ZXVIDEOCAPTURETEST_CPP